@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../../StereoKitC/stereokit.h"
+
+// Headless tests and benchmarks for the parts of StereoKit that don't need
+// a device, window or GPU. Each one returns false if something it checked
+// failed, and benchmarks print their own timings as they go.
+//
+// Most of them compile the engine code they exercise straight into this
+// project. The ones that need more of the engine call into StereoKitC.dll,
+// which only builds for x64 on desktop, so they're left out elsewhere.
+#if defined(_M_X64)
+#define BENCH_STEREOKIT_DLL
+#endif
+
+bool   bench_check  (bool passed, const char *format, ...);
+bool   bench_near   (float value, float expected, float tolerance, const char *what);
+double bench_time_ms();
+
+bool test_pose_predict    ();
+bool bench_light_cluster  ();
+bool test_offset_allocator();
+bool test_state_cache     ();
+bool test_pixel_convert   ();
+#if defined(BENCH_STEREOKIT_DLL)
+bool bench_bulk           ();
+bool bench_particles      ();
+bool test_mesh_simplify   ();
+#endif
@@ -0,0 +1,51 @@
+#include "bench.h"
+
+#if defined(BENCH_STEREOKIT_DLL)
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+using namespace std;
+using namespace sk;
+
+///////////////////////////////////////////
+
+// Native side of the bulk submission comparison: one exported call per
+// pose against a single pose_matrix_list call for all of them. The C#
+// side, where each call is a P/Invoke, is in the StereoKitTest
+// DemoBulkSubmit scene, since it needs the runtime up.
+bool bench_bulk() {
+	const int32_t count = 10000;
+	const int32_t runs  = 50;
+
+	vector<pose_t> poses   (count);
+	vector<matrix> per_call(count);
+	vector<matrix> bulk    (count);
+	for (int32_t i = 0; i < count; i++) {
+		float angle = i * 0.001f;
+		poses[i] = { vec3{ (float)(i % 100), (float)(i / 100), -1 }, quat{ 0, sinf(angle), 0, cosf(angle) } };
+	}
+
+	double best_call = 1e9, best_bulk = 1e9;
+	for (int32_t r = 0; r < runs; r++) {
+		double start = bench_time_ms();
+		for (int32_t i = 0; i < count; i++)
+			per_call[i] = pose_matrix(poses[i]);
+		double mid = bench_time_ms();
+		pose_matrix_list(poses.data(), count, bulk.data());
+		double end = bench_time_ms();
+
+		if (mid - start < best_call) best_call = mid - start;
+		if (end - mid   < best_bulk) best_bulk = end - mid;
+	}
+	printf("  %d poses: per call %.1f ns each, list %.1f ns each (%.2fx)\n", count,
+		best_call * 1000000 / count,
+		best_bulk * 1000000 / count,
+		best_call / best_bulk);
+
+	return bench_check(memcmp(per_call.data(), bulk.data(), sizeof(matrix) * count) == 0,
+		"pose_matrix_list doesn't match pose_matrix");
+}
+
+#endif
@@ -0,0 +1,129 @@
+#include "bench.h"
+#include "../../StereoKitC/light_cluster.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <random>
+#include <vector>
+using namespace std;
+using namespace sk;
+
+///////////////////////////////////////////
+
+// Big enough that it shouldn't go on the stack
+cluster_bins_t light_bins;
+cluster_bins_t light_bins_split;
+
+///////////////////////////////////////////
+
+vec3 light_bench_transform(const matrix &m, const vec3 &pt) {
+	return vec3{
+		pt.x*m.row[0].x + pt.y*m.row[1].x + pt.z*m.row[2].x + m.row[3].x,
+		pt.x*m.row[0].y + pt.y*m.row[1].y + pt.z*m.row[2].y + m.row[3].y,
+		pt.x*m.row[0].z + pt.y*m.row[1].z + pt.z*m.row[2].z + m.row[3].z };
+}
+
+///////////////////////////////////////////
+
+int32_t light_bench_cell(float ndc, int32_t cells) {
+	int32_t result = (int32_t)floorf((ndc * 0.5f + 0.5f) * cells);
+	return result < 0 ? 0 : (result >= cells ? cells - 1 : result);
+}
+
+///////////////////////////////////////////
+
+// Finds the froxel a world point lands in, the same way the PBR shader does.
+const cluster_cell_t &light_bench_find(const cluster_bins_t &bins, const cluster_grid_t &grid, vec3 world) {
+	vec3    view  = light_bench_transform(grid.view, world);
+	float   depth = fmaxf(-view.z, grid.near_plane);
+	int32_t x     = light_bench_cell(grid.proj.x * view.x / depth - grid.proj.z, cluster_x);
+	int32_t y     = light_bench_cell(grid.proj.y * view.y / depth - grid.proj.w, cluster_y);
+	int32_t z     = (int32_t)floorf(logf(depth / grid.near_plane) * grid.depth_scale);
+	z = z < 0 ? 0 : (z >= cluster_z ? cluster_z - 1 : z);
+	return bins.cells[(z * cluster_y + y) * cluster_x + x];
+}
+
+///////////////////////////////////////////
+
+bool bench_light_cluster() {
+	const int32_t light_count = 1000;
+	const int32_t runs        = 50;
+	bool          result      = true;
+
+	// Two eyes a little apart with asymmetric frustums, like a headset
+	matrix views[2] = {}, projs[2] = {};
+	for (int32_t e = 0; e < 2; e++) {
+		float l = e ? -1.1f : -0.9f;
+		float r = e ?  0.9f :  1.1f;
+		views[e].row[0] = { 1, 0, 0, 0 };
+		views[e].row[1] = { 0, 1, 0, 0 };
+		views[e].row[2] = { 0, 0, 1, 0 };
+		views[e].row[3] = { e ? -0.032f : 0.032f, -1.5f, 0, 1 };
+		projs[e].row[0].x = 2 / (r - l);
+		projs[e].row[1].y = 1;
+		projs[e].row[2].x = (r + l) / (r - l);
+		projs[e].row[2].w = -1;
+	}
+	cluster_grid_t grid = light_cluster_grid(views, projs, 2, 0.01f, 50);
+
+	mt19937                         rng(3);
+	uniform_real_distribution<float> unit(0, 1);
+	vector<cluster_light_t>          lights(light_count);
+	for (int32_t i = 0; i < light_count; i++) {
+		lights[i] = {};
+		lights[i].pos            = vec3{ (unit(rng) * 2 - 1) * 10, 1.5f + (unit(rng) * 2 - 1) * 5, -unit(rng) * 20 };
+		lights[i].radius         = 0.1f + unit(rng) * 2;
+		lights[i].spot_cos_outer = -2;
+	}
+
+	double best = 1e9;
+	for (int32_t r = 0; r < runs; r++) {
+		double start = bench_time_ms();
+		light_cluster_bounds    (light_bins, grid, lights.data(), light_count);
+		light_cluster_bin_slices(light_bins, 0, cluster_z);
+		light_cluster_finish    (light_bins);
+		double time = bench_time_ms() - start;
+		if (time < best) best = time;
+	}
+	printf("  %d lights: %.1f us, %d visible, %d indices\n", light_count, best * 1000,
+		(int32_t)light_bins.visible.size(),
+		(int32_t)light_bins.indices.size());
+
+	// Binning slices in separate chunks, like the job pool does, has to
+	// come out the same as doing it all at once.
+	light_cluster_bounds    (light_bins_split, grid, lights.data(), light_count);
+	light_cluster_bin_slices(light_bins_split, cluster_z / 2, cluster_z);
+	light_cluster_bin_slices(light_bins_split, 0, cluster_z / 2);
+	light_cluster_finish    (light_bins_split);
+	result &= bench_check(
+		light_bins_split.indices == light_bins.indices &&
+		memcmp(light_bins_split.cells, light_bins.cells, sizeof(light_bins.cells)) == 0,
+		"binning in chunks doesn't match binning all at once");
+
+	// Any visible point inside a light's radius must find that light in its
+	// froxel, or it would be lit wrong.
+	int32_t checks = 0, misses = 0;
+	for (int32_t i = 0; i < 100000; i++) {
+		int32_t eye   = i & 1;
+		float   depth = 0.02f + unit(rng) * unit(rng) * 49;
+		vec3    pt    = {
+			-views[eye].row[3].x + (unit(rng) * 2 - 1) * depth,
+			1.5f                 + (unit(rng) * 2 - 1) * depth,
+			-depth };
+		const cluster_cell_t &cell = light_bench_find(light_bins, grid, pt);
+		for (int32_t l = 0; l < light_count; l++) {
+			if (vec3_magnitude(lights[l].pos - pt) >= lights[l].radius)
+				continue;
+			checks += 1;
+			bool found = false;
+			for (uint32_t c = 0; c < cell.count && !found; c++)
+				found = light_bins.indices[cell.offset + c] == (uint32_t)l;
+			if (!found)
+				misses += 1;
+		}
+	}
+	result &= bench_check(checks > 0,  "no sample points landed inside a light");
+	result &= bench_check(misses == 0, "%d of %d lit points didn't find their light", misses, checks);
+	return result;
+}
@@ -0,0 +1,88 @@
+#include "bench.h"
+
+#if defined(BENCH_STEREOKIT_DLL)
+
+#include "../../StereoKitC/particle_sim.h"
+
+#include <stdio.h>
+#include <vector>
+using namespace std;
+using namespace sk;
+
+///////////////////////////////////////////
+
+// Runs the particle kernels the way particles_update does, a frame at a
+// time on a single thread, and reports how many particles each kernel gets
+// through in a millisecond. The emitter keeps spawning, so compaction
+// always has some dead particles to remove.
+bool bench_particles() {
+	const int32_t capacity = 100000;
+	const int32_t frames   = 300;
+	bool          result   = true;
+
+	particle_soa_t particles = {};
+	particle_soa_resize(particles, capacity);
+
+	particle_spawn_t spawn = {};
+	spawn.transform       = matrix_identity;
+	spawn.velocity        = vec3{ 0, 1, 0 };
+	spawn.velocity_spread = 0.5f;
+	spawn.radius          = 0.1f;
+	spawn.life_min        = 1;
+	spawn.life_max        = 3;
+	spawn.seed            = 1234;
+
+	particle_step_t step = { vec3{ 0, -9.8f, 0 }, 0.1f, 1 / 90.0f };
+
+	particle_look_t look = {};
+	look.right      = vec3{ 1, 0, 0 };
+	look.up         = vec3{ 0, 1, 0 };
+	look.forward    = vec3{ 0, 0, 1 };
+	look.size_start = 0.01f;
+	look.size_end   = 0.02f;
+	for (int32_t i = 0; i < particle_lut_size; i++)
+		look.lut[i] = color128{ 1, 1, 1, 1 - i / (float)(particle_lut_size - 1) };
+
+	result &= bench_check(particle_sim_spawn(particles, spawn, capacity + 100) == particles.capacity,
+		"spawning past capacity didn't fill the list");
+
+	vector<render_instance_t> instances(particles.capacity);
+	double  time_step = 0, time_compact = 0, time_instances = 0;
+	int64_t processed = 0, drawn = 0;
+	for (int32_t f = 0; f < frames; f++) {
+		int32_t count = particles.count;
+
+		double start = bench_time_ms();
+		particle_sim_step(particles, step, 0, particles.count);
+		double stepped = bench_time_ms();
+		int32_t removed = particle_sim_compact(particles);
+		double compacted = bench_time_ms();
+		particle_sim_instances(particles, look, 0, particles.count, instances.data());
+		double end = bench_time_ms();
+
+		time_step      += stepped   - start;
+		time_compact   += compacted - stepped;
+		time_instances += end       - compacted;
+		processed      += count;
+		drawn          += particles.count;
+
+		result &= bench_check(particles.count == count - removed, "compact removed %d but the count went from %d to %d", removed, count, particles.count);
+		for (int32_t i = 0; i < particles.count; i++) {
+			if (particles.life[i] >= 1) {
+				result &= bench_check(false, "particle %d is still alive at life %g", i, particles.life[i]);
+				break;
+			}
+		}
+		particle_sim_spawn(particles, spawn, 1000);
+	}
+	printf("  %d frames, %d alive at the end\n", frames, particles.count);
+	printf("  particles/ms: step %.0f, compact %.0f, instances %.0f\n",
+		processed / time_step,
+		processed / time_compact,
+		drawn     / time_instances);
+
+	particle_soa_free(particles);
+	return result;
+}
+
+#endif
@@ -0,0 +1,75 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+
+struct bench_t {
+	const char *name;
+	bool      (*run)();
+};
+
+bench_t benches[] = {
+	{ "pose_predict",     test_pose_predict     },
+	{ "light_cluster",    bench_light_cluster   },
+	{ "offset_allocator", test_offset_allocator },
+	{ "state_cache",      test_state_cache      },
+	{ "pixel_convert",    test_pixel_convert    },
+#if defined(BENCH_STEREOKIT_DLL)
+	{ "bulk",             bench_bulk            },
+	{ "particles",        bench_particles       },
+	{ "mesh_simplify",    test_mesh_simplify    },
+#endif
+};
+
+///////////////////////////////////////////
+
+bool bench_check(bool passed, const char *format, ...) {
+	if (passed)
+		return true;
+
+	va_list args;
+	va_start(args, format);
+	printf("    failed: ");
+	vprintf(format, args);
+	printf("\n");
+	va_end(args);
+	return false;
+}
+
+///////////////////////////////////////////
+
+bool bench_near(float value, float expected, float tolerance, const char *what) {
+	return bench_check(fabsf(value - expected) <= tolerance, "%s was %g, expected %g", what, value, expected);
+}
+
+///////////////////////////////////////////
+
+double bench_time_ms() {
+	return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+}
+
+///////////////////////////////////////////
+
+// Runs everything, or only the entries whose names contain one of the
+// arguments. Returns non-zero if anything failed, so it can gate a build.
+int main(int argc, char **argv) {
+	int32_t failures = 0;
+	for (size_t i = 0; i < _countof(benches); i++) {
+		bool selected = argc <= 1;
+		for (int32_t a = 1; a < argc; a++)
+			selected = selected || strstr(benches[i].name, argv[a]) != nullptr;
+		if (!selected)
+			continue;
+
+		printf("%s\n", benches[i].name);
+		bool passed = benches[i].run();
+		printf("  %s\n", passed ? "passed" : "FAILED");
+		if (!passed)
+			failures += 1;
+	}
+	printf("%d failed\n", failures);
+	return failures > 0 ? 1 : 0;
+}
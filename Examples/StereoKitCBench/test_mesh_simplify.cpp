@@ -0,0 +1,176 @@
+#include "bench.h"
+
+#if defined(BENCH_STEREOKIT_DLL)
+
+#include "../../StereoKitC/mesh_simplify.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+using namespace std;
+using namespace sk;
+
+///////////////////////////////////////////
+
+// A UV sphere, with a duplicated column of vertices down the UV seam and a
+// ring of duplicates at each pole, so it has plenty of seam vertices that
+// the simplifier has to leave alone.
+void simplify_test_sphere(int32_t segments, int32_t rings, vector<vert_t> &out_verts, vector<uint32_t> &out_inds) {
+	const float pi = 3.14159265f;
+	out_verts.clear();
+	out_inds .clear();
+	for (int32_t r = 0; r <= rings; r++) {
+	for (int32_t s = 0; s <= segments; s++) {
+		float u = s / (float)segments;
+		float v = r / (float)rings;
+		vec3  n = { cosf(u * 2 * pi) * sinf(v * pi), cosf(v * pi), sinf(u * 2 * pi) * sinf(v * pi) };
+		// The seam column and the poles need exactly the same positions as
+		// their twins, or they won't be recognized as seams.
+		if (s == segments) n = out_verts[r * (segments + 1)].pos;
+		if (r == 0)        n = vec3{ 0,  1, 0 };
+		if (r == rings)    n = vec3{ 0, -1, 0 };
+		out_verts.push_back({ n, n, vec2{ u, v }, color32{ 255, 255, 255, 255 } });
+	} }
+	for (int32_t r = 0; r < rings; r++) {
+	for (int32_t s = 0; s < segments; s++) {
+		uint32_t a = r * (segments + 1) + s;
+		uint32_t b = a + 1;
+		uint32_t c = a + segments + 1;
+		uint32_t d = c + 1;
+		// The triangles touching a pole would have no area
+		if (r != 0)         { out_inds.push_back(a); out_inds.push_back(b); out_inds.push_back(d); }
+		if (r != rings - 1) { out_inds.push_back(a); out_inds.push_back(d); out_inds.push_back(c); }
+	} }
+}
+
+///////////////////////////////////////////
+
+// A flat grid, which is all open border around the outside.
+void simplify_test_grid(int32_t cells, vector<vert_t> &out_verts, vector<uint32_t> &out_inds) {
+	out_verts.clear();
+	out_inds .clear();
+	for (int32_t y = 0; y <= cells; y++) {
+	for (int32_t x = 0; x <= cells; x++) {
+		vec2 uv = { x / (float)cells, y / (float)cells };
+		out_verts.push_back({ vec3{ uv.x, 0, uv.y }, vec3{ 0, 1, 0 }, uv, color32{ 255, 255, 255, 255 } });
+	} }
+	for (int32_t y = 0; y < cells; y++) {
+	for (int32_t x = 0; x < cells; x++) {
+		uint32_t a = y * (cells + 1) + x;
+		uint32_t c = a + cells + 1;
+		out_inds.push_back(a); out_inds.push_back(a + 1); out_inds.push_back(c + 1);
+		out_inds.push_back(a); out_inds.push_back(c + 1); out_inds.push_back(c);
+	} }
+}
+
+///////////////////////////////////////////
+
+// Simplified indices still point into the original vertex list, so a
+// vertex that's been left in place is one that's still referenced.
+bool simplify_test_kept(const vector<bool> &should_keep, const uint32_t *inds, int32_t ind_count, const char *what) {
+	vector<bool> used(should_keep.size(), false);
+	for (int32_t i = 0; i < ind_count; i++)
+		used[inds[i]] = true;
+	for (size_t i = 0; i < should_keep.size(); i++) {
+		if (!bench_check(!should_keep[i] || used[i], "%s vertex %d was collapsed", what, (int32_t)i))
+			return false;
+	}
+	return true;
+}
+
+///////////////////////////////////////////
+
+bool test_simplify_sphere() {
+	const float target_error = 0.02f;
+	bool        result       = true;
+
+	vector<vert_t>   verts;
+	vector<uint32_t> inds;
+	simplify_test_sphere(128, 64, verts, inds);
+	int32_t ind_count = (int32_t)inds.size();
+
+	// The UV seam runs down both sides of the texture. The pole vertices
+	// are locked too, but each one is only in a single triangle, which goes
+	// away when its two ring neighbors collapse together, so they're not
+	// expected to survive.
+	vector<bool> seam(verts.size(), false);
+	for (size_t i = 0; i < verts.size(); i++) {
+		int32_t s = (int32_t)(i % 129);
+		int32_t r = (int32_t)(i / 129);
+		seam[i] = (s == 0 || s == 128) && r != 0 && r != 64;
+	}
+
+	vector<uint32_t> out(ind_count);
+	float            prev_error = 0;
+	for (int32_t level = 1; level <= 4; level++) {
+		int32_t target = (ind_count >> level) / 3 * 3;
+		float   error  = -1;
+		double  start  = bench_time_ms();
+		int32_t count  = mesh_simplify(verts.data(), (int32_t)verts.size(), inds.data(), ind_count, out.data(), target, target_error, &error);
+		double  time   = bench_time_ms() - start;
+		printf("  %d -> %d tris (target %d), error %.4f, %.1f ms\n", ind_count / 3, count / 3, target / 3, error, time);
+
+		result &= bench_check(count % 3 == 0,     "index count %d isn't whole triangles", count);
+		result &= bench_check(count <= target,    "simplified to %d indices, target was %d", count, target);
+		result &= bench_check(error >= 0 && error <= target_error, "error %g is outside 0-%g", error, target_error);
+		result &= bench_check(error >= prev_error, "error dropped from %g to %g at a coarser level", prev_error, error);
+		result &= simplify_test_kept(seam, out.data(), count, "seam");
+		prev_error = error;
+	}
+
+	// A tight error bound stops early, and says so
+	float   error = -1;
+	int32_t count = mesh_simplify(verts.data(), (int32_t)verts.size(), inds.data(), ind_count, out.data(), 0, 0.001f, &error);
+	result &= bench_check(count > 0 && error <= 0.001f, "an error bound of 0.001 gave %d indices at error %g", count, error);
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool test_simplify_border() {
+	bool             result = true;
+	vector<vert_t>   verts;
+	vector<uint32_t> inds;
+	simplify_test_grid(32, verts, inds);
+	int32_t ind_count = (int32_t)inds.size();
+
+	vector<bool> border(verts.size(), false);
+	for (size_t i = 0; i < verts.size(); i++) {
+		int32_t x = (int32_t)(i % 33);
+		int32_t y = (int32_t)(i / 33);
+		border[i] = x == 0 || x == 32 || y == 0 || y == 32;
+	}
+
+	// Flat, so everything inside can go at no cost, but the border can't
+	vector<uint32_t> out(ind_count);
+	float            error = -1;
+	int32_t          count = mesh_simplify(verts.data(), (int32_t)verts.size(), inds.data(), ind_count, out.data(), 0, 0.01f, &error);
+	printf("  grid %d -> %d tris, error %.4f\n", ind_count / 3, count / 3, error);
+	result &= bench_check(count < ind_count / 4, "a flat grid only simplified to %d of %d indices", count, ind_count);
+	result &= bench_near (error, 0, 0.00001f, "flat grid error");
+	result &= simplify_test_kept(border, out.data(), count, "border");
+
+	// Compacting keeps the same triangles, with only the used vertices
+	vector<vert_t> compact(verts.size());
+	vector<uint32_t> compact_inds(out.begin(), out.begin() + count);
+	int32_t compact_count = mesh_simplify_compact(verts.data(), (int32_t)verts.size(), compact_inds.data(), count, compact.data());
+	result &= bench_check(compact_count <= (int32_t)verts.size(), "compact wrote %d vertices", compact_count);
+	for (int32_t i = 0; i < count; i++) {
+		vec3 a = verts  [out         [i]].pos;
+		vec3 b = compact[compact_inds[i]].pos;
+		if (!bench_check(a.x == b.x && a.y == b.y && a.z == b.z, "compacted index %d points at a different vertex", i))
+			return false;
+	}
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool test_mesh_simplify() {
+	bool result = true;
+	result &= test_simplify_sphere();
+	result &= test_simplify_border();
+	return result;
+}
+
+#endif
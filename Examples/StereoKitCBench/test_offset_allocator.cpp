@@ -0,0 +1,144 @@
+#include "bench.h"
+#include "../../StereoKitC/offset_allocator.h"
+
+#include <stdio.h>
+#include <random>
+#include <vector>
+#include <algorithm>
+using namespace std;
+using namespace sk;
+
+///////////////////////////////////////////
+
+struct alloc_test_t {
+	offset_alloc_t alloc;
+	uint32_t       size;
+};
+
+///////////////////////////////////////////
+
+// Live allocations must sit inside the range without overlapping, and the
+// free space has to account for everything that isn't live.
+bool test_alloc_consistent(const offset_allocator_t &allocator, const vector<alloc_test_t> &live) {
+	vector<pair<uint32_t, uint32_t>> ranges;
+	uint64_t                         used = 0;
+	for (size_t i = 0; i < live.size(); i++) {
+		uint32_t size = offset_allocator_size_of(allocator, live[i].alloc);
+		if (!bench_check(size >= live[i].size, "allocation of %u reports a size of %u", live[i].size, size))
+			return false;
+		ranges.push_back({ live[i].alloc.offset, size });
+		used += size;
+	}
+	sort(ranges.begin(), ranges.end());
+	for (size_t i = 0; i < ranges.size(); i++) {
+		if (!bench_check((uint64_t)ranges[i].first + ranges[i].second <= allocator.size, "range at %u runs past the end", ranges[i].first))
+			return false;
+		if (i > 0 && !bench_check(ranges[i-1].first + ranges[i-1].second <= ranges[i].first, "ranges at %u and %u overlap", ranges[i-1].first, ranges[i].first))
+			return false;
+	}
+
+	uint32_t total, largest;
+	offset_allocator_free_space(allocator, &total, &largest);
+	return
+		bench_check(total + used == allocator.size, "%u free and %llu used doesn't add up to %u", total, (unsigned long long)used, allocator.size) &&
+		bench_check(largest <= total, "largest free range %u is more than the total %u", largest, total);
+}
+
+///////////////////////////////////////////
+
+bool test_alloc_basics() {
+	bool               result = true;
+	offset_allocator_t allocator;
+	offset_allocator_init(allocator, 1024, 4);
+
+	result &= bench_check(offset_allocator_alloc(allocator, 0).offset == offset_alloc_none, "a zero size allocation succeeded");
+	result &= bench_check(offset_allocator_alloc(allocator, 2048).offset == offset_alloc_none, "an allocation bigger than the range succeeded");
+
+	offset_alloc_t a = offset_allocator_alloc(allocator, 100);
+	offset_alloc_t b = offset_allocator_alloc(allocator, 200);
+	offset_alloc_t c = offset_allocator_alloc(allocator, 300);
+	result &= bench_check(a.offset != offset_alloc_none && b.offset != offset_alloc_none && c.offset != offset_alloc_none, "small allocations failed");
+	result &= test_alloc_consistent(allocator, { { a, 100 }, { b, 200 }, { c, 300 } });
+
+	// Freeing the middle one, then its neighbors, has to merge everything
+	// back into a single range.
+	offset_allocator_free(allocator, b);
+	offset_allocator_free(allocator, a);
+	offset_allocator_free(allocator, c);
+	uint32_t total, largest;
+	offset_allocator_free_space(allocator, &total, &largest);
+	result &= bench_check(total == 1024 && largest == 1024, "freeing everything left %u free, largest %u", total, largest);
+
+	offset_alloc_t all = offset_allocator_alloc(allocator, 1024);
+	result &= bench_check(all.offset == 0, "the whole range wasn't available after freeing everything");
+	offset_allocator_free(allocator, all);
+
+	// Running out of nodes fails cleanly, and frees make them available
+	offset_alloc_t nodes[4];
+	for (int32_t i = 0; i < 4; i++)
+		nodes[i] = offset_allocator_alloc(allocator, 8);
+	result &= bench_check(offset_allocator_alloc(allocator, 8).offset == offset_alloc_none, "allocated past max_allocs");
+	offset_allocator_free(allocator, nodes[2]);
+	offset_alloc_t again = offset_allocator_alloc(allocator, 8);
+	result &= bench_check(again.offset != offset_alloc_none, "a freed node wasn't reused");
+
+	offset_allocator_reset(allocator);
+	offset_allocator_free_space(allocator, &total, &largest);
+	result &= bench_check(total == 1024 && largest == 1024, "reset left %u free, largest %u", total, largest);
+
+	offset_allocator_destroy(allocator);
+	return result;
+}
+
+///////////////////////////////////////////
+
+// Lots of random allocs and frees of mixed sizes, like meshes coming and
+// going, checking the bookkeeping as it goes.
+bool test_alloc_random() {
+	const uint32_t size       = 1 << 20;
+	const uint32_t max_allocs = 4096;
+	const int32_t  steps      = 200000;
+	bool           result     = true;
+
+	offset_allocator_t allocator;
+	offset_allocator_init(allocator, size, max_allocs);
+
+	mt19937              rng(3);
+	vector<alloc_test_t> live;
+	int32_t              failed = 0;
+	for (int32_t i = 0; i < steps && result; i++) {
+		if (live.size() < 1000 && rng() % 3 != 0) {
+			uint32_t       alloc_size = 1 + rng() % (rng() % 4 == 0 ? 20000 : 300);
+			offset_alloc_t alloc      = offset_allocator_alloc(allocator, alloc_size);
+			if (alloc.offset == offset_alloc_none) failed += 1;
+			else                                   live.push_back({ alloc, alloc_size });
+		} else if (live.size() > 0) {
+			size_t index = rng() % live.size();
+			offset_allocator_free(allocator, live[index].alloc);
+			live[index] = live.back();
+			live.pop_back();
+		}
+
+		if (i % 1000 == 0)
+			result &= test_alloc_consistent(allocator, live);
+	}
+	printf("  %d steps, %d allocations didn't fit\n", steps, failed);
+
+	for (size_t i = 0; i < live.size(); i++)
+		offset_allocator_free(allocator, live[i].alloc);
+	uint32_t total, largest;
+	offset_allocator_free_space(allocator, &total, &largest);
+	result &= bench_check(total == size && largest == size, "freeing everything left %u free, largest %u", total, largest);
+
+	offset_allocator_destroy(allocator);
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool test_offset_allocator() {
+	bool result = true;
+	result &= test_alloc_basics();
+	result &= test_alloc_random();
+	return result;
+}
@@ -0,0 +1,240 @@
+#include "bench.h"
+#include "../../StereoKitC/pixel_convert.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <random>
+#include <vector>
+using namespace std;
+using namespace sk;
+
+///////////////////////////////////////////
+
+// The kernels do as much as they can with SIMD (SSE2 on x64, NEON on
+// ARM64), and finish the tail one value at a time. Converting one value per
+// call only ever hits that tail, so it's a reference for the SIMD path that
+// comes from the same build.
+
+uint32_t pixel_test_bits(float value) {
+	uint32_t result;
+	memcpy(&result, &value, sizeof(result));
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool pixel_test_same(float a, float b) {
+	return pixel_test_bits(a) == pixel_test_bits(b) || (isnan(a) && isnan(b));
+}
+
+///////////////////////////////////////////
+
+float pixel_test_half_exact(uint16_t half) {
+	int32_t exp  = (half >> 10) & 0x1F;
+	int32_t mant = half & 0x3FF;
+	float   sign = half & 0x8000 ? -1.0f : 1.0f;
+	if (exp == 0x1F) return mant == 0 ? sign * INFINITY : NAN;
+	if (exp == 0)    return sign * ldexpf((float)mant, -24);
+	return sign * ldexpf((float)(mant | 0x400), exp - 25);
+}
+
+///////////////////////////////////////////
+
+float pixel_test_srgb_exact(float linear) {
+	return linear <= 0.0031308f
+		? linear * 12.92f
+		: 1.055f * powf(linear, 1 / 2.4f) - 0.055f;
+}
+
+///////////////////////////////////////////
+
+bool test_pixel_u8() {
+	bool            result = true;
+	vector<uint8_t> bytes(259);
+	vector<float>   floats(bytes.size());
+	for (size_t i = 0; i < bytes.size(); i++)
+		bytes[i] = (uint8_t)i;
+
+	pixel_u8_to_f32(bytes.data(), floats.data(), bytes.size());
+	for (size_t i = 0; i < bytes.size(); i++) {
+		float single;
+		pixel_u8_to_f32(&bytes[i], &single, 1);
+		result &= bench_check(pixel_test_same(floats[i], single), "u8_to_f32 of %d was %g, but %g on its own", bytes[i], floats[i], single);
+		result &= bench_near(floats[i], bytes[i] / 255.0f, 0.0000001f, "u8_to_f32");
+	}
+
+	// Out of range and NaN clamp, and everything rounds to nearest
+	vector<float> values;
+	for (int32_t i = -300; i < 300 * 255; i++)
+		values.push_back(i / (255.0f * 255.0f));
+	values.push_back(NAN);
+	values.push_back(-INFINITY);
+	values.push_back(INFINITY);
+	vector<uint8_t> out(values.size());
+	pixel_f32_to_u8(values.data(), out.data(), values.size());
+	for (size_t i = 0; i < values.size(); i++) {
+		uint8_t single;
+		pixel_f32_to_u8(&values[i], &single, 1);
+		float   clamped  = isnan(values[i]) ? 0 : fminf(fmaxf(values[i], 0), 1);
+		uint8_t expected = (uint8_t)lrintf(clamped * 255);
+		if (!bench_check(out[i] == single && out[i] == expected, "f32_to_u8 of %g was %d, %d on its own, expected %d", values[i], out[i], single, expected))
+			return false;
+	}
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool test_pixel_half() {
+	bool result = true;
+
+	// Every half, both ways
+	vector<uint16_t> halves(65536 + 3);
+	vector<float>    floats(halves.size());
+	vector<uint16_t> round_trip(halves.size());
+	for (size_t i = 0; i < halves.size(); i++)
+		halves[i] = (uint16_t)i;
+	pixel_f16_to_f32(halves.data(), floats.data(),     halves.size());
+	pixel_f32_to_f16(floats.data(), round_trip.data(), floats.size());
+	for (size_t i = 0; i < halves.size(); i++) {
+		float single;
+		pixel_f16_to_f32(&halves[i], &single, 1);
+		float exact = pixel_test_half_exact(halves[i]);
+		if (!bench_check(pixel_test_same(floats[i], exact) && pixel_test_same(single, exact), "f16_to_f32 of %04x was %g, %g on its own, expected %g", halves[i], floats[i], single, exact))
+			return false;
+		if (isnan(exact))
+			continue;
+		if (!bench_check(round_trip[i] == halves[i], "f16 %04x came back from f32 as %04x", halves[i], round_trip[i]))
+			return false;
+	}
+
+	// Rounding, overflow and denormals, all round to nearest even
+	struct half_case_t { float value; uint16_t expected; };
+	half_case_t cases[] = {
+		{ 1 + ldexpf(1, -11),     0x3C00 }, // tie, rounds down to even
+		{ 1 + 3 * ldexpf(1, -11), 0x3C02 }, // tie, rounds up to even
+		{ 65519,                  0x7BFF },
+		{ 65520,                  0x7C00 }, // rounds up past the largest half
+		{ 1e10f,                  0x7C00 },
+		{ -1e10f,                 0xFC00 },
+		{ ldexpf(1, -24),         0x0001 }, // smallest denormal
+		{ ldexpf(1, -25),         0x0000 }, // tie, rounds down to even 0
+		{ ldexpf(3, -26),         0x0001 },
+		{ ldexpf(3, -25),         0x0002 }, // tie, rounds up to even
+		{ -0.0f,                  0x8000 },
+		{ INFINITY,               0x7C00 },
+	};
+	float    values[_countof(cases) * 3];
+	uint16_t out   [_countof(cases) * 3];
+	for (size_t i = 0; i < _countof(values); i++)
+		values[i] = cases[i % _countof(cases)].value;
+	pixel_f32_to_f16(values, out, _countof(values));
+	for (size_t i = 0; i < _countof(values); i++) {
+		half_case_t &c = cases[i % _countof(cases)];
+		result &= bench_check(out[i] == c.expected, "f32_to_f16 of %a was %04x, expected %04x", c.value, out[i], c.expected);
+	}
+	uint16_t nan_half;
+	float    nan_value = NAN;
+	pixel_f32_to_f16(&nan_value, &nan_half, 1);
+	result &= bench_check((nan_half & 0x7C00) == 0x7C00 && (nan_half & 0x3FF) != 0, "NaN became %04x", nan_half);
+
+	// Random bit patterns, SIMD against the single value path
+	mt19937          rng(1);
+	vector<float>    random(1 << 20);
+	vector<uint16_t> random_out(random.size());
+	for (size_t i = 0; i < random.size(); i++) {
+		uint32_t bits = rng();
+		memcpy(&random[i], &bits, sizeof(bits));
+	}
+	double start = bench_time_ms();
+	pixel_f32_to_f16(random.data(), random_out.data(), random.size());
+	double time = bench_time_ms() - start;
+	for (size_t i = 0; i < random.size(); i++) {
+		if (isnan(random[i]))
+			continue;
+		uint16_t single;
+		pixel_f32_to_f16(&random[i], &single, 1);
+		if (!bench_check(random_out[i] == single, "f32_to_f16 of %a was %04x, but %04x on its own", random[i], random_out[i], single))
+			return false;
+	}
+	printf("  f32_to_f16: %.0f values/ms\n", random.size() / time);
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool test_pixel_srgb() {
+	bool result = true;
+
+	// Decoding is exact, and encoding what was decoded gets the same byte
+	vector<uint8_t> srgb(256 * 4);
+	vector<float>   linear(srgb.size());
+	vector<uint8_t> back(srgb.size());
+	for (size_t i = 0; i < srgb.size(); i++)
+		srgb[i] = (uint8_t)(i / 4);
+	pixel_srgb_to_linear(srgb.data(), linear.data(), 256);
+	pixel_linear_to_srgb(linear.data(), back.data(), 256);
+	for (size_t i = 0; i < srgb.size(); i++) {
+		float c        = srgb[i] / 255.0f;
+		float expected = i % 4 == 3 ? c : (c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f));
+		result &= bench_near(linear[i], expected, 0.000001f, "srgb_to_linear");
+		if (!bench_check(back[i] == srgb[i], "%d went through linear and came back as %d", srgb[i], back[i]))
+			return false;
+	}
+
+	// Encoding anywhere in 0-1 lands within one step of the exact curve
+	const int32_t   steps = 100000;
+	vector<float>   values((steps + 1) * 4);
+	vector<uint8_t> encoded(values.size());
+	for (int32_t i = 0; i <= steps; i++) {
+		for (int32_t c = 0; c < 4; c++)
+			values[i * 4 + c] = i / (float)steps;
+	}
+	double start = bench_time_ms();
+	pixel_linear_to_srgb(values.data(), encoded.data(), steps + 1);
+	double time = bench_time_ms() - start;
+	int32_t worst = 0;
+	for (int32_t i = 0; i <= steps; i++) {
+		float   value = values[i * 4];
+		int32_t error = abs((int32_t)lrintf(pixel_test_srgb_exact(value) * 255) - encoded[i * 4]);
+		if (error > worst) worst = error;
+		result &= bench_check(encoded[i * 4 + 3] == (uint8_t)lrintf(value * 255), "alpha of %g wasn't left linear", value);
+	}
+	result &= bench_check(worst <= 1, "linear_to_srgb was off by %d steps", worst);
+	printf("  linear_to_srgb: %.0f pixels/ms, worst error %d step\n", (steps + 1) / time, worst);
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool test_pixel_r8() {
+	vector<uint8_t> src(16 * 3 + 5);
+	vector<color32> dest(src.size());
+	for (size_t i = 0; i < src.size(); i++)
+		src[i] = (uint8_t)(i * 7);
+	pixel_r8_to_rgba32(src.data(), dest.data(), src.size());
+	for (size_t i = 0; i < src.size(); i++) {
+		if (!bench_check(dest[i].r == src[i] && dest[i].g == 0 && dest[i].b == 0 && dest[i].a == 0,
+			"r8_to_rgba32 of %d was (%d, %d, %d, %d)", src[i], dest[i].r, dest[i].g, dest[i].b, dest[i].a))
+			return false;
+	}
+	return true;
+}
+
+///////////////////////////////////////////
+
+bool test_pixel_convert() {
+#if defined(_M_ARM64)
+	printf("  NEON kernels\n");
+#elif defined(_M_X64)
+	printf("  SSE2 kernels\n");
+#endif
+	bool result = true;
+	result &= test_pixel_u8();
+	result &= test_pixel_half();
+	result &= test_pixel_srgb();
+	result &= test_pixel_r8();
+	return result;
+}
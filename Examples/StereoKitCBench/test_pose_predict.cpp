@@ -0,0 +1,152 @@
+#include "bench.h"
+#include "../../StereoKitC/pose_predict.h"
+
+#include <math.h>
+using namespace sk;
+
+///////////////////////////////////////////
+
+quat test_quat_y(float radians) {
+	return quat{ 0, sinf(radians * 0.5f), 0, cosf(radians * 0.5f) };
+}
+
+///////////////////////////////////////////
+
+bool test_quat_near(const quat &value, const quat &expected, float tolerance, const char *what) {
+	// q and -q are the same rotation
+	float dot = value.x*expected.x + value.y*expected.y + value.z*expected.z + value.w*expected.w;
+	return bench_check(fabsf(dot) >= 1 - tolerance, "%s was (%g, %g, %g, %g), expected (%g, %g, %g, %g)", what,
+		value   .x, value   .y, value   .z, value   .w,
+		expected.x, expected.y, expected.z, expected.w);
+}
+
+///////////////////////////////////////////
+
+bool test_angular_velocity() {
+	bool result = true;
+
+	vec3 spin = quat_angular_velocity(quat_identity, test_quat_y(1), 0.5f);
+	result &= bench_near(spin.x, 0, 0.0001f, "angular velocity x");
+	result &= bench_near(spin.y, 2, 0.0001f, "angular velocity y");
+	result &= bench_near(spin.z, 0, 0.0001f, "angular velocity z");
+
+	// The long way around is the same rotation as the short way back
+	spin = quat_angular_velocity(quat_identity, test_quat_y(3 * 3.14159265f / 2), 1);
+	result &= bench_near(spin.y, -3.14159265f / 2, 0.0001f, "angular velocity, long way around");
+
+	// A negated quaternion hasn't rotated at all
+	quat from = test_quat_y(0.3f);
+	spin = quat_angular_velocity(from, quat{ -from.x, -from.y, -from.z, -from.w }, 1);
+	result &= bench_near(vec3_magnitude(spin), 0, 0.0001f, "angular velocity of a negated quat");
+
+	// Tiny angles go through the small angle path
+	spin = quat_angular_velocity(quat_identity, test_quat_y(0.000001f), 0.001f);
+	result &= bench_near(spin.y, 0.001f, 0.00001f, "small angle angular velocity");
+
+	spin = quat_angular_velocity(quat_identity, test_quat_y(1), 0);
+	result &= bench_near(vec3_magnitude(spin), 0, 0, "angular velocity over no time");
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool test_extrapolate() {
+	bool   result = true;
+	pose_t start  = { vec3{ 1, 2, 3 }, test_quat_y(0.25f) };
+
+	pose_t still = pose_extrapolate(start, vec3_zero, vec3_zero, 1);
+	result &= bench_near(vec3_magnitude(still.position - start.position), 0, 0, "still position");
+	result &= test_quat_near(still.orientation, start.orientation, 0, "still orientation");
+
+	pose_t moved = pose_extrapolate(start, vec3{ 2, 0, -1 }, vec3{ 0, 0.5f, 0 }, 0.5f);
+	result &= bench_near(moved.position.x, 2,    0.0001f, "extrapolated x");
+	result &= bench_near(moved.position.z, 2.5f, 0.0001f, "extrapolated z");
+	result &= test_quat_near(moved.orientation, test_quat_y(0.5f), 0.00001f, "extrapolated orientation");
+
+	// Rotation is in world space, so it applies after the existing one
+	pose_t tilted  = { vec3_zero, quat{ sinf(0.25f), 0, 0, cosf(0.25f) } };
+	pose_t spun    = pose_extrapolate(tilted, vec3_zero, vec3{ 0, 1, 0 }, 1);
+	quat   y       = test_quat_y(1);
+	quat   x       = tilted.orientation;
+	quat   world   = {
+		y.w*x.x + y.x*x.w + y.y*x.z - y.z*x.y,
+		y.w*x.y - y.x*x.z + y.y*x.w + y.z*x.x,
+		y.w*x.z + y.x*x.y - y.y*x.x + y.z*x.w,
+		y.w*x.w - y.x*x.x - y.y*x.y - y.z*x.z };
+	result &= test_quat_near(spun.orientation, world, 0.00001f, "world space rotation");
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool test_predictor() {
+	bool             result = true;
+	pose_predictor_t predictor;
+	pose_predictor_reset(predictor);
+
+	// Nothing to predict with yet
+	pose_t first = { vec3{ 0, 1, 0 }, quat_identity };
+	pose_predictor_add(predictor, first, 1.0);
+	pose_t ahead = pose_predictor_at(predictor, 1.05);
+	result &= bench_near(vec3_magnitude(ahead.position - first.position), 0, 0, "prediction from one sample");
+
+	// Moving at 2m/s along x, and turning at 1 rad/s
+	for (int32_t i = 1; i <= 10; i++) {
+		float  t    = i * 0.011f;
+		pose_t pose = { vec3{ 2 * t, 1, 0 }, test_quat_y(t) };
+		pose_predictor_add(predictor, pose, 1.0 + t);
+	}
+	double last = predictor.time;
+	ahead = pose_predictor_at(predictor, last + 0.05);
+	result &= bench_near(ahead.position.x, 2 * (0.11f + 0.05f), 0.0001f, "predicted x");
+	result &= bench_near(ahead.position.y, 1,                   0.0001f, "predicted y");
+	result &= test_quat_near(ahead.orientation, test_quat_y(0.11f + 0.05f), 0.00001f, "predicted orientation");
+
+	// Predicting far out is clamped to max_ahead
+	pose_t far_out = pose_predictor_at(predictor, last + 10);
+	result &= bench_near(far_out.position.x, 2 * (0.11f + predictor.max_ahead), 0.0001f, "clamped prediction");
+
+	// Samples from the past are ignored, and don't disturb the velocity
+	pose_t stale = { vec3{ -5, 1, 0 }, quat_identity };
+	pose_predictor_add(predictor, stale, last - 0.5);
+	result &= bench_check(predictor.time == last, "an old sample replaced the newest one");
+	result &= bench_near(predictor.velocity.x, 2, 0.001f, "velocity after an old sample");
+
+	// Repeating a timestamp can't produce a velocity from a zero dt
+	int32_t count = predictor.sample_count;
+	pose_predictor_add(predictor, predictor.pose, last);
+	result &= bench_check(predictor.sample_count == count, "a repeated timestamp counted as a new sample");
+	result &= bench_near(predictor.velocity.x, 2, 0.001f, "velocity after a repeated sample");
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool test_predictor_smoothing() {
+	bool             result = true;
+	pose_predictor_t smooth, raw;
+	pose_predictor_reset(smooth, 0.9f);
+	pose_predictor_reset(raw,    0);
+
+	// A sudden stop shows up right away without smoothing, and only
+	// partly with it.
+	for (int32_t i = 0; i < 4; i++) {
+		pose_t pose = { vec3{ i < 3 ? i * 0.01f : 0.02f, 0, 0 }, quat_identity };
+		pose_predictor_add(smooth, pose, i * 0.01);
+		pose_predictor_add(raw,    pose, i * 0.01);
+	}
+	result &= bench_near(raw.velocity.x, 0, 0.0001f, "unsmoothed velocity after stopping");
+	result &= bench_near(smooth.velocity.x, 0.9f, 0.0001f, "smoothed velocity after stopping");
+	return result;
+}
+
+///////////////////////////////////////////
+
+bool test_pose_predict() {
+	bool result = true;
+	result &= test_angular_velocity();
+	result &= test_extrapolate();
+	result &= test_predictor();
+	result &= test_predictor_smoothing();
+	return result;
+}
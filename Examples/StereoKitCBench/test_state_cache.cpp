@@ -0,0 +1,59 @@
+#include "bench.h"
+#include "../../StereoKitC/systems/state_cache.h"
+
+#include <vector>
+#include <algorithm>
+using namespace std;
+using namespace sk;
+
+///////////////////////////////////////////
+
+struct state_key_test_t {
+	state_type_ type;
+	uint32_t    a, b, c;
+};
+
+///////////////////////////////////////////
+
+// The key is the only thing the cache looks states up by, so different
+// settings must never share a key, and the settings have to come back out
+// of it intact, since that's what the state gets created from.
+bool test_state_cache() {
+	bool                     result = true;
+	vector<state_key_test_t> settings;
+
+	transparency_ blends [] = { transparency_none, transparency_blend, transparency_clip };
+	cull_         culls  [] = { cull_back, cull_front, cull_none };
+	tex_sample_   samples[] = { tex_sample_linear, tex_sample_point, tex_sample_anisotropic };
+	tex_address_  address[] = { tex_address_wrap, tex_address_clamp, tex_address_mirror };
+	for (size_t i = 0; i < _countof(blends); i++) settings.push_back({ state_type_blend,  (uint32_t)blends[i], 0, 0 });
+	for (size_t i = 0; i < _countof(culls);  i++) settings.push_back({ state_type_raster, (uint32_t)culls [i], 0, 0 });
+	for (size_t s = 0; s < _countof(samples); s++) {
+	for (size_t a = 0; a < _countof(address); a++) {
+	for (uint32_t aniso = 0; aniso <= 16; aniso++) {
+		settings.push_back({ state_type_sampler, (uint32_t)samples[s], (uint32_t)address[a], aniso });
+	} } }
+
+	vector<uint64_t> keys;
+	for (size_t i = 0; i < settings.size(); i++) {
+		const state_key_test_t &set = settings[i];
+		uint64_t key = state_cache_key(set.type, set.a, set.b, set.c);
+		keys.push_back(key);
+
+		result &= bench_check(
+			(state_type_)((key >> 48) & 0xFFFF) == set.type &&
+			(uint32_t   )((key >> 32) & 0xFFFF) == set.a    &&
+			(uint32_t   )((key >> 16) & 0xFFFF) == set.b    &&
+			(uint32_t   )((key      ) & 0xFFFF) == set.c,
+			"key %llx doesn't decode back to type %d (%u, %u, %u)", (unsigned long long)key, set.type, set.a, set.b, set.c);
+	}
+
+	// Blend and raster use the defaults for b and c, and that has to match
+	// what state_cache_blend and state_cache_raster ask for.
+	result &= bench_check(state_cache_key(state_type_blend, transparency_clip) == state_cache_key(state_type_blend, transparency_clip, 0, 0),
+		"default key arguments aren't 0");
+
+	sort(keys.begin(), keys.end());
+	result &= bench_check(adjacent_find(keys.begin(), keys.end()) == keys.end(), "two different states share a key");
+	return result;
+}
@@ -0,0 +1,82 @@
+#include "demo_bulk.h"
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+using namespace std;
+
+#include "../../StereoKitC/stereokit.h"
+using namespace sk;
+
+///////////////////////////////////////////
+
+// Compares submitting a grid of cubes one call at a time against submitting
+// them all through render_add_mesh_list. Alternates each frame, and logs the
+// average submission cost of each every couple of seconds.
+const int32_t bulk_grid = 20;
+
+mesh_t                    bulk_mesh;
+material_t                bulk_mat;
+vector<render_mesh_cmd_t> bulk_cmds;
+double                    bulk_time[2];
+int32_t                   bulk_frames[2];
+float                     bulk_report;
+
+///////////////////////////////////////////
+
+void demo_bulk_init() {
+	bulk_mesh = mesh_gen_cube(vec3_one * 0.04f, 0);
+	bulk_mat  = material_find("default/material");
+
+	bulk_cmds.resize(bulk_grid * bulk_grid);
+	for (int32_t y = 0; y < bulk_grid; y++) {
+	for (int32_t x = 0; x < bulk_grid; x++) {
+		render_mesh_cmd_t &cmd = bulk_cmds[x + y * bulk_grid];
+		cmd.mesh      = bulk_mesh;
+		cmd.material  = bulk_mat;
+		cmd.transform = matrix_trs(vec3{ (x - bulk_grid/2) * 0.05f, -0.5f, (y - bulk_grid/2) * 0.05f - 0.5f });
+		cmd.color     = { x/(float)bulk_grid, y/(float)bulk_grid, 1, 1 };
+	} }
+
+	bulk_time  [0] = bulk_time  [1] = 0;
+	bulk_frames[0] = bulk_frames[1] = 0;
+	bulk_report    = time_getf() + 2;
+}
+
+///////////////////////////////////////////
+
+void demo_bulk_update() {
+	int32_t mode = bulk_frames[0] > bulk_frames[1] ? 1 : 0;
+
+	auto start = chrono::high_resolution_clock::now();
+	if (mode == 0) {
+		for (size_t i = 0; i < bulk_cmds.size(); i++)
+			render_add_mesh(bulk_cmds[i].mesh, bulk_cmds[i].material, bulk_cmds[i].transform, bulk_cmds[i].color);
+	} else {
+		render_add_mesh_list(bulk_cmds.data(), (int32_t)bulk_cmds.size());
+	}
+	auto end = chrono::high_resolution_clock::now();
+
+	bulk_time  [mode] += chrono::duration<double, micro>(end - start).count();
+	bulk_frames[mode] += 1;
+
+	if (time_getf() > bulk_report && bulk_frames[0] > 0 && bulk_frames[1] > 0) {
+		char text[128];
+		snprintf(text, sizeof(text), "%d draws: per-call %.1fus, bulk %.1fus",
+			(int32_t)bulk_cmds.size(),
+			bulk_time[0] / bulk_frames[0],
+			bulk_time[1] / bulk_frames[1]);
+		log_write(log_inform, text);
+		bulk_time  [0] = bulk_time  [1] = 0;
+		bulk_frames[0] = bulk_frames[1] = 0;
+		bulk_report    = time_getf() + 2;
+	}
+}
+
+///////////////////////////////////////////
+
+void demo_bulk_shutdown() {
+	mesh_release    (bulk_mesh);
+	material_release(bulk_mat);
+	bulk_cmds.clear();
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+void demo_bulk_init();
+void demo_bulk_update();
+void demo_bulk_shutdown();
\ No newline at end of file
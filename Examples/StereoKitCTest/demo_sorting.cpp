@@ -0,0 +1,95 @@
+#include "demo_sorting.h"
+
+#include <stdio.h>
+#include <vector>
+using namespace std;
+
+#include "../../StereoKitC/stereokit.h"
+using namespace sk;
+
+///////////////////////////////////////////
+
+// A synthetic scene of many materials that cycle through a few shaders and
+// textures, created interleaved so their asset indices alternate shaders,
+// like a glTF file full of material copies. Logs the shader and material
+// swaps per frame from render_get_stats, next to the shader swaps that
+// drawing in material index order would take.
+const int32_t sorting_count = 60;
+
+mesh_t             sorting_mesh;
+vector<shader_t>   sorting_shaders;
+vector<material_t> sorting_mats;
+int64_t            sorting_swaps_shader;
+int64_t            sorting_swaps_material;
+int32_t            sorting_frames;
+float              sorting_report;
+
+///////////////////////////////////////////
+
+void demo_sorting_init() {
+	const char *shader_ids [] = { "default/shader", "default/shader_unlit", "default/shader_pbr" };
+	const char *texture_ids[] = { "default/tex", "default/tex_gray", "default/tex_black" };
+	for (int32_t i = 0; i < 3; i++)
+		sorting_shaders.push_back(shader_find(shader_ids[i]));
+
+	sorting_mesh = mesh_gen_cube(vec3_one * 0.04f, 0);
+	for (int32_t i = 0; i < sorting_count; i++) {
+		material_t mat = material_create(sorting_shaders[i % 3]);
+		tex_t      tex = tex_find(texture_ids[(i / 3) % 3]);
+		material_set_texture(mat, "diffuse", tex);
+		tex_release(tex);
+		sorting_mats.push_back(mat);
+	}
+
+	sorting_swaps_shader   = 0;
+	sorting_swaps_material = 0;
+	sorting_frames         = 0;
+	sorting_report         = time_getf() + 2;
+}
+
+///////////////////////////////////////////
+
+void demo_sorting_update() {
+	for (int32_t i = 0; i < sorting_count; i++) {
+		vec3 at = { (i % 10 - 5) * 0.06f, -0.4f + (i / 10) * 0.06f, -0.5f };
+		render_add_mesh(sorting_mesh, sorting_mats[i], matrix_trs(at));
+	}
+
+	// Stats are for the last frame that finished drawing, which includes
+	// the rest of the scene too, like the floor and sky.
+	render_stats_t stats = render_get_stats();
+	sorting_swaps_shader   += stats.swaps_shader;
+	sorting_swaps_material += stats.swaps_material;
+	sorting_frames         += 1;
+
+	if (time_getf() > sorting_report) {
+		// Material index order is creation order here, and each material
+		// uses a different shader from the one before it.
+		int32_t index_order_swaps = sorting_count;
+
+		char text[160];
+		snprintf(text, sizeof(text), "%d materials, %d shaders: %.1f shader swaps and %.1f material swaps per frame, index order needs %d shader swaps",
+			sorting_count,
+			(int32_t)sorting_shaders.size(),
+			sorting_swaps_shader   / (double)sorting_frames,
+			sorting_swaps_material / (double)sorting_frames,
+			index_order_swaps);
+		log_write(log_inform, text);
+		sorting_swaps_shader   = 0;
+		sorting_swaps_material = 0;
+		sorting_frames         = 0;
+		sorting_report         = time_getf() + 2;
+	}
+}
+
+///////////////////////////////////////////
+
+void demo_sorting_shutdown() {
+	for (size_t i = 0; i < sorting_mats.size(); i++)
+		material_release(sorting_mats[i]);
+	for (size_t i = 0; i < sorting_shaders.size(); i++)
+		shader_release(sorting_shaders[i]);
+	mesh_release(sorting_mesh);
+	sorting_mats   .clear();
+	sorting_shaders.clear();
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+void demo_sorting_init();
+void demo_sorting_update();
+void demo_sorting_shutdown();
\ No newline at end of file
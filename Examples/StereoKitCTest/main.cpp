@@ -5,6 +5,8 @@ using namespace sk;
 #include "demo_basics.h"
 #include "demo_ui.h"
 #include "demo_sprites.h"
+#include "demo_bulk.h"
+#include "demo_sorting.h"
 
 #include <stdio.h>
 
@@ -28,6 +30,16 @@ scene_t demo_sprites = {
 	demo_sprites_update,
 	demo_sprites_shutdown,
 };
+scene_t demo_bulk = {
+	demo_bulk_init,
+	demo_bulk_update,
+	demo_bulk_shutdown,
+};
+scene_t demo_sorting = {
+	demo_sorting_init,
+	demo_sorting_update,
+	demo_sorting_shutdown,
+};
 
 void common_init();
 void common_update();
@@ -0,0 +1,69 @@
+﻿using StereoKit;
+using System.Diagnostics;
+
+namespace StereoKitTest
+{
+    /// Compares drawing a grid of cubes with one Renderer.Add call per cube
+    /// against a single bulk Renderer.Add with a RenderCommand array. It
+    /// alternates each frame, and shows the average submission cost of each.
+    class DemoBulkSubmit : IDemo
+    {
+        const int grid = 20;
+
+        Mesh            mesh;
+        Material        material;
+        RenderCommand[] commands = new RenderCommand[grid * grid];
+        Stopwatch       watch    = new Stopwatch();
+        double[]        times    = new double[2];
+        int[]           frames   = new int[2];
+        AsciiText       label;
+        TextSpan[]      spans    = new TextSpan[1];
+        string          results  = "";
+
+        public void Initialize()
+        {
+            mesh     = Mesh.GenerateCube(Vec3.One * 0.04f);
+            material = Material.Find(DefaultIds.material);
+            for (int y = 0; y < grid; y++) {
+            for (int x = 0; x < grid; x++) {
+                commands[x + y * grid] = new RenderCommand(mesh, material,
+                    Matrix.T(new Vec3((x - grid/2) * 0.05f, -0.5f, (y - grid/2) * 0.05f - 0.5f)),
+                    new Color(x/(float)grid, y/(float)grid, 1, 1));
+            } }
+
+            label    = new AsciiText("Bulk submission");
+            spans[0] = new TextSpan(label, Matrix.TRS(new Vec3(0, 0, -0.5f), Quat.LookDir(0, 0, 1), 0.5f));
+        }
+
+        public void Shutdown()
+        {
+            label.Dispose();
+        }
+
+        public void Update()
+        {
+            int mode = frames[0] > frames[1] ? 1 : 0;
+
+            watch.Restart();
+            if (mode == 0) {
+                for (int i = 0; i < commands.Length; i++)
+                    Renderer.Add(mesh, material, commands[i].transform, commands[i].color);
+            } else {
+                Renderer.Add(commands, commands.Length);
+            }
+            watch.Stop();
+
+            times [mode] += watch.Elapsed.TotalMilliseconds * 1000;
+            frames[mode] += 1;
+
+            if (frames[1] >= 60) {
+                results   = $"{commands.Length} draws\nper-call {times[0]/frames[0]:0.0}us\nbulk {times[1]/frames[1]:0.0}us";
+                times [0] = times [1] = 0;
+                frames[0] = frames[1] = 0;
+            }
+
+            Text.Add(spans, spans.Length);
+            Text.Add(results, Matrix.TRS(new Vec3(0, -0.1f, -0.5f), Quat.LookDir(0, 0, 1), 0.5f));
+        }
+    }
+}
@@ -72,6 +72,24 @@ namespace StereoKit
         /// <returns>A link to the Material asset used by the mesh subset at subsetIndex</returns>
         public Material GetMaterial(int subsetIndex) => new Material(NativeAPI.model_get_material(_inst, subsetIndex));
 
+        /// <summary>Adds a lower detail version of a subset's Mesh. When drawn, the subset switches
+        /// to this Mesh once it covers less than screenSize of the view's height, so far away
+        /// objects cost less to draw. Switching back and forth needs to go 10% past screenSize,
+        /// so an object that sits right at the threshold doesn't flicker between levels.</summary>
+        /// <param name="subsetIndex">Index of the mesh subset this is a level of detail for.</param>
+        /// <param name="mesh">A simpler version of the subset's Mesh.</param>
+        /// <param name="screenSize">Fraction of the view's height, 1 being the whole view. The
+        /// subset has to be smaller than this on screen for this Mesh to be used.</param>
+        /// <returns>Index of the new level of detail, levels are sorted from most to least detailed.</returns>
+        public int AddLod(int subsetIndex, Mesh mesh, float screenSize)
+            => NativeAPI.model_add_lod(_inst, subsetIndex, mesh._inst, screenSize);
+
+        /// <summary>How many levels of detail a subset has, not including the subset's own Mesh.</summary>
+        /// <param name="subsetIndex">Index of the mesh subset, should be less than SubsetCount.</param>
+        /// <returns>The number of lower detail Meshes for this subset.</returns>
+        public int LodCount(int subsetIndex)
+            => NativeAPI.model_lod_count(_inst, subsetIndex);
+
         /// <summary>Adds this Model to the render queue for this frame! If the Hierarchy has a transform on it,
         /// that transform is combined with the Matrix provided here.</summary>
         /// <param name="transform">A Matrix that will transform the Model from Model Space into the current
@@ -99,6 +117,16 @@ namespace StereoKit
             return model == IntPtr.Zero ? null : new Model(model);
         }
 
+        /// <summary>Models loaded from .gltf or .glb files after this call will get levels of
+        /// detail generated for each subset that doesn't already have them from the file's
+        /// MSFT_lod extension. This takes extra time while loading, but that work is spread
+        /// across all cores. Off by default.</summary>
+        /// <param name="lodCount">How many levels to generate, 0 turns this off.</param>
+        /// <param name="triangleRatio">Each level tries to have this fraction of the previous
+        /// level's triangles.</param>
+        public static void SetAutoLod(int lodCount, float triangleRatio = 0.5f)
+            => NativeAPI.model_set_auto_lod(lodCount, triangleRatio);
+
         /// <summary>Loads a list of mesh and material subsets from a .obj, .gltf, or .glb file.</summary>
         /// <param name="file">Name of the file to load! This gets prefixed with the StereoKit asset
         /// folder if no drive letter is specified in the path.</param>
@@ -15,6 +15,14 @@ namespace StereoKit
         /// <summary>The name of the shader, provided in the shader file itself. Not the filename or id.</summary>
         public string Name => NativeAPI.shader_get_name(_inst);
 
+        /// <summary>Finds where a per-instance field declared with `// [inst]` lives in the
+        /// custom instance data passed to Renderer.Add.</summary>
+        /// <param name="name">Name of the field, as written in the shader.</param>
+        /// <returns>Offset in floats into the instance data's Vec4, or -1 if the shader has
+        /// no field with that name.</returns>
+        public int GetInstanceOffset(string name)
+            => NativeAPI.shader_get_inst_offset(_inst, name);
+
         internal Shader(IntPtr shader)
         {
             _inst = shader;
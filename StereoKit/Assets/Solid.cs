@@ -134,5 +134,21 @@ namespace StereoKit
         {
             NativeAPI.solid_get_pose(_inst, out pose);
         }
+
+        static IntPtr[] _bulkHandles = new IntPtr[0];
+        /// <summary>Retreives the current pose of many Solids in a single call! This is 
+        /// much cheaper than calling GetPose on each Solid individually.</summary>
+        /// <param name="solids">Solids to get the poses of.</param>
+        /// <param name="poses">Destination for the poses, this should be at least as long
+        /// as the solids array.</param>
+        public static void GetPoses(Solid[] solids, Pose[] poses)
+        {
+            int count = Math.Min(solids.Length, poses.Length);
+            if (_bulkHandles.Length < count)
+                _bulkHandles = new IntPtr[count];
+            for (int i = 0; i < count; i++)
+                _bulkHandles[i] = solids[i]._inst;
+            NativeAPI.solid_get_poses(_bulkHandles, count, poses);
+        }
     }
 }
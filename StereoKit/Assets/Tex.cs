@@ -65,6 +65,38 @@ namespace StereoKit
 
         #endregion
 
+        #region Methods
+
+        /// <summary>Replaces a rectangle of a dynamic texture's pixels, without re-uploading the rest
+        /// of it. The pixels are copied right away, and go up to the GPU before the next frame draws,
+        /// so this never waits on the GPU. Great for video, or live data that only changes in places!
+        /// The texture needs to be created with TexType.Dynamic, and sized with a full write first.</summary>
+        /// <param name="x">Left edge of the rectangle, in pixels.</param>
+        /// <param name="y">Top edge of the rectangle, in pixels.</param>
+        /// <param name="width">Width of the rectangle, in pixels.</param>
+        /// <param name="height">Height of the rectangle, in pixels.</param>
+        /// <param name="data">Pixels in the texture's format, starting at the top left of the
+        /// rectangle.</param>
+        /// <param name="stride">Bytes from the start of one row of data to the next. Zero means the
+        /// rows are tightly packed.</param>
+        public void SetColorsRegion(int x, int y, int width, int height, IntPtr data, int stride = 0)
+            => NativeAPI.tex_set_colors_region(_inst, x, y, width, height, data, stride);
+
+        /// <summary>Sets the texture's colors from an NV12 image, the usual output of video decoders.
+        /// NV12 is a full size plane of 8 bit luma, followed by a half size plane of interleaved U,V
+        /// pairs, so it's a lot less to upload than colors. It's converted to color on the GPU, using
+        /// BT.709 limited range. The texture needs to be created as a TexType.Rendertarget, and the
+        /// width and height must be even.</summary>
+        /// <param name="width">Width of the image, in pixels.</param>
+        /// <param name="height">Height of the image, in pixels.</param>
+        /// <param name="data">The luma plane, immediately followed by the chroma plane.</param>
+        /// <param name="stride">Bytes from the start of one row of data to the next. Zero means the
+        /// rows are tightly packed.</param>
+        public void SetColorsNV12(int width, int height, IntPtr data, int stride = 0)
+            => NativeAPI.tex_set_colors_nv12(_inst, width, height, data, stride);
+
+        #endregion
+
         #region Static Methods
 
         /// <summary>Finds a texture that matches the given Id! Check out the DefaultIds static class for
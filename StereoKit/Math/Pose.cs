@@ -62,5 +62,22 @@ namespace StereoKit
         [MethodImpl(MethodImplOptions.AggressiveInlining)]
         public Matrix ToMatrix()           => NativeAPI.pose_matrix(this, Vec3.One);
 
+        /// <summary>Converts a list of poses into transform matrices in a single call,
+        /// which is much cheaper than calling ToMatrix on each of them.</summary>
+        /// <param name="poses">Poses to convert.</param>
+        /// <param name="results">Destination for the matrices, this should be at least as
+        /// long as the poses array.</param>
+        /// <param name="scale">A scale vector applied to each matrix.</param>
+        public static void ToMatrices(Pose[] poses, Matrix[] results, Vec3 scale)
+            => NativeAPI.pose_matrix_list(poses, System.Math.Min(poses.Length, results.Length), results, scale);
+
+        /// <summary>Converts a list of poses into transform matrices in a single call,
+        /// which is much cheaper than calling ToMatrix on each of them.</summary>
+        /// <param name="poses">Poses to convert.</param>
+        /// <param name="results">Destination for the matrices, this should be at least as
+        /// long as the poses array.</param>
+        public static void ToMatrices(Pose[] poses, Matrix[] results)
+            => NativeAPI.pose_matrix_list(poses, System.Math.Min(poses.Length, results.Length), results, Vec3.One);
+
     };
 }
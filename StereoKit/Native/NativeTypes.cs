@@ -30,6 +30,10 @@ namespace StereoKit
         /// '[assetsFolder]/[file]', so a trailing '/' is unnecessary.</summary>
         [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 128)]
         public string assetsFolder;
+        /// <summary>Draws and presents each frame on a separate render thread, while the app
+        /// thread moves on to updating the next frame. This can help a lot with CPU heavy scenes,
+        /// but changes to assets that are already in use will wait on the render thread.</summary>
+        public bool renderPipelined;
     }
 
     /// <summary>This describes the type of display tech used on a Mixed Reality device.</summary>
@@ -109,8 +113,9 @@ namespace StereoKit
         /// This is what you'll want most of the time you're dealing with color data! Matches well with the 
         /// Color32 struct.</summary>
         Rgba32Linear,
-        /// <summary>Red/Green/Blue/Transparency data channels, at 16 bits per-channel! This is not
-        /// common, but you might encounter it with raw photos, or HDR images.</summary>
+        /// <summary>Red/Green/Blue/Transparency data channels, at 16 bits per-channel! Each channel is a
+        /// half float, so this is a good fit for HDR images, and it's what StereoKit loads .hdr files
+        /// and generates cubemaps as.</summary>
         Rgba64,
         /// <summary>Red/Green/Blue/Transparency data channels at 32 bits per-channel! Basically 4 floats
         /// per color, which is bonkers expensive. Don't use this unless you know -exactly- what you're doing.</summary>
@@ -125,6 +130,11 @@ namespace StereoKit
         /// If you're seeing lots of flickering where two objects overlap, you either need to bring your far clip
         /// in, or switch to 32/24 bit depth.</summary>
         Depth16,
+        /// <summary>A single 8 bit channel of linear data, like a mask or a heatmap. Shaders see it in
+        /// the red channel.</summary>
+        R8,
+        /// <summary>Same as Rgba64, the name just makes it clear that it's half floats.</summary>
+        Rgba64f = Rgba64,
     }
 
     /// <summary>How does the shader grab pixels from the texture? Or more specifically,
@@ -249,6 +259,181 @@ namespace StereoKit
         internal int id;
     }
 
+    /// <summary>A single piece of text for submitting to Text.Add in bulk! The text
+    /// itself is a pre-encoded AsciiText, so no string marshalling happens when the
+    /// list is handed off to StereoKit.</summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct TextSpan
+    {
+        internal IntPtr    text;
+        /// <summary>Transform of the text mesh! Try Matrix.TRS.</summary>
+        public   Matrix    transform;
+        internal int       style;
+        /// <summary>How should the text's bounding rectangle be positioned relative to the transform?</summary>
+        public   TextAlign position;
+        /// <summary>How should the text be aligned within the text's bounding rectangle?</summary>
+        public   TextAlign align;
+        /// <summary>An additional offset from the transform.</summary>
+        public   Vec3      offset;
+
+        /// <summary>Creates a span of text for bulk submission.</summary>
+        /// <param name="text">Pre-encoded text, this must stay alive until the span is submitted.</param>
+        /// <param name="transform">A Matrix representing the transform of the text mesh! Try Matrix.TRS.</param>
+        /// <param name="style">Style information for rendering, see Text.MakeStyle or the TextStyle object.</param>
+        /// <param name="position">How should the text's bounding rectangle be positioned relative to the transform?</param>
+        /// <param name="align">How should the text be aligned within the text's bounding rectangle?</param>
+        public TextSpan(AsciiText text, Matrix transform, TextStyle style, TextAlign position = TextAlign.Center, TextAlign align = TextAlign.Center)
+        {
+            this.text      = text._inst;
+            this.transform = transform;
+            this.style     = style.id;
+            this.position  = position;
+            this.align     = align;
+            this.offset    = Vec3.Zero;
+        }
+
+        /// <summary>Creates a span of text for bulk submission, using the default text style.</summary>
+        /// <param name="text">Pre-encoded text, this must stay alive until the span is submitted.</param>
+        /// <param name="transform">A Matrix representing the transform of the text mesh! Try Matrix.TRS.</param>
+        /// <param name="position">How should the text's bounding rectangle be positioned relative to the transform?</param>
+        /// <param name="align">How should the text be aligned within the text's bounding rectangle?</param>
+        public TextSpan(AsciiText text, Matrix transform, TextAlign position = TextAlign.Center, TextAlign align = TextAlign.Center)
+        {
+            this.text      = text._inst;
+            this.transform = transform;
+            this.style     = -1;
+            this.position  = position;
+            this.align     = align;
+            this.offset    = Vec3.Zero;
+        }
+    }
+
+    /// <summary>Counts from a single drawn frame, see Renderer.Stats. Uploads include
+    /// anything sent to the GPU while the frame was drawing, from any thread.</summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct RenderStats
+    {
+        /// <summary>Items in the render queue, an instanced batch counts once.</summary>
+        public int  queueItems;
+        /// <summary>Runs of queue items that share a Material and Mesh.</summary>
+        public int  batches;
+        /// <summary>Draw calls sent to the GPU.</summary>
+        public int  drawCalls;
+        /// <summary>Instances drawn, counted once for each view.</summary>
+        public int  instances;
+        /// <summary>Triangles drawn, counted once for each view.</summary>
+        public long triangles;
+        /// <summary>Lights added with Renderer.AddLight and AddSpotLight.</summary>
+        public int  lights;
+        /// <summary>Times the active Mesh changed.</summary>
+        public int  swapsMesh;
+        /// <summary>Times the active Shader changed.</summary>
+        public int  swapsShader;
+        /// <summary>Texture slots that changed when switching Materials.</summary>
+        public int  swapsTexture;
+        /// <summary>Times the active Material changed.</summary>
+        public int  swapsMaterial;
+        /// <summary>Bytes of vertex and index data sent to the GPU.</summary>
+        public long uploadMeshBytes;
+        /// <summary>Bytes of texture data sent to the GPU.</summary>
+        public long uploadTextureBytes;
+        /// <summary>Bytes of shader constants sent to the GPU, from Materials and globals.</summary>
+        public long uploadConstantBytes;
+        /// <summary>Bytes of per-instance data sent to the GPU.</summary>
+        public long uploadInstanceBytes;
+        /// <summary>Bytes of light and light cluster data sent to the GPU.</summary>
+        public long uploadLightBytes;
+        /// <summary>GPU buffers and textures that were re-created to change their size.</summary>
+        public int  bufferReallocs;
+    }
+
+    /// <summary>Settings for how a ParticleSystem spawns and moves its particles.</summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct ParticleEmitter
+    {
+        /// <summary>New particles per second, while the system is being drawn.</summary>
+        public float rate;
+        /// <summary>Shortest a particle will live, in seconds.</summary>
+        public float lifeMin;
+        /// <summary>Longest a particle will live, in seconds.</summary>
+        public float lifeMax;
+        /// <summary>Starting velocity, in the emitter's space.</summary>
+        public Vec3  velocity;
+        /// <summary>Random speed added to the starting velocity in any direction, 
+        /// in meters/second.</summary>
+        public float velocitySpread;
+        /// <summary>Constant acceleration in world space, gravity goes here.</summary>
+        public Vec3  acceleration;
+        /// <summary>Fraction of velocity lost each second.</summary>
+        public float drag;
+        /// <summary>Particles start somewhere within this sphere around the emitter,
+        /// in meters.</summary>
+        public float radius;
+        /// <summary>Width of a particle at birth, in meters.</summary>
+        public float sizeStart;
+        /// <summary>Width of a particle when it dies, in meters.</summary>
+        public float sizeEnd;
+    }
+
+    /// <summary>A single line vertex, for submitting lines to Lines.Add in bulk!</summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct LinePoint
+    {
+        /// <summary>Location of the point, in world space.</summary>
+        public Vec3    pt;
+        /// <summary>Thickness of the line at this point, in meters.</summary>
+        public float   thickness;
+        /// <summary>Vertex color of the line at this point.</summary>
+        public Color32 color;
+
+        /// <summary>Creates a line point.</summary>
+        /// <param name="pt">Location of the point, in world space.</param>
+        /// <param name="color">Vertex color of the line at this point.</param>
+        /// <param name="thickness">Thickness of the line at this point, in meters.</param>
+        public LinePoint(Vec3 pt, Color32 color, float thickness)
+        {
+            this.pt        = pt;
+            this.thickness = thickness;
+            this.color     = color;
+        }
+    }
+
+    /// <summary>A single mesh draw, for submitting to Renderer.Add in bulk! This is
+    /// the same information as a Renderer.Add(Mesh, Material, Matrix, Color) call, just
+    /// packed so that many of them can cross into StereoKit in one go.</summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct RenderCommand
+    {
+        internal IntPtr mesh;
+        internal IntPtr material;
+        /// <summary>Transform from Model Space into the current Hierarchy Space.</summary>
+        public   Matrix transform;
+        /// <summary>A per-instance color value to pass into the shader.</summary>
+        public   Color  color;
+
+        /// <summary>Creates a mesh draw command.</summary>
+        /// <param name="mesh">A valid Mesh you wish to draw.</param>
+        /// <param name="material">A Material to apply to the Mesh.</param>
+        /// <param name="transform">A Matrix that will transform the mesh from Model Space into the current
+        /// Hierarchy Space.</param>
+        /// <param name="color">A per-instance color value to pass into the shader!</param>
+        public RenderCommand(Mesh mesh, Material material, Matrix transform, Color color)
+        {
+            this.mesh      = mesh._inst;
+            this.material  = material._inst;
+            this.transform = transform;
+            this.color     = color;
+        }
+
+        /// <summary>Creates a mesh draw command with a white instance color.</summary>
+        /// <param name="mesh">A valid Mesh you wish to draw.</param>
+        /// <param name="material">A Material to apply to the Mesh.</param>
+        /// <param name="transform">A Matrix that will transform the mesh from Model Space into the current
+        /// Hierarchy Space.</param>
+        public RenderCommand(Mesh mesh, Material material, Matrix transform)
+            : this(mesh, material, transform, Color.White) { }
+    }
+
     /// <summary>This describes the behavior of a 'Solid' physics object! the physics 
     /// engine will apply forces differently </summary>
     public enum SolidType
@@ -403,6 +588,73 @@ namespace StereoKit
         Max,
     }
 
+    /// <summary>The different kinds of asset StereoKit keeps track of.</summary>
+    public enum AssetType
+    {
+        /// <summary>Mesh assets.</summary>
+        Mesh = 0,
+        /// <summary>Tex assets, this includes render targets and depth buffers.</summary>
+        Texture,
+        /// <summary>Shader assets.</summary>
+        Shader,
+        /// <summary>Material assets.</summary>
+        Material,
+        /// <summary>Model assets.</summary>
+        Model,
+        /// <summary>Font assets.</summary>
+        Font,
+        /// <summary>Sprite assets.</summary>
+        Sprite,
+        /// <summary>Sound assets.</summary>
+        Sound,
+    }
+
+    /// <summary>The subsystem a piece of heap memory was allocated for, see
+    /// Memory.GetUsage.</summary>
+    public enum MemoryTag
+    {
+        /// <summary>Asset objects, and the data they keep on the CPU, like Material
+        /// parameters.</summary>
+        Assets = 0,
+        /// <summary>The render queue, and the lists used to sort and draw it.</summary>
+        Render,
+        /// <summary>Vertex data for text drawn this frame.</summary>
+        Text,
+        /// <summary>Vertex data for batched Sprites.</summary>
+        Sprites,
+        /// <summary>Vertex data for Lines drawn this frame.</summary>
+        Lines,
+        /// <summary>Particle data for each ParticleSystem.</summary>
+        Particles,
+        /// <summary>Anything that doesn't fit one of the others.</summary>
+        Other,
+    }
+
+    /// <summary>Heap memory used by a single subsystem, see Memory.GetUsage.</summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct MemoryUsage
+    {
+        /// <summary>Bytes currently allocated.</summary>
+        public long bytes;
+        /// <summary>The most bytes this has ever had allocated at once.</summary>
+        public long bytesPeak;
+        /// <summary>Number of live allocations.</summary>
+        public int  allocations;
+    }
+
+    /// <summary>Memory used by all the assets of one type, see Memory.GetAssetUsage.</summary>
+    [StructLayout(LayoutKind.Sequential)]
+    public struct AssetMemoryUsage
+    {
+        /// <summary>Number of live assets of this type.</summary>
+        public int  count;
+        /// <summary>Bytes the assets use on the CPU heap.</summary>
+        public long cpuBytes;
+        /// <summary>An estimate of the bytes the assets use on the GPU, from the size
+        /// and format of their buffers and textures.</summary>
+        public long gpuBytes;
+    }
+
     /// <summary>Severity of a log item.</summary>
     public enum LogLevel
     {
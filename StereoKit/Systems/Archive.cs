@@ -0,0 +1,27 @@
+﻿namespace StereoKit
+{
+    /// <summary>Archives are packed collections of asset files! Instead of opening
+    /// thousands of individual files, StereoKit can memory map a single archive, and
+    /// load assets straight out of it without copying. Once an archive is mounted, any
+    /// asset loaded with a relative filename is looked for in the mounted archives 
+    /// first, and then falls back to loose files in the assets folder.</summary>
+    public static class Archive
+    {
+        /// <summary>Mounts an archive file, so assets can be loaded out of it. Archives
+        /// mounted later take priority over earlier ones, so you can mount a patch
+        /// archive over the top of a base one.</summary>
+        /// <param name="archiveFile">Archive filename, relative to the assets folder.</param>
+        /// <returns>True if the archive was found and is valid.</returns>
+        public static bool Mount(string archiveFile)
+            => NativeAPI.vfs_mount(archiveFile) > 0;
+
+        /// <summary>Packs a list of loose asset files into a new archive. File names
+        /// are stored as-is, so use the same relative names here that you'll use to
+        /// load the assets later.</summary>
+        /// <param name="archiveFile">Archive filename to create, relative to the assets folder.</param>
+        /// <param name="files">Asset filenames to pack, relative to the assets folder.</param>
+        /// <returns>True if every file was found, and the archive was written.</returns>
+        public static bool Pack(string archiveFile, string[] files)
+            => NativeAPI.vfs_pack(archiveFile, files, files.Length) > 0;
+    }
+}
@@ -94,6 +94,14 @@ namespace StereoKit
         public static Pose  Head  => Marshal.PtrToStructure<Pose>(NativeAPI.input_head());
         public static Mouse Mouse => Marshal.PtrToStructure<Mouse>(NativeAPI.input_mouse());
 
+        /// <summary>Extrapolates the head pose into the future using its recent velocity. Handy for
+        /// app logic that needs to know where the user will be looking, rather than where they were.</summary>
+        /// <param name="secondsAhead">How far past the most recent head sample to predict. This is
+        /// clamped to a short window, since extrapolation gets wild pretty quickly!</param>
+        /// <returns>The predicted head pose.</returns>
+        public static Pose HeadPredict(float secondsAhead)
+            => NativeAPI.input_head_predict(secondsAhead);
+
         public static int PointerCount(InputSource filter = InputSource.Any) 
             => NativeAPI.input_pointer_count(filter);
         public static Pointer Pointer(int index, InputSource filter = InputSource.Any)
@@ -25,6 +25,15 @@ namespace StereoKit
         public static void Add(Ray ray, float length, Color32 color, float thickness)
             => NativeAPI.line_add(ray.position, ray.position+ray.direction*length, color, thickness);
 
+        /// <summary>Adds many separate line segments in a single call! Each pair of points
+        /// in the array is one segment, so [0]-[1] is the first line, [2]-[3] the second,
+        /// and so on. This is much cheaper than calling Add for each individual line.</summary>
+        /// <param name="startEndPairs">Pairs of points, start then end.</param>
+        /// <param name="segmentCount">How many segments (pairs of points) should be added? This
+        /// is clamped to half the array's length.</param>
+        public static void Add(LinePoint[] startEndPairs, int segmentCount)
+            => NativeAPI.line_add_segments(startEndPairs, Math.Min(segmentCount, startEndPairs.Length / 2));
+
         /// <summary>Displays an RGB/XYZ axis widget at the pose! Note that this draws lines
         /// along 'Forward' vectors for each axis, not necessarily in the axis positive direction.</summary>
         /// <param name="atPose">What position and orientation do we want this axis widget at?</param>
@@ -0,0 +1,31 @@
+﻿namespace StereoKit
+{
+    /// <summary>A look at how much memory StereoKit is using, and where! Heap memory
+    /// is counted by the subsystem that asked for it, and assets can be counted by
+    /// type, along with an estimate of how much GPU memory they take up. This is
+    /// handy for keeping an eye on budgets, or spotting leaks in apps that run for
+    /// a long time.</summary>
+    public static class Memory
+    {
+        /// <summary>Total heap bytes StereoKit is tracking, across all subsystems.</summary>
+        public static long Total => NativeAPI.memory_get_total();
+
+        /// <summary>Heap memory used by a single subsystem.</summary>
+        /// <param name="tag">The subsystem to check.</param>
+        /// <returns>Current and peak bytes, and the number of allocations.</returns>
+        public static MemoryUsage GetUsage(MemoryTag tag)
+            => NativeAPI.memory_get_usage(tag);
+
+        /// <summary>Memory used by all the live assets of one type. This walks the
+        /// asset list, so it's not something to call every frame.</summary>
+        /// <param name="type">The type of asset to count.</param>
+        /// <returns>Asset count, CPU bytes, and estimated GPU bytes.</returns>
+        public static AssetMemoryUsage GetAssetUsage(AssetType type)
+            => NativeAPI.memory_get_asset_usage(type);
+
+        /// <summary>Writes a breakdown of memory by subsystem and asset type to the
+        /// log, at the Info level.</summary>
+        public static void Log()
+            => NativeAPI.memory_log();
+    }
+}
@@ -0,0 +1,75 @@
+﻿using System;
+
+namespace StereoKit
+{
+    /// <summary>A set of camera facing particles, spawned and moved by StereoKit
+    /// itself, and drawn as a single instanced draw call. Particles are stored and
+    /// simulated natively, so thousands of them are far cheaper than thousands of
+    /// individual Renderer.Add calls.
+    /// 
+    /// Like the rest of StereoKit's drawing, a ParticleSystem is immediate mode. It
+    /// only spawns and moves particles while Draw is being called each frame, and
+    /// the simulation happens once per frame, after your update, at the last place
+    /// it was drawn.</summary>
+    public class ParticleSystem : IDisposable
+    {
+        internal IntPtr _inst;
+
+        /// <summary>How many particles were alive after the last frame's
+        /// simulation step?</summary>
+        public int Count => NativeAPI.particles_count(_inst);
+
+        /// <summary>The settings for how particles are spawned and moved. Changes
+        /// affect new particles, as well as those that are already alive.</summary>
+        public ParticleEmitter Emitter { set => NativeAPI.particles_set_emitter(_inst, value); }
+
+        /// <summary>Creates a particle system with room for a fixed number of 
+        /// particles.</summary>
+        /// <param name="maxParticles">Most particles that can be alive at once. Any
+        /// that would spawn past this are skipped.</param>
+        /// <param name="emitter">How particles are spawned and moved.</param>
+        /// <param name="material">The material to draw each particle with, null 
+        /// uses a default soft, unlit, alpha blended dot. Particle color comes 
+        /// through as the per-instance color.</param>
+        public ParticleSystem(int maxParticles, ParticleEmitter emitter, Material material = null)
+        {
+            _inst = NativeAPI.particles_create(maxParticles, emitter, material == null ? IntPtr.Zero : material._inst);
+        }
+        ~ParticleSystem()
+        {
+            if (_inst != IntPtr.Zero)
+                NativeAPI.particles_release(_inst);
+        }
+
+        /// <summary>Releases the particle system's memory immediately.</summary>
+        public void Dispose()
+        {
+            if (_inst != IntPtr.Zero)
+                NativeAPI.particles_release(_inst);
+            _inst = IntPtr.Zero;
+            GC.SuppressFinalize(this);
+        }
+
+        /// <summary>Sets the color of particles over their lifetime, where 0 on the
+        /// gradient is birth, and 1 is death. The gradient is sampled into a small
+        /// lookup table, so changing the gradient later has no effect unless it's
+        /// set again.</summary>
+        /// <param name="colorOverLife">Colors for each point in a particle's life.</param>
+        public void SetColors(Gradient colorOverLife)
+            => NativeAPI.particles_set_colors(_inst, colorOverLife._inst);
+
+        /// <summary>Spawns a number of particles all at once, the next time the
+        /// system is simulated.</summary>
+        /// <param name="count">How many particles to spawn.</param>
+        public void Burst(int count)
+            => NativeAPI.particles_burst(_inst, count);
+
+        /// <summary>Draws the particle system, and keeps it simulating for this
+        /// frame. New particles spawn from this transform, combined with the 
+        /// current Hierarchy.</summary>
+        /// <param name="transform">Where the emitter is, particles stay in world 
+        /// space once they've spawned.</param>
+        public void Draw(Matrix transform)
+            => NativeAPI.particles_draw(_inst, transform);
+    }
+}
@@ -0,0 +1,81 @@
+﻿using System;
+
+namespace StereoKit
+{
+    /// <summary>A list of mesh draws that can be built up ahead of time, on any thread,
+    /// and then added to the render queue all at once with Submit! This lets you split 
+    /// up scene traversal across multiple threads, with each thread filling its own 
+    /// command buffer, and then submitting them all at the end of the frame's update.
+    /// 
+    /// A single command buffer should only be used by one thread at a time. The
+    /// buffer keeps the Meshes and Materials it draws alive until it's cleared or
+    /// disposed, so they don't need to be held onto separately.</summary>
+    public class RenderCommandBuffer : IDisposable
+    {
+        internal IntPtr _inst;
+
+        /// <summary>How many draws are currently in this command buffer?</summary>
+        public int Count => NativeAPI.render_cmdbuf_count(_inst);
+
+        /// <summary>Creates an empty command buffer.</summary>
+        /// <param name="capacity">How many draws should space be reserved for up front?
+        /// The buffer will still grow past this if needed.</param>
+        public RenderCommandBuffer(int capacity = 0)
+        {
+            _inst = NativeAPI.render_cmdbuf_create(capacity);
+        }
+        ~RenderCommandBuffer()
+        {
+            if (_inst != IntPtr.Zero)
+                NativeAPI.render_cmdbuf_release(_inst);
+        }
+
+        /// <summary>Releases the command buffer's memory immediately.</summary>
+        public void Dispose()
+        {
+            if (_inst != IntPtr.Zero)
+                NativeAPI.render_cmdbuf_release(_inst);
+            _inst = IntPtr.Zero;
+            GC.SuppressFinalize(this);
+        }
+
+        /// <summary>Removes all draws from the command buffer, and lets go of their
+        /// Meshes and Materials. The buffer's memory is kept around so it can be
+        /// filled again without allocating.</summary>
+        public void Clear()
+            => NativeAPI.render_cmdbuf_clear(_inst);
+
+        /// <summary>Adds a mesh draw to the command buffer. Note that the Hierarchy is
+        /// not applied here, but when the buffer is submitted!</summary>
+        /// <param name="mesh">A valid Mesh you wish to draw.</param>
+        /// <param name="material">A Material to apply to the Mesh.</param>
+        /// <param name="transform">A Matrix that will transform the mesh from Model Space into the
+        /// Hierarchy Space that's active when this buffer is submitted.</param>
+        /// <param name="color">A per-instance color value to pass into the shader!</param>
+        public void Add(Mesh mesh, Material material, Matrix transform, Color color)
+            => NativeAPI.render_cmdbuf_add_mesh(_inst, mesh._inst, material._inst, transform, color);
+
+        /// <summary>Adds a mesh draw to the command buffer. Note that the Hierarchy is
+        /// not applied here, but when the buffer is submitted!</summary>
+        /// <param name="mesh">A valid Mesh you wish to draw.</param>
+        /// <param name="material">A Material to apply to the Mesh.</param>
+        /// <param name="transform">A Matrix that will transform the mesh from Model Space into the
+        /// Hierarchy Space that's active when this buffer is submitted.</param>
+        public void Add(Mesh mesh, Material material, Matrix transform)
+            => NativeAPI.render_cmdbuf_add_mesh(_inst, mesh._inst, material._inst, transform, Color.White);
+
+        /// <summary>Adds a list of draws to the command buffer in a single call.</summary>
+        /// <param name="commands">Draw commands to add, see RenderCommand.</param>
+        /// <param name="count">How many commands from the start of the array should be added?
+        /// This is clamped to the array's length.</param>
+        public void Add(RenderCommand[] commands, int count)
+            => NativeAPI.render_cmdbuf_add_list(_inst, commands, Math.Min(count, commands.Length));
+
+        /// <summary>Appends everything in this command buffer to this frame's render 
+        /// queue, combined with the current Hierarchy transform. The buffer's contents
+        /// are left as-is, so a static buffer can be submitted again every frame. This
+        /// uses the Hierarchy of the thread it's called from.</summary>
+        public void Submit()
+            => NativeAPI.render_cmdbuf_submit(_inst);
+    }
+}
@@ -35,6 +35,46 @@ namespace StereoKit
             set => NativeAPI.render_enable_skytex(value);
         }
 
+        /// <summary>Opaque items are sorted front to back within each Material and Mesh pair, so
+        /// the depth test can skip more hidden pixels. This costs a little CPU time per item, so
+        /// it can be turned off for scenes that don't overlap much. Transparent items are always
+        /// sorted back to front. On by default.</summary>
+        public static bool EnableOpaqueSort
+        {
+            get => NativeAPI.render_enabled_opaque_sort();
+            set => NativeAPI.render_enable_opaque_sort(value);
+        }
+
+        /// <summary>Consecutive draws that share a Material but not a Mesh get merged into
+        /// one batch, with one instance upload and no buffer rebinds between Meshes that
+        /// live in the same shared buffers. This only applies to shaders that read their
+        /// instance index from the `SK_INSTANCE` semantic, which all the built-in shaders
+        /// do. On by default.</summary>
+        public static bool EnableBatching
+        {
+            get => NativeAPI.render_enabled_batching();
+            set => NativeAPI.render_enable_batching(value);
+        }
+
+        /// <summary>Counts from the most recently drawn frame, like draw calls, triangles,
+        /// and bytes uploaded to the GPU. These are gathered up when the frame finishes
+        /// drawing, so this is usually the previous frame.</summary>
+        public static RenderStats Stats => NativeAPI.render_get_stats();
+
+        /// <summary>Stats for the most recently drawn frames, newest first. StereoKit 
+        /// keeps the last 120 frames.</summary>
+        /// <param name="maxFrames">The most frames to return.</param>
+        /// <returns>An array with up to maxFrames entries, the first of which matches
+        /// Renderer.Stats.</returns>
+        public static RenderStats[] GetStatsHistory(int maxFrames = 120)
+        {
+            RenderStats[] history = new RenderStats[Math.Max(0, maxFrames)];
+            int count = NativeAPI.render_get_stats_history(history, history.Length);
+            if (count < history.Length)
+                Array.Resize(ref history, count);
+            return history;
+        }
+
         /// <summary>Adds a mesh to the render queue for this frame! If the Hierarchy has a transform on it,
         /// that transform is combined with the Matrix provided here.</summary>
         /// <param name="mesh">A valid Mesh you wish to draw.</param>
@@ -54,6 +94,44 @@ namespace StereoKit
         /// spot to pack in extra per-instance data for the shader!</param>
         public static void Add(Mesh mesh, Material material, Matrix transform, Color color)
             => NativeAPI.render_add_mesh(mesh._inst, material._inst, transform, color);
+        /// <summary>Adds a mesh to the render queue for this frame, along with a Vec4 of custom
+        /// per-instance data! Shaders can declare named fields in this data with `// [inst] float2 name`
+        /// comments, and read the whole thing through a `float4 : SK_INST_DATA` vertex input. This
+        /// keeps the draw batched with others using the same Material, where a Material per value
+        /// would not.</summary>
+        /// <param name="mesh">A valid Mesh you wish to draw.</param>
+        /// <param name="material">A Material to apply to the Mesh.</param>
+        /// <param name="transform">A Matrix that will transform the mesh from Model Space into the current
+        /// Hierarchy Space.</param>
+        /// <param name="color">A per-instance color value to pass into the shader!</param>
+        /// <param name="instanceData">Custom per-instance data for the shader. Shader.GetInstanceOffset
+        /// tells you where each of the shader's named fields lives in here.</param>
+        public static void Add(Mesh mesh, Material material, Matrix transform, Color color, Vec4 instanceData)
+            => NativeAPI.render_add_mesh_data(mesh._inst, material._inst, transform, color, instanceData);
+
+        /// <summary>Adds a point light for this frame! Lights are used by the default PBR shader,
+        /// and each pixel only pays for the lights that actually reach it, so scenes can have
+        /// hundreds of small lights. If the Hierarchy has a transform on it, the position is
+        /// transformed by it.</summary>
+        /// <param name="position">Center of the light, in Hierarchy Space.</param>
+        /// <param name="radius">Distance in meters where the light fades out completely. Smaller
+        /// is cheaper!</param>
+        /// <param name="color">Linear color of the light.</param>
+        /// <param name="intensity">Brightness multiplier for the color.</param>
+        public static void AddLight(Vec3 position, float radius, Color color, float intensity = 1)
+            => NativeAPI.render_add_light(position, radius, color, intensity);
+
+        /// <summary>Adds a spot light for this frame! Works like AddLight, but only lights up a
+        /// cone in front of it.</summary>
+        /// <param name="position">Tip of the light's cone, in Hierarchy Space.</param>
+        /// <param name="direction">Direction the cone points.</param>
+        /// <param name="radius">Distance in meters where the light fades out completely.</param>
+        /// <param name="angleInner">Full angle in degrees of the cone's bright center.</param>
+        /// <param name="angleOuter">Full angle in degrees where the cone fades out completely.</param>
+        /// <param name="color">Linear color of the light.</param>
+        /// <param name="intensity">Brightness multiplier for the color.</param>
+        public static void AddSpotLight(Vec3 position, Vec3 direction, float radius, float angleInner, float angleOuter, Color color, float intensity = 1)
+            => NativeAPI.render_add_light_spot(position, direction, radius, angleInner, angleOuter, color, intensity);
 
         /// <summary>Adds a Model to the render queue for this frame! If the Hierarchy has a transform on it,
         /// that transform is combined with the Matrix provided here.</summary>
@@ -73,6 +151,70 @@ namespace StereoKit
         public static void Add(Model model, Matrix transform, Color color)
             => NativeAPI.render_add_model(model._inst, transform, color);
 
+        /// <summary>Adds a whole list of meshes to the render queue in a single call! This 
+        /// behaves exactly like calling Add(Mesh, Material, Matrix, Color) for each command, 
+        /// but only crosses into StereoKit once, which is a lot cheaper when drawing many
+        /// objects. Keep the array around and re-use it between frames!</summary>
+        /// <param name="commands">Draw commands to add, see RenderCommand.</param>
+        /// <param name="count">How many commands from the start of the array should be added?
+        /// This is clamped to the array's length.</param>
+        public static void Add(RenderCommand[] commands, int count)
+            => NativeAPI.render_add_mesh_list(commands, Math.Min(count, commands.Length));
+
+        /// <summary>Draws many copies of a Mesh in a single call, as one instanced item in
+        /// the render queue. This is much faster than calling Add for each copy, since the
+        /// sort key is only worked out once, and the transforms go straight into the
+        /// instance list. If the Hierarchy has a transform on it, it applies to every
+        /// instance.</summary>
+        /// <param name="mesh">A valid Mesh you wish to draw.</param>
+        /// <param name="material">A Material to apply to the Mesh.</param>
+        /// <param name="transforms">A Matrix for each instance, from Model Space into the
+        /// current Hierarchy Space.</param>
+        /// <param name="colors">A color for each instance, or null for white.</param>
+        /// <param name="count">How many instances from the start of the arrays should be
+        /// drawn? This is clamped to the arrays' lengths.</param>
+        public static void AddInstances(Mesh mesh, Material material, Matrix[] transforms, Color[] colors, int count)
+            => NativeAPI.render_add_mesh_instances(mesh._inst, material._inst, transforms, colors, InstanceCount(transforms, colors, count));
+
+        /// <summary>Draws many copies of a Model in a single call. Each subset of the Model
+        /// becomes one instanced item in the render queue, so thousands of copies cost about
+        /// as much to submit as a handful of Add calls. Instances always use the Model's full
+        /// detail meshes. If the Hierarchy has a transform on it, it applies to every
+        /// instance.</summary>
+        /// <param name="model">A valid Model you wish to draw.</param>
+        /// <param name="transforms">A Matrix for each instance, from Model Space into the
+        /// current Hierarchy Space.</param>
+        /// <param name="colors">A color for each instance, or null for white.</param>
+        /// <param name="count">How many instances from the start of the arrays should be
+        /// drawn? This is clamped to the arrays' lengths.</param>
+        public static void AddInstances(Model model, Matrix[] transforms, Color[] colors, int count)
+            => NativeAPI.render_add_model_instances(model._inst, transforms, colors, InstanceCount(transforms, colors, count));
+
+        static int InstanceCount(Matrix[] transforms, Color[] colors, int count)
+        {
+            count = Math.Min(count, transforms.Length);
+            return colors == null ? count : Math.Min(count, colors.Length);
+        }
+
+        /// <summary>Adds a mesh to the render queue that's attached to the user's head! The transform 
+        /// is relative to the head, and the head pose gets latched as late as possible before drawing,
+        /// so this content won't lag behind head motion the way Input.Head based content can.</summary>
+        /// <param name="mesh">A valid Mesh you wish to draw.</param>
+        /// <param name="material">A Material to apply to the Mesh.</param>
+        /// <param name="headTransform">A Matrix that will transform the mesh from Model Space into
+        /// the current Hierarchy Space, relative to the head.</param>
+        /// <param name="color">A per-instance color value to pass into the shader!</param>
+        public static void AddHead(Mesh mesh, Material material, Matrix headTransform, Color color)
+            => NativeAPI.render_add_mesh_head(mesh._inst, material._inst, headTransform, color);
+        /// <summary>Adds a Model to the render queue that's attached to the user's head! The transform 
+        /// is relative to the head, and the head pose gets latched as late as possible before drawing.</summary>
+        /// <param name="model">A valid Model you wish to draw.</param>
+        /// <param name="headTransform">A Matrix that will transform the Model from Model Space into
+        /// the current Hierarchy Space, relative to the head.</param>
+        /// <param name="color">A per-instance color value to pass into the shader!</param>
+        public static void AddHead(Model model, Matrix headTransform, Color color)
+            => NativeAPI.render_add_model_head(model._inst, headTransform, color);
+
         /// <summary>Set the near and far clipping planes of the camera! These are important
         /// to z-buffer quality, especially when using low bit depth z-buffers as recommended
         /// for devices like the HoloLens. The smaller the range between the near and far planes,
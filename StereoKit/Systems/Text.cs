@@ -37,6 +37,15 @@
         public static void Add(string text, Matrix transform, TextAlign position = TextAlign.Center, TextAlign align = TextAlign.Center, float offX = 0, float offY = 0, float offZ = 0)
             => NativeAPI.text_add_at(text, transform, -1, position, align, offX, offY, offZ);
 
+        /// <summary>Renders a whole list of text spans in a single call! Since each span 
+        /// refers to pre-encoded AsciiText, there's no per-frame string marshalling either.
+        /// Must be called every frame you want this text to be visible.</summary>
+        /// <param name="spans">Text spans to draw, see TextSpan.</param>
+        /// <param name="count">How many spans from the start of the array should be drawn?
+        /// This is clamped to the array's length.</param>
+        public static void Add(TextSpan[] spans, int count)
+            => NativeAPI.text_add_list(spans, System.Math.Min(count, spans.Length));
+
         /// <summary>Sometimes you just need to know how much room some text takes up! This finds
         /// the size of the text in meters, when using the indicated style!</summary>
         /// <param name="text">Text you want to find the size of.</param>
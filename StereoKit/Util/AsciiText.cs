@@ -0,0 +1,50 @@
+﻿using System;
+using System.Runtime.InteropServices;
+using System.Text;
+
+namespace StereoKit
+{
+    /// <summary>A string that's been encoded to null terminated ASCII ahead of time,
+    /// and lives in native memory! Passing a C# string to StereoKit means encoding and
+    /// copying it on every call, so for text that gets drawn every frame, it's much 
+    /// cheaper to encode it once here and submit it via TextSpan. StereoKit's fonts
+    /// only have glyphs for ASCII, same as Text.Add, so anything else becomes '?'.</summary>
+    public class AsciiText : IDisposable
+    {
+        internal IntPtr _inst;
+        string _text;
+
+        /// <summary>The text this was created from.</summary>
+        public string Text => _text;
+
+        /// <summary>Encodes the text into native memory.</summary>
+        /// <param name="text">Text to encode, null is treated as an empty string.</param>
+        public AsciiText(string text)
+        {
+            _text = text ?? "";
+            byte[] bytes = Encoding.ASCII.GetBytes(_text);
+            _inst = Marshal.AllocHGlobal(bytes.Length + 1);
+            Marshal.Copy(bytes, 0, _inst, bytes.Length);
+            Marshal.WriteByte(_inst, bytes.Length, 0);
+        }
+        ~AsciiText()
+        {
+            Free();
+        }
+
+        /// <summary>Frees the native copy of the text. Any TextSpan that still refers 
+        /// to this text must not be submitted after this!</summary>
+        public void Dispose()
+        {
+            Free();
+            GC.SuppressFinalize(this);
+        }
+
+        void Free()
+        {
+            if (_inst != IntPtr.Zero)
+                Marshal.FreeHGlobal(_inst);
+            _inst = IntPtr.Zero;
+        }
+    }
+}
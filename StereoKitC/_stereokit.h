@@ -19,6 +19,7 @@ extern int64_t sk_timev_raw;
 extern bool32_t sk_focused;
 extern bool32_t sk_run;
 
-void sk_update_timer();
+void sk_update_timer  ();
+bool sk_on_main_thread();
 
 } // namespace sk
\ No newline at end of file
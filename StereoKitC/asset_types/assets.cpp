@@ -10,10 +10,19 @@
 #include "sprite.h"
 #include "sound.h"
 #include "../libraries/stref.h"
+#include "../memory_tracking.h"
+#include "../systems/mesh_arena.h"
+#include "../systems/tex_upload.h"
+#include "../systems/state_cache.h"
+#include "../systems/defaults.h"
+#include "../math.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include <vector>
+#include <mutex>
+#include <atomic>
 using namespace std;
 
 namespace sk {
@@ -21,6 +30,31 @@ namespace sk {
 ///////////////////////////////////////////
 
 vector<asset_header_t *> assets;
+// The render thread can create and release assets too (screenshots), so
+// the list itself needs a little protection when pipelining.
+mutex                    assets_lock;
+
+// Released assets may still be in the render queue being built, or the one
+// the render thread is drawing, so they wait a couple of frames before
+// they're actually destroyed.
+struct asset_destroy_t {
+	asset_header_t *asset;
+	uint64_t        frame;
+};
+vector<asset_destroy_t> assets_destroy_queue;
+vector<asset_destroy_t> assets_destroy_now;
+mutex                   assets_destroy_lock;
+atomic<uint64_t>        assets_frame;
+const uint64_t          assets_destroy_delay = 2;
+
+///////////////////////////////////////////
+
+// refs stays a plain int so asset structs can still be cleared with = {},
+// but it's only ever touched atomically, through here.
+inline atomic<int32_t> &assets_refs(asset_header_t &asset) {
+	static_assert(sizeof(atomic<int32_t>) == sizeof(int32_t), "Asset refcounts need to be lock free!");
+	return *reinterpret_cast<atomic<int32_t> *>(&asset.refs);
+}
 
 ///////////////////////////////////////////
 
@@ -31,6 +65,7 @@ void *assets_find(const char *id, asset_type_ type) {
 ///////////////////////////////////////////
 
 void *assets_find(uint64_t id, asset_type_ type) {
+	lock_guard<mutex> lock(assets_lock);
 	size_t count = assets.size();
 	for (size_t i = 0; i < count; i++) {
 		if (assets[i]->id == id && assets[i]->type == type)
@@ -41,6 +76,33 @@ void *assets_find(uint64_t id, asset_type_ type) {
 
 ///////////////////////////////////////////
 
+void *assets_find_ref(const char *id, asset_type_ type) {
+	uint64_t id_hash = string_hash(id);
+
+	{
+		lock_guard<mutex> lock(assets_lock);
+		size_t count = assets.size();
+		for (size_t i = 0; i < count; i++) {
+			if (assets[i]->id != id_hash || assets[i]->type != type)
+				continue;
+
+			// Another thread may have just released the last reference, and be
+			// waiting on the lock to take it out of the list. Those stay dead.
+			atomic<int32_t> &refs = assets_refs(*assets[i]);
+			int32_t          curr = refs.load();
+			while (curr > 0 && !refs.compare_exchange_weak(curr, curr + 1)) {}
+			if (curr > 0)
+				return assets[i];
+		}
+	}
+
+	// Default assets aren't made until someone asks for one. This creates
+	// assets, so it can't happen under the lock.
+	return defaults_find(id_hash, type);
+}
+
+///////////////////////////////////////////
+
 void assets_unique_name(asset_type_ type, const char *root_name, char *dest, int dest_size) {
 	sprintf_s(dest, dest_size, "%s", root_name);
 	uint64_t id    = string_hash(dest);
@@ -68,11 +130,12 @@ void *assets_allocate(asset_type_ type) {
 	default: throw "Unimplemented asset type!";
 	}
 
+	asset_header_t *header = (asset_header_t *)sk_calloc(memory_tag_assets, 1, size);
+
+	lock_guard<mutex> lock(assets_lock);
 	char name[64];
 	sprintf_s(name, "auto/asset_%d", (int)assets.size());
 
-	asset_header_t *header = (asset_header_t *)malloc(size);
-	memset(header, 0, size);
 	header->type  = type;
 	header->refs += 1;
 	header->id    = string_hash(name);
@@ -102,19 +165,38 @@ void assets_set_id(asset_header_t &header, uint64_t id) {
 ///////////////////////////////////////////
 
 void  assets_addref(asset_header_t &asset) {
-	asset.refs += 1;
+	assets_refs(asset).fetch_add(1);
 }
 
 ///////////////////////////////////////////
 
 void  assets_releaseref(asset_header_t &asset) {
 	// Manage the reference count
-	asset.refs -= 1;
-	if (asset.refs < 0)
+	int32_t refs = assets_refs(asset).fetch_sub(1) - 1;
+	if (refs < 0)
 		throw "Released too many references to asset!";
-	if (asset.refs != 0)
+	if (refs != 0)
 		return;
 
+	// Remove it from our list of assets, so nothing can find it again
+	{
+		lock_guard<mutex> lock(assets_lock);
+		for (size_t i = 0; i < assets.size(); i++) {
+			if (assets[i] == &asset) {
+				assets.erase(assets.begin() + i);
+				break;
+			}
+		}
+	}
+
+	// And queue it up for destruction once nothing can be drawing with it
+	lock_guard<mutex> lock(assets_destroy_lock);
+	assets_destroy_queue.push_back({ &asset, assets_frame.load() });
+}
+
+///////////////////////////////////////////
+
+void assets_destroy(asset_header_t &asset) {
 	// Call asset specific destroy function
 	switch(asset.type) {
 	case asset_type_mesh:     mesh_destroy    ((mesh_t    )&asset); break;
@@ -128,19 +210,62 @@ void  assets_releaseref(asset_header_t &asset) {
 	default: throw "Unimplemented asset type!";
 	}
 
-	// Remove it from our list of assets
-	for (size_t i = 0; i < assets.size(); i++) {
-		if (assets[i] == &asset) {
-			assets.erase(assets.begin() + i);
-			break;
-		}
-	}
-
 	// And at last, free the memory we allocated for it!
 #ifdef _DEBUG
 	free(asset.id_text);
 #endif
-	free(&asset);
+	sk_free(&asset);
+}
+
+///////////////////////////////////////////
+
+void assets_destroy_queued(uint64_t before_frame) {
+	// Destroying an asset releases the ones it references, which adds to
+	// the queue, so the lock isn't held while destroying.
+	{
+		lock_guard<mutex> lock(assets_destroy_lock);
+		size_t keep = 0;
+		for (size_t i = 0; i < assets_destroy_queue.size(); i++) {
+			if (assets_destroy_queue[i].frame < before_frame)
+				assets_destroy_now.push_back(assets_destroy_queue[i]);
+			else
+				assets_destroy_queue[keep++] = assets_destroy_queue[i];
+		}
+		assets_destroy_queue.resize(keep);
+	}
+	for (size_t i = 0; i < assets_destroy_now.size(); i++)
+		assets_destroy(*assets_destroy_now[i].asset);
+	assets_destroy_now.clear();
+}
+
+///////////////////////////////////////////
+
+void assets_update() {
+	uint64_t frame = assets_frame.fetch_add(1) + 1;
+	if (frame > assets_destroy_delay)
+		assets_destroy_queued(frame - assets_destroy_delay);
+	state_cache_update();
+}
+
+///////////////////////////////////////////
+
+void assets_shutdown() {
+	// Nothing is drawing anymore, so everything can go right away, including
+	// anything released by the assets destroyed here.
+	size_t count;
+	do {
+		assets_destroy_queued(UINT64_MAX);
+		lock_guard<mutex> lock(assets_destroy_lock);
+		count = assets_destroy_queue.size();
+	} while (count > 0);
+
+	// Every mesh is gone now, so their arenas can go too, and the same for
+	// texture upload buffers and the render states that materials and
+	// textures shared.
+	mesh_arena_shutdown();
+	tex_upload_shutdown();
+	state_cache_shutdown();
+	assets_shutdown_check();
 }
 
 ///////////////////////////////////////////
@@ -148,25 +273,110 @@ void  assets_releaseref(asset_header_t &asset) {
 void  assets_shutdown_check() {
 	if (assets.size() > 0) {
 		log_errf("%d unreleased assets still found in the asset manager!", (int)assets.size());
+		memory_log();
 	}
 }
 
 ///////////////////////////////////////////
 
-char assets_file_buffer[1024];
-const char *assets_file(const char *file_name) {
-	if (file_name == nullptr || sk_settings.assets_folder[0] == '\0')
-		return file_name;
-
-	const char *ch = file_name;
-	while (*ch != '\0') {
-		if (*ch == ':') {
-			return file_name;
+int64_t assets_gpu_bytes(asset_header_t *asset) {
+	int64_t result = 0;
+	switch (asset->type) {
+	case asset_type_mesh: {
+		// Meshes in an arena only count their own part of it, and meshes
+		// from mesh_gen leave theirs to the cached mesh they came from.
+		mesh_t            mesh = (mesh_t)asset;
+		D3D11_BUFFER_DESC desc;
+		if (mesh->gen_source != nullptr)
+			break;
+		if      (mesh->vert_arena  != 0)       { result += (int64_t)mesh->vert_count * sizeof(vert_t); }
+		else if (mesh->vert_buffer != nullptr) { mesh->vert_buffer->GetDesc(&desc); result += desc.ByteWidth; }
+		if      (mesh->ind_arena   != 0)       { result += (int64_t)mesh->ind_count * (mesh->ind_wide ? sizeof(uint32_t) : sizeof(uint16_t)); }
+		else if (mesh->ind_buffer  != nullptr) { mesh->ind_buffer ->GetDesc(&desc); result += desc.ByteWidth; }
+	} break;
+	case asset_type_texture: {
+		tex_t tex = (tex_t)asset;
+		if (tex->texture == nullptr)
+			break;
+		D3D11_TEXTURE2D_DESC desc;
+		tex->texture->GetDesc(&desc);
+		int64_t pixel = (int64_t)tex_format_size(tex->format) * desc.ArraySize * desc.SampleDesc.Count;
+		for (UINT mip = 0; mip < desc.MipLevels; mip++) {
+			int64_t width  = maxi(1u, desc.Width  >> mip);
+			int64_t height = maxi(1u, desc.Height >> mip);
+			result += width * height * pixel;
 		}
-		ch++;
+	} break;
+	default: break;
 	}
+	return result;
+}
+
+///////////////////////////////////////////
+
+int64_t assets_cpu_bytes(asset_header_t *asset) {
+	int64_t result = 0;
+	switch (asset->type) {
+	case asset_type_mesh:     result = sizeof(_mesh_t );    break;
+	case asset_type_texture:  result = sizeof(_tex_t);      break;
+	case asset_type_shader:   result = sizeof(_shader_t);   break;
+	case asset_type_material: {
+		material_t material = (material_t)asset;
+		result = sizeof(_material_t);
+		if (material->shader != nullptr)
+			result += material->shader->args.buffer_size + sizeof(tex_t) * material->shader->tex_slots.tex_count;
+	} break;
+	case asset_type_model: {
+		model_t model = (model_t)asset;
+		result = sizeof(_model_t) + sizeof(model_subset_t) * model->subset_count;
+	} break;
+	case asset_type_font:     result = sizeof(_font_t);     break;
+	case asset_type_sprite:   result = sizeof(_sprite_t);   break;
+	case asset_type_sound:    result = sizeof(_sound_t);    break;
+	default: break;
+	}
+	return result;
+}
+
+///////////////////////////////////////////
 
-	sprintf_s(assets_file_buffer, "%s/%s", sk_settings.assets_folder, file_name);
+memory_asset_usage_t memory_get_asset_usage(asset_type_ type) {
+	memory_asset_usage_t result = {};
+	lock_guard<mutex> lock(assets_lock);
+	for (size_t i = 0; i < assets.size(); i++) {
+		if (assets[i]->type != type)
+			continue;
+		result.count     += 1;
+		result.cpu_bytes += assets_cpu_bytes(assets[i]);
+		result.gpu_bytes += assets_gpu_bytes(assets[i]);
+	}
+	return result;
+}
+
+///////////////////////////////////////////
+
+void assets_file_path(const char *file_name, char *out_path, size_t out_path_size) {
+	if (file_name == nullptr) {
+		out_path[0] = '\0';
+		return;
+	}
+	if (sk_settings.assets_folder[0] == '\0' || strchr(file_name, ':') != nullptr) {
+		sprintf_s(out_path, out_path_size, "%s", file_name);
+		return;
+	}
+	sprintf_s(out_path, out_path_size, "%s/%s", sk_settings.assets_folder, file_name);
+}
+
+///////////////////////////////////////////
+
+// Kept per-thread so loads on different threads don't trample each other,
+// but the result is still only good until the next call on the same thread.
+// Prefer assets_file_path, or vfs_open for reading.
+thread_local char assets_file_buffer[1024];
+const char *assets_file(const char *file_name) {
+	if (file_name == nullptr)
+		return file_name;
+	assets_file_path(file_name, assets_file_buffer, sizeof(assets_file_buffer));
 	return assets_file_buffer;
 }
 
@@ -1,24 +1,16 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 
-namespace sk {
+#include "../stereokit.h"
 
-enum asset_type_ {
-	asset_type_mesh = 0,
-	asset_type_texture,
-	asset_type_shader,
-	asset_type_material,
-	asset_type_model,
-	asset_type_font,
-	asset_type_sprite,
-	asset_type_sound,
-};
+namespace sk {
 
 struct asset_header_t {
 	asset_type_ type;
 	uint64_t    id;
-	int32_t     refs;
+	int32_t     refs; // Atomic, only touch it through assets_addref/releaseref
 	uint64_t    index;
 #ifdef _DEBUG
 	char       *id_text;
@@ -27,13 +19,20 @@ struct asset_header_t {
 
 void *assets_find       (const char *id, asset_type_ type);
 void *assets_find       (uint64_t    id, asset_type_ type);
+void *assets_find_ref   (const char *id, asset_type_ type);
 void *assets_allocate   (asset_type_ type);
 void  assets_set_id     (asset_header_t &header, const char *id);
 void  assets_set_id     (asset_header_t &header, uint64_t    id);
 void  assets_unique_name(asset_type_ type, const char *root_name, char *dest, int dest_size);
+// Safe from any thread. Releasing the last reference takes the asset out of
+// the list right away, but it's only destroyed by assets_update a couple of
+// frames later, once the renderer can't be using it anymore.
 void  assets_addref     (asset_header_t &asset);
 void  assets_releaseref (asset_header_t &asset);
+void  assets_update     ();
+void  assets_shutdown   ();
 void  assets_shutdown_check();
-const char *assets_file(const char *file_name);
+const char *assets_file     (const char *file_name);
+void        assets_file_path(const char *file_name, char *out_path, size_t out_path_size);
 
 } // namespace sk
\ No newline at end of file
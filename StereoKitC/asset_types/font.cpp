@@ -4,6 +4,8 @@
 #define STB_TRUETYPE_IMPLEMENTATION
 #include "../libraries/stb_rect_pack.h"
 #include "../libraries/stb_truetype.h"
+#include "../systems/vfs.h"
+#include "../pixel_convert.h"
 
 #include <stdio.h>
 
@@ -12,12 +14,7 @@ namespace sk {
 ///////////////////////////////////////////
 
 font_t font_find(const char *id) {
-	font_t result = (font_t)assets_find(id, asset_type_font);
-	if (result != nullptr) {
-		assets_addref(result->header);
-		return result;
-	}
-	return nullptr;
+	return (font_t)assets_find_ref(id, asset_type_font);
 }
 
 ///////////////////////////////////////////
@@ -29,20 +26,10 @@ font_t font_create(const char *file) {
 	result = (font_t)assets_allocate(asset_type_font);
 	assets_set_id(result->header, file);
 
-	FILE *fp;
-	if (fopen_s(&fp, assets_file(file), "rb") != 0 || fp == nullptr)
+	vfs_file_t font_file;
+	if (!vfs_open(file, font_file))
 		return nullptr;
-
-	// Get length of file
-	fseek(fp, 0L, SEEK_END);
-	size_t length = ftell(fp);
-	rewind(fp);
-
-	// Read the data
-	unsigned char *data = (unsigned char *)malloc(sizeof(unsigned char) *length);
-	if (data == nullptr) { fclose(fp); return nullptr; }
-	fread(data, 1, length, fp);
-	fclose(fp);
+	const unsigned char *data = (const unsigned char *)font_file.data;
 
 	// Load and pack font data
 	const int w = 512;
@@ -58,7 +45,7 @@ font_t font_create(const char *file) {
 	stbtt_PackBegin(&pc, (unsigned char*)(bitmap), w, h, 0, 1, NULL);
 	stbtt_PackFontRange(&pc, data, 0, size, start_char, 95, chars);
 	stbtt_PackEnd(&pc);
-	free(data);
+	vfs_close(font_file);
 	
 	// convert characters
 	float convert_w = 1.0f / w;
@@ -80,9 +67,7 @@ font_t font_create(const char *file) {
 
 	// Convert to color data
 	color32 *colors = (color32*)malloc(w * h * sizeof(color32));
-	for (size_t i = 0; i < w*h; i++) {
-		colors[i] = color32{ bitmap[i], 0, 0, 0 };
-	}
+	pixel_r8_to_rgba32(bitmap, colors, (size_t)w * h);
 	result->font_tex = tex_create(tex_type_image);
 	tex_set_colors(result->font_tex, w, h, colors);
 
@@ -2,6 +2,7 @@
 #include "texture.h"
 #include "../systems/d3d.h"
 #include "../libraries/stref.h"
+#include "../memory_tracking.h"
 
 #include <stdio.h>
 
@@ -10,12 +11,7 @@ namespace sk {
 ///////////////////////////////////////////
 
 material_t material_find(const char *id) {
-	material_t result = (material_t)assets_find(id, asset_type_material);
-	if (result != nullptr) {
-		assets_addref(result->header);
-		return result;
-	}
-	return result;
+	return (material_t)assets_find_ref(id, asset_type_material);
 }
 
 ///////////////////////////////////////////
@@ -40,8 +36,8 @@ inline size_t material_param_size(material_param_ type) {
 ///////////////////////////////////////////
 
 void material_create_arg_defaults(material_t material, shader_t shader) {
-	material->args.buffer   = malloc(shader->args.buffer_size);
-	material->args.textures = (tex_t*)malloc(sizeof(tex_t)*shader->tex_slots.tex_count);
+	material->args.buffer   = sk_malloc(memory_tag_assets, shader->args.buffer_size);
+	material->args.textures = (tex_t*)sk_malloc(memory_tag_assets, sizeof(tex_t)*shader->tex_slots.tex_count);
 	memset(material->args.buffer,   0, shader->args.buffer_size);
 	memset(material->args.textures, 0, sizeof(tex_t) * shader->tex_slots.tex_count);
 
@@ -61,8 +57,8 @@ material_t material_create(shader_t shader) {
 	result->alpha_mode = transparency_none;
 	result->shader     = shader;
 	
-	material_set_cull(result, cull_back);
 	material_create_arg_defaults(result, shader);
+	material_set_cull(result, cull_back);
 
 	return result;
 }
@@ -91,8 +87,8 @@ material_t material_copy(material_t material) {
 		if (result->args.textures[i] != nullptr)
 			assets_addref(result->args.textures[i]->header);
 	}
-	if (result->rasterizer_state != nullptr) result->rasterizer_state->AddRef();
-	if (result->blend_state      != nullptr) result->blend_state->AddRef();
+	state_cache_addref(result->raster_state);
+	state_cache_addref(result->blend_state);
 
 	return result;
 }
@@ -122,14 +118,49 @@ void material_destroy(material_t material) {
 			tex_release(material->args.textures[i]);
 	}
 	shader_release(material->shader);
-	if (material->blend_state != nullptr) material->blend_state->Release();
-	free(material->args.buffer);
-	free(material->args.textures);
+	state_cache_release(material->blend_state);
+	state_cache_release(material->raster_state);
+	sk_free(material->args.buffer);
+	sk_free(material->args.textures);
 	*material = {};
 }
 
 ///////////////////////////////////////////
 
+// Packs what switching to this material changes on the GPU into 20 bits,
+// most expensive first, so materials that share a shader sort next to
+// each other even when their asset indices are far apart. Copies from
+// glTF files are the usual case.
+// [19..12] shader index
+// [11.. 8] blend and rasterizer state ids
+// [ 7.. 0] texture set hash
+void material_update_sort_key(material_t material) {
+	shader_t shader = material->shader;
+	if (shader == nullptr) {
+		material->sort_key = 0;
+		return;
+	}
+
+	uint32_t states = (material->blend_state * 5 + material->raster_state) & 0xF;
+
+	// FNV-1a over the texture indices, folded down to a byte
+	uint32_t textures = 2166136261u;
+	for (int32_t i = 0; i < shader->tex_slots.tex_count; i++) {
+		tex_t tex = material->args.textures[i];
+		if (tex == nullptr)
+			tex = shader->tex_slots.tex[i].default_tex;
+		textures = (textures ^ (uint32_t)(tex == nullptr ? 0 : tex->header.index)) * 16777619u;
+	}
+	textures = (textures ^ (textures >> 8) ^ (textures >> 16) ^ (textures >> 24)) & 0xFF;
+
+	material->sort_key =
+		((uint32_t)(shader->header.index & 0xFF) << 12) |
+		(states << 8) |
+		textures;
+}
+
+///////////////////////////////////////////
+
 shaderargs_desc_item_t *find_desc(shader_t shader, uint64_t id) {
 	for (size_t i = 0; i < shader->args_desc.item_count; i++) {
 		if (shader->args_desc.item[i].id == id) {
@@ -156,8 +187,8 @@ void material_set_shader(material_t material, shader_t shader) {
 		return;
 
 	// Copy over any relevant values that are attached to the old shader
-	if (material->shader != nullptr && shader != nullptr) {
-		shader_t old_shader   = material->shader;
+	shader_t old_shader = material->shader;
+	if (old_shader != nullptr && shader != nullptr) {
 		void    *old_buffer   = material->args.buffer;
 		tex_t *old_textures = material->args.textures;
 		material_create_arg_defaults(material, shader);
@@ -171,23 +202,25 @@ void material_set_shader(material_t material, shader_t shader) {
 						(uint8_t *)old_buffer            + item.offset, new_slot->size);
 		}
 
-		// Do the same for textures
+		// Do the same for textures, which need the new shader's slots
+		material->shader = shader;
 		for (size_t i = 0; i < old_shader->tex_slots.tex_count; i++) {
 			material_set_texture_id(material, old_shader->tex_slots.tex[i].id, old_textures[i]);
 			tex_release(old_textures[i]);
 		}
 
-		free(old_buffer);
-		free(old_textures);
+		sk_free(old_buffer);
+		sk_free(old_textures);
 	}
 
 	// Update references
 	if (shader != nullptr)
 		assets_addref(shader->header);
-	if (material->shader != nullptr)
-		shader_release(material->shader);
+	if (old_shader != nullptr)
+		shader_release(old_shader);
 
 	material->shader = shader;
+	material_update_sort_key(material);
 }
 
 ///////////////////////////////////////////
@@ -199,40 +232,23 @@ shader_t material_get_shader(material_t material) {
 ///////////////////////////////////////////
 
 void material_set_transparency(material_t material, transparency_ mode) {
-	if (material->blend_state != nullptr)
-		material->blend_state->Release();
-	D3D11_BLEND_DESC desc_blend = {};
-	desc_blend.AlphaToCoverageEnable  = false;
-	desc_blend.IndependentBlendEnable = false;
-	desc_blend.RenderTarget[0].BlendEnable = mode == transparency_blend;
-	desc_blend.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-	desc_blend.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
-	desc_blend.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
-	desc_blend.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
-	desc_blend.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
-	desc_blend.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ZERO;
-	desc_blend.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
-
-	d3d_device->CreateBlendState(&desc_blend, &material->blend_state);
-	material->alpha_mode = mode;
+	// Get the new state before releasing the old, so a shared state that's
+	// only referenced by this material doesn't get recreated.
+	state_id_t old_state = material->blend_state;
+	material->blend_state = state_cache_blend(mode);
+	material->alpha_mode  = mode;
+	state_cache_release(old_state);
+	material_update_sort_key(material);
 }
 
 ///////////////////////////////////////////
 
 void material_set_cull(material_t material, cull_ mode) {
-	if (material->rasterizer_state != nullptr)
-		material->rasterizer_state->Release();
-	D3D11_RASTERIZER_DESC desc_rasterizer = {};
-	desc_rasterizer.FillMode = D3D11_FILL_SOLID;
-	switch (mode) {
-	case cull_none:  desc_rasterizer.CullMode = D3D11_CULL_NONE;  break;
-	case cull_front: desc_rasterizer.CullMode = D3D11_CULL_FRONT; break;
-	case cull_back:  desc_rasterizer.CullMode = D3D11_CULL_BACK;  break;
-	}
-	desc_rasterizer.FrontCounterClockwise = true;
-
-	d3d_device->CreateRasterizerState(&desc_rasterizer, &material->rasterizer_state);
-	material->cull = mode;
+	state_id_t old_state = material->raster_state;
+	material->raster_state = state_cache_raster(mode);
+	material->cull         = mode;
+	state_cache_release(old_state);
+	material_update_sort_key(material);
 }
 
 ///////////////////////////////////////////
@@ -293,6 +309,7 @@ bool32_t material_set_texture_id(material_t material, uint64_t id, tex_t value)
 				material->args.textures[slot] = value;
 				if (value != nullptr)
 					assets_addref(value->header);
+				material_update_sort_key(material);
 			}
 			return true;
 		}
@@ -3,6 +3,7 @@
 #include "../stereokit.h"
 #include "assets.h"
 #include "shader.h"
+#include "../systems/state_cache.h"
 
 namespace sk {
 
@@ -13,11 +14,13 @@ struct _material_t {
 	transparency_     alpha_mode;
 	cull_             cull;
 	int32_t           queue_offset;
-	ID3D11BlendState      *blend_state;
-	ID3D11RasterizerState *rasterizer_state;
+	state_id_t        blend_state;
+	state_id_t        raster_state;
+	uint32_t          sort_key; // Bits for render sort ids, see material_update_sort_key
 };
 
-void   material_destroy   (material_t material);
+void   material_destroy        (material_t material);
+void   material_update_sort_key(material_t material);
 size_t material_param_size(material_param_ type);
 
 } // namespace sk
\ No newline at end of file
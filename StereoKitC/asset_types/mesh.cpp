@@ -1,5 +1,10 @@
 #include "../stereokit.h"
 #include "../systems/d3d.h"
+#include "../systems/render_pipeline.h"
+#include "../systems/render.h"
+#include "../systems/mesh_arena.h"
+#include "../systems/job_pool.h"
+#include "../libraries/stref.h"
 #include "mesh.h"
 #include "assets.h"
 
@@ -16,21 +21,36 @@ ID3D11InputLayout *vert_t_layout = nullptr;
 
 ///////////////////////////////////////////
 
+void mesh_gen_detach(mesh_t mesh);
+
+///////////////////////////////////////////
+
 void mesh_set_verts(mesh_t mesh, vert_t *vertices, int32_t vertex_count, bool32_t calculate_bounds) {
+	// Brand new meshes can't be in flight yet, but existing ones might be
+	if (mesh->vert_buffer != nullptr)
+		render_pipeline_sync();
+	if (mesh->gen_source != nullptr)
+		mesh_gen_detach(mesh);
+
 	if (mesh->vert_buffer == nullptr) {
-		// Create a static vertex buffer the first time we call this function!
+		// The first time we call this function, the mesh is static. Those go
+		// in a shared arena if they fit, or get a static buffer of their own!
 		mesh->vert_dynamic = false;
 
-		D3D11_SUBRESOURCE_DATA vert_buff_data = { vertices };
-		CD3D11_BUFFER_DESC     vert_buff_desc(sizeof(vert_t) * vertex_count, D3D11_BIND_VERTEX_BUFFER);
-		if (FAILED(d3d_device->CreateBuffer(&vert_buff_desc, &vert_buff_data, &mesh->vert_buffer)))
-			log_err("mesh_set_verts: Failed to create vertex buffer");
-		DX11ResType(mesh->vert_buffer, "verts");
+		if (mesh->generated || !mesh_arena_place(mesh, mesh_arena_verts, vertices, vertex_count)) {
+			D3D11_SUBRESOURCE_DATA vert_buff_data = { vertices };
+			CD3D11_BUFFER_DESC     vert_buff_desc(sizeof(vert_t) * vertex_count, D3D11_BIND_VERTEX_BUFFER);
+			if (FAILED(d3d_device->CreateBuffer(&vert_buff_desc, &vert_buff_data, &mesh->vert_buffer)))
+				log_err("mesh_set_verts: Failed to create vertex buffer");
+			DX11ResType(mesh->vert_buffer, "verts");
+		}
 	} else if (mesh->vert_dynamic == false || vertex_count > mesh->vert_count) {
 		// If they call this a second time, or they need more verts than will
 		// fit in this buffer, lets make a new dynamic buffer!
-		mesh->vert_buffer->Release();
+		if (mesh->vert_arena != 0) mesh_arena_remove(mesh, mesh_arena_verts);
+		else                       mesh->vert_buffer->Release();
 		mesh->vert_dynamic = true;
+		render_stats_realloc();
 
 		D3D11_SUBRESOURCE_DATA vert_buff_data = { vertices };
 		CD3D11_BUFFER_DESC     vert_buff_desc(sizeof(vert_t) * vertex_count, 
@@ -48,6 +68,7 @@ void mesh_set_verts(mesh_t mesh, vert_t *vertices, int32_t vertex_count, bool32_
 		memcpy(resource.pData, vertices, sizeof(vert_t) * vertex_count);
 		d3d_context->Unmap(mesh->vert_buffer, 0);
 	}
+	render_stats_upload(render_upload_mesh, sizeof(vert_t) * vertex_count);
 
 	mesh->vert_count = vertex_count;
 
@@ -70,24 +91,37 @@ void mesh_set_verts(mesh_t mesh, vert_t *vertices, int32_t vertex_count, bool32_
 
 ///////////////////////////////////////////
 
-void mesh_set_inds (mesh_t mesh, vind_t *indices,  int32_t index_count) {
+void mesh_set_inds_internal(mesh_t mesh, const void *indices, int32_t index_count, bool32_t wide) {
+	if (mesh->ind_buffer != nullptr)
+		render_pipeline_sync();
+	if (mesh->gen_source != nullptr)
+		mesh_gen_detach(mesh);
+
+	uint32_t stride = wide ? sizeof(uint32_t) : sizeof(uint16_t);
 	if (mesh->ind_buffer == nullptr) {
-		// Create a static vertex buffer the first time we call this function!
+		// Static the first time we call this function, same as the verts
 		mesh->ind_dynamic = false;
-
-		D3D11_SUBRESOURCE_DATA ind_buff_data = { indices };
-		CD3D11_BUFFER_DESC     ind_buff_desc(sizeof(vind_t) * index_count, D3D11_BIND_INDEX_BUFFER);
-		if (FAILED(d3d_device->CreateBuffer(&ind_buff_desc, &ind_buff_data, &mesh->ind_buffer)))
-			log_err("mesh_set_inds: Failed to create index buffer");
-		DX11ResType(mesh->ind_buffer,  "inds");
-	} else if (mesh->ind_dynamic == false || index_count > mesh->ind_count) {
+		mesh->ind_wide    = wide;
+
+		if (mesh->generated || !mesh_arena_place(mesh, wide ? mesh_arena_inds32 : mesh_arena_inds16, indices, index_count)) {
+			D3D11_SUBRESOURCE_DATA ind_buff_data = { indices };
+			CD3D11_BUFFER_DESC     ind_buff_desc(stride * index_count, D3D11_BIND_INDEX_BUFFER);
+			if (FAILED(d3d_device->CreateBuffer(&ind_buff_desc, &ind_buff_data, &mesh->ind_buffer)))
+				log_err("mesh_set_inds: Failed to create index buffer");
+			DX11ResType(mesh->ind_buffer,  "inds");
+		}
+	} else if (mesh->ind_dynamic == false || index_count > mesh->ind_count || wide != mesh->ind_wide) {
 		// If they call this a second time, or they need more inds than will
-		// fit in this buffer, lets make a new dynamic buffer!
-		mesh->ind_buffer->Release();
+		// fit in this buffer, lets make a new dynamic buffer! Same if the
+		// indices changed width.
+		if (mesh->ind_arena != 0) mesh_arena_remove(mesh, mesh->ind_wide ? mesh_arena_inds32 : mesh_arena_inds16);
+		else                      mesh->ind_buffer->Release();
 		mesh->ind_dynamic = true;
+		mesh->ind_wide    = wide;
+		render_stats_realloc();
 
 		D3D11_SUBRESOURCE_DATA ind_buff_data = { indices };
-		CD3D11_BUFFER_DESC     ind_buff_desc(sizeof(vind_t) * index_count, 
+		CD3D11_BUFFER_DESC     ind_buff_desc(stride * index_count, 
 			D3D11_BIND_INDEX_BUFFER,
 			D3D11_USAGE_DYNAMIC,
 			D3D11_CPU_ACCESS_WRITE);
@@ -99,9 +133,10 @@ void mesh_set_inds (mesh_t mesh, vind_t *indices,  int32_t index_count) {
 		// buffer, just copy things over!
 		D3D11_MAPPED_SUBRESOURCE resource;
 		d3d_context->Map(mesh->ind_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource);
-		memcpy(resource.pData, indices, sizeof(vind_t) * index_count);
+		memcpy(resource.pData, indices, stride * index_count);
 		d3d_context->Unmap(mesh->ind_buffer, 0);
 	}
+	render_stats_upload(render_upload_mesh, stride * index_count);
 
 	mesh->ind_count = index_count;
 	mesh->ind_draw  = index_count;
@@ -109,6 +144,39 @@ void mesh_set_inds (mesh_t mesh, vind_t *indices,  int32_t index_count) {
 
 ///////////////////////////////////////////
 
+void mesh_set_inds16(mesh_t mesh, const uint16_t *indices, int32_t index_count) {
+	mesh_set_inds_internal(mesh, indices, index_count, false);
+}
+
+///////////////////////////////////////////
+
+void mesh_set_inds32(mesh_t mesh, const uint32_t *indices, int32_t index_count) {
+	// Most meshes are small enough for 16 bit indices, which is half the
+	// memory and bandwidth, so only stay at 32 bit when it's needed.
+	uint32_t max_ind = 0;
+	for (int32_t i = 0; i < index_count; i++)
+		max_ind = indices[i] > max_ind ? indices[i] : max_ind;
+	if (max_ind > 0xFFFF) {
+		mesh_set_inds_internal(mesh, indices, index_count, true);
+		return;
+	}
+
+	uint16_t *packed = (uint16_t *)malloc(sizeof(uint16_t) * index_count);
+	for (int32_t i = 0; i < index_count; i++)
+		packed[i] = (uint16_t)indices[i];
+	mesh_set_inds_internal(mesh, packed, index_count, false);
+	free(packed);
+}
+
+///////////////////////////////////////////
+
+void mesh_set_inds(mesh_t mesh, vind_t *indices, int32_t index_count) {
+	if (sizeof(vind_t) == sizeof(uint32_t)) mesh_set_inds32(mesh, (uint32_t *)indices, index_count);
+	else                                    mesh_set_inds16(mesh, (uint16_t *)indices, index_count);
+}
+
+///////////////////////////////////////////
+
 void mesh_set_draw_inds(mesh_t mesh, int32_t index_count) {
 	if (index_count > mesh->ind_count) {
 		index_count = mesh->ind_count;
@@ -132,22 +200,20 @@ bounds_t mesh_get_bounds(mesh_t mesh) {
 ///////////////////////////////////////////
 
 mesh_t mesh_find(const char *id) {
-	mesh_t result = (mesh_t)assets_find(id, asset_type_mesh);
-	if (result != nullptr) {
-		assets_addref(result->header);
-		return result;
-	}
-	return nullptr;
+	return (mesh_t)assets_find_ref(id, asset_type_mesh);
 }
 
 ///////////////////////////////////////////
 
 void mesh_set_id(mesh_t mesh, const char *id) {
 	assets_set_id(mesh->header, id);
+	// A cached mesh that's renamed can't be found by mesh_gen anymore
+	mesh->generated = false;
 
-	if (mesh->ind_buffer)
+	// Arena buffers are shared, so they keep their own names
+	if (mesh->ind_buffer && mesh->ind_arena == 0)
 		DX11ResName(mesh->ind_buffer, "mesh_inds", id);
-	if (mesh->vert_buffer)
+	if (mesh->vert_buffer && mesh->vert_arena == 0)
 		DX11ResName(mesh->vert_buffer, "mesh_verts", id);
 }
 
@@ -169,8 +235,11 @@ void mesh_release(mesh_t mesh) {
 ///////////////////////////////////////////
 
 void mesh_destroy(mesh_t mesh) {
-	if (mesh->ind_buffer  != nullptr) mesh->ind_buffer ->Release();
-	if (mesh->vert_buffer != nullptr) mesh->vert_buffer->Release();
+	if      (mesh->ind_arena   != 0)       mesh_arena_remove(mesh, mesh->ind_wide ? mesh_arena_inds32 : mesh_arena_inds16);
+	else if (mesh->ind_buffer  != nullptr) mesh->ind_buffer ->Release();
+	if      (mesh->vert_arena  != 0)       mesh_arena_remove(mesh, mesh_arena_verts);
+	else if (mesh->vert_buffer != nullptr) mesh->vert_buffer->Release();
+	mesh_release(mesh->gen_source);
 	*mesh = {};
 }
 
@@ -195,208 +264,302 @@ void mesh_gen_cube_vert(int i, const vec3 &size, vec3 &pos, vec3 &norm, vec2 &uv
 
 ///////////////////////////////////////////
 
-mesh_t mesh_gen_plane(vec2 dimensions, vec3 plane_normal, vec3 plane_top_direction, int32_t subdivisions) {
-	vind_t subd   = (vind_t)subdivisions;
+// The corners of a unit cube's faces only need working out once, rather
+// than for every mesh that's built from them.
+struct mesh_gen_faces_t {
+	vec3 corner[6][4];
+	vec2 uv    [6][4];
+	vec3 normal[6];
+};
+
+mesh_gen_faces_t mesh_gen_faces_build() {
+	mesh_gen_faces_t result;
+	for (int32_t f = 0; f < 6; f++) {
+		for (int32_t c = 0; c < 4; c++)
+			mesh_gen_cube_vert(f*4 + c, vec3_one, result.corner[f][c], result.normal[f], result.uv[f][c]);
+	}
+	return result;
+}
+const mesh_gen_faces_t mesh_gen_faces = mesh_gen_faces_build();
+
+// Building a mesh this big on one thread takes longer than waking up the
+// job pool does.
+const int32_t mesh_gen_job_verts = 16 * 1024;
+
+struct mesh_gen_ctx_t {
+	vert_t *verts;
+	vind_t *inds;
+	vind_t  subd;
+	float  *t;      // Lerp amount for each step across a face
+	vec3    size;
+	float   radius;
+	vec3    offset;
+};
+
+///////////////////////////////////////////
+
+// Generated meshes are cached, and shared between everyone who asks for the
+// same generator with the same parameters. The cached mesh is named after a
+// hash of those parameters, so finding one is just an asset lookup. Callers
+// never get the cached mesh itself, just a new mesh with the same buffers,
+// so editing one can't change anyone else's.
+mesh_t mesh_gen_share(mesh_t source) {
 	mesh_t result = mesh_create();
+	result->gen_source  = source;
+	result->vert_count  = source->vert_count;
+	result->vert_buffer = source->vert_buffer;
+	result->ind_count   = source->ind_count;
+	result->ind_wide    = source->ind_wide;
+	result->ind_buffer  = source->ind_buffer;
+	result->ind_draw    = source->ind_draw;
+	result->bounds      = source->bounds;
+	if (result->vert_buffer) result->vert_buffer->AddRef();
+	if (result->ind_buffer ) result->ind_buffer ->AddRef();
+	return result;
+}
 
-	subd = max(0,subd) + 2;
+///////////////////////////////////////////
 
-	int vert_count = subd*subd;
-	int ind_count  = 6*(subd-1)*(subd-1);
-	vert_t *verts = (vert_t *)malloc(vert_count * sizeof(vert_t));
-	vind_t *inds  = (vind_t *)malloc(ind_count  * sizeof(vind_t));
+mesh_t mesh_gen_find(const char *generator, const void *params, size_t params_size, char *out_id, size_t out_id_size) {
+	uint64_t       hash  = string_hash(generator);
+	const uint8_t *bytes = (const uint8_t *)params;
+	for (size_t i = 0; i < params_size; i++)
+		hash = (hash ^ bytes[i]) * 1099511628211ULL;
+	sprintf_s(out_id, out_id_size, "sk/gen/%s/%016llx", generator, (unsigned long long)hash);
+
+	// The new mesh takes over the reference from finding this
+	mesh_t source = mesh_find(out_id);
+	return source == nullptr
+		? nullptr
+		: mesh_gen_share(source);
+}
 
-	vec3 right = vec3_cross(plane_normal, plane_top_direction);
-	vec3 up    = vec3_cross(plane_normal, right);
-	vec2 size  = dimensions / 2;
+///////////////////////////////////////////
 
-	// Make vertices
-	for (vind_t y = 0; y < subd; y++) {
-		float yp = y / (float)(subd-1);
-	for (vind_t x = 0; x < subd; x++) {
-		float xp = x / (float)(subd-1);
-
-		verts[x + y*subd] = vert_t{ 
-			right * ((xp - 0.5f) * dimensions.x) +
-			up    * ((yp - 0.5f) * dimensions.y), 
-			plane_normal, {xp,yp}, {255,255,255,255} };
-	} }
-
-	// make indices
-	int ind = 0;
-	for (vind_t y = 0; y < subd-1; y++) {
-	for (vind_t x = 0; x < subd-1; x++) {
-			inds[ind++] =  x    +  y    * subd;
-			inds[ind++] = (x+1) +  y    * subd;
-			inds[ind++] = (x+1) + (y+1) * subd;
-
-			inds[ind++] =  x    +  y    * subd;
-			inds[ind++] = (x+1) + (y+1) * subd;
-			inds[ind++] =  x    + (y+1) * subd;
-	} }
-
-	mesh_set_verts(result, verts, vert_count);
-	mesh_set_inds (result, inds,  ind_count);
+mesh_t mesh_gen_finish(const char *id, vert_t *verts, int32_t vert_count, vind_t *inds, int32_t ind_count) {
+	mesh_t source = mesh_create();
+	mesh_set_id   (source, id);
+	source->generated = true;
+	mesh_set_verts(source, verts, vert_count);
+	mesh_set_inds (source, inds,  ind_count);
 
 	free(verts);
 	free(inds);
-
-	DX11ResType(result->ind_buffer,  "inds_gen_plane" );
-	DX11ResType(result->vert_buffer, "verts_gen_plane");
-	return result;
+	return mesh_gen_share(source);
 }
 
 ///////////////////////////////////////////
 
-mesh_t mesh_gen_cube(vec3 dimensions, int32_t subdivisions) {
-	vind_t subd   = (vind_t)subdivisions;
-	mesh_t result = mesh_create();
+// Called before an edit. The buffer being edited gets replaced rather than
+// written to, so there's no copy to make, just the cache to let go of.
+void mesh_gen_detach(mesh_t mesh) {
+	mesh_release(mesh->gen_source);
+	mesh->gen_source = nullptr;
+}
 
-	subd = max(0,subd) + 2;
+///////////////////////////////////////////
 
-	int vert_count = 6*subd*subd;
-	int ind_count  = 6*(subd-1)*(subd-1)*6;
-	vert_t *verts = (vert_t *)malloc(vert_count * sizeof(vert_t));
-	vind_t *inds  = (vind_t *)malloc(ind_count  * sizeof(vind_t));
+void mesh_gen_run(int32_t count, int32_t vert_count, void (*job)(int32_t index, void *context), void *context) {
+	if (vert_count >= mesh_gen_job_verts) {
+		job_pool_for(count, job, context);
+	} else {
+		for (int32_t i = 0; i < count; i++)
+			job(i, context);
+	}
+}
 
-	vec3   size   = dimensions / 2;
-	int    ind    = 0;
-	vind_t offset = 0;
-	for (vind_t i = 0; i < 6*4; i+=4) {
-		vec3 p1, p2, p3, p4;
-		vec3 n1, n2, n3, n4;
-		vec2 u1, u2, u3, u4;
-
-		mesh_gen_cube_vert(i,   size, p1, n1, u1);
-		mesh_gen_cube_vert(i+1, size, p2, n2, u2);
-		mesh_gen_cube_vert(i+2, size, p3, n3, u3);
-		mesh_gen_cube_vert(i+3, size, p4, n4, u4);
-
-		offset = (i/4) * (subd)*(subd);
-		for (vind_t y = 0; y < subd; y++) {
-			float  py    = y / (float)(subd-1);
-			vind_t yOff  = offset + y * subd;
-			vind_t yOffN = offset + (y+1) * subd;
-
-			vec3 pl = vec3_lerp(p1, p4, py);
-			vec3 pr = vec3_lerp(p2, p3, py);
-			vec3 nl = vec3_lerp(n1, n4, py);
-			vec3 nr = vec3_lerp(n2, n3, py);
-			vec2 ul = vec2_lerp(u1, u4, py);
-			vec2 ur = vec2_lerp(u2, u3, py);
-
-			for (vind_t x = 0; x < subd; x++) {
-				float px = x / (float)(subd-1);
-				vind_t  ptIndex = x + yOff;
-				vert_t *pt      = &verts[ptIndex];
-
-				pt->pos = vec3_lerp(pl, pr, px);
-				pt->norm= vec3_lerp(nl, nr, px);
-				pt->uv  = vec2_lerp(ul, ur, px);
-				pt->col = {255,255,255,255};
-
-				if (y != subd-1 && x != subd-1) {
-
-					inds[ind++] = (x  ) + yOff;
-					inds[ind++] = (x+1) + yOff;
-					inds[ind++] = (x+1) + yOffN;
-
-					inds[ind++] = (x  ) + yOff;
-					inds[ind++] = (x+1) + yOffN;
-					inds[ind++] = (x  ) + yOffN;
-				}
-			}
+///////////////////////////////////////////
+
+// Two triangles for each cell in a width x height grid of verts.
+void mesh_gen_grid_inds(vind_t *inds, vind_t offset, vind_t width, vind_t height) {
+	for (vind_t y = 0; y < height-1; y++) {
+		vind_t row  = offset +  y    * width;
+		vind_t next = offset + (y+1) * width;
+		for (vind_t x = 0; x < width-1; x++) {
+			*inds++ = (x  ) + row;
+			*inds++ = (x+1) + row;
+			*inds++ = (x+1) + next;
+
+			*inds++ = (x  ) + row;
+			*inds++ = (x+1) + next;
+			*inds++ = (x  ) + next;
 		}
 	}
+}
 
-	mesh_set_verts(result, verts, vert_count);
-	mesh_set_inds (result, inds,  ind_count);
-
-	free(verts);
-	free(inds);
+///////////////////////////////////////////
 
-	DX11ResType(result->ind_buffer,  "inds_gen_cube" );
-	DX11ResType(result->vert_buffer, "verts_gen_cube");
+float *mesh_gen_steps(vind_t count) {
+	float *result = (float *)malloc(count * sizeof(float));
+	for (vind_t i = 0; i < count; i++)
+		result[i] = i / (float)(count-1);
 	return result;
 }
 
 ///////////////////////////////////////////
 
-mesh_t mesh_gen_sphere(float diameter, int32_t subdivisions) {
-	vind_t subd   = (vind_t)subdivisions;
-	mesh_t result = mesh_create();
+struct mesh_gen_plane_t {
+	mesh_gen_ctx_t ctx;
+	vec3 right;
+	vec3 up;
+	vec3 normal;
+	vec2 dimensions;
+};
+
+void mesh_gen_plane_row(int32_t y, void *context) {
+	mesh_gen_plane_t &plane = *(mesh_gen_plane_t *)context;
+	vind_t  subd  = plane.ctx.subd;
+	vert_t *verts = &plane.ctx.verts[y * subd];
+	float   yp    = plane.ctx.t[y];
+	vec3    row   = plane.up * ((yp - 0.5f) * plane.dimensions.y);
 
-	subd = max(0,subd) + 2;
+	for (vind_t x = 0; x < subd; x++) {
+		float xp = plane.ctx.t[x];
+		verts[x] = vert_t{ 
+			plane.right * ((xp - 0.5f) * plane.dimensions.x) + row,
+			plane.normal, {xp,yp}, {255,255,255,255} };
+	}
+	if (y < (int32_t)subd-1)
+		mesh_gen_grid_inds(&plane.ctx.inds[y * (subd-1) * 6], y * subd, subd, 2);
+}
 
-	int vert_count = 6*subd*subd;
-	int ind_count  = 6*(subd-1)*(subd-1)*6;
-	vert_t *verts = (vert_t *)malloc(vert_count * sizeof(vert_t));
-	vind_t *inds  = (vind_t *)malloc(ind_count  * sizeof(vind_t));
+///////////////////////////////////////////
 
-	vec3   size = vec3_one;
-	float  radius = diameter / 2;
-	int    ind    = 0;
-	vind_t offset = 0;
-	for (vind_t i = 0; i < 6*4; i+=4) {
-		vec3 p1, p2, p3, p4;
-		vec3 n1, n2, n3, n4;
-		vec2 u1, u2, u3, u4;
-
-		mesh_gen_cube_vert(i,   size, p1, n1, u1);
-		mesh_gen_cube_vert(i+1, size, p2, n2, u2);
-		mesh_gen_cube_vert(i+2, size, p3, n3, u3);
-		mesh_gen_cube_vert(i+3, size, p4, n4, u4);
-
-		offset = (i/4) * (subd)*(subd);
-		for (vind_t y = 0; y < subd; y++) {
-			float  py    = y / (float)(subd-1);
-			vind_t yOff  = offset + y * subd;
-			vind_t yOffN = offset + (y+1) * subd;
-
-			vec3 pl = vec3_lerp(p1, p4, py);
-			vec3 pr = vec3_lerp(p2, p3, py);
-			vec2 ul = vec2_lerp(u1, u4, py);
-			vec2 ur = vec2_lerp(u2, u3, py);
-
-			for (vind_t x = 0; x < subd; x++) {
-				float px = x / (float)(subd-1);
-				vind_t  ptIndex = x + yOff;
-				vert_t *pt = &verts[ptIndex];
-
-				pt->norm= vec3_normalize(vec3_lerp(pl, pr, px));
-				pt->pos = pt->norm*radius;
-				pt->uv  = vec2_lerp(ul, ur, px);
-				pt->col = {255,255,255,255};
-
-				if (y != subd-1 && x != subd-1) {
-
-					inds[ind++] = (x  ) + yOff;
-					inds[ind++] = (x+1) + yOff;
-					inds[ind++] = (x+1) + yOffN;
-
-					inds[ind++] = (x  ) + yOff;
-					inds[ind++] = (x+1) + yOffN;
-					inds[ind++] = (x  ) + yOffN;
-				}
-			}
+mesh_t mesh_gen_plane(vec2 dimensions, vec3 plane_normal, vec3 plane_top_direction, int32_t subdivisions) {
+	struct { vec2 dimensions; vec3 normal; vec3 top; int32_t subdivisions; } params = { dimensions, plane_normal, plane_top_direction, subdivisions };
+	char   id[64];
+	mesh_t result = mesh_gen_find("plane", &params, sizeof(params), id, sizeof(id));
+	if (result != nullptr)
+		return result;
+
+	vind_t subd       = (vind_t)(max(0,subdivisions) + 2);
+	int    vert_count = subd*subd;
+	int    ind_count  = 6*(subd-1)*(subd-1);
+
+	mesh_gen_plane_t plane = {};
+	plane.ctx.subd   = subd;
+	plane.ctx.verts  = (vert_t *)malloc(vert_count * sizeof(vert_t));
+	plane.ctx.inds   = (vind_t *)malloc(ind_count  * sizeof(vind_t));
+	plane.ctx.t      = mesh_gen_steps(subd);
+	plane.right      = vec3_cross(plane_normal, plane_top_direction);
+	plane.up         = vec3_cross(plane_normal, plane.right);
+	plane.normal     = plane_normal;
+	plane.dimensions = dimensions;
+	mesh_gen_run(subd, vert_count, mesh_gen_plane_row, &plane);
+
+	free(plane.ctx.t);
+	return mesh_gen_finish(id, plane.ctx.verts, vert_count, plane.ctx.inds, ind_count);
+}
+
+///////////////////////////////////////////
+
+void mesh_gen_cube_face(int32_t f, void *context) {
+	mesh_gen_ctx_t &ctx  = *(mesh_gen_ctx_t *)context;
+	vind_t          subd = ctx.subd;
+	vert_t         *pt   = &ctx.verts[f * subd * subd];
+	vec3            norm = mesh_gen_faces.normal[f];
+	const vec3     *p    = mesh_gen_faces.corner[f];
+	const vec2     *u    = mesh_gen_faces.uv    [f];
+
+	for (vind_t y = 0; y < subd; y++) {
+		float py = ctx.t[y];
+		vec3  pl = vec3_lerp(p[0], p[3], py) * ctx.size;
+		vec3  pr = vec3_lerp(p[1], p[2], py) * ctx.size;
+		vec2  ul = vec2_lerp(u[0], u[3], py);
+		vec2  ur = vec2_lerp(u[1], u[2], py);
+
+		for (vind_t x = 0; x < subd; x++, pt++) {
+			float px = ctx.t[x];
+			*pt = vert_t{ vec3_lerp(pl, pr, px), norm, vec2_lerp(ul, ur, px), {255,255,255,255} };
 		}
 	}
+	mesh_gen_grid_inds(&ctx.inds[f * (subd-1) * (subd-1) * 6], f * subd * subd, subd, subd);
+}
 
-	mesh_set_verts(result, verts, vert_count);
-	mesh_set_inds (result, inds,  ind_count);
+///////////////////////////////////////////
 
-	free(verts);
-	free(inds);
+mesh_t mesh_gen_cube(vec3 dimensions, int32_t subdivisions) {
+	struct { vec3 dimensions; int32_t subdivisions; } params = { dimensions, subdivisions };
+	char   id[64];
+	mesh_t result = mesh_gen_find("cube", &params, sizeof(params), id, sizeof(id));
+	if (result != nullptr)
+		return result;
 
-	DX11ResType(result->ind_buffer,  "inds_gen_sphere" );
-	DX11ResType(result->vert_buffer, "verts_gen_sphere");
-	return result;
+	vind_t subd       = (vind_t)(max(0,subdivisions) + 2);
+	int    vert_count = 6*subd*subd;
+	int    ind_count  = 6*(subd-1)*(subd-1)*6;
+
+	mesh_gen_ctx_t ctx = {};
+	ctx.subd  = subd;
+	ctx.verts = (vert_t *)malloc(vert_count * sizeof(vert_t));
+	ctx.inds  = (vind_t *)malloc(ind_count  * sizeof(vind_t));
+	ctx.t     = mesh_gen_steps(subd);
+	ctx.size  = dimensions / 2;
+	mesh_gen_run(6, vert_count, mesh_gen_cube_face, &ctx);
+
+	free(ctx.t);
+	return mesh_gen_finish(id, ctx.verts, vert_count, ctx.inds, ind_count);
+}
+
+///////////////////////////////////////////
+
+void mesh_gen_sphere_face(int32_t f, void *context) {
+	mesh_gen_ctx_t &ctx  = *(mesh_gen_ctx_t *)context;
+	vind_t          subd = ctx.subd;
+	vert_t         *pt   = &ctx.verts[f * subd * subd];
+	const vec3     *p    = mesh_gen_faces.corner[f];
+	const vec2     *u    = mesh_gen_faces.uv    [f];
+
+	for (vind_t y = 0; y < subd; y++) {
+		float py = ctx.t[y];
+		vec3  pl = vec3_lerp(p[0], p[3], py);
+		vec3  pr = vec3_lerp(p[1], p[2], py);
+		vec2  ul = vec2_lerp(u[0], u[3], py);
+		vec2  ur = vec2_lerp(u[1], u[2], py);
+
+		for (vind_t x = 0; x < subd; x++, pt++) {
+			float px   = ctx.t[x];
+			vec3  norm = vec3_normalize(vec3_lerp(pl, pr, px));
+			*pt = vert_t{ norm*ctx.radius, norm, vec2_lerp(ul, ur, px), {255,255,255,255} };
+		}
+	}
+	mesh_gen_grid_inds(&ctx.inds[f * (subd-1) * (subd-1) * 6], f * subd * subd, subd, subd);
+}
+
+///////////////////////////////////////////
+
+mesh_t mesh_gen_sphere(float diameter, int32_t subdivisions) {
+	struct { float diameter; int32_t subdivisions; } params = { diameter, subdivisions };
+	char   id[64];
+	mesh_t result = mesh_gen_find("sphere", &params, sizeof(params), id, sizeof(id));
+	if (result != nullptr)
+		return result;
+
+	vind_t subd       = (vind_t)(max(0,subdivisions) + 2);
+	int    vert_count = 6*subd*subd;
+	int    ind_count  = 6*(subd-1)*(subd-1)*6;
+
+	mesh_gen_ctx_t ctx = {};
+	ctx.subd   = subd;
+	ctx.verts  = (vert_t *)malloc(vert_count * sizeof(vert_t));
+	ctx.inds   = (vind_t *)malloc(ind_count  * sizeof(vind_t));
+	ctx.t      = mesh_gen_steps(subd);
+	ctx.radius = diameter / 2;
+	mesh_gen_run(6, vert_count, mesh_gen_sphere_face, &ctx);
+
+	free(ctx.t);
+	return mesh_gen_finish(id, ctx.verts, vert_count, ctx.inds, ind_count);
 }
 
 ///////////////////////////////////////////
 
 mesh_t mesh_gen_cylinder(float diameter, float depth, vec3 dir, int32_t subdivisions) {
-	mesh_t result = mesh_create();
+	struct { float diameter; float depth; vec3 dir; int32_t subdivisions; } params = { diameter, depth, dir, subdivisions };
+	char   id[64];
+	mesh_t result = mesh_gen_find("cylinder", &params, sizeof(params), id, sizeof(id));
+	if (result != nullptr)
+		return result;
+
 	dir = vec3_normalize(dir);
 	float radius = diameter / 2;
 
@@ -448,109 +611,84 @@ mesh_t mesh_gen_cylinder(float diameter, float depth, vec3 dir, int32_t subdivis
 	verts[subdivisions*4]   = {  dir*radius,  dir, {.5f,.5f}, {255,255,255,255} };
 	verts[subdivisions*4+1] = { -dir*radius, -dir, {.5f,.5f}, {255,255,255,255} };
 
-	mesh_set_verts(result, verts, vert_count);
-	mesh_set_inds (result, inds,  ind_count);
+	return mesh_gen_finish(id, verts, vert_count, inds, ind_count);
+}
 
-	free(verts);
-	free(inds);
+///////////////////////////////////////////
 
-	DX11ResType(result->ind_buffer,  "inds_gen_cylinder" );
-	DX11ResType(result->vert_buffer, "verts_gen_cylinder");
-	return result;
+void mesh_gen_rounded_cube_face(int32_t f, void *context) {
+	mesh_gen_ctx_t &ctx    = *(mesh_gen_ctx_t *)context;
+	vind_t          subd   = ctx.subd;
+	vert_t         *pt     = &ctx.verts[f * subd * subd];
+	const vec3     *p      = mesh_gen_faces.corner[f];
+	const vec2     *u      = mesh_gen_faces.uv    [f];
+	float           radius = ctx.radius;
+
+	// ctx.size is the full dimensions here, the face's size in U and V
+	// decides how far the rounded edges stretch its UVs.
+	float sizeU = vec3_magnitude((p[3] - p[0]) * (ctx.size/2));
+	float sizeV = vec3_magnitude((p[1] - p[0]) * (ctx.size/2));
+	float stretchU = (radius*2)/sizeU;
+	float stretchV = (radius*2)/sizeV;
+
+	for (vind_t sy = 0; sy < subd; sy++) {
+		bool  first_half_y = sy < subd / 2;
+		vind_t y           = first_half_y ? sy : sy-1;
+		vec3  stretchA     = first_half_y ? p[0] : p[3];
+		vec3  stretchB     = first_half_y ? p[1] : p[2];
+		float offV         = first_half_y ? 0 : sizeV-(radius*2);
+
+		float py = ctx.t[y];
+		float pv = py * stretchV + offV;
+		vec3  pl = vec3_lerp(p[0], p[3], py);
+		vec3  pr = vec3_lerp(p[1], p[2], py);
+		vec2  ul = vec2_lerp(u[0], u[3], pv);
+		vec2  ur = vec2_lerp(u[1], u[2], pv);
+		vec3  offA = stretchA*ctx.offset;
+		vec3  offB = stretchB*ctx.offset;
+
+		for (vind_t sx = 0; sx < subd; sx++, pt++) {
+			bool   first_half_x = sx < subd / 2;
+			vind_t x            = first_half_x ? sx : sx-1;
+			float  offU         = first_half_x ? 0 : sizeU-(radius*2);
+
+			float px   = ctx.t[x];
+			float pu   = px * stretchU + offU;
+			vec3  norm = vec3_normalize(vec3_lerp(pl, pr, px));
+			*pt = vert_t{ norm*radius + (first_half_x ? offA : offB), norm, vec2_lerp(ul, ur, pu), {255,255,255,255} };
+		}
+	}
+	mesh_gen_grid_inds(&ctx.inds[f * (subd-1) * (subd-1) * 6], f * subd * subd, subd, subd);
 }
 
 ///////////////////////////////////////////
 
 mesh_t mesh_gen_rounded_cube(vec3 dimensions, float edge_radius, int32_t subdivisions) {
-	vind_t subd   = (vind_t)subdivisions;
-	mesh_t result = mesh_create();
+	struct { vec3 dimensions; float edge_radius; int32_t subdivisions; } params = { dimensions, edge_radius, subdivisions };
+	char   id[64];
+	mesh_t result = mesh_gen_find("rounded_cube", &params, sizeof(params), id, sizeof(id));
+	if (result != nullptr)
+		return result;
 
-	subd = max(0,subd) + 2;
+	vind_t subd = (vind_t)(max(0,subdivisions) + 2);
 	if (subd % 2 == 1) // need an even number of subdivisions
 		subd += 1;
 
-	vind_t  vert_count = 6*subd*subd;
-	vind_t  ind_count  = 6*(subd-1)*(subd-1)*6;
-	vert_t *verts = (vert_t *)malloc(vert_count * sizeof(vert_t));
-	vind_t *inds  = (vind_t *)malloc(ind_count  * sizeof(vind_t));
-
-	vec3   off = (dimensions / 2) - vec3_one*edge_radius;
-	vec3   size = vec3_one;
-	float  radius = edge_radius;
-	vind_t ind    = 0;
-	vind_t offset = 0;
-	for (vind_t i = 0; i < 6*4; i+=4) {
-		vec3 p1, p2, p3, p4;
-		vec3 n1, n2, n3, n4;
-		vec2 u1, u2, u3, u4;
-
-		mesh_gen_cube_vert(i,   size, p1, n1, u1);
-		mesh_gen_cube_vert(i+1, size, p2, n2, u2);
-		mesh_gen_cube_vert(i+2, size, p3, n3, u3);
-		mesh_gen_cube_vert(i+3, size, p4, n4, u4);
-
-		float sizeU = vec3_magnitude((p4 - p1) * (dimensions/2));
-		float sizeV = vec3_magnitude((p2 - p1) * (dimensions/2));
-
-		offset = (i/4) * (subd)*(subd);
-		vind_t x, y;
-		for (vind_t sy = 0; sy < subd; sy++) {
-			bool first_half_y = sy < subd / 2;
-			y = first_half_y ? sy : sy-1;
-			vec3 stretchA  = first_half_y ? p1 : p4;
-			vec3 stretchB  = first_half_y ? p2 : p3;
-			float stretchV = (radius*2)/sizeV;
-			float offV     = first_half_y ? 0 : sizeV-(radius*2);
-			
-			float py    = y / (float)(subd-2);
-			float pv    = py * stretchV + offV;
-			vind_t yOff  = offset + sy * subd;
-			vind_t yOffN = offset + (sy+1) * subd;
-			
-			vec3 pl = vec3_lerp(p1, p4, py);
-			vec3 pr = vec3_lerp(p2, p3, py);
-			vec2 ul = vec2_lerp(u1, u4, pv);
-			vec2 ur = vec2_lerp(u2, u3, pv);
-
-			for (vind_t sx = 0; sx < subd; sx++) {
-				bool first_half_x = sx < subd / 2;
-				x = first_half_x ? sx : sx-1;
-				vec3  stretch = first_half_x ? stretchA : stretchB;
-				float stretchU = (radius*2)/sizeU;
-				float offU     = first_half_x ? 0 : sizeU-(radius*2);
-
-				float px      = x / (float)(subd-2);
-				float pu      = px * stretchU + offU;
-				int   ptIndex = sx + yOff;
-				vert_t *pt    = &verts[ptIndex];
-
-				pt->norm= vec3_normalize(vec3_lerp(pl, pr, px));
-				pt->pos = pt->norm*radius + stretch*off;
-				pt->uv = vec2_lerp(ul, ur, pu);
-				pt->col = {255,255,255,255};
-
-				if (sy != subd-1 && sx != subd-1) {
-					inds[ind++] = (sx  ) + yOff;
-					inds[ind++] = (sx+1) + yOff;
-					inds[ind++] = (sx+1) + yOffN;
-
-					inds[ind++] = (sx  ) + yOff;
-					inds[ind++] = (sx+1) + yOffN;
-					inds[ind++] = (sx  ) + yOffN;
-				}
-			}
-		}
-	}
-
-	mesh_set_verts(result, verts, vert_count);
-	mesh_set_inds (result, inds,  ind_count);
-
-	free(verts);
-	free(inds);
+	int vert_count = 6*subd*subd;
+	int ind_count  = 6*(subd-1)*(subd-1)*6;
 
-	DX11ResType(result->ind_buffer,  "inds_gen_rndcube" );
-	DX11ResType(result->vert_buffer, "verts_gen_rndcube");
-	return result;
+	mesh_gen_ctx_t ctx = {};
+	ctx.subd   = subd;
+	ctx.verts  = (vert_t *)malloc(vert_count * sizeof(vert_t));
+	ctx.inds   = (vind_t *)malloc(ind_count  * sizeof(vind_t));
+	ctx.t      = mesh_gen_steps(subd-1); // The middle row and column are doubled up
+	ctx.size   = dimensions;
+	ctx.radius = edge_radius;
+	ctx.offset = (dimensions / 2) - vec3_one*edge_radius;
+	mesh_gen_run(6, vert_count, mesh_gen_rounded_cube_face, &ctx);
+
+	free(ctx.t);
+	return mesh_gen_finish(id, ctx.verts, vert_count, ctx.inds, ind_count);
 }
 
-} // namespace sk
\ No newline at end of file
+} // namespace sk
@@ -5,6 +5,7 @@
 
 #include "../stereokit.h"
 #include "assets.h"
+#include "../offset_allocator.h"
 
 namespace sk {
 
@@ -15,9 +16,27 @@ struct _mesh_t {
 	ID3D11Buffer  *vert_buffer;
 	int            ind_count;
 	bool32_t       ind_dynamic;
+	bool32_t       ind_wide; // 32 bit indices, only when 16 won't fit
 	ID3D11Buffer  *ind_buffer;
 	int            ind_draw;
 	bounds_t       bounds;
+
+	// Static meshes share big arena buffers instead of having their own,
+	// see mesh_arena.h. The arena is 0 for meshes that own their buffers.
+	int32_t        vert_arena;
+	uint32_t       vert_start;
+	offset_alloc_t vert_alloc;
+	int32_t        ind_arena;
+	uint32_t       ind_start;
+	offset_alloc_t ind_alloc;
+
+	// The mesh_gen functions cache what they build, and every caller gets a
+	// mesh of their own that holds references to the cached mesh's buffers.
+	// Those buffers are static, so they're never written to, only replaced,
+	// and the first edit replaces them for that caller alone. gen_source
+	// keeps the cached mesh findable until then.
+	mesh_t         gen_source;
+	bool32_t       generated; // The cached mesh, its buffers can't go in an arena
 };
 
 void mesh_destroy(mesh_t mesh);
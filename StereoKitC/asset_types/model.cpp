@@ -5,6 +5,9 @@
 #include "mesh.h"
 #include "material.h"
 #include "texture.h"
+#include "../mesh_simplify.h"
+#include "../systems/vfs.h"
+#include "../systems/job_pool.h"
 
 #pragma warning( disable : 26451 )
 #define CGLTF_IMPLEMENTATION
@@ -22,6 +25,16 @@ namespace sk {
 bool modelfmt_obj (model_t model, const char *filename, void *file_data, size_t file_size, shader_t shader);
 bool modelfmt_gltf(model_t model, const char *filename, void *file_data, size_t file_size, shader_t shader);
 
+// Generated LODs are picked so their error stays under this fraction of the
+// view's height, and never simplify further than model_lod_error_max of the
+// mesh's size.
+const float model_lod_tolerance  = 0.002f;
+const float model_lod_error_max  = 0.05f;
+const float model_lod_hysteresis = 0.1f;
+
+int32_t model_auto_lod_count = 0;
+float   model_auto_lod_ratio = 0.5f;
+
 ///////////////////////////////////////////
 
 model_t model_create() {
@@ -38,12 +51,7 @@ void model_set_id(model_t model, const char *id) {
 ///////////////////////////////////////////
 
 model_t model_find(const char *id) {
-	model_t result = (model_t)assets_find(id, asset_type_model);
-	if (result != nullptr) {
-		assets_addref(result->header);
-		return result;
-	}
-	return nullptr;
+	return (model_t)assets_find_ref(id, asset_type_model);
 }
 
 ///////////////////////////////////////////
@@ -65,33 +73,29 @@ model_t model_create_file(const char *filename, shader_t shader) {
 	result = model_create();
 	model_set_id(result, filename);
 
-	const char *model_file = assets_file(filename);
-	// Open file
-	FILE *fp;
-	if (fopen_s(&fp, model_file, "rb") != 0 || fp == nullptr) {
-		log_errf("Can't find file %s!", model_file);
+	vfs_file_t file;
+	if (!vfs_open(filename, file)) {
+		log_errf("Can't find file %s!", filename);
 		return nullptr;
 	}
 
-	// Get length of file
-	fseek(fp, 0L, SEEK_END);
-	uint64_t length = ftell(fp);
-	rewind(fp);
-
-	// Read the data
-	uint8_t *data = (uint8_t *)malloc(sizeof(uint8_t) *length+1);
-	if (data == nullptr) { fclose(fp); return false; }
-	fread(data, 1, length, fp);
-	fclose(fp);
-	data[length] = '\0';
-
-	if        (modelfmt_gltf(result, filename, data, length, shader)) {
-	} else if (modelfmt_obj (result, filename, data, length, shader)) {
+	if (modelfmt_gltf(result, filename, (void*)file.data, file.size, shader)) {
 	} else {
-		log_errf("Issue loading %s! Can't recognize the file format.", filename);
+		// The obj parser treats the file as a string, loose files come with a
+		// terminator, but archive views need copying first.
+		char *text = (char *)file.owned;
+		if (text == nullptr) {
+			text = (char *)malloc(file.size + 1);
+			memcpy(text, file.data, file.size);
+			text[file.size] = '\0';
+		}
+		if (!modelfmt_obj(result, filename, text, file.size, shader))
+			log_errf("Issue loading %s! Can't recognize the file format.", filename);
+		if (text != file.owned)
+			free(text);
 	}
 
-	free(data);
+	vfs_close(file);
 
 	return result;
 }
@@ -144,6 +148,71 @@ int32_t model_add_subset(model_t model, mesh_t mesh, material_t material, const
 
 ///////////////////////////////////////////
 
+int32_t model_add_lod(model_t model, int32_t subset, mesh_t mesh, float screen_size) {
+	if (subset < 0 || subset >= model->subset_count) {
+		log_errf("model_add_lod: subset %d is out of range!", subset);
+		return -1;
+	}
+	model_subset_t &s = model->subsets[subset];
+
+	// Keep them sorted from most to least detailed
+	int32_t at = s.lod_count;
+	while (at > 0 && s.lods[at - 1].screen_size < screen_size)
+		at--;
+
+	s.lods = (model_lod_t *)realloc(s.lods, sizeof(model_lod_t) * (s.lod_count + 1));
+	memmove(&s.lods[at + 1], &s.lods[at], sizeof(model_lod_t) * (s.lod_count - at));
+	s.lods[at] = model_lod_t{ mesh, screen_size };
+	s.lod_count += 1;
+	assets_addref(mesh->header);
+	return at;
+}
+
+///////////////////////////////////////////
+
+int32_t model_lod_count(model_t model, int32_t subset) {
+	return model->subsets[subset].lod_count;
+}
+
+///////////////////////////////////////////
+
+void model_set_auto_lod(int32_t lod_count, float triangle_ratio) {
+	model_auto_lod_count = lod_count < 0 ? 0 : lod_count;
+	model_auto_lod_ratio = fminf(fmaxf(triangle_ratio, 0.01f), 0.95f);
+}
+
+///////////////////////////////////////////
+
+int32_t model_lod_select(const model_subset_t &subset, float screen_size, int32_t prev_level) {
+	// Level 0 is the subset's own mesh, level N is lods[N-1]. Nothing is
+	// kept on the subset, since the same model can be drawn at several
+	// distances in a frame, and from several threads, so the caller hangs
+	// on to the last level for its draw.
+	int32_t level = 0;
+	if (prev_level < 0 || prev_level > subset.lod_count) {
+		while (level < subset.lod_count && screen_size < subset.lods[level].screen_size)
+			level++;
+		return level;
+	}
+
+	// Moving off the last level needs to go a little past the threshold,
+	// so an object sitting right on it doesn't flicker back and forth.
+	level = prev_level;
+	while (level < subset.lod_count && screen_size < subset.lods[level    ].screen_size * (1 - model_lod_hysteresis)) level++;
+	while (level > 0                && screen_size > subset.lods[level - 1].screen_size * (1 + model_lod_hysteresis)) level--;
+	return level;
+}
+
+///////////////////////////////////////////
+
+mesh_t model_lod_mesh(const model_subset_t &subset, int32_t level) {
+	return level == 0
+		? subset.mesh
+		: subset.lods[level - 1].mesh;
+}
+
+///////////////////////////////////////////
+
 void model_release(model_t model) {
 	if (model == nullptr)
 		return;
@@ -169,6 +238,9 @@ void model_destroy(model_t model) {
 	for (size_t i = 0; i < model->subset_count; i++) {
 		mesh_release    (model->subsets[i].mesh);
 		material_release(model->subsets[i].material);
+		for (int32_t l = 0; l < model->subsets[i].lod_count; l++)
+			mesh_release(model->subsets[i].lods[l].mesh);
+		free(model->subsets[i].lods);
 	}
 	free(model->subsets);
 	*model = {};
@@ -182,12 +254,12 @@ inline int meshfmt_obj_idx(int i1, int i2, int i3, int vSize, int nSize) {
 
 ///////////////////////////////////////////
 
-int indexof(int iV, int iT, int iN, vector<vec3> &verts, vector<vec3> &norms, vector<vec2> &uvs, map<int, vind_t> indmap, vector<vert_t> &mesh_verts) {
+int indexof(int iV, int iT, int iN, vector<vec3> &verts, vector<vec3> &norms, vector<vec2> &uvs, map<int, uint32_t> indmap, vector<vert_t> &mesh_verts) {
 	int  id = meshfmt_obj_idx(iV, iN, iT, (int)verts.size(), (int)norms.size());
-	map<int, vind_t>::iterator item = indmap.find(id);
+	map<int, uint32_t>::iterator item = indmap.find(id);
 	if (item == indmap.end()) {
 		mesh_verts.push_back({ verts[iV - 1LL], norms[iN - 1LL], uvs[iT - 1LL], {255,255,255,255} });
-		indmap[id] = (vind_t)(mesh_verts.size() - 1);
+		indmap[id] = (uint32_t)(mesh_verts.size() - 1);
 		return (int)mesh_verts.size() - 1;
 	}
 	return item->second;
@@ -206,9 +278,9 @@ bool modelfmt_obj(model_t model, const char *filename, void *file_data, size_t f
 	vector<vec3> norms;
 	vector<vec2> uvs;
 
-	map<int, vind_t> indmap;
-	vector<vert_t>   verts;
-	vector<vind_t> faces;
+	map<int, uint32_t> indmap;
+	vector<vert_t>     verts;
+	vector<uint32_t>   faces;
 
 	vec3 in;
 	int inds[12];
@@ -222,12 +294,12 @@ bool modelfmt_obj(model_t model, const char *filename, void *file_data, size_t f
 			vec2 uv = { in.x, in.y };
 			uvs.push_back(uv);
 		} else if ((count = sscanf_s(line, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n%n", &inds[0], &inds[1], &inds[2],&inds[3],&inds[4],&inds[5],&inds[6],&inds[7],&inds[8],&inds[9],&inds[10],&inds[11],  &read)) > 0) {
-			vind_t id1 = (vind_t)indexof(inds[0], inds[1],  inds[2],  poss, norms, uvs, indmap, verts);
-			vind_t id2 = (vind_t)indexof(inds[3], inds[4],  inds[5],  poss, norms, uvs, indmap, verts);
-			vind_t id3 = (vind_t)indexof(inds[6], inds[7],  inds[8],  poss, norms, uvs, indmap, verts);
+			uint32_t id1 = (uint32_t)indexof(inds[0], inds[1],  inds[2],  poss, norms, uvs, indmap, verts);
+			uint32_t id2 = (uint32_t)indexof(inds[3], inds[4],  inds[5],  poss, norms, uvs, indmap, verts);
+			uint32_t id3 = (uint32_t)indexof(inds[6], inds[7],  inds[8],  poss, norms, uvs, indmap, verts);
 			faces.push_back(id1); faces.push_back(id2); faces.push_back(id3);
 			if (count > 9) {
-				vind_t id4 = (vind_t)indexof(inds[9], inds[10], inds[11], poss, norms, uvs, indmap, verts);
+				uint32_t id4 = (uint32_t)indexof(inds[9], inds[10], inds[11], poss, norms, uvs, indmap, verts);
 				faces.push_back(id1); faces.push_back(id3); faces.push_back(id4);
 			}
 		} else {
@@ -240,9 +312,9 @@ bool modelfmt_obj(model_t model, const char *filename, void *file_data, size_t f
 	char id[512];
 	sprintf_s(id, 512, "%s/mesh", filename);
 	mesh_t mesh = mesh_create();
-	mesh_set_id   (mesh, id);
-	mesh_set_verts(mesh, &verts[0], (int32_t)verts.size());
-	mesh_set_inds (mesh, &faces[0], (int32_t)faces.size());
+	mesh_set_id    (mesh, id);
+	mesh_set_verts (mesh, &verts[0], (int32_t)verts.size());
+	mesh_set_inds32(mesh, &faces[0], (int32_t)faces.size());
 
 	model_add_subset(model, mesh, shader == nullptr ? material_find("default/material") : material_create(shader), matrix_identity);
 
@@ -253,20 +325,12 @@ bool modelfmt_obj(model_t model, const char *filename, void *file_data, size_t f
 
 ///////////////////////////////////////////
 
-mesh_t gltf_parsemesh(cgltf_mesh *mesh, int node_id, const char *filename) {
+// Only reads from cgltf's data, so this is safe to call from worker threads.
+// The caller is responsible for freeing out_verts and out_inds.
+void gltf_mesh_data(cgltf_mesh *mesh, vert_t **out_verts, int32_t *out_vert_count, uint32_t **out_inds, int32_t *out_ind_count) {
 	cgltf_mesh      *m = mesh;
 	cgltf_primitive *p = &m->primitives[0];
 
-	if (p->type != cgltf_primitive_type_triangles)
-		log_warnf("Unimplemented gltf primitive mode: %d", p->type);
-
-	char id[512];
-	sprintf_s(id, 512, "%s/node_%d_%s", filename, node_id, m->name);
-	mesh_t result = mesh_find(id);
-	if (result != nullptr) {
-		return result;
-	}
-
 	vert_t *verts = nullptr;
 	int     vert_count = 0;
 
@@ -308,9 +372,10 @@ mesh_t gltf_parsemesh(cgltf_mesh *mesh, int node_id, const char *filename) {
 		}
 	}
 
-	// Now grab the mesh indices
-	int ind_count = (int)p->indices->count;
-	vind_t *inds = (vind_t *)malloc(sizeof(vind_t) * ind_count);
+	// Now grab the mesh indices, at full width. mesh_set_inds32 packs them
+	// down to 16 bit if they fit.
+	int       ind_count = (int)p->indices->count;
+	uint32_t *inds      = (uint32_t *)malloc(sizeof(uint32_t) * ind_count);
 	if (p->indices->component_type == cgltf_component_type_r_16u) {
 		cgltf_buffer_view *buff   = p->indices->buffer_view;
 		size_t             offset = buff->offset + p->indices->offset;
@@ -323,18 +388,40 @@ mesh_t gltf_parsemesh(cgltf_mesh *mesh, int node_id, const char *filename) {
 		size_t             offset = buff->offset + p->indices->offset;
 		for (size_t v = 0; v < ind_count; v++) {
 			uint32_t *ind = (uint32_t *)(((uint8_t *)buff->buffer->data) + (sizeof(uint32_t) * v) + offset);
-#ifdef SK_32BIT_INDICES
 			inds[v] = *ind;
-#else
-			inds[v] = *ind > 0x0000FFFF ? 0 : (uint16_t)*ind;
-#endif
 		}
 	}
 
+	*out_verts      = verts;
+	*out_vert_count = vert_count;
+	*out_inds       = inds;
+	*out_ind_count  = ind_count;
+}
+
+///////////////////////////////////////////
+
+mesh_t gltf_parsemesh(cgltf_mesh *mesh, int node_id, const char *filename) {
+	cgltf_primitive *p = &mesh->primitives[0];
+
+	if (p->type != cgltf_primitive_type_triangles)
+		log_warnf("Unimplemented gltf primitive mode: %d", p->type);
+
+	char id[512];
+	sprintf_s(id, 512, "%s/node_%d_%s", filename, node_id, mesh->name);
+	mesh_t result = mesh_find(id);
+	if (result != nullptr) {
+		return result;
+	}
+
+	vert_t   *verts;
+	uint32_t *inds;
+	int32_t   vert_count, ind_count;
+	gltf_mesh_data(mesh, &verts, &vert_count, &inds, &ind_count);
+
 	result = mesh_create();
-	mesh_set_id   (result, id);
-	mesh_set_verts(result, verts, vert_count);
-	mesh_set_inds (result, inds,  ind_count);
+	mesh_set_id    (result, id);
+	mesh_set_verts (result, verts, vert_count);
+	mesh_set_inds32(result, inds,  ind_count);
 	free(verts);
 	free(inds );
 
@@ -343,6 +430,152 @@ mesh_t gltf_parsemesh(cgltf_mesh *mesh, int node_id, const char *filename) {
 
 ///////////////////////////////////////////
 
+struct gltf_lod_level_t {
+	vector<vert_t>   verts;
+	vector<uint32_t> inds;
+	float            error;
+};
+struct gltf_lod_job_t {
+	int32_t                  subset;
+	cgltf_mesh              *mesh;
+	vector<gltf_lod_level_t> levels;
+};
+
+///////////////////////////////////////////
+
+void gltf_lod_generate(gltf_lod_job_t &job) {
+	vert_t   *verts;
+	uint32_t *inds;
+	int32_t   vert_count, ind_count;
+	gltf_mesh_data(job.mesh, &verts, &vert_count, &inds, &ind_count);
+
+	// Each level starts from the full mesh rather than the previous level,
+	// so the reported error is the true error for that level.
+	vector<uint32_t> lod_inds(ind_count);
+	int32_t          prev_count = ind_count;
+	float            target     = (float)ind_count;
+	for (int32_t l = 0; l < model_auto_lod_count; l++) {
+		target *= model_auto_lod_ratio;
+		float   error;
+		int32_t count = mesh_simplify(verts, vert_count, inds, ind_count, lod_inds.data(), ((int32_t)target / 3) * 3, model_lod_error_max, &error);
+
+		// Not worth a level if it didn't get meaningfully simpler
+		if (count == 0 || count > prev_count * 0.9f)
+			break;
+		prev_count = count;
+
+		gltf_lod_level_t level;
+		level.error = error;
+		level.inds .assign(lod_inds.begin(), lod_inds.begin() + count);
+		level.verts.resize(vert_count);
+		level.verts.resize(mesh_simplify_compact(verts, vert_count, level.inds.data(), count, level.verts.data()));
+		job.levels.push_back(level);
+	}
+	free(verts);
+	free(inds );
+}
+
+///////////////////////////////////////////
+
+void gltf_lod_generate_all(model_t model, vector<gltf_lod_job_t> &jobs) {
+	if (jobs.size() == 0)
+		return;
+
+	// Simplification is pure CPU work on cgltf's data, so it can spread
+	// across the job pool. Meshes get created back here afterwards.
+	job_pool_for((int32_t)jobs.size(), [](int32_t index, void *context) {
+		gltf_lod_generate((*(vector<gltf_lod_job_t> *)context)[index]);
+	}, &jobs);
+
+	for (size_t j = 0; j < jobs.size(); j++) {
+		float screen_size = 1;
+		for (size_t l = 0; l < jobs[j].levels.size(); l++) {
+			gltf_lod_level_t &level = jobs[j].levels[l];
+
+			// Switch once the level's error would be smaller than the
+			// tolerance on screen. The error is relative to the mesh size,
+			// so it scales right along with the screen size.
+			if (level.error > 0)
+				screen_size = fminf(screen_size, model_lod_tolerance / level.error);
+
+			mesh_t mesh = mesh_create();
+			mesh_set_verts (mesh, level.verts.data(), (int32_t)level.verts.size());
+			mesh_set_inds32(mesh, level.inds .data(), (int32_t)level.inds .size());
+			model_add_lod  (model, jobs[j].subset, mesh, screen_size);
+			mesh_release   (mesh);
+		}
+	}
+}
+
+///////////////////////////////////////////
+
+int32_t gltf_json_find(const jsmntok_t *tokens, int32_t object, const uint8_t *json, const char *key) {
+	if (object < 0 || tokens[object].type != JSMN_OBJECT)
+		return -1;
+
+	int32_t i = object + 1;
+	for (int32_t k = 0; k < tokens[object].size && i >= 0; k++) {
+		if (cgltf_json_strcmp(&tokens[i], json, key) == 0)
+			return i + 1;
+		i = cgltf_skip_json(tokens, i + 1);
+	}
+	return -1;
+}
+
+///////////////////////////////////////////
+
+// cgltf skips over extensions it doesn't know, so MSFT_lod gets picked out
+// of the json here. out_ids gets the LOD node ids for each node, and
+// out_coverage the matching MSFT_screencoverage values, if any.
+void gltf_parse_lods(cgltf_data *data, vector<vector<int32_t>> &out_ids, vector<vector<float>> &out_coverage) {
+	out_ids     .resize(data->nodes_count);
+	out_coverage.resize(data->nodes_count);
+
+	bool used = false;
+	for (cgltf_size i = 0; i < data->extensions_used_count; i++) {
+		if (strcmp(data->extensions_used[i], "MSFT_lod") == 0)
+			used = true;
+	}
+	if (!used)
+		return;
+
+	const uint8_t *json = (const uint8_t *)data->json;
+	jsmn_parser    parser;
+	jsmn_init(&parser);
+	int32_t token_count = jsmn_parse(&parser, data->json, data->json_size, nullptr, 0);
+	if (token_count <= 0)
+		return;
+	vector<jsmntok_t> tokens(token_count + 1);
+	jsmn_init(&parser);
+	if (jsmn_parse(&parser, data->json, data->json_size, tokens.data(), token_count) <= 0)
+		return;
+
+	int32_t nodes = gltf_json_find(tokens.data(), 0, json, "nodes");
+	if (nodes < 0 || tokens[nodes].type != JSMN_ARRAY)
+		return;
+
+	int32_t node = nodes + 1;
+	for (int32_t n = 0; n < tokens[nodes].size && n < (int32_t)data->nodes_count && node >= 0; n++) {
+		int32_t ext = gltf_json_find(tokens.data(), node, json, "extensions");
+		int32_t ids = gltf_json_find(tokens.data(), gltf_json_find(tokens.data(), ext, json, "MSFT_lod"), json, "ids");
+		if (ids >= 0 && tokens[ids].type == JSMN_ARRAY) {
+			for (int32_t i = 0; i < tokens[ids].size; i++)
+				out_ids[n].push_back(cgltf_json_to_int(&tokens[ids + 1 + i], json));
+		}
+
+		int32_t extras   = gltf_json_find(tokens.data(), node, json, "extras");
+		int32_t coverage = gltf_json_find(tokens.data(), extras, json, "MSFT_screencoverage");
+		if (coverage >= 0 && tokens[coverage].type == JSMN_ARRAY) {
+			for (int32_t i = 0; i < tokens[coverage].size; i++)
+				out_coverage[n].push_back(cgltf_json_to_float(&tokens[coverage + 1 + i], json));
+		}
+
+		node = cgltf_skip_json(tokens.data(), node);
+	}
+}
+
+///////////////////////////////////////////
+
 void gltf_imagename(cgltf_data *data, cgltf_image *image, const char *filename, char *dest, int dest_length) {
 	if (image->uri != nullptr && strncmp(image->uri, "data:", 5) != 0 && strstr(image->uri, "://") == nullptr) {
 		char *last1 = strrchr((char*)filename, '/');
@@ -476,9 +709,38 @@ void gltf_build_node_matrix(cgltf_node *curr, matrix &result) {
 bool modelfmt_gltf(model_t model, const char *filename, void *file_data, size_t file_size, shader_t shader) {
 	cgltf_options options = {};
 	cgltf_data*   data    = NULL;
-	const char *model_file = assets_file(filename);
 	if (cgltf_parse(&options, file_data, file_size, &data) != cgltf_result_success)
 		return false;
+
+	// External buffers may live in an archive, so look for them through the
+	// vfs first. cgltf frees buffer data itself, so these need to be copies.
+	const char *last_slash = max(strrchr(filename, '/'), strrchr(filename, '\\'));
+	for (cgltf_size i = 0; i < data->buffers_count; i++) {
+		cgltf_buffer &buffer = data->buffers[i];
+		if (buffer.data != nullptr || buffer.uri == nullptr || strncmp(buffer.uri, "data:", 5) == 0 || strstr(buffer.uri, "://") != nullptr)
+			continue;
+
+		char buffer_file[512];
+		if (last_slash == nullptr) sprintf_s(buffer_file, "%s", buffer.uri);
+		else                       sprintf_s(buffer_file, "%.*s/%s", (int)(last_slash - filename), filename, buffer.uri);
+
+		vfs_file_t file;
+		if (!vfs_open(buffer_file, file))
+			continue;
+		if (file.size >= buffer.size) {
+			if (file.owned != nullptr) {
+				buffer.data = file.owned;
+				file.owned  = nullptr;
+			} else {
+				buffer.data = malloc(buffer.size);
+				memcpy(buffer.data, file.data, buffer.size);
+			}
+		}
+		vfs_close(file);
+	}
+
+	char model_file[1024];
+	assets_file_path(filename, model_file, sizeof(model_file));
 	if (cgltf_load_buffers(&options, data, model_file) != cgltf_result_success) {
 		cgltf_free(data);
 		return true;
@@ -488,10 +750,23 @@ bool modelfmt_gltf(model_t model, const char *filename, void *file_data, size_t
 	// rotate the gltf matrices so that they use -Z as forward, simplifying lookat math
 	matrix orientation_correction = matrix_trs(vec3_zero, quat_from_angles(0, 180, 0));
 
+	// Nodes that are only there as another node's LOD aren't subsets
+	vector<vector<int32_t>> lod_ids;
+	vector<vector<float>>   lod_coverage;
+	vector<bool>            is_lod(data->nodes_count, false);
+	vector<gltf_lod_job_t>  lod_jobs;
+	gltf_parse_lods(data, lod_ids, lod_coverage);
+	for (size_t i = 0; i < lod_ids.size(); i++) {
+		for (size_t l = 0; l < lod_ids[i].size(); l++) {
+			if (lod_ids[i][l] >= 0 && lod_ids[i][l] < (int32_t)data->nodes_count)
+				is_lod[lod_ids[i][l]] = true;
+		}
+	}
+
 	// Load each subset
 	for (int32_t i = 0; i < data->nodes_count; i++) {
 		cgltf_node *n = &data->nodes[i];
-		if (n->mesh == nullptr)
+		if (n->mesh == nullptr || is_lod[i])
 			continue;
 
 		matrix transform = matrix_identity;
@@ -500,11 +775,29 @@ bool modelfmt_gltf(model_t model, const char *filename, void *file_data, size_t
 		mesh_t     mesh     = gltf_parsemesh    (n->mesh, i, filename);
 		material_t material = gltf_parsematerial(data, n->mesh->primitives[0].material, filename, shader);
 
-		model_add_subset(model, mesh, material, offset);
+		int32_t subset = model_add_subset(model, mesh, material, offset);
+
+		// Authored LODs win over generated ones. MSFT_screencoverage is an
+		// area, and LOD selection works on height, hence the sqrt.
+		for (size_t l = 0; l < lod_ids[i].size(); l++) {
+			int32_t id = lod_ids[i][l];
+			if (id < 0 || id >= (int32_t)data->nodes_count || data->nodes[id].mesh == nullptr)
+				continue;
+			float screen_size = l < lod_coverage[i].size()
+				? sqrtf(lod_coverage[i][l])
+				: 0.5f * powf(0.5f, (float)l);
+			mesh_t lod_mesh = gltf_parsemesh(data->nodes[id].mesh, id, filename);
+			model_add_lod(model, subset, lod_mesh, screen_size);
+			mesh_release (lod_mesh);
+		}
+		if (lod_ids[i].size() == 0 && model_auto_lod_count > 0 && n->mesh->primitives[0].indices != nullptr)
+			lod_jobs.push_back({ subset, n->mesh });
 
 		mesh_release    (mesh);
 		material_release(material);
 	}
+	gltf_lod_generate_all(model, lod_jobs);
+
 	cgltf_free(data);
 	return true;
 }
@@ -5,10 +5,17 @@
 
 namespace sk {
 
+struct model_lod_t {
+	mesh_t mesh;
+	float  screen_size; // Used when the subset covers less than this much of the view's height
+};
+
 struct model_subset_t {
-	mesh_t      mesh;
-	material_t  material;
-	matrix      offset;
+	mesh_t       mesh;
+	material_t   material;
+	matrix       offset;
+	model_lod_t *lods;      // Lower detail versions of mesh, most detailed first
+	int32_t      lod_count;
 };
 
 struct _model_t {
@@ -18,6 +25,8 @@ struct _model_t {
 	bounds_t        bounds;
 };
 
-void model_destroy(model_t model);
+void    model_destroy   (model_t model);
+int32_t model_lod_select(const model_subset_t &subset, float screen_size, int32_t prev_level = -1);
+mesh_t  model_lod_mesh  (const model_subset_t &subset, int32_t level);
 
 } // namespace sk
\ No newline at end of file
@@ -2,10 +2,12 @@
 #include "../_stereokit.h"
 #include "../libraries/stref.h"
 #include "../systems/d3d.h"
+#include "../systems/vfs.h"
 #include "shader.h"
 #include "assets.h"
 
 #include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include <direct.h>
 
@@ -109,8 +111,10 @@ void shader_parse_file(shader_t shader, const char *hlsl) {
 
 	vector<shaderargs_desc_item_t > buffer_items;
 	vector<shader_tex_slots_item_t> tex_items;
+	vector<shader_inst_item_t     > inst_items;
 
-	size_t buffer_size = 0;
+	size_t  buffer_size = 0;
+	int32_t inst_floats = 0;
 	while (stref_nextline(file, line)) {
 		stref_t curr = line;
 		stref_t word = {};
@@ -204,6 +208,36 @@ void shader_parse_file(shader_t shader, const char *hlsl) {
 			}
 
 			tex_items.emplace_back(item);
+		} if (stref_equals(stripped_word, "inst")) {
+			if (!stref_nextword(curr, word))
+				continue;
+
+			shader_inst_item_t item = {};
+			if      (stref_equals(word, "float" )) item.size = 1;
+			else if (stref_equals(word, "float2")) item.size = 2;
+			else if (stref_equals(word, "float3")) item.size = 3;
+			else if (stref_equals(word, "float4") || stref_equals(word, "vector") || stref_equals(word, "color")) item.size = 4;
+			else {
+				char name[64];
+				stref_copy_to(word, name, 64);
+				log_warnf("Unrecognized shader inst type: %s", name);
+				continue;
+			}
+			if (!stref_nextword(curr, word))
+				continue;
+
+			// Everything has to fit in the instance's single float4
+			if (inst_floats + item.size > 4) {
+				char name[64];
+				stref_copy_to(word, name, 64);
+				log_warnf("Shader inst field %s doesn't fit, instances only get 4 floats of custom data", name);
+				continue;
+			}
+			item.offset  = inst_floats;
+			item.name    = stref_copy(word);
+			item.id      = stref_hash(word);
+			inst_floats += item.size;
+			inst_items.emplace_back(item);
 		} if (stref_equals(stripped_word, "name")) {
 			if (!stref_nextword(curr, word))
 				continue;
@@ -232,17 +266,21 @@ void shader_parse_file(shader_t shader, const char *hlsl) {
 		shader->tex_slots.tex       = (shader_tex_slots_item_t*)malloc(data_size);
 		memcpy(shader->tex_slots.tex, &tex_items[0], data_size);
 	}
+
+	shader->inst_desc = {};
+	shader->inst_desc.float_count = inst_floats;
+	data_size = sizeof(shader_inst_item_t) * inst_items.size();
+	if (data_size > 0) {
+		shader->inst_desc.item_count = (int32_t)inst_items.size();
+		shader->inst_desc.item       = (shader_inst_item_t*)malloc(data_size);
+		memcpy(shader->inst_desc.item, &inst_items[0], data_size);
+	}
 }
 
 ///////////////////////////////////////////
 
 shader_t shader_find(const char *id) {
-	shader_t result = (shader_t)assets_find(id, asset_type_shader);
-	if (result != nullptr) {
-		assets_addref(result->header);
-		return result;
-	}
-	return nullptr;
+	return (shader_t)assets_find_ref(id, asset_type_shader);
 }
 
 ///////////////////////////////////////////
@@ -260,6 +298,17 @@ void shader_set_id(shader_t shader, const char *id) {
 
 ///////////////////////////////////////////
 
+int32_t shader_get_inst_offset(shader_t shader, const char *name) {
+	uint64_t id = string_hash(name);
+	for (int32_t i = 0; i < shader->inst_desc.item_count; i++) {
+		if (shader->inst_desc.item[i].id == id)
+			return shader->inst_desc.item[i].offset;
+	}
+	return -1;
+}
+
+///////////////////////////////////////////
+
 const char *shader_get_name(shader_t shader) {
 	return shader->name;
 }
@@ -324,39 +373,39 @@ bool32_t shader_set_code(shader_t shader, const char *hlsl, const char *filename
 		{"NORMAL",      0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
 		{"TEXCOORD",    0, DXGI_FORMAT_R32G32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
 		{"COLOR" ,      0, DXGI_FORMAT_R8G8B8A8_UNORM,  0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-		{"SV_RenderTargetArrayIndex" ,  0, DXGI_FORMAT_R32_UINT,  0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0} };
+		{"SV_RenderTargetArrayIndex" ,  0, DXGI_FORMAT_R32_UINT,  0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
+		{"SK_INSTANCE", 0, DXGI_FORMAT_R32_UINT,        1, 0,                            D3D11_INPUT_PER_INSTANCE_DATA, 1},
+		{"SK_INST_DATA",0, DXGI_FORMAT_R32G32B32A32_FLOAT, 2, 0,                         D3D11_INPUT_PER_INSTANCE_DATA, 1} };
 	if (FAILED(d3d_device->CreateInputLayout(vert_desc, (UINT)_countof(vert_desc), vert_shader_blob.data, vert_shader_blob.size, &shader->vert_layout)))
 		log_warnf("Issue creating vertex layout for %s", filename);
 
 	free(vert_shader_blob .data);
 	free(pixel_shader_blob.data);
 
+	// Unlike SV_InstanceID, the SK_INSTANCE stream respects the draw's start
+	// instance, which is what lets the renderer merge meshes into one batch.
+	shader->batchable = strstr(hlsl, "SK_INSTANCE") != nullptr;
+
 	return true;
 }
 
 ///////////////////////////////////////////
 
 bool32_t shader_set_codefile(shader_t shader, const char *filename) {
-	// Open file
-	FILE *fp;
-	if (fopen_s(&fp, assets_file(filename), "rb") != 0 || fp == nullptr)
+	vfs_file_t file;
+	if (!vfs_open(filename, file))
 		return false;
 
-	// Get length of file
-	fseek(fp, 0L, SEEK_END);
-	size_t length = ftell(fp);
-	rewind(fp);
-
-	// Read the data
-	unsigned char *data = (unsigned char *)malloc(sizeof(unsigned char) *length+1);
-	if (data == nullptr) { fclose(fp); return false; }
-	fread(data, 1, length, fp);
-	data[length] = '\0';
-	fclose(fp);
+	// Shader code needs to be null terminated, and archive views aren't
+	char *code = (char *)malloc(file.size + 1);
+	if (code == nullptr) { vfs_close(file); return false; }
+	memcpy(code, file.data, file.size);
+	code[file.size] = '\0';
+	vfs_close(file);
 
 	// Compile the shader
-	shader_set_code(shader, (const char *)data, filename);
-	free(data);
+	shader_set_code(shader, code, filename);
+	free(code);
 
 	return true;
 }
@@ -378,8 +427,13 @@ void shader_destroy_parsedata(shader_t shader) {
 		free(shader->args_desc.item[i].default_value);
 	}
 
+	for (int32_t i = 0; i < shader->inst_desc.item_count; i++) {
+		free(shader->inst_desc.item[i].name);
+	}
+
 	shaderargs_destroy(shader->args);
 	free(shader->args_desc.item);
+	free(shader->inst_desc.item);
 	free(shader->name);
 }
 
@@ -47,6 +47,21 @@ struct shader_tex_slots_t {
 	int tex_count;
 };
 
+// Per-instance fields, from '// [inst]' tags. These all pack into the one
+// float4 each instance gets, which shaders read from SK_INST_DATA.
+struct shader_inst_item_t {
+	uint64_t id;
+	char    *name;
+	int32_t  offset; // In floats
+	int32_t  size;   // In floats
+};
+
+struct shader_inst_desc_t {
+	shader_inst_item_t *item;
+	int32_t             item_count;
+	int32_t             float_count;
+};
+
 struct _shader_t {
 	asset_header_t      header;
 	ID3D11VertexShader *vshader;
@@ -55,7 +70,11 @@ struct _shader_t {
 	shaderargs_t        args;
 	shaderargs_desc_t   args_desc;
 	shader_tex_slots_t  tex_slots;
+	shader_inst_desc_t  inst_desc;
 	char               *name;
+	// Reads its instance index from the SK_INSTANCE stream instead of
+	// SV_InstanceID, so draws can start partway into the instance buffer.
+	bool32_t            batchable;
 };
 
 void shader_destroy          (shader_t shader);
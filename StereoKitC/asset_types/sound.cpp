@@ -25,12 +25,7 @@ ma_device         au_device = {};
 ///////////////////////////////////////////
 
 sound_t sound_find(const char *id) {
-    sound_t result = (sound_t)assets_find(id, asset_type_sound);
-    if (result != nullptr) {
-        assets_addref(result->header);
-        return result;
-    }
-    return nullptr;
+    return (sound_t)assets_find_ref(id, asset_type_sound);
 }
 
 ///////////////////////////////////////////
@@ -48,11 +43,15 @@ sound_t sound_create(const char *filename) {
     result = (_sound_t*)assets_allocate(asset_type_sound);
     sound_set_id(result, filename);
 
-    const char *sound_file = assets_file(filename);
+    if (!vfs_open(filename, result->file)) {
+        log_errf("Failed to find sound '%s'.", filename);
+        return nullptr;
+    }
 
     au_decoder_config = ma_decoder_config_init(SAMPLE_FORMAT, CHANNEL_COUNT, SAMPLE_RATE);
-    if (ma_decoder_init_file(sound_file, &au_decoder_config, &result->decoder) != MA_SUCCESS) {
-        log_errf("Failed to load sound '%s'.", sound_file);
+    if (ma_decoder_init_memory(result->file.data, result->file.size, &au_decoder_config, &result->decoder) != MA_SUCCESS) {
+        log_errf("Failed to load sound '%s'.", filename);
+        vfs_close(result->file);
         return nullptr;
     }
     return result;
@@ -116,6 +115,7 @@ void sound_release(sound_t sound) {
 void sound_destroy(sound_t sound) {
     ma_decoder_uninit(&sound->decoder);
     free(sound->sound_data);
+    vfs_close(sound->file);
     memset(sound, 0, sizeof(_sound_t));
 }
 
@@ -2,6 +2,7 @@
 
 #include "../libraries/miniaudio.h"
 #include "assets.h"
+#include "../systems/vfs.h"
 
 namespace sk {
 
@@ -9,6 +10,7 @@ struct _sound_t {
 	asset_header_t header;
 	ma_decoder decoder;
 	void *sound_data;
+	vfs_file_t file; // the decoder streams from this, so it lives as long as the sound
 };
 
 struct sound_inst_t {
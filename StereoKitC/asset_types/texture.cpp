@@ -1,9 +1,14 @@
 #include "../stereokit.h"
 #include "../shaders_builtin/shader_builtin.h"
 #include "../systems/d3d.h"
+#include "../systems/render_pipeline.h"
+#include "../systems/render.h"
+#include "../systems/tex_upload.h"
+#include "../systems/vfs.h"
 #include "../libraries/stref.h"
 #include "../math.h"
 #include "../spherical_harmonics.h"
+#include "../pixel_convert.h"
 #include "texture.h"
 
 #pragma warning( disable : 26451 6011 6262 6308 6387 28182 )
@@ -46,12 +51,7 @@ tex_t tex_add_zbuffer(tex_t texture, tex_format_ format) {
 ///////////////////////////////////////////
 
 tex_t tex_find(const char *id) {
-	tex_t result = (tex_t)assets_find(id, asset_type_texture);
-	if (result != nullptr) {
-		assets_addref(result->header);
-		return result;
-	}
-	return nullptr;
+	return (tex_t)assets_find_ref(id, asset_type_texture);
 }
 
 ///////////////////////////////////////////
@@ -74,20 +74,37 @@ tex_t tex_create_file(const char *file, bool32_t srgb_data) {
 	if (result != nullptr)
 		return result;
 
-	bool     is_hdr   = stbi_is_hdr(assets_file(file));
+	vfs_file_t file_data;
+	if (!vfs_open(file, file_data)) {
+		log_warnf("Couldn't find image file: %s", file);
+		return nullptr;
+	}
+
+	const stbi_uc *file_bytes = (const stbi_uc *)file_data.data;
+	int            file_size  = (int)file_data.size;
+	bool     is_hdr   = stbi_is_hdr_from_memory(file_bytes, file_size);
 	int      channels = 0;
 	int      width    = 0;
 	int      height   = 0;
 	uint8_t *data     =  is_hdr ? 
-		(uint8_t *)stbi_loadf(assets_file(file), &width, &height, &channels, 4):
-		(uint8_t *)stbi_load (assets_file(file), &width, &height, &channels, 4);
+		(uint8_t *)stbi_loadf_from_memory(file_bytes, file_size, &width, &height, &channels, 4):
+		(uint8_t *)stbi_load_from_memory (file_bytes, file_size, &width, &height, &channels, 4);
+	vfs_close(file_data);
 
 	if (data == nullptr) {
 		log_warnf("Couldn't load image file: %s", file);
 		return nullptr;
 	}
 	tex_format_ format = srgb_data ? tex_format_rgba32 : tex_format_rgba32_linear;
-	if (is_hdr) format = tex_format_rgba128;
+	if (is_hdr) {
+		// Half floats are plenty for HDR images, at half the memory
+		size_t    count = (size_t)width * height * 4;
+		uint16_t *half  = (uint16_t *)malloc(count * sizeof(uint16_t));
+		pixel_f32_to_f16((float *)data, half, count);
+		free(data);
+		data   = (uint8_t *)half;
+		format = tex_format_rgba64f;
+	}
 
 	result = tex_create(tex_type_image, format);
 	
@@ -164,7 +181,11 @@ tex_t tex_create_cubemap_files(const char **cube_face_file_xxyyzz, bool32_t srgb
 		int channels = 0;
 		int width    = 0;
 		int height   = 0;
-		data[i] = stbi_load(assets_file(cube_face_file_xxyyzz[i]), &width, &height, &channels, 4);
+		vfs_file_t file_data;
+		if (vfs_open(cube_face_file_xxyyzz[i], file_data)) {
+			data[i] = stbi_load_from_memory((const stbi_uc *)file_data.data, (int)file_data.size, &width, &height, &channels, 4);
+			vfs_close(file_data);
+		}
 
 		// Check if there were issues, or one of the images is the wrong size!
 		if (data[i] == nullptr || 
@@ -231,8 +252,9 @@ void tex_release(tex_t texture) {
 
 void tex_destroy(tex_t tex) {
 	tex_releasesurface(tex);
-	if (tex->sampler      != nullptr) tex->sampler->Release();
+	state_cache_release(tex->sampler);
 	if (tex->depth_buffer != nullptr) tex_release(tex->depth_buffer);
+	if (tex->nv12_plane   != nullptr) tex_release(tex->nv12_plane);
 	
 	*tex = {};
 }
@@ -240,6 +262,7 @@ void tex_destroy(tex_t tex) {
 ///////////////////////////////////////////
 
 void tex_releasesurface(tex_t tex) {
+	tex_upload_drop(tex);
 	if (tex->resource    != nullptr) tex->resource   ->Release();
 	if (tex->target_view != nullptr) tex->target_view->Release();
 	if (tex->texture     != nullptr) tex->texture    ->Release();
@@ -257,7 +280,14 @@ void tex_set_color_arr(tex_t texture, int32_t width, int32_t height, void **data
 	bool different_size = texture->width != width || texture->height != height || texture->array_size != data_count;
 	if (!different_size && (data == nullptr || *data == nullptr))
 		return;
+	if (data != nullptr && *data != nullptr)
+		render_stats_upload(render_upload_texture, tex_format_size(texture->format) * width * height * data_count);
 	if (texture->texture == nullptr || different_size) {
+		// Brand new textures can't be in flight yet, but existing ones might be
+		if (texture->texture != nullptr) {
+			render_pipeline_sync();
+			render_stats_realloc();
+		}
 		tex_releasesurface(texture);
 		
 		texture->width  = width;
@@ -270,21 +300,9 @@ void tex_set_color_arr(tex_t texture, int32_t width, int32_t height, void **data
 		if (result && texture->depth_buffer != nullptr)
 			tex_set_colors(texture->depth_buffer, width, height, nullptr);
 	} else if (dynamic) {
-		D3D11_MAPPED_SUBRESOURCE tex_mem = {};
-		if (FAILED(d3d_context->Map(texture->texture, 0, D3D11_MAP_WRITE_DISCARD, 0, &tex_mem))) {
-			log_err("Failed mapping a texture");
-			return;
-		}
-
-		size_t   color_size = tex_format_size(texture->format);
-		uint8_t *dest_line  = (uint8_t *)tex_mem.pData;
-		uint8_t *src_line   = (uint8_t *)data[0];
-		for (int i = 0; i < height; i++) {
-			memcpy(dest_line, src_line, (size_t)width * color_size);
-			dest_line += tex_mem.RowPitch;
-			src_line  += width * color_size;
-		}
-		d3d_context->Unmap(texture->texture, 0);
+		// These go up on the drawing thread, so there's no waiting on it
+		for (int32_t i = 0; i < data_count; i++)
+			tex_upload_queue(texture, i, 0, 0, width, height, data[i], 0);
 	} else {
 		log_warn("Attempting additional writes to a non-dynamic texture!");
 	}
@@ -299,41 +317,61 @@ void tex_set_colors(tex_t texture, int32_t width, int32_t height, void *data) {
 
 ///////////////////////////////////////////
 
+void tex_set_colors_region(tex_t texture, int32_t x, int32_t y, int32_t width, int32_t height, const void *data, int32_t stride) {
+	if (!(texture->type & tex_type_dynamic) || texture->texture == nullptr) {
+		log_warn("tex_set_colors_region needs a dynamic texture that's been sized with tex_set_colors first!");
+		return;
+	}
+	if (x < 0 || y < 0 || width <= 0 || height <= 0 || x + width > texture->width || y + height > texture->height) {
+		log_warnf("tex_set_colors_region: %d,%d %dx%d doesn't fit in a %dx%d texture!", x, y, width, height, texture->width, texture->height);
+		return;
+	}
+
+	render_stats_upload(render_upload_texture, tex_format_size(texture->format) * width * height);
+	tex_upload_queue(texture, 0, x, y, width, height, data, stride);
+}
+
+///////////////////////////////////////////
+
+void tex_set_colors_nv12(tex_t texture, int32_t width, int32_t height, const void *data, int32_t stride) {
+	if (!(texture->type & tex_type_rendertarget)) {
+		log_warn("tex_set_colors_nv12 needs a rendertarget texture to convert into!");
+		return;
+	}
+	if (width <= 0 || height <= 0 || width % 2 != 0 || height % 2 != 0) {
+		log_warnf("tex_set_colors_nv12: NV12 images need an even width and height, got %dx%d!", width, height);
+		return;
+	}
+	tex_set_colors(texture, width, height, nullptr);
+
+	// The luma rows and the interleaved chroma rows below them go up as a
+	// single one channel image, half again as tall as the video. That's 1.5
+	// bytes a pixel instead of 4, and a shader turns it into color.
+	int32_t plane_height = height + height / 2;
+	if (texture->nv12_plane == nullptr) {
+		char id[64];
+		assets_unique_name(asset_type_texture, "nv12/", id, sizeof(id));
+		texture->nv12_plane = tex_create(tex_type_image_nomips | tex_type_dynamic, tex_format_r8);
+		tex_set_id(texture->nv12_plane, id);
+	}
+	tex_set_colors(texture->nv12_plane, width, plane_height, nullptr);
+
+	render_stats_upload(render_upload_texture, (size_t)width * plane_height);
+	tex_upload_queue(texture->nv12_plane, 0, 0, 0, width, plane_height, data, stride, texture);
+}
+
+///////////////////////////////////////////
+
 void tex_set_options(tex_t texture, tex_sample_ sample, tex_address_ address_mode, int32_t anisotropy_level) {
 	texture->address_mode = address_mode;
 	texture->anisotropy   = anisotropy_level;
 	texture->sample_mode  = sample;
-	if (texture->sampler != nullptr)
-		texture->sampler->Release();
-
-	D3D11_TEXTURE_ADDRESS_MODE mode;
-	switch (address_mode) {
-	case tex_address_clamp:  mode = D3D11_TEXTURE_ADDRESS_CLAMP;  break;
-	case tex_address_wrap:   mode = D3D11_TEXTURE_ADDRESS_WRAP;   break;
-	case tex_address_mirror: mode = D3D11_TEXTURE_ADDRESS_MIRROR; break;
-	default: mode = D3D11_TEXTURE_ADDRESS_WRAP;
-	}
-
-	D3D11_FILTER filter;
-	switch (sample) {
-	case tex_sample_linear:     filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR; break; // Technically trilinear
-	case tex_sample_point:      filter = D3D11_FILTER_MIN_MAG_MIP_POINT;  break;
-	case tex_sample_anisotropic:filter = D3D11_FILTER_ANISOTROPIC;        break;
-	default: filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-	}
-
-	D3D11_SAMPLER_DESC desc_sampler = {};
-	desc_sampler.AddressU = mode;
-	desc_sampler.AddressV = mode;
-	desc_sampler.AddressW = mode;
-	desc_sampler.Filter   = filter;
-	desc_sampler.MaxAnisotropy  = anisotropy_level;
-	desc_sampler.MaxLOD         = D3D11_FLOAT32_MAX;
-	desc_sampler.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
-
-	// D3D will already return the same sampler when provided the same settings, so we
-	// can just lean on that to prevent sampler duplicates :)
-	if (FAILED(d3d_device->CreateSamplerState(&desc_sampler, &texture->sampler)))
+
+	// Textures with the same settings share a sampler from the state cache
+	state_id_t old_sampler = texture->sampler;
+	texture->sampler = state_cache_sampler(sample, address_mode, anisotropy_level);
+	state_cache_release(old_sampler);
+	if (texture->sampler == state_id_none)
 		log_warnf("tex_set_options: failed to create sampler state!");
 }
 
@@ -353,7 +391,7 @@ int32_t tex_get_height(tex_t texture) {
 
 void tex_set_sample(tex_t texture, tex_sample_ sample) {
 	texture->sample_mode = sample;
-	if (texture->sampler != nullptr)
+	if (texture->sampler != state_id_none)
 		tex_set_options(texture, texture->sample_mode, texture->address_mode, texture->anisotropy);
 }
 
@@ -367,7 +405,7 @@ tex_sample_ tex_get_sample(tex_t texture) {
 
 void tex_set_address(tex_t texture, tex_address_ address_mode) {
 	texture->address_mode = address_mode;
-	if (texture->sampler != nullptr)
+	if (texture->sampler != state_id_none)
 		tex_set_options(texture, texture->sample_mode, texture->address_mode, texture->anisotropy);
 }
 
@@ -381,7 +419,7 @@ tex_address_ tex_get_address(tex_t texture) {
 
 void tex_set_anisotropy(tex_t texture, int32_t anisotropy_level) {
 	texture->anisotropy = anisotropy_level;
-	if (texture->sampler != nullptr)
+	if (texture->sampler != state_id_none)
 		tex_set_options(texture, texture->sample_mode, texture->address_mode, texture->anisotropy);
 }
 
@@ -395,7 +433,8 @@ int32_t tex_get_anisotropy(tex_t texture) {
 
 void tex_set_active(tex_t texture, int slot) {
 	if (texture != nullptr) {
-		d3d_context->PSSetSamplers       (slot, 1, &texture->sampler);
+		ID3D11SamplerState *sampler = state_cache_get_sampler(texture->sampler);
+		d3d_context->PSSetSamplers       (slot, 1, &sampler);
 		d3d_context->PSSetShaderResources(slot, 1, &texture->resource);
 	} else {
 		d3d_context->PSSetShaderResources(slot, 1, nullptr);
@@ -404,11 +443,24 @@ void tex_set_active(tex_t texture, int slot) {
 
 ///////////////////////////////////////////
 
+bool tex_has_mips(tex_t texture) {
+	// Dynamic textures only ever get their top level written to
+	return
+		(texture->type & tex_type_mips) &&
+		!(texture->type & tex_type_dynamic) &&
+		texture->width == texture->height && (
+			texture->format == tex_format_rgba32        ||
+			texture->format == tex_format_rgba32_linear ||
+			texture->format == tex_format_rgba64f       ||
+			texture->format == tex_format_rgba128);
+}
+
+///////////////////////////////////////////
+
 bool tex_create_surface(tex_t texture, void **data, int32_t data_count, spherical_harmonics_t *sh_lighting_info) {
 	if (sh_lighting_info != nullptr) *sh_lighting_info = {};
 
-	bool mips    = texture->type & tex_type_mips && texture->width == texture->height && (texture->format == tex_format_rgba32 || texture->format == tex_format_rgba32_linear || texture->format == tex_format_rgba128);
-	bool dynamic = texture->type & tex_type_dynamic;
+	bool mips    = tex_has_mips(texture);
 	bool depth   = texture->type & tex_type_depth;
 	bool rtarget = texture->type & tex_type_rendertarget;
 
@@ -420,8 +472,9 @@ bool tex_create_surface(tex_t texture, void **data, int32_t data_count, spherica
 	desc.SampleDesc.Count = 1;
 	desc.Format           = tex_get_native_format(texture->format);
 	desc.BindFlags        = depth   ? D3D11_BIND_DEPTH_STENCIL : D3D11_BIND_SHADER_RESOURCE;
-	desc.Usage            = dynamic ? D3D11_USAGE_DYNAMIC      : D3D11_USAGE_DEFAULT;
-	desc.CPUAccessFlags   = dynamic ? D3D11_CPU_ACCESS_WRITE   : 0;
+	// Dynamic textures are copied into from staging textures, so they can
+	// be written a region at a time, see tex_upload.
+	desc.Usage            = D3D11_USAGE_DEFAULT;
 	if (rtarget)
 		desc.BindFlags |= D3D11_BIND_RENDER_TARGET;
 	if (texture->type & tex_type_cubemap)
@@ -445,6 +498,8 @@ bool tex_create_surface(tex_t texture, void **data, int32_t data_count, spherica
 					uint32_t index = i*desc.MipLevels + m;
 					if (texture->format == tex_format_rgba128)
 						tex_downsample_128((color128*)mip_data, mip_width, mip_height, (color128**)&tex_mem[index].pSysMem, &mip_width, &mip_height);
+					else if (texture->format == tex_format_rgba64f)
+						tex_downsample_64 ((uint16_t*)mip_data, mip_width, mip_height, (uint16_t**)&tex_mem[index].pSysMem, &mip_width, &mip_height);
 					else
 						tex_downsample    ((color32* )mip_data, mip_width, mip_height, (color32** )&tex_mem[index].pSysMem, &mip_width, &mip_height);
 					mip_data = (void*)tex_mem[index].pSysMem;
@@ -514,8 +569,7 @@ void tex_setsurface(tex_t texture, ID3D11Texture2D *source, DXGI_FORMAT source_f
 
 bool tex_create_views(tex_t texture, DXGI_FORMAT source_format, bool create_shader_view) {
 	DXGI_FORMAT format    = source_format == DXGI_FORMAT_UNKNOWN ? tex_get_native_format(texture->format) : source_format;
-	bool        mips      = texture->type & tex_type_mips && texture->width == texture->height && (texture->format == tex_format_rgba32 || texture->format == tex_format_rgba32_linear || texture->format == tex_format_rgba128) ;
-	uint32_t    mip_count = (uint32_t)(mips ? log2(texture->width) + 1 : 1);
+	uint32_t    mip_count = (uint32_t)(tex_has_mips(texture) ? log2(texture->width) + 1 : 1);
 
 	if (!(texture->type & tex_type_depth) && create_shader_view) {
 		D3D11_SHADER_RESOURCE_VIEW_DESC res_desc = {};
@@ -569,7 +623,7 @@ bool tex_create_views(tex_t texture, DXGI_FORMAT source_format, bool create_shad
 		}
 	}
 
-	if (texture->sampler == nullptr)
+	if (texture->sampler == state_id_none)
 		tex_set_options(texture);
 
 	return true;
@@ -586,6 +640,7 @@ DXGI_FORMAT tex_get_native_format(tex_format_ format) {
 	case tex_format_depth32:       return DXGI_FORMAT_D32_FLOAT;
 	case tex_format_depth16:       return DXGI_FORMAT_D16_UNORM;
 	case tex_format_depthstencil:  return DXGI_FORMAT_D24_UNORM_S8_UINT;
+	case tex_format_r8:            return DXGI_FORMAT_R8_UNORM;
 	default: return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
 	}
 }
@@ -601,6 +656,7 @@ size_t tex_format_size(tex_format_ format) {
 	case tex_format_rgba64:        return sizeof(uint16_t)*4;
 	case tex_format_rgba128:       return sizeof(color128);
 	case tex_format_depth16:       return sizeof(uint16_t);
+	case tex_format_r8:            return sizeof(uint8_t);
 	default: return sizeof(color32);
 	}
 }
@@ -609,6 +665,7 @@ size_t tex_format_size(tex_format_ format) {
 
 void tex_rtarget_clear(tex_t render_target, color32 color) {
 	assert(render_target->type & tex_type_rendertarget);
+	render_pipeline_sync();
 
 	if (render_target->target_view != nullptr) {
 		float colorF[4] = {
@@ -626,6 +683,7 @@ void tex_rtarget_clear(tex_t render_target, color32 color) {
 ///////////////////////////////////////////
 
 void tex_rtarget_set_active(tex_t render_target) {
+	render_pipeline_sync();
 	if (render_target == nullptr) {
 		ID3D11RenderTargetView* null_rtv = nullptr;
 		d3d_context->OMSetRenderTargets(1, &null_rtv, nullptr);
@@ -646,6 +704,8 @@ void tex_get_data(tex_t texture, void *out_data, size_t out_data_size) {
 	// Make sure we've been provided enough memory to hold this texture
 	size_t format_size = tex_format_size(texture->format);
 	assert(out_data_size == (size_t)texture->width * (size_t)texture->height * format_size);
+	render_pipeline_sync();
+	tex_upload_flush();
 
 	D3D11_TEXTURE2D_DESC desc             = {};
 	ID3D11Texture2D     *copy_tex         = nullptr;
@@ -712,7 +772,7 @@ void tex_set_resource(tex_t texture, void *surface) {
 ///////////////////////////////////////////
 
 tex_t tex_gen_cubemap(const gradient_t gradient_bot_to_top, vec3 gradient_dir, int32_t resolution, spherical_harmonics_t* sh_lighting_info) {
-	tex_t result = tex_create(tex_type_image | tex_type_cubemap, tex_format_rgba128);
+	tex_t result = tex_create(tex_type_image | tex_type_cubemap, tex_format_rgba64f);
 	if (result == nullptr) {
 		return nullptr;
 	}
@@ -727,9 +787,10 @@ tex_t tex_gen_cubemap(const gradient_t gradient_bot_to_top, vec3 gradient_dir, i
 
 	float    half_px = 0.5f / size;
 	int32_t  size2 = size * size;
-	color128*data[6];
+	color128 *face = (color128 *)malloc(size2 * sizeof(color128));
+	uint16_t *data[6];
 	for (int32_t i = 0; i < 6; i++) {
-		data[i] = (color128 *)malloc(size2 * sizeof(color128));
+		data[i] = (uint16_t *)malloc(size2 * 4 * sizeof(uint16_t));
 		vec3 p1 = math_cubemap_corner(i * 4);
 		vec3 p2 = math_cubemap_corner(i * 4+1);
 		vec3 p3 = math_cubemap_corner(i * 4+2);
@@ -756,15 +817,17 @@ tex_t tex_gen_cubemap(const gradient_t gradient_bot_to_top, vec3 gradient_dir, i
 			pt = vec3_normalize(pt);
 
 			float pct = (vec3_dot(pt, gradient_dir)+1)*0.5f;
-			data[i][x + y * size] = gradient_get(gradient_bot_to_top, pct);
+			face[x + y * size] = gradient_get(gradient_bot_to_top, pct);
 		}
 		}
+		pixel_f32_to_f16((float *)face, data[i], (size_t)size2 * 4);
 	}
 
 	tex_set_color_arr(result, (int32_t)size, (int32_t)size, (void**)data, 6, sh_lighting_info);
 	for (int32_t i = 0; i < 6; i++) {
 		free(data[i]);
 	}
+	free(face);
 
 	return result;
 }
@@ -772,7 +835,7 @@ tex_t tex_gen_cubemap(const gradient_t gradient_bot_to_top, vec3 gradient_dir, i
 ///////////////////////////////////////////
 
 tex_t tex_gen_cubemap_sh(const spherical_harmonics_t& lookup, int32_t face_size) {
-	tex_t result = tex_create(tex_type_image | tex_type_cubemap, tex_format_rgba128);
+	tex_t result = tex_create(tex_type_image | tex_type_cubemap, tex_format_rgba64f);
 	if (result == nullptr) {
 		return nullptr;
 	}
@@ -786,9 +849,10 @@ tex_t tex_gen_cubemap_sh(const spherical_harmonics_t& lookup, int32_t face_size)
 
 	float    half_px = 0.5f / size;
 	int32_t  size2 = size * size;
-	color128 *data[6];
+	color128 *face = (color128 *)malloc(size2 * sizeof(color128));
+	uint16_t *data[6];
 	for (int32_t i = 0; i < 6; i++) {
-		data[i] = (color128 *)malloc(size2 * sizeof(color128));
+		data[i] = (uint16_t *)malloc(size2 * 4 * sizeof(uint16_t));
 		vec3 p1 = math_cubemap_corner(i * 4);
 		vec3 p2 = math_cubemap_corner(i * 4+1);
 		vec3 p3 = math_cubemap_corner(i * 4+2);
@@ -814,15 +878,17 @@ tex_t tex_gen_cubemap_sh(const spherical_harmonics_t& lookup, int32_t face_size)
 				vec3 pt = vec3_lerp(pl, pr, px);
 				pt = vec3_normalize(pt);
 
-				data[i][x + y * size] = sh_lookup(lookup, pt);
+				face[x + y * size] = sh_lookup(lookup, pt);
 			}
 		}
+		pixel_f32_to_f16((float *)face, data[i], (size_t)size2 * 4);
 	}
 
 	tex_set_color_arr(result, (int32_t)size, (int32_t)size, (void**)data, 6);
 	for (int32_t i = 0; i < 6; i++) {
 		free(data[i]);
 	}
+	free(face);
 
 	return result;
 }
@@ -897,4 +963,23 @@ bool tex_downsample_128(color128 *data, int32_t width, int32_t height, color128
 	return w > 1 && h > 1;
 }
 
+///////////////////////////////////////////
+
+bool tex_downsample_64(uint16_t *data, int32_t width, int32_t height, uint16_t **out_data, int32_t *out_width, int32_t *out_height) {
+	// Averaging happens in full floats, and goes back to half after
+	size_t    count = (size_t)width * height * 4;
+	color128 *full  = (color128 *)malloc(count * sizeof(float));
+	color128 *mip   = nullptr;
+	pixel_f16_to_f32(data, (float *)full, count);
+
+	bool   result    = tex_downsample_128(full, width, height, &mip, out_width, out_height);
+	size_t mip_count = (size_t)*out_width * *out_height * 4;
+	*out_data = (uint16_t *)malloc(mip_count * sizeof(uint16_t));
+	pixel_f32_to_f16((float *)mip, *out_data, mip_count);
+
+	free(full);
+	free(mip);
+	return result;
+}
+
 } // namespace sk
\ No newline at end of file
@@ -12,9 +12,9 @@ namespace sk {
 
 ///////////////////////////////////////////
 
-vector<hierarchy_item_t> hierarchy_stack;
-bool32_t                 hierarchy_enabled     = false;
-bool32_t                 hierarchy_userenabled = true;
+thread_local vector<hierarchy_item_t> hierarchy_stack;
+thread_local bool32_t                 hierarchy_enabled     = false;
+thread_local bool32_t                 hierarchy_userenabled = true;
 
 ///////////////////////////////////////////
 
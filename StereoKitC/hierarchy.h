@@ -14,8 +14,10 @@ struct hierarchy_item_t {
 
 ///////////////////////////////////////////
 
-extern std::vector<hierarchy_item_t> hierarchy_stack;
-extern bool32_t                      hierarchy_enabled;
-extern bool32_t                      hierarchy_userenabled;
+// Each thread gets its own hierarchy, so draw submission from worker
+// threads can push and pop without stepping on the main thread.
+extern thread_local std::vector<hierarchy_item_t> hierarchy_stack;
+extern thread_local bool32_t                      hierarchy_enabled;
+extern thread_local bool32_t                      hierarchy_userenabled;
 
 }
\ No newline at end of file
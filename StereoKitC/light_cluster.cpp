@@ -0,0 +1,182 @@
+#include "light_cluster.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+inline vec3 cluster_mul_point(const matrix &m, const vec3 &pt) {
+	return {
+		pt.x*m.row[0].x + pt.y*m.row[1].x + pt.z*m.row[2].x + m.row[3].x,
+		pt.x*m.row[0].y + pt.y*m.row[1].y + pt.z*m.row[2].y + m.row[3].y,
+		pt.x*m.row[0].z + pt.y*m.row[1].z + pt.z*m.row[2].z + m.row[3].z };
+}
+
+///////////////////////////////////////////
+
+inline int32_t cluster_cell(float ndc, int32_t cells) {
+	int32_t result = (int32_t)floorf((ndc * 0.5f + 0.5f) * cells);
+	return result < 0 ? 0 : (result >= cells ? cells - 1 : result);
+}
+
+///////////////////////////////////////////
+
+inline int32_t cluster_slice(const cluster_grid_t &grid, float depth) {
+	if (depth <= grid.near_plane)
+		return 0;
+	int32_t result = (int32_t)floorf(logf(depth / grid.near_plane) * grid.depth_scale);
+	return result >= cluster_z ? cluster_z - 1 : result;
+}
+
+///////////////////////////////////////////
+
+cluster_grid_t light_cluster_grid(const matrix *views, const matrix *projections, int32_t view_count, float near_plane, float far_plane) {
+	// Views are rigid, so the camera position is -t * R^T
+	vec3 center = vec3_zero;
+	for (int32_t i = 0; i < view_count; i++) {
+		const matrix &v = views[i];
+		vec3 t = { v.row[3].x, v.row[3].y, v.row[3].z };
+		center = center - vec3{
+			t.x*v.row[0].x + t.y*v.row[0].y + t.z*v.row[0].z,
+			t.x*v.row[1].x + t.y*v.row[1].y + t.z*v.row[1].z,
+			t.x*v.row[2].x + t.y*v.row[2].y + t.z*v.row[2].z };
+	}
+	center = center / (float)view_count;
+
+	// The grid sits between all the views, looking the same way as the
+	// first, and its frustum is the union of all of them. A pixel that
+	// still lands outside of it gets clamped to the edge, and so do the
+	// lights, so nothing goes missing.
+	cluster_grid_t result = {};
+	result.view = views[0];
+	result.view.row[3] = {
+		-(center.x*views[0].row[0].x + center.y*views[0].row[1].x + center.z*views[0].row[2].x),
+		-(center.x*views[0].row[0].y + center.y*views[0].row[1].y + center.z*views[0].row[2].y),
+		-(center.x*views[0].row[0].z + center.y*views[0].row[1].z + center.z*views[0].row[2].z),
+		1 };
+
+	float left = 0, right = 0, bottom = 0, top = 0;
+	for (int32_t i = 0; i < view_count; i++) {
+		const matrix &p = projections[i];
+		float l = (-1 + p.row[2].x) / p.row[0].x, r = (1 + p.row[2].x) / p.row[0].x;
+		float b = (-1 + p.row[2].y) / p.row[1].y, t = (1 + p.row[2].y) / p.row[1].y;
+		left   = i == 0 ? l : fminf(left,   l);
+		right  = i == 0 ? r : fmaxf(right,  r);
+		bottom = i == 0 ? b : fminf(bottom, b);
+		top    = i == 0 ? t : fmaxf(top,    t);
+	}
+	result.proj = {
+		2 / (right - left),
+		2 / (top - bottom),
+		(right + left) / (right - left),
+		(top + bottom) / (top - bottom) };
+	result.near_plane  = near_plane;
+	result.far_plane   = far_plane;
+	result.depth_scale = cluster_z / logf(far_plane / near_plane);
+	return result;
+}
+
+///////////////////////////////////////////
+
+void light_cluster_bounds(cluster_bins_t &bins, const cluster_grid_t &grid, const cluster_light_t *lights, int32_t light_count) {
+	bins.min_x.resize(light_count); bins.max_x.resize(light_count);
+	bins.min_y.resize(light_count); bins.max_y.resize(light_count);
+	bins.min_z.resize(light_count); bins.max_z.resize(light_count);
+	bins.visible.clear();
+
+	for (int32_t i = 0; i < light_count; i++) {
+		vec3  pos   = cluster_mul_point(grid.view, lights[i].pos);
+		float r     = lights[i].radius;
+		float depth = -pos.z;
+		if (depth + r <= 0 || depth - r >= grid.far_plane)
+			continue;
+
+		bins.min_z[i] = (uint8_t)cluster_slice(grid, depth - r);
+		bins.max_z[i] = (uint8_t)cluster_slice(grid, depth + r);
+
+		// The light's bounding box projects widest at its near corners when
+		// it's on the outside edge, and its far corners when it's crossing
+		// the middle. Too close to the camera, it just covers everything.
+		if (depth - r <= grid.near_plane) {
+			bins.min_x[i] = 0; bins.max_x[i] = cluster_x - 1;
+			bins.min_y[i] = 0; bins.max_y[i] = cluster_y - 1;
+		} else {
+			float near_d = depth - r, far_d = depth + r;
+			float x0 = pos.x - r, x1 = pos.x + r;
+			float y0 = pos.y - r, y1 = pos.y + r;
+			bins.min_x[i] = (uint8_t)cluster_cell(grid.proj.x * x0 / (x0 < 0 ? near_d : far_d) - grid.proj.z, cluster_x);
+			bins.max_x[i] = (uint8_t)cluster_cell(grid.proj.x * x1 / (x1 > 0 ? near_d : far_d) - grid.proj.z, cluster_x);
+			bins.min_y[i] = (uint8_t)cluster_cell(grid.proj.y * y0 / (y0 < 0 ? near_d : far_d) - grid.proj.w, cluster_y);
+			bins.max_y[i] = (uint8_t)cluster_cell(grid.proj.y * y1 / (y1 > 0 ? near_d : far_d) - grid.proj.w, cluster_y);
+		}
+		bins.visible.push_back(i);
+	}
+}
+
+///////////////////////////////////////////
+
+void light_cluster_bin_slices(cluster_bins_t &bins, int32_t slice_start, int32_t slice_end) {
+	const uint32_t *visible = bins.visible.data();
+	int32_t         count   = (int32_t)bins.visible.size();
+
+	for (int32_t z = slice_start; z < slice_end; z++) {
+		cluster_cell_t *cells = &bins.cells[z * cluster_x * cluster_y];
+		memset(cells, 0, sizeof(cluster_cell_t) * cluster_x * cluster_y);
+
+		// Count first, so each cell's list can be packed together
+		for (int32_t v = 0; v < count; v++) {
+			uint32_t i = visible[v];
+			if (z < bins.min_z[i] || z > bins.max_z[i]) continue;
+			for (int32_t y = bins.min_y[i]; y <= bins.max_y[i]; y++) {
+				for (int32_t x = bins.min_x[i]; x <= bins.max_x[i]; x++)
+					cells[y * cluster_x + x].count += 1;
+			}
+		}
+
+		uint32_t total = 0;
+		for (int32_t c = 0; c < cluster_x * cluster_y; c++) {
+			cells[c].offset = total;
+			total          += cells[c].count;
+			cells[c].count  = 0;
+		}
+
+		std::vector<uint32_t> &slice = bins.slices[z];
+		slice.resize(total);
+		for (int32_t v = 0; v < count; v++) {
+			uint32_t i = visible[v];
+			if (z < bins.min_z[i] || z > bins.max_z[i]) continue;
+			for (int32_t y = bins.min_y[i]; y <= bins.max_y[i]; y++) {
+				for (int32_t x = bins.min_x[i]; x <= bins.max_x[i]; x++) {
+					cluster_cell_t &cell = cells[y * cluster_x + x];
+					slice[cell.offset + cell.count] = i;
+					cell.count += 1;
+				}
+			}
+		}
+	}
+}
+
+///////////////////////////////////////////
+
+void light_cluster_finish(cluster_bins_t &bins) {
+	size_t total = 0;
+	for (int32_t z = 0; z < cluster_z; z++)
+		total += bins.slices[z].size();
+	bins.indices.resize(total);
+
+	uint32_t offset = 0;
+	for (int32_t z = 0; z < cluster_z; z++) {
+		std::vector<uint32_t> &slice = bins.slices[z];
+		if (slice.size() > 0)
+			memcpy(&bins.indices[offset], slice.data(), sizeof(uint32_t) * slice.size());
+
+		cluster_cell_t *cells = &bins.cells[z * cluster_x * cluster_y];
+		for (int32_t c = 0; c < cluster_x * cluster_y; c++)
+			cells[c].offset += offset;
+		offset += (uint32_t)slice.size();
+	}
+}
+
+} // namespace sk
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "stereokit.h"
+
+#include <vector>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Clustered light assignment. The view frustum is cut into a grid of
+// 'froxels', exponentially spaced in depth, and each froxel gets a list of
+// the lights that might touch it. Shaders find their froxel from the world
+// position, and only loop over that list.
+//
+// This is all CPU side and renderer free. Binning happens in three steps:
+// light_cluster_bounds finds the froxel range for each light, then
+// light_cluster_bin_slices fills the lists for a range of depth slices,
+// which is safe to run on separate threads for separate slices, and
+// light_cluster_finish packs the slices into one index list.
+
+const int32_t cluster_x     = 16;
+const int32_t cluster_y     = 9;
+const int32_t cluster_z     = 24;
+const int32_t cluster_count = cluster_x * cluster_y * cluster_z;
+
+// Matches the shader's light struct, 3 float4s
+struct cluster_light_t {
+	vec3  pos;        // World space
+	float radius;     // Light has no effect past this distance
+	vec3  color;      // Linear, with intensity already multiplied in
+	float spot_cos_outer; // cos of the spot's outer half angle, -2 for point lights
+	vec3  dir;        // Spot direction
+	float spot_cos_inner;
+};
+
+struct cluster_cell_t {
+	uint32_t offset;
+	uint32_t count;
+};
+
+struct cluster_grid_t {
+	matrix view;        // World to cluster view space
+	vec4   proj;        // Projection's x scale, y scale, x offset, y offset
+	float  near_plane;
+	float  far_plane;
+	float  depth_scale; // cluster_z / log(far/near)
+};
+
+struct cluster_bins_t {
+	// Froxel range for each light, structure of arrays so the bounds pass
+	// and the slice loops stay in straight lines through memory.
+	std::vector<uint8_t>  min_x, max_x, min_y, max_y, min_z, max_z;
+	std::vector<uint32_t> visible;   // Indices of lights that touch the grid at all
+	std::vector<uint32_t> slices[cluster_z];
+	cluster_cell_t        cells[cluster_count];
+	std::vector<uint32_t> indices;
+};
+
+///////////////////////////////////////////
+
+// Builds a grid that covers all the given views, so one set of clusters can
+// serve both eyes of a stereo display.
+cluster_grid_t light_cluster_grid      (const matrix *views, const matrix *projections, int32_t view_count, float near_plane, float far_plane);
+void           light_cluster_bounds    (cluster_bins_t &bins, const cluster_grid_t &grid, const cluster_light_t *lights, int32_t light_count);
+void           light_cluster_bin_slices(cluster_bins_t &bins, int32_t slice_start, int32_t slice_end);
+void           light_cluster_finish    (cluster_bins_t &bins);
+
+} // namespace sk
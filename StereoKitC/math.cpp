@@ -94,6 +94,19 @@ matrix pose_matrix(const pose_t &pose, vec3 scale) {
 
 ///////////////////////////////////////////
 
+void pose_matrix_list(const pose_t *poses, int32_t count, matrix *out_results, vec3 scale) {
+	XMVECTOR scale_fast = math_vec3_to_fast(scale);
+	for (int32_t i = 0; i < count; i++) {
+		XMMATRIX mat = XMMatrixAffineTransformation(
+			scale_fast, DirectX::g_XMZero, 
+			math_quat_to_fast(poses[i].orientation), 
+			math_vec3_to_fast(poses[i].position));
+		math_fast_to_matrix(mat, &out_results[i]);
+	}
+}
+
+///////////////////////////////////////////
+
 bool32_t ray_intersect_plane(ray_t ray, vec3 plane_pt, vec3 plane_normal, float &out_t) {
 	float denom = vec3_dot(plane_normal, ray.dir); 
 	if (denom > 1e-6) { 
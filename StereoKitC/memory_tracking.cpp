@@ -0,0 +1,157 @@
+#include "memory_tracking.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+using namespace std;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// 16 bytes, so the memory after it keeps malloc's alignment for SIMD.
+struct memory_header_t {
+	uint64_t    size;
+	memory_tag_ tag;
+	uint32_t    pad;
+};
+
+struct memory_counter_t {
+	atomic<int64_t> bytes;
+	atomic<int64_t> bytes_peak;
+	atomic<int32_t> allocations;
+};
+
+memory_counter_t memory_counters[memory_tag_max] = {};
+
+const char *memory_tag_names[memory_tag_max] = {
+	"Assets",
+	"Render",
+	"Text",
+	"Sprites",
+	"Lines",
+	"Particles",
+	"Other",
+};
+const char *memory_asset_names[asset_type_max] = {
+	"Mesh",
+	"Texture",
+	"Shader",
+	"Material",
+	"Model",
+	"Font",
+	"Sprite",
+	"Sound",
+};
+
+///////////////////////////////////////////
+
+void memory_count(memory_tag_ tag, int64_t bytes_delta, int32_t allocation_delta) {
+	memory_counter_t &counter = memory_counters[tag];
+	int64_t bytes = counter.bytes.fetch_add(bytes_delta) + bytes_delta;
+	counter.allocations.fetch_add(allocation_delta);
+
+	int64_t peak = counter.bytes_peak.load();
+	while (bytes > peak && !counter.bytes_peak.compare_exchange_weak(peak, bytes)) {}
+}
+
+///////////////////////////////////////////
+
+void *sk_malloc(memory_tag_ tag, size_t size) {
+	memory_header_t *header = (memory_header_t *)malloc(sizeof(memory_header_t) + size);
+	if (header == nullptr) {
+		log_errf("sk_malloc: out of memory allocating %zu bytes for %s!", size, memory_tag_names[tag]);
+		return nullptr;
+	}
+	header->size = size;
+	header->tag  = tag;
+	memory_count(tag, size, 1);
+	return header + 1;
+}
+
+///////////////////////////////////////////
+
+void *sk_calloc(memory_tag_ tag, size_t count, size_t size) {
+	void *result = sk_malloc(tag, count * size);
+	if (result != nullptr)
+		memset(result, 0, count * size);
+	return result;
+}
+
+///////////////////////////////////////////
+
+void *sk_realloc(memory_tag_ tag, void *ptr, size_t size) {
+	if (ptr == nullptr)
+		return sk_malloc(tag, size);
+
+	memory_header_t *header   = (memory_header_t *)ptr - 1;
+	uint64_t         old_size = header->size;
+	memory_header_t *result   = (memory_header_t *)realloc(header, sizeof(memory_header_t) + size);
+	if (result == nullptr) {
+		log_errf("sk_realloc: out of memory allocating %zu bytes for %s!", size, memory_tag_names[header->tag]);
+		return nullptr;
+	}
+	result->size = size;
+	memory_count(result->tag, (int64_t)size - (int64_t)old_size, 0);
+	return result + 1;
+}
+
+///////////////////////////////////////////
+
+void sk_free(void *ptr) {
+	if (ptr == nullptr)
+		return;
+	memory_header_t *header = (memory_header_t *)ptr - 1;
+	memory_count(header->tag, -(int64_t)header->size, -1);
+	free(header);
+}
+
+///////////////////////////////////////////
+
+void memory_track(memory_tag_ tag, int64_t bytes_delta) {
+	if (bytes_delta != 0)
+		memory_count(tag, bytes_delta, 0);
+}
+
+///////////////////////////////////////////
+
+memory_usage_t memory_get_usage(memory_tag_ tag) {
+	memory_usage_t result = {};
+	if (tag < 0 || tag >= memory_tag_max)
+		return result;
+	result.bytes       = memory_counters[tag].bytes;
+	result.bytes_peak  = memory_counters[tag].bytes_peak;
+	result.allocations = memory_counters[tag].allocations;
+	return result;
+}
+
+///////////////////////////////////////////
+
+int64_t memory_get_total() {
+	int64_t result = 0;
+	for (int32_t i = 0; i < memory_tag_max; i++)
+		result += memory_counters[i].bytes;
+	return result;
+}
+
+///////////////////////////////////////////
+
+void memory_log() {
+	log_info("Memory usage, heap bytes by subsystem:");
+	for (int32_t i = 0; i < memory_tag_max; i++) {
+		memory_usage_t usage = memory_get_usage((memory_tag_)i);
+		log_infof("  %-10s %10.1f KB, peak %10.1f KB, %d allocations", memory_tag_names[i], usage.bytes / 1024.0, usage.bytes_peak / 1024.0, usage.allocations);
+	}
+	log_infof("  %-10s %10.1f KB", "Total", memory_get_total() / 1024.0);
+
+	log_info("Assets, with estimated GPU bytes:");
+	int64_t gpu_total = 0;
+	for (int32_t i = 0; i < asset_type_max; i++) {
+		memory_asset_usage_t usage = memory_get_asset_usage((asset_type_)i);
+		gpu_total += usage.gpu_bytes;
+		log_infof("  %-10s %5d assets, cpu %10.1f KB, gpu %10.1f KB", memory_asset_names[i], usage.count, usage.cpu_bytes / 1024.0, usage.gpu_bytes / 1024.0);
+	}
+	log_infof("  %-10s %10.1f KB", "GPU Total", gpu_total / 1024.0);
+}
+
+} // namespace sk
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "stereokit.h"
+
+#include <stddef.h>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Tagged heap allocation. Each block carries a small header with its size
+// and tag, so frees and reallocs don't need to be told either. Memory from
+// these must only ever be freed with sk_free, never plain free!
+
+void *sk_malloc (memory_tag_ tag, size_t size);
+void *sk_calloc (memory_tag_ tag, size_t count, size_t size);
+// Keeps the tag of the original block, tag is only used when ptr is null.
+void *sk_realloc(memory_tag_ tag, void *ptr, size_t size);
+void  sk_free   (void *ptr);
+
+// For memory that doesn't come from sk_malloc, like the capacity of a
+// std::vector. Owners report changes in size, so a tag's total stays
+// correct without knowing who else contributes to it.
+void  memory_track(memory_tag_ tag, int64_t bytes_delta);
+
+} // namespace sk
@@ -0,0 +1,271 @@
+#include "mesh_simplify.h"
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+using namespace std;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Symmetric 4x4 error matrix for the sum of squared distances to a set of
+// planes, weighted by triangle area. w is the total weight, so dividing by
+// it gives a mean squared distance that doesn't depend on mesh density.
+struct quadric_t {
+	double a2, b2, c2, ab, ac, bc, ad, bd, cd, d2;
+	double w;
+};
+
+struct simplify_collapse_t {
+	uint32_t src;
+	uint32_t dst;
+	double   error;
+};
+
+///////////////////////////////////////////
+
+void quadric_add_plane(quadric_t &q, vec3 normal, float dist, double weight) {
+	double a = normal.x, b = normal.y, c = normal.z, d = dist;
+	q.a2 += weight*a*a; q.b2 += weight*b*b; q.c2 += weight*c*c;
+	q.ab += weight*a*b; q.ac += weight*a*c; q.bc += weight*b*c;
+	q.ad += weight*a*d; q.bd += weight*b*d; q.cd += weight*c*d;
+	q.d2 += weight*d*d;
+	q.w  += weight;
+}
+
+///////////////////////////////////////////
+
+void quadric_add(quadric_t &to, const quadric_t &q) {
+	to.a2 += q.a2; to.b2 += q.b2; to.c2 += q.c2;
+	to.ab += q.ab; to.ac += q.ac; to.bc += q.bc;
+	to.ad += q.ad; to.bd += q.bd; to.cd += q.cd;
+	to.d2 += q.d2;
+	to.w  += q.w;
+}
+
+///////////////////////////////////////////
+
+double quadric_error(const quadric_t &q, vec3 pt) {
+	if (q.w <= 0) return 0;
+	double x = pt.x, y = pt.y, z = pt.z;
+	double result =
+		q.a2*x*x + q.b2*y*y + q.c2*z*z +
+		2*(q.ab*x*y + q.ac*x*z + q.bc*y*z) +
+		2*(q.ad*x   + q.bd*y   + q.cd*z) +
+		q.d2;
+	return fabs(result) / q.w;
+}
+
+///////////////////////////////////////////
+
+inline uint64_t simplify_edge_key(uint32_t a, uint32_t b) {
+	return a < b
+		? ((uint64_t)a << 32) | b
+		: ((uint64_t)b << 32) | a;
+}
+
+///////////////////////////////////////////
+
+// Would moving src to dst turn any of src's other triangles over, or
+// squash them flat?
+bool simplify_flips(const vert_t *verts, const uint32_t *inds, const uint32_t *tri_start, const uint32_t *tri_list, uint32_t src, uint32_t dst) {
+	vec3 dst_pos = verts[dst].pos;
+	for (uint32_t t = tri_start[src]; t < tri_start[src + 1]; t++) {
+		const uint32_t *tri = &inds[tri_list[t] * 3];
+		if (tri[0] == dst || tri[1] == dst || tri[2] == dst)
+			continue; // This one collapses away
+
+		vec3 p[3] = { verts[tri[0]].pos, verts[tri[1]].pos, verts[tri[2]].pos };
+		vec3 before = vec3_cross(p[1] - p[0], p[2] - p[0]);
+		for (int32_t i = 0; i < 3; i++) {
+			if (tri[i] == src) p[i] = dst_pos;
+		}
+		vec3 after = vec3_cross(p[1] - p[0], p[2] - p[0]);
+
+		float len = vec3_magnitude(before) * vec3_magnitude(after);
+		if (len <= 0 || vec3_dot(before, after) < 0.25f * len)
+			return true;
+	}
+	return false;
+}
+
+///////////////////////////////////////////
+
+int32_t mesh_simplify(const vert_t *verts, int32_t vert_count, const uint32_t *inds, int32_t ind_count, uint32_t *out_inds, int32_t target_ind_count, float target_error, float *out_error) {
+	memcpy(out_inds, inds, sizeof(uint32_t) * ind_count);
+	if (out_error != nullptr) *out_error = 0;
+	if (vert_count == 0 || ind_count < 3 || ind_count <= target_ind_count)
+		return ind_count;
+
+	// Size of the mesh, so errors can be relative to it
+	vec3 min = verts[0].pos, max = verts[0].pos;
+	for (int32_t i = 1; i < vert_count; i++) {
+		min = { fminf(min.x, verts[i].pos.x), fminf(min.y, verts[i].pos.y), fminf(min.z, verts[i].pos.z) };
+		max = { fmaxf(max.x, verts[i].pos.x), fmaxf(max.y, verts[i].pos.y), fmaxf(max.z, verts[i].pos.z) };
+	}
+	vec3   size       = max - min;
+	double scale      = fmax(size.x, fmax(size.y, size.z));
+	if (scale <= 0) scale = 1;
+	double error_max  = (target_error * scale) * (target_error * scale);
+	double error_curr = 0;
+
+	// Vertices sharing a position with another vertex sit on a seam, and
+	// moving them would tear the mesh apart.
+	vector<bool> locked(vert_count, false);
+	vector<uint32_t> weld(vert_count);
+	{
+		struct pos_hash_t { size_t operator()(const vec3 &v) const { uint32_t h[3]; memcpy(h, &v, sizeof(h)); return (size_t)(h[0] * 73856093u ^ h[1] * 19349663u ^ h[2] * 83492791u); } };
+		struct pos_eq_t   { bool   operator()(const vec3 &a, const vec3 &b) const { return a.x == b.x && a.y == b.y && a.z == b.z; } };
+		unordered_map<vec3, uint32_t, pos_hash_t, pos_eq_t> positions;
+		positions.reserve(vert_count);
+		for (int32_t i = 0; i < vert_count; i++) {
+			auto found = positions.find(verts[i].pos);
+			if (found == positions.end()) {
+				positions[verts[i].pos] = i;
+				weld[i] = i;
+			} else {
+				weld[i] = found->second;
+				locked[i]             = true;
+				locked[found->second] = true;
+			}
+		}
+	}
+
+	// Edges only used by one triangle are on the border of an open mesh
+	{
+		unordered_map<uint64_t, int32_t> edge_use;
+		edge_use.reserve(ind_count);
+		for (int32_t i = 0; i < ind_count; i += 3) {
+			for (int32_t e = 0; e < 3; e++)
+				edge_use[simplify_edge_key(weld[inds[i+e]], weld[inds[i+(e+1)%3]])] += 1;
+		}
+		for (int32_t i = 0; i < ind_count; i += 3) {
+			for (int32_t e = 0; e < 3; e++) {
+				uint32_t a = inds[i+e], b = inds[i+(e+1)%3];
+				if (edge_use[simplify_edge_key(weld[a], weld[b])] == 1) {
+					locked[a] = true;
+					locked[b] = true;
+				}
+			}
+		}
+	}
+
+	vector<quadric_t> quadrics(vert_count, quadric_t{});
+	for (int32_t i = 0; i < ind_count; i += 3) {
+		vec3  p0     = verts[inds[i  ]].pos;
+		vec3  p1     = verts[inds[i+1]].pos;
+		vec3  p2     = verts[inds[i+2]].pos;
+		vec3  normal = vec3_cross(p1 - p0, p2 - p0);
+		float area   = vec3_magnitude(normal);
+		if (area <= 0)
+			continue;
+		normal = normal / area;
+		for (int32_t v = 0; v < 3; v++)
+			quadric_add_plane(quadrics[inds[i+v]], normal, -vec3_dot(normal, p0), area * 0.5f);
+	}
+
+	// Collapse in passes. Each pass finds the cheapest collapses that don't
+	// touch each other, applies them, and removes the degenerate triangles.
+	vector<simplify_collapse_t> collapses;
+	vector<uint32_t>            remap    (vert_count);
+	vector<bool>                touched  (vert_count);
+	vector<uint32_t>            tri_start(vert_count + 1);
+	vector<uint32_t>            tri_list;
+	int32_t                     count = ind_count;
+	while (count > target_ind_count) {
+		collapses.clear();
+		for (int32_t i = 0; i < count; i += 3) {
+			for (int32_t e = 0; e < 3; e++) {
+				uint32_t src = out_inds[i+e], dst = out_inds[i+(e+1)%3];
+				if (!locked[src])
+					collapses.push_back({ src, dst, quadric_error(quadrics[src], verts[dst].pos) });
+			}
+		}
+		if (collapses.size() == 0)
+			break;
+		sort(collapses.begin(), collapses.end(), [](const simplify_collapse_t &a, const simplify_collapse_t &b) { return a.error < b.error; });
+
+		// Triangles around each vertex, for the flip checks
+		fill(tri_start.begin(), tri_start.end(), 0);
+		for (int32_t i = 0; i < count; i++) tri_start[out_inds[i] + 1] += 1;
+		for (int32_t i = 0; i < vert_count; i++) tri_start[i + 1] += tri_start[i];
+		tri_list.resize(count);
+		for (int32_t i = 0; i < count; i++) {
+			uint32_t &at = tri_start[out_inds[i]];
+			tri_list[at++] = i / 3;
+		}
+		for (int32_t i = vert_count; i > 0; i--) tri_start[i] = tri_start[i - 1];
+		tri_start[0] = 0;
+
+		for (int32_t i = 0; i < vert_count; i++) remap[i] = i;
+		fill(touched.begin(), touched.end(), false);
+
+		int32_t removed   = 0;
+		int32_t collapsed = 0;
+		for (size_t c = 0; c < collapses.size(); c++) {
+			const simplify_collapse_t &collapse = collapses[c];
+			if (collapse.error > error_max)
+				break;
+			if (touched[collapse.src] || touched[collapse.dst])
+				continue;
+			if (simplify_flips(verts, out_inds, tri_start.data(), tri_list.data(), collapse.src, collapse.dst))
+				continue;
+
+			remap[collapse.src] = collapse.dst;
+			quadric_add(quadrics[collapse.dst], quadrics[collapse.src]);
+			error_curr = fmax(error_curr, collapse.error);
+			collapsed += 1;
+
+			// Anything sharing a triangle with src is now stale for this pass
+			for (uint32_t t = tri_start[collapse.src]; t < tri_start[collapse.src + 1]; t++) {
+				const uint32_t *tri = &out_inds[tri_list[t] * 3];
+				touched[tri[0]] = true;
+				touched[tri[1]] = true;
+				touched[tri[2]] = true;
+				if (tri[0] == collapse.dst || tri[1] == collapse.dst || tri[2] == collapse.dst)
+					removed += 3;
+			}
+			if (count - removed <= target_ind_count)
+				break;
+		}
+		if (collapsed == 0)
+			break;
+
+		int32_t write = 0;
+		for (int32_t i = 0; i < count; i += 3) {
+			uint32_t a = remap[out_inds[i]], b = remap[out_inds[i+1]], c = remap[out_inds[i+2]];
+			if (a == b || b == c || c == a)
+				continue;
+			out_inds[write++] = (uint32_t)a;
+			out_inds[write++] = (uint32_t)b;
+			out_inds[write++] = (uint32_t)c;
+		}
+		count = write;
+	}
+
+	if (out_error != nullptr)
+		*out_error = (float)(sqrt(error_curr) / scale);
+	return count;
+}
+
+///////////////////////////////////////////
+
+int32_t mesh_simplify_compact(const vert_t *verts, int32_t vert_count, uint32_t *inds, int32_t ind_count, vert_t *out_verts) {
+	vector<uint32_t> remap(vert_count, 0xFFFFFFFF);
+	int32_t          count = 0;
+	for (int32_t i = 0; i < ind_count; i++) {
+		uint32_t &to = remap[inds[i]];
+		if (to == 0xFFFFFFFF) {
+			to = count;
+			out_verts[count] = verts[inds[i]];
+			count += 1;
+		}
+		inds[i] = (uint32_t)to;
+	}
+	return count;
+}
+
+} // namespace sk
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "stereokit.h"
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Quadric error edge collapse simplification. This only works on the CPU
+// side data, so it has no dependencies on the renderer, and is safe to call
+// from any thread. Indices are always 32 bit here, mesh_set_inds32 packs
+// them down to 16 bit when they fit.
+//
+// Vertices only ever collapse onto other existing vertices, so the results
+// are indices into the original vertex list. Vertices on open borders, or on
+// UV/normal seams (a position shared by several vertices) are left in place
+// so the silhouette and texture mapping stay intact.
+//
+// target_ind_count - stops once the mesh has this many indices or fewer.
+// target_error     - stops before any collapse that would move the surface
+//                    more than this, as a fraction of the mesh's size.
+// out_inds         - needs room for ind_count indices.
+// out_error        - optional, the largest error any collapse introduced,
+//                    as a fraction of the mesh's size.
+//
+// Returns the number of indices written to out_inds.
+int32_t mesh_simplify        (const vert_t *verts, int32_t vert_count, const uint32_t *inds, int32_t ind_count, uint32_t *out_inds, int32_t target_ind_count, float target_error, float *out_error);
+
+// Copies only the vertices referenced by inds into out_verts, and rewrites
+// inds to match. out_verts needs room for vert_count vertices. Returns the
+// number of vertices written.
+int32_t mesh_simplify_compact(const vert_t *verts, int32_t vert_count, uint32_t *inds, int32_t ind_count, vert_t *out_verts);
+
+} // namespace sk
@@ -0,0 +1,299 @@
+#include "offset_allocator.h"
+
+#include <stdlib.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Sizes are binned like a tiny float, 5 bits of exponent and 3 bits of
+// mantissa. Sizes below 8 are exact.
+const uint32_t offset_mantissa_bits  = 3;
+const uint32_t offset_mantissa_value = 1 << offset_mantissa_bits;
+const uint32_t offset_mantissa_mask  = offset_mantissa_value - 1;
+const uint32_t offset_leaf_bins      = 8;
+
+///////////////////////////////////////////
+
+inline uint32_t offset_highest_bit(uint32_t value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanReverse(&index, value);
+	return index;
+#else
+	return 31 - __builtin_clz(value);
+#endif
+}
+
+///////////////////////////////////////////
+
+inline uint32_t offset_lowest_bit(uint32_t value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return index;
+#else
+	return __builtin_ctz(value);
+#endif
+}
+
+///////////////////////////////////////////
+
+inline uint32_t offset_lowest_bit_after(uint32_t mask, uint32_t start) {
+	uint32_t masked = start >= 32 ? 0 : mask & ~((1u << start) - 1);
+	return masked == 0 ? offset_alloc_none : offset_lowest_bit(masked);
+}
+
+///////////////////////////////////////////
+
+// Rounding up is for allocation, so any range in the bin is big enough.
+// Rounding down is for storing free ranges, so the bin never overstates.
+uint32_t offset_bin_round_up(uint32_t size) {
+	if (size < offset_mantissa_value)
+		return size;
+	uint32_t highest   = offset_highest_bit(size);
+	uint32_t start     = highest - offset_mantissa_bits;
+	uint32_t exponent  = start + 1;
+	uint32_t mantissa  = (size >> start) & offset_mantissa_mask;
+	if ((size & ((1u << start) - 1)) != 0)
+		mantissa += 1;
+	// A mantissa that overflows carries into the exponent, which is right
+	return (exponent << offset_mantissa_bits) + mantissa;
+}
+
+///////////////////////////////////////////
+
+uint32_t offset_bin_round_down(uint32_t size) {
+	if (size < offset_mantissa_value)
+		return size;
+	uint32_t highest  = offset_highest_bit(size);
+	uint32_t start    = highest - offset_mantissa_bits;
+	uint32_t exponent = start + 1;
+	uint32_t mantissa = (size >> start) & offset_mantissa_mask;
+	return (exponent << offset_mantissa_bits) | mantissa;
+}
+
+///////////////////////////////////////////
+
+uint32_t offset_bin_size(uint32_t bin) {
+	uint32_t exponent = bin >> offset_mantissa_bits;
+	uint32_t mantissa = bin &  offset_mantissa_mask;
+	return exponent == 0
+		? mantissa
+		: (mantissa | offset_mantissa_value) << (exponent - 1);
+}
+
+///////////////////////////////////////////
+
+uint32_t offset_insert_node(offset_allocator_t &allocator, uint32_t offset, uint32_t size) {
+	uint32_t bin  = offset_bin_round_down(size);
+	uint32_t top  = bin / offset_leaf_bins;
+	uint32_t leaf = bin % offset_leaf_bins;
+
+	if (allocator.bin_indices[bin] == offset_alloc_none) {
+		allocator.used_bins[top] |= 1 << leaf;
+		allocator.used_bins_top  |= 1 << top;
+	}
+
+	uint32_t head  = allocator.bin_indices[bin];
+	uint32_t index = allocator.free_nodes[--allocator.free_offset];
+	allocator.nodes[index] = { offset, size, offset_alloc_none, head, offset_alloc_none, offset_alloc_none, false };
+	if (head != offset_alloc_none)
+		allocator.nodes[head].bin_prev = index;
+	allocator.bin_indices[bin] = index;
+
+	allocator.free_storage += size;
+	return index;
+}
+
+///////////////////////////////////////////
+
+void offset_remove_node(offset_allocator_t &allocator, uint32_t index) {
+	offset_node_t &node = allocator.nodes[index];
+	if (node.bin_prev != offset_alloc_none) {
+		allocator.nodes[node.bin_prev].bin_next = node.bin_next;
+		if (node.bin_next != offset_alloc_none)
+			allocator.nodes[node.bin_next].bin_prev = node.bin_prev;
+	} else {
+		// First in its bin, so the bin's head changes
+		uint32_t bin  = offset_bin_round_down(node.size);
+		uint32_t top  = bin / offset_leaf_bins;
+		uint32_t leaf = bin % offset_leaf_bins;
+		allocator.bin_indices[bin] = node.bin_next;
+		if (node.bin_next != offset_alloc_none)
+			allocator.nodes[node.bin_next].bin_prev = offset_alloc_none;
+
+		if (allocator.bin_indices[bin] == offset_alloc_none) {
+			allocator.used_bins[top] &= ~(1 << leaf);
+			if (allocator.used_bins[top] == 0)
+				allocator.used_bins_top &= ~(1u << top);
+		}
+	}
+
+	allocator.free_nodes[allocator.free_offset++] = index;
+	allocator.free_storage -= node.size;
+}
+
+///////////////////////////////////////////
+
+void offset_allocator_init(offset_allocator_t &allocator, uint32_t size, uint32_t max_allocs) {
+	allocator = {};
+	allocator.size       = size;
+	allocator.max_allocs = max_allocs;
+	allocator.nodes      = (offset_node_t *)malloc(sizeof(offset_node_t) * max_allocs);
+	allocator.free_nodes = (uint32_t      *)malloc(sizeof(uint32_t)      * max_allocs);
+	offset_allocator_reset(allocator);
+}
+
+///////////////////////////////////////////
+
+void offset_allocator_destroy(offset_allocator_t &allocator) {
+	free(allocator.nodes);
+	free(allocator.free_nodes);
+	allocator = {};
+}
+
+///////////////////////////////////////////
+
+void offset_allocator_reset(offset_allocator_t &allocator) {
+	allocator.free_storage  = 0;
+	allocator.used_bins_top = 0;
+	for (uint32_t i = 0; i < 32;  i++) allocator.used_bins  [i] = 0;
+	for (uint32_t i = 0; i < 256; i++) allocator.bin_indices[i] = offset_alloc_none;
+
+	// Popped from the back, so nodes get used from 0 up
+	allocator.free_offset = allocator.max_allocs;
+	for (uint32_t i = 0; i < allocator.max_allocs; i++)
+		allocator.free_nodes[i] = allocator.max_allocs - i - 1;
+
+	offset_insert_node(allocator, 0, allocator.size);
+}
+
+///////////////////////////////////////////
+
+offset_alloc_t offset_allocator_alloc(offset_allocator_t &allocator, uint32_t size) {
+	offset_alloc_t result = { offset_alloc_none, offset_alloc_none };
+	// A split needs a spare node for the leftovers
+	if (size == 0 || allocator.free_offset == 0)
+		return result;
+
+	// Look in the smallest bin that's certain to fit, then anything bigger
+	uint32_t min_bin  = offset_bin_round_up(size);
+	uint32_t min_top  = min_bin / offset_leaf_bins;
+	uint32_t min_leaf = min_bin % offset_leaf_bins;
+	if (min_top >= 32)
+		return result;
+
+	uint32_t top  = min_top;
+	uint32_t leaf = offset_alloc_none;
+	if (allocator.used_bins_top & (1u << top))
+		leaf = offset_lowest_bit_after(allocator.used_bins[top], min_leaf);
+	if (leaf == offset_alloc_none) {
+		top = offset_lowest_bit_after(allocator.used_bins_top, min_top + 1);
+		if (top == offset_alloc_none)
+			return result;
+		leaf = offset_lowest_bit(allocator.used_bins[top]);
+	}
+
+	uint32_t       bin   = top * offset_leaf_bins + leaf;
+	uint32_t       index = allocator.bin_indices[bin];
+	offset_node_t &node  = allocator.nodes[index];
+	uint32_t       total = node.size;
+	node.size = size;
+	node.used = true;
+
+	allocator.bin_indices[bin] = node.bin_next;
+	if (node.bin_next != offset_alloc_none)
+		allocator.nodes[node.bin_next].bin_prev = offset_alloc_none;
+	allocator.free_storage -= total;
+	if (allocator.bin_indices[bin] == offset_alloc_none) {
+		allocator.used_bins[top] &= ~(1 << leaf);
+		if (allocator.used_bins[top] == 0)
+			allocator.used_bins_top &= ~(1u << top);
+	}
+
+	// Whatever's left over goes back as a new free range, right after this
+	uint32_t remainder = total - size;
+	if (remainder > 0) {
+		uint32_t rest = offset_insert_node(allocator, node.offset + size, remainder);
+		if (node.neighbor_next != offset_alloc_none)
+			allocator.nodes[node.neighbor_next].neighbor_prev = rest;
+		allocator.nodes[rest].neighbor_prev = index;
+		allocator.nodes[rest].neighbor_next = node.neighbor_next;
+		node.neighbor_next = rest;
+	}
+
+	result.offset = node.offset;
+	result.node   = index;
+	return result;
+}
+
+///////////////////////////////////////////
+
+void offset_allocator_free(offset_allocator_t &allocator, offset_alloc_t alloc) {
+	if (alloc.node == offset_alloc_none)
+		return;
+
+	offset_node_t &node   = allocator.nodes[alloc.node];
+	uint32_t       offset = node.offset;
+	uint32_t       size   = node.size;
+
+	// Merge with any free neighbors
+	if (node.neighbor_prev != offset_alloc_none && !allocator.nodes[node.neighbor_prev].used) {
+		offset_node_t &prev = allocator.nodes[node.neighbor_prev];
+		offset  = prev.offset;
+		size   += prev.size;
+		offset_remove_node(allocator, node.neighbor_prev);
+		node.neighbor_prev = prev.neighbor_prev;
+	}
+	if (node.neighbor_next != offset_alloc_none && !allocator.nodes[node.neighbor_next].used) {
+		offset_node_t &next = allocator.nodes[node.neighbor_next];
+		size += next.size;
+		offset_remove_node(allocator, node.neighbor_next);
+		node.neighbor_next = next.neighbor_next;
+	}
+
+	uint32_t neighbor_prev = node.neighbor_prev;
+	uint32_t neighbor_next = node.neighbor_next;
+	node.used = false;
+	allocator.free_nodes[allocator.free_offset++] = alloc.node;
+
+	uint32_t merged = offset_insert_node(allocator, offset, size);
+	if (neighbor_prev != offset_alloc_none) {
+		allocator.nodes[merged       ].neighbor_prev = neighbor_prev;
+		allocator.nodes[neighbor_prev].neighbor_next = merged;
+	}
+	if (neighbor_next != offset_alloc_none) {
+		allocator.nodes[merged       ].neighbor_next = neighbor_next;
+		allocator.nodes[neighbor_next].neighbor_prev = merged;
+	}
+}
+
+///////////////////////////////////////////
+
+uint32_t offset_allocator_size_of(const offset_allocator_t &allocator, offset_alloc_t alloc) {
+	return alloc.node == offset_alloc_none
+		? 0
+		: allocator.nodes[alloc.node].size;
+}
+
+///////////////////////////////////////////
+
+void offset_allocator_free_space(const offset_allocator_t &allocator, uint32_t *out_total, uint32_t *out_largest) {
+	if (out_total)
+		*out_total = allocator.free_storage;
+	if (out_largest) {
+		*out_largest = 0;
+		if (allocator.used_bins_top != 0) {
+			uint32_t top  = offset_highest_bit(allocator.used_bins_top);
+			uint32_t leaf = offset_highest_bit(allocator.used_bins[top]);
+			*out_largest  = offset_bin_size(top * offset_leaf_bins + leaf);
+		}
+	}
+}
+
+} // namespace sk
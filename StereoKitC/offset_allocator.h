@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// A TLSF style allocator for ranges of some other memory, like a GPU buffer.
+// It only hands out offsets, and never touches the memory it manages, so
+// it doesn't care what that memory is. Free ranges are kept in 256 size
+// bins, each bin covering sizes with the same top 3 bits, and two levels of
+// bitmasks find a big enough bin in constant time. Neighbors merge right
+// away when freed.
+
+const uint32_t offset_alloc_none = 0xFFFFFFFF;
+
+struct offset_alloc_t {
+	uint32_t offset; // offset_alloc_none if the allocation failed
+	uint32_t node;
+};
+
+struct offset_node_t {
+	uint32_t offset;
+	uint32_t size;
+	uint32_t bin_prev;
+	uint32_t bin_next;
+	uint32_t neighbor_prev;
+	uint32_t neighbor_next;
+	bool     used;
+};
+
+struct offset_allocator_t {
+	uint32_t       size;
+	uint32_t       max_allocs;
+	uint32_t       free_storage;
+	uint32_t       used_bins_top;
+	uint8_t        used_bins  [32];
+	uint32_t       bin_indices[256];
+	offset_node_t *nodes;
+	uint32_t      *free_nodes;
+	uint32_t       free_offset;
+};
+
+///////////////////////////////////////////
+
+void           offset_allocator_init   (offset_allocator_t &allocator, uint32_t size, uint32_t max_allocs);
+void           offset_allocator_destroy(offset_allocator_t &allocator);
+// Forgets all allocations, the whole range is free again.
+void           offset_allocator_reset  (offset_allocator_t &allocator);
+offset_alloc_t offset_allocator_alloc  (offset_allocator_t &allocator, uint32_t size);
+void           offset_allocator_free   (offset_allocator_t &allocator, offset_alloc_t alloc);
+uint32_t       offset_allocator_size_of(const offset_allocator_t &allocator, offset_alloc_t alloc);
+// The total free space, and a lower bound on the largest single range that
+// can still be allocated. When the two drift apart, it's time to defrag.
+void           offset_allocator_free_space(const offset_allocator_t &allocator, uint32_t *out_total, uint32_t *out_largest);
+
+} // namespace sk
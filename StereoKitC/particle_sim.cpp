@@ -0,0 +1,199 @@
+#include "particle_sim.h"
+#include "memory_tracking.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <directxmath.h> // Matrix math functions and objects
+using namespace DirectX;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+const int32_t particle_soa_arrays = 8;
+
+///////////////////////////////////////////
+
+inline float particle_rand(uint32_t &seed) {
+	// xorshift32, it only needs to look random
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return (seed & 0xFFFFFF) / (float)0x1000000;
+}
+
+///////////////////////////////////////////
+
+inline vec3 particle_rand_sphere(uint32_t &seed) {
+	vec3 result;
+	do {
+		result = {
+			particle_rand(seed) * 2 - 1,
+			particle_rand(seed) * 2 - 1,
+			particle_rand(seed) * 2 - 1 };
+	} while (vec3_magnitude_sq(result) > 1);
+	return result;
+}
+
+///////////////////////////////////////////
+
+void particle_soa_resize(particle_soa_t &particles, int32_t capacity) {
+	capacity = (capacity + 3) & ~3;
+	if (capacity == particles.capacity)
+		return;
+	if (particles.count > capacity)
+		particles.count = capacity;
+
+	// All the arrays share one allocation, one after the other
+	float *data   = (float *)sk_calloc(memory_tag_particles, (size_t)capacity * particle_soa_arrays, sizeof(float));
+	float *old[]  = { particles.pos_x, particles.pos_y, particles.pos_z, particles.vel_x, particles.vel_y, particles.vel_z, particles.life, particles.life_rate };
+	float **arr[] = { &particles.pos_x, &particles.pos_y, &particles.pos_z, &particles.vel_x, &particles.vel_y, &particles.vel_z, &particles.life, &particles.life_rate };
+	for (int32_t i = 0; i < particle_soa_arrays; i++) {
+		*arr[i] = data + (size_t)capacity * i;
+		if (particles.count > 0)
+			memcpy(*arr[i], old[i], sizeof(float) * particles.count);
+	}
+	sk_free(old[0]);
+	particles.capacity = capacity;
+}
+
+///////////////////////////////////////////
+
+void particle_soa_free(particle_soa_t &particles) {
+	sk_free(particles.pos_x);
+	particles = {};
+}
+
+///////////////////////////////////////////
+
+int32_t particle_sim_spawn(particle_soa_t &particles, particle_spawn_t &spawn, int32_t count) {
+	if (count > particles.capacity - particles.count)
+		count = particles.capacity - particles.count;
+
+	vec3  velocity  = matrix_mul_direction(spawn.transform, spawn.velocity);
+	float life_span = spawn.life_max - spawn.life_min;
+	for (int32_t i = particles.count; i < particles.count + count; i++) {
+		vec3  pos  = matrix_mul_point(spawn.transform, particle_rand_sphere(spawn.seed) * spawn.radius);
+		vec3  vel  = velocity + particle_rand_sphere(spawn.seed) * spawn.velocity_spread;
+		float life = spawn.life_min + life_span * particle_rand(spawn.seed);
+		particles.pos_x    [i] = pos.x;
+		particles.pos_y    [i] = pos.y;
+		particles.pos_z    [i] = pos.z;
+		particles.vel_x    [i] = vel.x;
+		particles.vel_y    [i] = vel.y;
+		particles.vel_z    [i] = vel.z;
+		particles.life     [i] = 0;
+		particles.life_rate[i] = life > 0 ? 1.0f / life : 1000000.0f;
+	}
+	particles.count += count;
+	return count;
+}
+
+///////////////////////////////////////////
+
+void particle_sim_step(particle_soa_t &particles, const particle_step_t &step, int32_t start, int32_t end) {
+	XMVECTOR dt    = XMVectorReplicate(step.dt);
+	XMVECTOR acc_x = XMVectorReplicate(step.acceleration.x * step.dt);
+	XMVECTOR acc_y = XMVectorReplicate(step.acceleration.y * step.dt);
+	XMVECTOR acc_z = XMVectorReplicate(step.acceleration.z * step.dt);
+	XMVECTOR damp  = XMVectorReplicate(fmaxf(0, 1 - step.drag * step.dt));
+
+	// Semi-implicit Euler, velocity first, then position with the new
+	// velocity. It's cheap and stays stable with the drag term.
+	for (int32_t i = start; i < end; i += 4) {
+		XMVECTOR vel_x = XMLoadFloat4((XMFLOAT4 *)&particles.vel_x[i]);
+		XMVECTOR vel_y = XMLoadFloat4((XMFLOAT4 *)&particles.vel_y[i]);
+		XMVECTOR vel_z = XMLoadFloat4((XMFLOAT4 *)&particles.vel_z[i]);
+		vel_x = XMVectorMultiply(XMVectorAdd(vel_x, acc_x), damp);
+		vel_y = XMVectorMultiply(XMVectorAdd(vel_y, acc_y), damp);
+		vel_z = XMVectorMultiply(XMVectorAdd(vel_z, acc_z), damp);
+		XMStoreFloat4((XMFLOAT4 *)&particles.vel_x[i], vel_x);
+		XMStoreFloat4((XMFLOAT4 *)&particles.vel_y[i], vel_y);
+		XMStoreFloat4((XMFLOAT4 *)&particles.vel_z[i], vel_z);
+
+		XMStoreFloat4((XMFLOAT4 *)&particles.pos_x[i], XMVectorMultiplyAdd(vel_x, dt, XMLoadFloat4((XMFLOAT4 *)&particles.pos_x[i])));
+		XMStoreFloat4((XMFLOAT4 *)&particles.pos_y[i], XMVectorMultiplyAdd(vel_y, dt, XMLoadFloat4((XMFLOAT4 *)&particles.pos_y[i])));
+		XMStoreFloat4((XMFLOAT4 *)&particles.pos_z[i], XMVectorMultiplyAdd(vel_z, dt, XMLoadFloat4((XMFLOAT4 *)&particles.pos_z[i])));
+
+		XMVECTOR life = XMLoadFloat4((XMFLOAT4 *)&particles.life     [i]);
+		XMVECTOR rate = XMLoadFloat4((XMFLOAT4 *)&particles.life_rate[i]);
+		XMStoreFloat4((XMFLOAT4 *)&particles.life[i], XMVectorMultiplyAdd(rate, dt, life));
+	}
+}
+
+///////////////////////////////////////////
+
+int32_t particle_sim_compact(particle_soa_t &particles) {
+	int32_t  start = particles.count;
+	int32_t  i     = 0;
+	XMVECTOR one   = XMVectorSplatOne();
+	while (i < particles.count) {
+		// Most particles are alive most of the time, so skip along four at
+		// a time while nothing in the group has died.
+		if ((i & 3) == 0 && i + 4 <= particles.count) {
+			uint32_t compare;
+			XMVectorGreaterOrEqualR(&compare, XMLoadFloat4((XMFLOAT4 *)&particles.life[i]), one);
+			if (XMComparisonAllFalse(compare)) {
+				i += 4;
+				continue;
+			}
+		}
+
+		if (particles.life[i] < 1) {
+			i += 1;
+			continue;
+		}
+
+		// Move the last particle into this slot, and check it again, since
+		// it may be dead too.
+		int32_t last = particles.count - 1;
+		particles.pos_x    [i] = particles.pos_x    [last];
+		particles.pos_y    [i] = particles.pos_y    [last];
+		particles.pos_z    [i] = particles.pos_z    [last];
+		particles.vel_x    [i] = particles.vel_x    [last];
+		particles.vel_y    [i] = particles.vel_y    [last];
+		particles.vel_z    [i] = particles.vel_z    [last];
+		particles.life     [i] = particles.life     [last];
+		particles.life_rate[i] = particles.life_rate[last];
+		particles.count -= 1;
+	}
+	return start - particles.count;
+}
+
+///////////////////////////////////////////
+
+void particle_sim_instances(const particle_soa_t &particles, const particle_look_t &look, int32_t start, int32_t end, render_instance_t *out_instances) {
+	XMVECTOR right      = XMLoadFloat3((XMFLOAT3 *)&look.right);
+	XMVECTOR up         = XMLoadFloat3((XMFLOAT3 *)&look.up);
+	XMVECTOR forward    = XMLoadFloat3((XMFLOAT3 *)&look.forward);
+	XMVECTOR size_start = XMVectorReplicate(look.size_start);
+	XMVECTOR size_delta = XMVectorReplicate(look.size_end - look.size_start);
+	XMVECTOR lut_scale  = XMVectorReplicate((float)(particle_lut_size - 1));
+
+	render_instance_t *out = out_instances;
+	for (int32_t i = start; i < end; i += 4) {
+		XMVECTOR life = XMVectorSaturate(XMLoadFloat4((XMFLOAT4 *)&particles.life[i]));
+		XMFLOAT4 size, lut;
+		XMStoreFloat4(&size, XMVectorMultiplyAdd(life, size_delta, size_start));
+		XMStoreFloat4(&lut,  XMVectorMultiply   (life, lut_scale));
+
+		const float *size_f = &size.x;
+		const float *lut_f  = &lut.x;
+		int32_t      lanes  = end - i < 4 ? end - i : 4;
+		for (int32_t l = 0; l < lanes; l++) {
+			int32_t  p = i + l;
+			XMMATRIX transform;
+			transform.r[0] = XMVectorScale(right,   size_f[l]);
+			transform.r[1] = XMVectorScale(up,      size_f[l]);
+			transform.r[2] = XMVectorScale(forward, size_f[l]);
+			transform.r[3] = XMVectorSet(particles.pos_x[p], particles.pos_y[p], particles.pos_z[p], 1);
+			XMStoreFloat4x4((XMFLOAT4X4 *)&out->transform, transform);
+			out->color = look.lut[(int32_t)lut_f[l]];
+			out += 1;
+		}
+	}
+}
+
+} // namespace sk
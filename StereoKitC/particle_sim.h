@@ -0,0 +1,72 @@
+#pragma once
+
+#include "stereokit.h"
+#include "systems/render.h"
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Particle storage and update kernels. Particles are kept as a structure of
+// arrays so the kernels can step four at a time with SIMD, and there are no
+// dependencies on the renderer beyond the instance struct it writes to, so
+// all of this is safe to call from any thread, as long as no two threads
+// work on the same range of the same particle list.
+//
+// Capacity is always a multiple of 4, so kernels can run over the padding at
+// the end of the arrays without checking.
+
+const int32_t particle_lut_size = 64;
+
+struct particle_soa_t {
+	float  *pos_x, *pos_y, *pos_z;
+	float  *vel_x, *vel_y, *vel_z;
+	float  *life;      // 0 at birth, and the particle dies at 1
+	float  *life_rate; // 1/lifetime in seconds
+	int32_t count;
+	int32_t capacity;
+};
+
+struct particle_step_t {
+	vec3  acceleration;
+	float drag;
+	float dt;
+};
+
+struct particle_spawn_t {
+	matrix   transform;       // Emitter to world
+	vec3     velocity;        // In emitter space
+	float    velocity_spread;
+	float    radius;
+	float    life_min;
+	float    life_max;
+	uint32_t seed;
+};
+
+struct particle_look_t {
+	vec3     right;           // Billboard axes, usually from the head
+	vec3     up;
+	vec3     forward;
+	float    size_start;      // Half the particle's width, the quad is 2x2
+	float    size_end;
+	color128 lut[particle_lut_size]; // Color over life
+};
+
+///////////////////////////////////////////
+
+void    particle_soa_resize    (particle_soa_t &particles, int32_t capacity);
+void    particle_soa_free      (particle_soa_t &particles);
+
+// Returns the number spawned, which can be less than count if the list is
+// full. Updates spawn.seed.
+int32_t particle_sim_spawn     (particle_soa_t &particles, particle_spawn_t &spawn, int32_t count);
+// start must be a multiple of 4.
+void    particle_sim_step      (particle_soa_t &particles, const particle_step_t &step, int32_t start, int32_t end);
+// Removes dead particles, moving live ones from the end into their place.
+// Returns the number removed.
+int32_t particle_sim_compact   (particle_soa_t &particles);
+// Writes particles [start, end) to out_instances[0, end-start), start must
+// be a multiple of 4.
+void    particle_sim_instances (const particle_soa_t &particles, const particle_look_t &look, int32_t start, int32_t end, render_instance_t *out_instances);
+
+} // namespace sk
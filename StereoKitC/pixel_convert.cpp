@@ -0,0 +1,363 @@
+#include "pixel_convert.h"
+
+#include <string.h>
+#include <math.h>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define PIXEL_SSE2
+#include <emmintrin.h>
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define PIXEL_NEON
+#include <arm_neon.h>
+#endif
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Float to half is done in integer math, after "float_to_half_fast3" from
+// Fabian Giesen, since x64 only gets a hardware conversion with F16C. Both
+// directions round to nearest even, and handle denormals, inf and NaN.
+const uint32_t f16_f32_infinity = 255 << 23;
+const uint32_t f16_max          = (127 + 16) << 23;
+const uint32_t f16_denorm_magic = ((127 - 15) + (23 - 10) + 1) << 23;
+const uint32_t f16_min_normal   = 113 << 23;
+const uint32_t f16_shifted_exp  = 0x7C00 << 13;
+
+// The sRGB encode table is big enough that its steps are well under one
+// 8 bit step, even down near black where the curve is steepest.
+const int32_t  srgb_encode_size = 1 << 14;
+
+struct pixel_tables_t {
+	float   srgb_decode[256];
+	uint8_t srgb_encode[srgb_encode_size];
+
+	pixel_tables_t() {
+		for (int32_t i = 0; i < 256; i++) {
+			float c = i / 255.0f;
+			srgb_decode[i] = c <= 0.04045f
+				? c / 12.92f
+				: powf((c + 0.055f) / 1.055f, 2.4f);
+		}
+		for (int32_t i = 0; i < srgb_encode_size; i++) {
+			float c = i / (float)(srgb_encode_size - 1);
+			c = c <= 0.0031308f
+				? c * 12.92f
+				: 1.055f * powf(c, 1 / 2.4f) - 0.055f;
+			srgb_encode[i] = (uint8_t)lrintf(c * 255);
+		}
+	}
+};
+
+///////////////////////////////////////////
+
+const pixel_tables_t &pixel_tables() {
+	static pixel_tables_t tables;
+	return tables;
+}
+
+///////////////////////////////////////////
+
+inline float pixel_saturate(float value) {
+	// Written so NaN comes out as 0, like the SIMD min/max
+	value = value > 0 ? value : 0;
+	return  value < 1 ? value : 1;
+}
+
+///////////////////////////////////////////
+
+inline uint16_t pixel_f32_to_f16_1(float value) {
+	uint32_t x;
+	memcpy(&x, &value, sizeof(x));
+	uint32_t sign = x & 0x80000000;
+	x ^= sign;
+
+	uint32_t result;
+	if (x >= f16_max) {
+		result = x > f16_f32_infinity ? 0x7E00 : 0x7C00;
+	} else if (x < f16_min_normal) {
+		// Adding the magic number lines the mantissa up where a half
+		// denormal wants it, and the FPU does the rounding.
+		float f, magic;
+		memcpy(&f,     &x,                sizeof(f));
+		memcpy(&magic, &f16_denorm_magic, sizeof(magic));
+		f += magic;
+		memcpy(&result, &f, sizeof(result));
+		result -= f16_denorm_magic;
+	} else {
+		uint32_t mant_odd = (x >> 13) & 1;
+		x += ((uint32_t)(15 - 127) << 23) + 0xFFF;
+		x += mant_odd;
+		result = x >> 13;
+	}
+	return (uint16_t)(result | (sign >> 16));
+}
+
+///////////////////////////////////////////
+
+inline float pixel_f16_to_f32_1(uint16_t value) {
+	uint32_t result = (uint32_t)(value & 0x7FFF) << 13;
+	uint32_t exp    = result & f16_shifted_exp;
+	result += (uint32_t)(127 - 15) << 23;
+
+	if (exp == f16_shifted_exp) {
+		result += (uint32_t)(128 - 16) << 23;
+	} else if (exp == 0) {
+		result += 1 << 23;
+		float f, magic;
+		memcpy(&f,     &result,         sizeof(f));
+		memcpy(&magic, &f16_min_normal, sizeof(magic));
+		f -= magic;
+		memcpy(&result, &f, sizeof(result));
+	}
+	result |= (uint32_t)(value & 0x8000) << 16;
+
+	float f;
+	memcpy(&f, &result, sizeof(f));
+	return f;
+}
+
+///////////////////////////////////////////
+
+void pixel_u8_to_f32(const uint8_t *src, float *dest, size_t count) {
+	const float scale = 1 / 255.0f;
+	size_t      i     = 0;
+#if defined(PIXEL_SSE2)
+	const __m128  scale4 = _mm_set1_ps(scale);
+	const __m128i zero   = _mm_setzero_si128();
+	for (; i + 16 <= count; i += 16) {
+		__m128i bytes = _mm_loadu_si128((const __m128i *)(src + i));
+		__m128i lo    = _mm_unpacklo_epi8(bytes, zero);
+		__m128i hi    = _mm_unpackhi_epi8(bytes, zero);
+		_mm_storeu_ps(dest + i,      _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale4));
+		_mm_storeu_ps(dest + i + 4,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale4));
+		_mm_storeu_ps(dest + i + 8,  _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale4));
+		_mm_storeu_ps(dest + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale4));
+	}
+#elif defined(PIXEL_NEON)
+	const float32x4_t scale4 = vdupq_n_f32(scale);
+	for (; i + 16 <= count; i += 16) {
+		uint8x16_t bytes = vld1q_u8(src + i);
+		uint16x8_t lo    = vmovl_u8(vget_low_u8 (bytes));
+		uint16x8_t hi    = vmovl_u8(vget_high_u8(bytes));
+		vst1q_f32(dest + i,      vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16 (lo))), scale4));
+		vst1q_f32(dest + i + 4,  vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), scale4));
+		vst1q_f32(dest + i + 8,  vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16 (hi))), scale4));
+		vst1q_f32(dest + i + 12, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), scale4));
+	}
+#endif
+	for (; i < count; i++)
+		dest[i] = src[i] * scale;
+}
+
+///////////////////////////////////////////
+
+void pixel_f32_to_u8(const float *src, uint8_t *dest, size_t count) {
+	size_t i = 0;
+#if defined(PIXEL_SSE2)
+	const __m128 zero  = _mm_setzero_ps();
+	const __m128 one   = _mm_set1_ps(1);
+	const __m128 scale = _mm_set1_ps(255);
+	for (; i + 16 <= count; i += 16) {
+		__m128i v[4];
+		for (int32_t j = 0; j < 4; j++) {
+			__m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + j * 4), zero), one);
+			v[j] = _mm_cvtps_epi32(_mm_mul_ps(value, scale));
+		}
+		__m128i shorts_lo = _mm_packs_epi32(v[0], v[1]);
+		__m128i shorts_hi = _mm_packs_epi32(v[2], v[3]);
+		_mm_storeu_si128((__m128i *)(dest + i), _mm_packus_epi16(shorts_lo, shorts_hi));
+	}
+#elif defined(PIXEL_NEON)
+	const float32x4_t zero  = vdupq_n_f32(0);
+	const float32x4_t one   = vdupq_n_f32(1);
+	const float32x4_t scale = vdupq_n_f32(255);
+	for (; i + 8 <= count; i += 8) {
+		// The nm versions of min/max pick the number over a NaN
+		float32x4_t a = vminnmq_f32(vmaxnmq_f32(vld1q_f32(src + i    ), zero), one);
+		float32x4_t b = vminnmq_f32(vmaxnmq_f32(vld1q_f32(src + i + 4), zero), one);
+		uint16x8_t  shorts = vcombine_u16(
+			vqmovun_s32(vcvtnq_s32_f32(vmulq_f32(a, scale))),
+			vqmovun_s32(vcvtnq_s32_f32(vmulq_f32(b, scale))));
+		vst1_u8(dest + i, vqmovn_u16(shorts));
+	}
+#endif
+	for (; i < count; i++)
+		dest[i] = (uint8_t)lrintf(pixel_saturate(src[i]) * 255);
+}
+
+///////////////////////////////////////////
+
+void pixel_f32_to_f16(const float *src, uint16_t *dest, size_t count) {
+	size_t i = 0;
+#if defined(PIXEL_SSE2)
+	const __m128i sign_mask    = _mm_set1_epi32((int32_t)0x80000000);
+	const __m128i one          = _mm_set1_epi32(1);
+	const __m128i denorm_magic = _mm_set1_epi32((int32_t)f16_denorm_magic);
+	const __m128i min_normal   = _mm_set1_epi32((int32_t)f16_min_normal);
+	const __m128i max_normal   = _mm_set1_epi32((int32_t)f16_max - 1);
+	const __m128i infinity     = _mm_set1_epi32((int32_t)f16_f32_infinity);
+	const __m128i rebias       = _mm_set1_epi32((int32_t)(((uint32_t)(15 - 127) << 23) + 0xFFF));
+	const __m128i half_inf     = _mm_set1_epi32(0x7C00);
+	const __m128i half_nan_bit = _mm_set1_epi32(0x0200);
+	for (; i + 8 <= count; i += 8) {
+		__m128i halves[2];
+		for (int32_t j = 0; j < 2; j++) {
+			__m128i x    = _mm_castps_si128(_mm_loadu_ps(src + i + j * 4));
+			__m128i sign = _mm_and_si128(x, sign_mask);
+			x = _mm_xor_si128(x, sign);
+
+			// Work out every case, then pick. With the sign gone, the
+			// signed compares are fine.
+			__m128i denorm = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(x), _mm_castsi128_ps(denorm_magic))), denorm_magic);
+			__m128i normal = _mm_add_epi32(_mm_add_epi32(x, rebias), _mm_and_si128(_mm_srli_epi32(x, 13), one));
+			normal = _mm_srli_epi32(normal, 13);
+			__m128i big    = _mm_or_si128(half_inf, _mm_and_si128(_mm_cmpgt_epi32(x, infinity), half_nan_bit));
+
+			__m128i is_denorm = _mm_cmplt_epi32(x, min_normal);
+			__m128i is_big    = _mm_cmpgt_epi32(x, max_normal);
+			__m128i result    = _mm_or_si128(_mm_and_si128(is_denorm, denorm), _mm_andnot_si128(is_denorm, normal));
+			result = _mm_or_si128(_mm_and_si128(is_big, big), _mm_andnot_si128(is_big, result));
+			result = _mm_or_si128(result, _mm_srli_epi32(sign, 16));
+
+			// SSE2 can only pack with signed saturation, so sign extend the
+			// bottom 16 bits first to keep the bit pattern intact.
+			halves[j] = _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+		}
+		_mm_storeu_si128((__m128i *)(dest + i), _mm_packs_epi32(halves[0], halves[1]));
+	}
+#elif defined(PIXEL_NEON)
+	for (; i + 4 <= count; i += 4)
+		vst1_u16(dest + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+#endif
+	for (; i < count; i++)
+		dest[i] = pixel_f32_to_f16_1(src[i]);
+}
+
+///////////////////////////////////////////
+
+void pixel_f16_to_f32(const uint16_t *src, float *dest, size_t count) {
+	size_t i = 0;
+#if defined(PIXEL_SSE2)
+	const __m128i zero        = _mm_setzero_si128();
+	const __m128i value_mask  = _mm_set1_epi32(0x7FFF);
+	const __m128i sign_mask   = _mm_set1_epi32(0x8000);
+	const __m128i shifted_exp = _mm_set1_epi32((int32_t)f16_shifted_exp);
+	const __m128i rebias      = _mm_set1_epi32((127 - 15) << 23);
+	const __m128i infnan_bias = _mm_set1_epi32((128 - 16) << 23);
+	const __m128i denorm_bias = _mm_set1_epi32(1 << 23);
+	const __m128  min_normal  = _mm_castsi128_ps(_mm_set1_epi32((int32_t)f16_min_normal));
+	for (; i + 8 <= count; i += 8) {
+		__m128i shorts = _mm_loadu_si128((const __m128i *)(src + i));
+		__m128i h[2]   = { _mm_unpacklo_epi16(shorts, zero), _mm_unpackhi_epi16(shorts, zero) };
+		for (int32_t j = 0; j < 2; j++) {
+			__m128i result = _mm_slli_epi32(_mm_and_si128(h[j], value_mask), 13);
+			__m128i exp    = _mm_and_si128(result, shifted_exp);
+			result = _mm_add_epi32(result, rebias);
+
+			__m128i is_infnan = _mm_cmpeq_epi32(exp, shifted_exp);
+			__m128i is_denorm = _mm_cmpeq_epi32(exp, zero);
+			result = _mm_add_epi32(result, _mm_and_si128(is_infnan, infnan_bias));
+			__m128i denorm = _mm_castps_si128(_mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(result, denorm_bias)), min_normal));
+			result = _mm_or_si128(_mm_and_si128(is_denorm, denorm), _mm_andnot_si128(is_denorm, result));
+			result = _mm_or_si128(result, _mm_slli_epi32(_mm_and_si128(h[j], sign_mask), 16));
+			_mm_storeu_ps(dest + i + j * 4, _mm_castsi128_ps(result));
+		}
+	}
+#elif defined(PIXEL_NEON)
+	for (; i + 4 <= count; i += 4)
+		vst1q_f32(dest + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+#endif
+	for (; i < count; i++)
+		dest[i] = pixel_f16_to_f32_1(src[i]);
+}
+
+///////////////////////////////////////////
+
+void pixel_srgb_to_linear(const uint8_t *src, float *dest, size_t pixel_count) {
+	// A table lookup per channel is already about as cheap as this gets,
+	// there's nothing for SIMD to do here without a gather.
+	const float *decode = pixel_tables().srgb_decode;
+	const float  scale  = 1 / 255.0f;
+	for (size_t i = 0; i < pixel_count * 4; i += 4) {
+		dest[i    ] = decode[src[i    ]];
+		dest[i + 1] = decode[src[i + 1]];
+		dest[i + 2] = decode[src[i + 2]];
+		dest[i + 3] = src[i + 3] * scale;
+	}
+}
+
+///////////////////////////////////////////
+
+void pixel_linear_to_srgb(const float *src, uint8_t *dest, size_t pixel_count) {
+	// Color channels scale to an index in the encode table, and alpha
+	// scales straight to 0-255, all four in one go.
+	const uint8_t *encode = pixel_tables().srgb_encode;
+	const float    steps  = (float)(srgb_encode_size - 1);
+	size_t         i      = 0;
+#if defined(PIXEL_SSE2)
+	const __m128 zero  = _mm_setzero_ps();
+	const __m128 one   = _mm_set1_ps(1);
+	const __m128 scale = _mm_setr_ps(steps, steps, steps, 255);
+	for (; i < pixel_count * 4; i += 4) {
+		__m128  value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), zero), one);
+		int32_t index[4];
+		_mm_storeu_si128((__m128i *)index, _mm_cvtps_epi32(_mm_mul_ps(value, scale)));
+		dest[i    ] = encode[index[0]];
+		dest[i + 1] = encode[index[1]];
+		dest[i + 2] = encode[index[2]];
+		dest[i + 3] = (uint8_t)index[3];
+	}
+#elif defined(PIXEL_NEON)
+	const float32x4_t zero  = vdupq_n_f32(0);
+	const float32x4_t one   = vdupq_n_f32(1);
+	const float       scale_arr[4] = { steps, steps, steps, 255 };
+	const float32x4_t scale = vld1q_f32(scale_arr);
+	for (; i < pixel_count * 4; i += 4) {
+		float32x4_t value = vminnmq_f32(vmaxnmq_f32(vld1q_f32(src + i), zero), one);
+		int32_t     index[4];
+		vst1q_s32(index, vcvtnq_s32_f32(vmulq_f32(value, scale)));
+		dest[i    ] = encode[index[0]];
+		dest[i + 1] = encode[index[1]];
+		dest[i + 2] = encode[index[2]];
+		dest[i + 3] = (uint8_t)index[3];
+	}
+#endif
+	for (; i < pixel_count * 4; i += 4) {
+		dest[i    ] = encode[lrintf(pixel_saturate(src[i    ]) * steps)];
+		dest[i + 1] = encode[lrintf(pixel_saturate(src[i + 1]) * steps)];
+		dest[i + 2] = encode[lrintf(pixel_saturate(src[i + 2]) * steps)];
+		dest[i + 3] = (uint8_t)lrintf(pixel_saturate(src[i + 3]) * 255);
+	}
+}
+
+///////////////////////////////////////////
+
+void pixel_r8_to_rgba32(const uint8_t *src, color32 *dest, size_t count) {
+	size_t i = 0;
+#if defined(PIXEL_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 16 <= count; i += 16) {
+		__m128i bytes = _mm_loadu_si128((const __m128i *)(src + i));
+		__m128i lo    = _mm_unpacklo_epi8(bytes, zero);
+		__m128i hi    = _mm_unpackhi_epi8(bytes, zero);
+		_mm_storeu_si128((__m128i *)(dest + i),      _mm_unpacklo_epi16(lo, zero));
+		_mm_storeu_si128((__m128i *)(dest + i + 4),  _mm_unpackhi_epi16(lo, zero));
+		_mm_storeu_si128((__m128i *)(dest + i + 8),  _mm_unpacklo_epi16(hi, zero));
+		_mm_storeu_si128((__m128i *)(dest + i + 12), _mm_unpackhi_epi16(hi, zero));
+	}
+#elif defined(PIXEL_NEON)
+	uint8x16x4_t pixels;
+	pixels.val[1] = vdupq_n_u8(0);
+	pixels.val[2] = vdupq_n_u8(0);
+	pixels.val[3] = vdupq_n_u8(0);
+	for (; i + 16 <= count; i += 16) {
+		pixels.val[0] = vld1q_u8(src + i);
+		vst4q_u8((uint8_t *)(dest + i), pixels);
+	}
+#endif
+	for (; i < count; i++)
+		dest[i] = color32{ src[i], 0, 0, 0 };
+}
+
+} // namespace sk
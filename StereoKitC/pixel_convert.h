@@ -0,0 +1,30 @@
+#pragma once
+
+#include "stereokit.h"
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Bulk pixel format conversions. Each has an SSE2 version on x64, NEON on
+// ARM64, and a plain version everywhere else, and they all round the same
+// way, so results don't depend on the platform (NaN payloads aside).
+//
+// Unless noted otherwise, count is the number of values, not pixels, so an
+// rgba image is width * height * 4. Float to 8 bit clamps to 0-1 first, and
+// rounds to nearest.
+
+void pixel_u8_to_f32     (const uint8_t  *src, float    *dest, size_t count);
+void pixel_f32_to_u8     (const float    *src, uint8_t  *dest, size_t count);
+void pixel_f32_to_f16    (const float    *src, uint16_t *dest, size_t count);
+void pixel_f16_to_f32    (const uint16_t *src, float    *dest, size_t count);
+
+// These work on whole rgba pixels, and leave alpha linear. Encoding goes
+// through a table, and lands within one 8 bit step of the exact curve.
+void pixel_srgb_to_linear(const uint8_t  *src, float    *dest, size_t pixel_count);
+void pixel_linear_to_srgb(const float    *src, uint8_t  *dest, size_t pixel_count);
+
+// Single channel to the red channel of a color32, with the rest left 0.
+void pixel_r8_to_rgba32  (const uint8_t  *src, color32  *dest, size_t count);
+
+} // namespace sk
@@ -0,0 +1,111 @@
+#include "pose_predict.h"
+
+#include <math.h>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Hamilton product, a*b applies b first, then a. Kept local so the
+// prediction math doesn't depend on DirectXMath's argument ordering.
+inline quat pose_predict_quat_mul(const quat &a, const quat &b) {
+	return quat{
+		a.w*b.x + a.x*b.w + a.y*b.z - a.z*b.y,
+		a.w*b.y - a.x*b.z + a.y*b.w + a.z*b.x,
+		a.w*b.z + a.x*b.y - a.y*b.x + a.z*b.w,
+		a.w*b.w - a.x*b.x - a.y*b.y - a.z*b.z };
+}
+
+///////////////////////////////////////////
+
+inline quat pose_predict_quat_norm(const quat &a) {
+	float mag = sqrtf(a.x*a.x + a.y*a.y + a.z*a.z + a.w*a.w);
+	if (mag <= 0) return quat_identity;
+	return quat{ a.x/mag, a.y/mag, a.z/mag, a.w/mag };
+}
+
+///////////////////////////////////////////
+
+vec3 quat_angular_velocity(const quat &from, const quat &to, float seconds) {
+	if (seconds <= 0)
+		return vec3_zero;
+
+	// World space delta, such that to = delta * from
+	quat delta = pose_predict_quat_mul(to, quat{ -from.x, -from.y, -from.z, from.w });
+	delta = pose_predict_quat_norm(delta);
+	// q and -q are the same rotation, we want the short way around
+	if (delta.w < 0)
+		delta = quat{ -delta.x, -delta.y, -delta.z, -delta.w };
+
+	vec3  axis  = { delta.x, delta.y, delta.z };
+	float sin_h = vec3_magnitude(axis);
+	// Small angles would divide by ~0, but sin(x) ~= x there, so just use it directly
+	if (sin_h < 0.00001f)
+		return axis * (2.0f / seconds);
+	float angle = 2 * atan2f(sin_h, delta.w);
+	return axis * (angle / (sin_h * seconds));
+}
+
+///////////////////////////////////////////
+
+pose_t pose_extrapolate(const pose_t &pose, vec3 velocity, vec3 angular_velocity, float seconds) {
+	pose_t result;
+	result.position = pose.position + velocity * seconds;
+
+	vec3  rotation = angular_velocity * seconds;
+	float angle    = vec3_magnitude(rotation);
+	if (angle < 0.00001f) {
+		result.orientation = pose.orientation;
+		return result;
+	}
+	vec3  axis  = rotation / angle;
+	float sin_h = sinf(angle * 0.5f);
+	quat  delta = { axis.x*sin_h, axis.y*sin_h, axis.z*sin_h, cosf(angle * 0.5f) };
+	result.orientation = pose_predict_quat_norm(pose_predict_quat_mul(delta, pose.orientation));
+	return result;
+}
+
+///////////////////////////////////////////
+
+void pose_predictor_reset(pose_predictor_t &predictor, float smoothing, float max_ahead) {
+	predictor = {};
+	predictor.pose.orientation = quat_identity;
+	predictor.smoothing        = fminf(fmaxf(smoothing, 0), 0.99f);
+	predictor.max_ahead        = max_ahead;
+}
+
+///////////////////////////////////////////
+
+void pose_predictor_add(pose_predictor_t &predictor, const pose_t &pose, double time) {
+	float dt = (float)(time - predictor.time);
+	if (predictor.sample_count > 0 && dt > 0) {
+		vec3 velocity         = (pose.position - predictor.pose.position) / dt;
+		vec3 angular_velocity = quat_angular_velocity(predictor.pose.orientation, pose.orientation, dt);
+
+		// The first delta has no history to blend with
+		float keep = predictor.sample_count > 1 ? predictor.smoothing : 0;
+		predictor.velocity         = vec3_lerp(velocity,         predictor.velocity,         keep);
+		predictor.angular_velocity = vec3_lerp(angular_velocity, predictor.angular_velocity, keep);
+	} else if (predictor.sample_count > 0 && dt < 0) {
+		// Time went backwards, that's not a sample we can learn anything from
+		return;
+	}
+
+	predictor.pose  = pose;
+	predictor.time  = time;
+	if (dt != 0 || predictor.sample_count == 0)
+		predictor.sample_count += 1;
+}
+
+///////////////////////////////////////////
+
+pose_t pose_predictor_at(const pose_predictor_t &predictor, double time) {
+	if (predictor.sample_count < 2)
+		return predictor.pose;
+
+	float ahead = (float)(time - predictor.time);
+	ahead = fminf(fmaxf(ahead, -predictor.max_ahead), predictor.max_ahead);
+	return pose_extrapolate(predictor.pose, predictor.velocity, predictor.angular_velocity, ahead);
+}
+
+} // namespace sk
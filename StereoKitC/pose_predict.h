@@ -0,0 +1,31 @@
+#pragma once
+
+#include "stereokit.h"
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Tracks a pose over time, and extrapolates it forward using its linear
+// and angular velocity. This is all plain CPU math with no dependencies on
+// the device or runtime, so it's easy to poke at in isolation!
+struct pose_predictor_t {
+	pose_t   pose;
+	double   time;
+	vec3     velocity;         // meters per second
+	vec3     angular_velocity; // axis * radians per second, world space
+	float    smoothing;        // 0 uses only the newest sample, approaching 1 favors history
+	float    max_ahead;        // seconds, predictions further out than this are clamped
+	int32_t  sample_count;
+};
+
+///////////////////////////////////////////
+
+void   pose_predictor_reset (pose_predictor_t &predictor, float smoothing = 0.5f, float max_ahead = 0.1f);
+void   pose_predictor_add   (pose_predictor_t &predictor, const pose_t &pose, double time);
+pose_t pose_predictor_at    (const pose_predictor_t &predictor, double time);
+
+pose_t pose_extrapolate     (const pose_t &pose, vec3 velocity, vec3 angular_velocity, float seconds);
+vec3   quat_angular_velocity(const quat &from, const quat &to, float seconds);
+
+} // namespace sk
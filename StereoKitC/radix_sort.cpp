@@ -0,0 +1,46 @@
+#include "radix_sort.h"
+
+#include <string.h>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+sort_key_t *radix_sort(sort_key_t *keys, sort_key_t *scratch, size_t count) {
+	if (count == 0)
+		return keys;
+
+	// All the histograms can be gathered in a single read of the keys
+	uint32_t counts[8][256];
+	memset(counts, 0, sizeof(counts));
+	for (size_t i = 0; i < count; i++) {
+		uint64_t key = keys[i].key;
+		for (int32_t b = 0; b < 8; b++)
+			counts[b][(key >> (b * 8)) & 0xFF] += 1;
+	}
+
+	sort_key_t *src = keys;
+	sort_key_t *dst = scratch;
+	for (int32_t b = 0; b < 8; b++) {
+		uint32_t *hist  = counts[b];
+		int32_t   shift = b * 8;
+		if (hist[(src[0].key >> shift) & 0xFF] == count)
+			continue;
+
+		uint32_t offsets[256];
+		uint32_t total = 0;
+		for (int32_t i = 0; i < 256; i++) {
+			offsets[i] = total;
+			total     += hist[i];
+		}
+		for (size_t i = 0; i < count; i++)
+			dst[offsets[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+		sort_key_t *tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+	return src;
+}
+
+} // namespace sk
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct sort_key_t {
+	uint64_t key;
+	uint32_t index;
+};
+
+// Stable LSD radix sort on the 64 bit keys, 8 bits at a time. Passes where
+// every key has the same byte are skipped, so keys that only use a few of
+// their bits only pay for those. scratch needs room for count keys. Returns
+// whichever of keys or scratch ends up holding the sorted result.
+sort_key_t *radix_sort(sort_key_t *keys, sort_key_t *scratch, size_t count);
+
+} // namespace sk
@@ -7,4 +7,5 @@ extern const char *sk_shader_builtin_unlit;
 extern const char *sk_shader_builtin_equirect;
 extern const char *sk_shader_builtin_font;
 extern const char *sk_shader_builtin_lines;
-extern const char *sk_shader_builtin_ui;
\ No newline at end of file
+extern const char *sk_shader_builtin_ui;
+extern const char *sk_shader_builtin_nv12;
\ No newline at end of file
@@ -43,7 +43,7 @@ struct psIn {
 Texture2D tex : register(t0);
 SamplerState tex_sampler;
 
-psIn vs(vsIn input, uint id : SV_InstanceID) {
+psIn vs(vsIn input, uint id : SK_INSTANCE) {
 	psIn output;
 	float3 world = mul(float4(input.pos.xyz, 1), sk_inst[id].world).xyz;
 	output.pos   = mul(float4(world,         1), sk_viewproj[sk_inst[id].view_id]);
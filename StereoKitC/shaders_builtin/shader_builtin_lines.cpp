@@ -39,7 +39,7 @@ struct psIn {
 Texture2D tex : register(t0);
 SamplerState tex_sampler;
 
-psIn vs(vsIn input, uint id : SV_InstanceID) {
+psIn vs(vsIn input, uint id : SK_INSTANCE) {
 	psIn output;
 	float4 view  = mul(float4(input.pos.xyz, 1), sk_viewproj[sk_inst[id].view_id]);
 	float3 norm  = mul(float4(input.norm,0), sk_viewproj[sk_inst[id].view_id]).xyz;
@@ -0,0 +1,70 @@
+const char* sk_shader_builtin_nv12 = R"_(
+// [name] sk/blit/nv12_convert
+cbuffer GlobalBuffer : register(b0) {
+	float4x4 sk_view[2];
+	float4x4 sk_proj[2];
+	float4x4 sk_viewproj[2];
+	float3   sk_lighting_sh[9];
+	float4   sk_camera_pos[2];
+	float4   sk_camera_dir[2];
+	float4   sk_fingertip[2];
+	float    sk_time;
+};
+cbuffer TransformBuffer : register(b1) {
+	float sk_width;
+	float sk_height;
+	float sk_pixel_width;
+	float sk_pixel_height;
+};
+
+cbuffer ParamBuffer : register(b2) {
+	// [param] float limited_range 1
+	float limited_range;
+};
+struct vsIn {
+	float4 pos : SV_POSITION;
+	float2 uv : TEXCOORD0;
+};
+struct psIn {
+	float4 pos : SV_POSITION;
+};
+
+// The whole NV12 image as a single channel texture: a full size luma plane,
+// followed by a half height plane of interleaved U,V pairs.
+// [texture] source white
+Texture2D source : register(t0);
+SamplerState source_sampler;
+
+psIn vs(vsIn input) {
+	psIn output;
+	output.pos = input.pos;
+	return output;
+}
+
+float3 ToLinear(float3 srgb) {
+	return srgb <= 0.04045
+		? srgb / 12.92
+		: pow((srgb + 0.055) / 1.055, 2.4);
+}
+
+float4 ps(psIn input) : SV_TARGET{
+	int2 px     = int2(input.pos.xy);
+	int2 chroma = int2(px.x & ~1, (int)sk_height + px.y / 2);
+
+	float  y  = source.Load(int3(px, 0)).r;
+	float2 uv = float2(
+		source.Load(int3(chroma,                   0)).r,
+		source.Load(int3(chroma.x + 1, chroma.y,   0)).r) - 128.0/255.0;
+	if (limited_range > 0) {
+		y  = (y - 16.0/255.0) * (255.0/219.0);
+		uv = uv * (255.0/224.0);
+	}
+
+	// BT.709, which is what HD video is almost always encoded with
+	float3 rgb = float3(
+		y                 + 1.5748 * uv.y,
+		y - 0.1873 * uv.x - 0.4681 * uv.y,
+		y + 1.8556 * uv.x);
+	return float4(ToLinear(saturate(rgb)), 1);
+}
+)_";
@@ -8,6 +8,9 @@ cbuffer GlobalBuffer : register(b0) {
 	float4   sk_camera_dir[2];
 	float4   sk_fingertip[2];
 	float    sk_time;
+	float4x4 sk_cluster_view;
+	float4   sk_cluster_proj;
+	float4   sk_cluster_depth;
 };
 struct Inst {
 	float4x4 world;
@@ -20,6 +23,18 @@ cbuffer TransformBuffer : register(b1) {
 TextureCube sk_cubemap : register(t11);
 SamplerState tex_cube_sampler;
 
+struct Light {
+	float3 pos;
+	float  radius;
+	float3 color;
+	float  spot_cos_outer;
+	float3 dir;
+	float  spot_cos_inner;
+};
+StructuredBuffer<Light> sk_lights          : register(t12);
+StructuredBuffer<uint2> sk_cluster_cells   : register(t13);
+StructuredBuffer<uint>  sk_cluster_indices : register(t14);
+
 cbuffer ParamBuffer : register(b2) {
 	// [param] color color {1,1,1,1}
 	float4 _color;
@@ -74,6 +89,7 @@ float DistributionGGX(float3 normal, float3 half_vec, float roughness);
 float GeometrySchlickGGX(float NdotV, float roughness);
 float GeometrySmith(float NdotL, float NdotV, float roughness);
 float3 FresnelSchlick(float NdotV, float3 surfaceColor, float metalness);
+float3 DirectLighting(float3 world, float3 normal, float3 view, float3 albedo, float metal, float rough);
 
 // A spherical harmonics lighting lookup!
 // Some calculations have been offloaded to 'sh_to_fast'
@@ -98,7 +114,7 @@ float3 Lighting(float3 normal) {
 	return result;
 }
 
-psIn vs(vsIn input, uint id : SV_InstanceID) {
+psIn vs(vsIn input, uint id : SK_INSTANCE) {
 	psIn output;
 	output.world = mul(float4(input.pos.xyz, 1), sk_inst[id].world).xyz;
 	output.pos   = mul(float4(output.world,  1), sk_viewproj[sk_inst[id].view_id]);
@@ -187,10 +203,63 @@ float4 ps(psIn input) : SV_TARGET{
 	// Combine it all together
 	float3 diffuse = (albedo*irradiance);
 	float3 ambient = diffuse_contribution * diffuse + reflection_color*F;
-	float3 reflectance = ambient;// + (diffuse_contribution * albedo / 3.14159) * sk_light_color.rgb * saturate(NdotL);
+	float3 reflectance = ambient + DirectLighting(input.world, normal, view, albedo, metal, rough);
 	return float4(reflectance + emissive, _color.a);
 }
 
+// Which light cluster this world position falls in. This has to match
+// light_cluster.cpp in StereoKitC exactly! Positions outside the grid get
+// clamped to its edge, and the lights are binned the same way.
+uint ClusterIndex(float3 world) {
+	float3 pos   = mul(float4(world, 1), sk_cluster_view).xyz;
+	float  depth = max(-pos.z, sk_cluster_depth.x);
+	float2 ndc   = float2(
+		sk_cluster_proj.x * pos.x / depth - sk_cluster_proj.z,
+		sk_cluster_proj.y * pos.y / depth - sk_cluster_proj.w);
+	uint x = (uint)clamp(floor((ndc.x * 0.5 + 0.5) * 16), 0, 15);
+	uint y = (uint)clamp(floor((ndc.y * 0.5 + 0.5) * 9),  0, 8);
+	uint z = (uint)clamp(floor(log(depth / sk_cluster_depth.x) * sk_cluster_depth.y), 0, 23);
+	return (z * 9 + y) * 16 + x;
+}
+
+// Point and spot lights from the cluster this pixel is in, with the same
+// BRDF as the ambient above.
+float3 DirectLighting(float3 world, float3 normal, float3 view, float3 albedo, float metal, float rough) {
+	if (sk_cluster_depth.z <= 0)
+		return 0;
+
+	float3 result = 0;
+	float  NdotV  = max(dot(normal, view), 0.0001);
+	uint2  cell   = sk_cluster_cells[ClusterIndex(world)];
+	[loop]
+	for (uint i = 0; i < cell.y; i++) {
+		Light  light    = sk_lights[sk_cluster_indices[cell.x + i]];
+		float3 to_light = light.pos - world;
+		float  dist_sq  = dot(to_light, to_light);
+		if (dist_sq >= light.radius * light.radius)
+			continue;
+
+		// Inverse square, smoothly windowed to zero at the radius
+		float3 light_dir = to_light * rsqrt(dist_sq);
+		float  window    = saturate(1 - pow(dist_sq / (light.radius * light.radius), 2));
+		float  atten     = (window * window) / max(dist_sq, 0.0001);
+		if (light.spot_cos_outer > -1) {
+			float spot = saturate((dot(-light_dir, light.dir) - light.spot_cos_outer) / max(light.spot_cos_inner - light.spot_cos_outer, 0.0001));
+			atten *= spot * spot;
+		}
+
+		float  NdotL    = saturate(dot(normal, light_dir));
+		float3 half_vec = normalize(light_dir + view);
+		float  D        = DistributionGGX(normal, half_vec, rough);
+		float3 F        = FresnelSchlick(max(dot(half_vec, view), 0), albedo, metal);
+		float  G        = GeometrySmith(NdotL, NdotV, rough);
+		float3 specular = (D * G * F) / max(4 * NdotL * NdotV, 0.0001);
+		float3 diffuse  = (1 - F) * (1 - metal) * albedo / 3.14159;
+		result += (diffuse + specular) * light.color * (atten * NdotL);
+	}
+	return result;
+}
+
 // From: http://chilliant.blogspot.com/2012/08/srgb-approximations-for-hlsl.html
 float3 sRGBToLinear(float3 sRGB) {
 	return sRGB * (sRGB * (sRGB * 0.305306011 + 0.682171111) + 0.012522878);
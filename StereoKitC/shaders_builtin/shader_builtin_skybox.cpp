@@ -39,7 +39,7 @@ struct psOut {
     float  depth : SV_Depth;
 };
 
-psIn vs(vsIn input, uint id : SV_InstanceID) {
+psIn vs(vsIn input, uint id : SK_INSTANCE) {
 	psIn output;
 	output.pos     = mul(float4(input.pos.xyz, 0), sk_viewproj[sk_inst[id].view_id]);
 	output.view_id = sk_inst[id].view_id;
@@ -65,7 +65,7 @@ float3 Lighting(float3 normal) {
 	return result;
 }
 
-psIn vs(vsIn input, uint id : SV_InstanceID) {
+psIn vs(vsIn input, uint id : SK_INSTANCE) {
 	psIn output;
 	output.world = mul(input .pos,   sk_inst[id].world);
 	output.pos   = mul(output.world, sk_viewproj[sk_inst[id].view_id]);
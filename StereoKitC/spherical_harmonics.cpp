@@ -1,12 +1,12 @@
 #include "spherical_harmonics.h"
 #include "math.h"
 #include "asset_types/texture.h"
+#include "pixel_convert.h"
 
-namespace sk {
-
+#include <stdlib.h>
+#include <string.h>
 
-vec3 to_color_128(uint8_t *color) { return *(vec3 *)color; }
-vec3 to_color_32 (uint8_t *color) { return vec3{color[0]/255.f,color[1]/255.f,color[2]/255.f}; }
+namespace sk {
 
 ///////////////////////////////////////////
 
@@ -42,11 +42,9 @@ void sh_add(spherical_harmonics_t &to, vec3 light_dir, color128 light_color) {
 ///////////////////////////////////////////
 
 spherical_harmonics_t sh_calculate(void **env_map_data, tex_format_ format, int32_t face_size) {
-	spherical_harmonics_t result = {};
-	size_t   col_size            = tex_format_size(format);
-	vec3   (*convert)(uint8_t *) = format == tex_format_rgba128 ?
-		to_color_128 :
-		to_color_32;
+	spherical_harmonics_t result   = {};
+	size_t                row_size = tex_format_size(format) * face_size;
+	float                *row      = (float *)malloc(sizeof(float) * 4 * face_size);
 
 	float half_px = 0.5f / face_size;
 	for (int32_t i = 0; i < 6; i++) {
@@ -63,6 +61,15 @@ spherical_harmonics_t sh_calculate(void **env_map_data, tex_format_ format, int3
 			if (i == 2) {
 				py = 1 - py;
 			}
+
+			// Each row goes to float colors in one go
+			uint8_t *row_data = &data[y * row_size];
+			switch (format) {
+			case tex_format_rgba128: memcpy(row, row_data, row_size); break;
+			case tex_format_rgba64f: pixel_f16_to_f32((uint16_t *)row_data, row, (size_t)face_size * 4); break;
+			default:                 pixel_u8_to_f32 (row_data,             row, (size_t)face_size * 4); break;
+			}
+
 			for (int32_t x = 0; x < face_size; x++) {
 				float px = x / (float)face_size + half_px;
 
@@ -76,7 +83,7 @@ spherical_harmonics_t sh_calculate(void **env_map_data, tex_format_ format, int3
 				vec3 pt = vec3_lerp(pl, pr, px);
 				pt = vec3_normalize(pt);
 
-				vec3 color = convert(&data[(x + y * face_size) * col_size]);
+				vec3 color = { row[x*4], row[x*4+1], row[x*4+2] };
 
 				// From here:
 				// https://graphics.stanford.edu/papers/envmap/envmap.pdf
@@ -93,6 +100,8 @@ spherical_harmonics_t sh_calculate(void **env_map_data, tex_format_ format, int3
 		}
 	}
 
+	free(row);
+
 	float count = face_size * face_size * 6.f;
 	for (size_t i = 0; i < 9; i++)
 		result.coefficients[i] /= count;
@@ -3,6 +3,7 @@
 #include "_stereokit_ui.h"
 
 #include "systems/render.h"
+#include "systems/render_pipeline.h"
 #include "systems/d3d.h"
 #include "systems/input.h"
 #include "systems/physics.h"
@@ -10,11 +11,15 @@
 #include "systems/text.h"
 #include "systems/sprite_drawer.h"
 #include "systems/line_drawer.h"
+#include "systems/particles.h"
+#include "systems/job_pool.h"
 #include "systems/defaults.h"
+#include "systems/vfs.h"
 #include "systems/platform/platform.h"
 #include "asset_types/sound.h"
+#include "asset_types/assets.h"
 
-#include <thread> // sleep_for
+#include <thread> // sleep_for, get_id
 using namespace std;
 
 #include <chrono>
@@ -33,7 +38,8 @@ system_info_t sk_info     = {};
 bool32_t      sk_focused  = true;
 bool32_t      sk_run      = true;
 
-bool sk_initialized = false;
+bool       sk_initialized = false;
+thread::id sk_main_thread_id;
 
 double  sk_timev_scale = 1;
 float   sk_timevf = 0;
@@ -94,6 +100,7 @@ bool32_t sk_init(const char *app_name, runtime_ runtime_preference, bool32_t fal
 	sk_runtime          = runtime_preference;
 	sk_runtime_fallback = fallback;
 	sk_app_name         = app_name;
+	sk_main_thread_id   = this_thread::get_id();
 
 	log_diagf("Initializing StereoKit v%s...", sk_version_name());
 
@@ -103,8 +110,16 @@ bool32_t sk_init(const char *app_name, runtime_ runtime_preference, bool32_t fal
 	sk_update_timer();
 
 	systems_add("Graphics", nullptr, 0, nullptr, 0, d3d_init, d3d_update, d3d_shutdown);
+	systems_add("Jobs",     nullptr, 0, nullptr, 0, job_pool_init, nullptr, job_pool_shutdown);
 
-	const char *default_deps[] = {"Graphics"};
+	const char *assets_deps[] = {"Graphics"};
+	const char *assets_update_deps[] = {"FramePresent"};
+	systems_add("Assets",
+		assets_deps,        _countof(assets_deps),
+		assets_update_deps, _countof(assets_update_deps),
+		nullptr, assets_update, assets_shutdown);
+
+	const char *default_deps[] = {"Graphics", "Assets"};
 	systems_add("Defaults", default_deps, _countof(default_deps), nullptr, 0, defaults_init, nullptr, defaults_shutdown);
 
 	const char *ui_deps       [] = {"Defaults"};
@@ -117,14 +132,13 @@ bool32_t sk_init(const char *app_name, runtime_ runtime_preference, bool32_t fal
 	const char *platform_deps[] = {"Graphics", "Defaults"};
 	systems_add("Platform", platform_deps, _countof(platform_deps), nullptr, 0, platform_init, nullptr, platform_shutdown);
 
-	const char *physics_deps[] = {"Defaults"};
 	const char *physics_update_deps[] = {"Input", "FrameBegin"};
 	systems_add("Physics",  
-		physics_deps,        _countof(physics_deps), 
+		nullptr,             0, 
 		physics_update_deps, _countof(physics_update_deps), 
 		physics_init, physics_update, physics_shutdown);
 
-	const char *renderer_deps[] = {"Graphics", "Defaults"};
+	const char *renderer_deps[] = {"Graphics", "Defaults", "Jobs"};
 	const char *renderer_update_deps[] = {"Physics", "FrameBegin"};
 	systems_add("Renderer",  
 		renderer_deps,        _countof(renderer_deps), 
@@ -166,14 +180,28 @@ bool32_t sk_init(const char *app_name, runtime_ runtime_preference, bool32_t fal
 		line_update_deps, _countof(line_update_deps), 
 		line_drawer_init, line_drawer_update, line_drawer_shutdown);
 
+	const char *particle_deps[] = {"Defaults", "Jobs"};
+	const char *particle_update_deps[] = {"App"};
+	systems_add("Particles",  
+		particle_deps,        _countof(particle_deps), 
+		particle_update_deps, _countof(particle_update_deps), 
+		particles_init, particles_update, particles_shutdown);
+
 	const char *app_deps[] = {"Input", "Defaults", "FrameBegin", "Graphics", "Physics", "Renderer", "UI"};
 	systems_add("App", nullptr, 0, app_deps, _countof(app_deps), nullptr, sk_app_update, nullptr);
 
 	systems_add("FrameBegin", nullptr, 0, nullptr, 0, nullptr, platform_begin_frame, nullptr);
-	const char *platform_end_deps[] = {"App", "Text", "Sprites", "Lines"};
-	systems_add("FrameRender",   nullptr, 0, platform_end_deps, _countof(platform_end_deps), nullptr, platform_end_frame,   nullptr);
+	const char *platform_end_init_deps[] = {"Platform", "Renderer"};
+	const char *platform_end_deps[] = {"App", "Text", "Sprites", "Lines", "Particles"};
+	systems_add("FrameRender",   platform_end_init_deps, _countof(platform_end_init_deps), platform_end_deps, _countof(platform_end_deps), render_pipeline_init, render_pipeline_frame, render_pipeline_shutdown);
 	const char *platform_present_deps[] = {"FrameRender"};
-	systems_add("FramePresent", nullptr, 0, platform_present_deps, _countof(platform_present_deps), nullptr, platform_present,   nullptr);
+	systems_add("FramePresent", nullptr, 0, platform_present_deps, _countof(platform_present_deps), nullptr, render_pipeline_present, nullptr);
+
+	// These don't touch the graphics device or the window, so they can start
+	// up on another thread while the main thread does the ones that do.
+	systems_set_init_any_thread("Jobs");
+	systems_set_init_any_thread("Physics");
+	systems_set_init_any_thread("Sound");
 
 	sk_initialized = systems_initialize();
 	return sk_initialized;
@@ -183,6 +211,7 @@ bool32_t sk_init(const char *app_name, runtime_ runtime_preference, bool32_t fal
 
 void sk_shutdown() {
 	systems_shutdown();
+	vfs_shutdown    ();
 	sk_initialized = false;
 }
 
@@ -207,6 +236,12 @@ bool32_t sk_step(void (*app_update)(void)) {
 
 ///////////////////////////////////////////
 
+bool sk_on_main_thread() {
+	return this_thread::get_id() == sk_main_thread_id;
+}
+
+///////////////////////////////////////////
+
 void sk_update_timer() {
 	time_point<high_resolution_clock> now = high_resolution_clock::now();
 	sk_timev_raw = duration_cast<nanoseconds>(now.time_since_epoch()).count();
@@ -41,11 +41,12 @@ enum runtime_ {
 };
 
 struct settings_t {
-	int32_t flatscreen_pos_x;
-	int32_t flatscreen_pos_y;
-	int32_t flatscreen_width;
-	int32_t flatscreen_height;
-	char assets_folder[128];
+	int32_t  flatscreen_pos_x;
+	int32_t  flatscreen_pos_y;
+	int32_t  flatscreen_width;
+	int32_t  flatscreen_height;
+	char     assets_folder[128];
+	bool32_t render_pipelined;
 };
 
 enum display_ {
@@ -167,6 +168,7 @@ SK_API vec3 quat_mul_vec    (const quat &a, const vec3 &b);
 
 SK_API matrix pose_matrix(const pose_t &pose, vec3 scale = {1,1,1});
 SK_API void   pose_matrix_out(const pose_t &pose, matrix &out_result, vec3 scale = {1,1,1});
+SK_API void   pose_matrix_list(const pose_t *poses, int32_t count, matrix *out_results, vec3 scale = {1,1,1});
 
 SK_API void   matrix_inverse      (const matrix &a, matrix &out_matrix);
 SK_API void   matrix_mul          (const matrix &a, const matrix &b, matrix &out_matrix);
@@ -274,6 +276,8 @@ struct vert_t {
 	color32 col;
 };
 
+// This is only the width the API takes indices in. Each mesh picks 16 or 32
+// bit on the GPU for itself, depending on whether its indices fit in 16.
 #ifdef SK_32BIT_INDICES
 typedef uint32_t vind_t;
 #else
@@ -288,6 +292,8 @@ SK_API void     mesh_set_id       (mesh_t mesh, const char *id);
 SK_API void     mesh_release      (mesh_t mesh);
 SK_API void     mesh_set_verts    (mesh_t mesh, vert_t *vertices, int32_t vertex_count, bool32_t calculate_bounds = true);
 SK_API void     mesh_set_inds     (mesh_t mesh, vind_t *indices,  int32_t index_count);
+SK_API void     mesh_set_inds16   (mesh_t mesh, const uint16_t *indices, int32_t index_count);
+SK_API void     mesh_set_inds32   (mesh_t mesh, const uint32_t *indices, int32_t index_count);
 SK_API void     mesh_set_draw_inds(mesh_t mesh, int32_t index_count);
 SK_API void     mesh_set_bounds   (mesh_t mesh, const bounds_t &bounds);
 SK_API bounds_t mesh_get_bounds   (mesh_t mesh);
@@ -319,6 +325,8 @@ enum tex_format_ {
 	tex_format_depthstencil,
 	tex_format_depth32,
 	tex_format_depth16,
+	tex_format_r8,
+	tex_format_rgba64f = tex_format_rgba64,
 };
 
 enum tex_sample_ {
@@ -344,6 +352,8 @@ SK_API void  tex_set_id              (tex_t texture, const char *id);
 SK_API void  tex_release             (tex_t texture);
 SK_API void  tex_set_colors          (tex_t texture, int32_t width, int32_t height, void *data);
 SK_API void  tex_set_color_arr       (tex_t texture, int32_t width, int32_t height, void** data, int32_t data_count, spherical_harmonics_t *sh_lighting_info = nullptr);
+SK_API void  tex_set_colors_region   (tex_t texture, int32_t x, int32_t y, int32_t width, int32_t height, const void *data, int32_t stride = 0);
+SK_API void  tex_set_colors_nv12     (tex_t texture, int32_t width, int32_t height, const void *data, int32_t stride = 0);
 SK_API tex_t tex_add_zbuffer         (tex_t texture, tex_format_ format = tex_format_depthstencil);
 SK_API void  tex_rtarget_clear       (tex_t render_target, color32 color);
 SK_API void  tex_rtarget_set_active  (tex_t render_target);
@@ -383,6 +393,7 @@ SK_API const char *shader_get_name    (shader_t shader);
 SK_API bool32_t    shader_set_code    (shader_t shader, const char *hlsl, const char *filename = nullptr);
 SK_API bool32_t    shader_set_codefile(shader_t shader, const char *filename);
 SK_API void        shader_release     (shader_t shader);
+SK_API int32_t     shader_get_inst_offset(shader_t shader, const char *name);
 
 ///////////////////////////////////////////
 
@@ -449,6 +460,17 @@ SK_API text_style_t text_make_style(font_t font, float character_height, materia
 SK_API void         text_add_at    (const char *text, const matrix& transform, text_style_t style = -1, text_align_ position = text_align_x_center | text_align_y_center, text_align_ align = text_align_x_center | text_align_y_center, float off_x = 0, float off_y = 0, float off_z = 0);
 SK_API vec2         text_size      (const char *text, text_style_t style = -1);
 
+struct text_span_t {
+	const char  *text; // null terminated ASCII, same as text_add_at
+	matrix       transform;
+	text_style_t style;
+	text_align_  position;
+	text_align_  align;
+	vec3         offset;
+};
+
+SK_API void         text_add_list  (const text_span_t *spans, int32_t count);
+
 ///////////////////////////////////////////
 
 enum solid_type_ {
@@ -471,6 +493,7 @@ SK_API void    solid_teleport        (solid_t solid, const vec3 &position, const
 SK_API void    solid_set_velocity    (solid_t solid, const vec3 &meters_per_second);
 SK_API void    solid_set_velocity_ang(solid_t solid, const vec3 &radians_per_second);
 SK_API void    solid_get_pose        (const solid_t solid, pose_t &out_pose);
+SK_API void    solid_get_poses       (const solid_t *solids, int32_t count, pose_t *out_poses);
 
 ///////////////////////////////////////////
 
@@ -486,6 +509,9 @@ SK_API int32_t    model_subset_count(model_t model);
 SK_API void       model_release     (model_t model);
 SK_API void       model_set_bounds  (model_t model, const bounds_t &bounds);
 SK_API bounds_t   model_get_bounds  (model_t model);
+SK_API int32_t    model_add_lod     (model_t model, int32_t subset, mesh_t mesh, float screen_size);
+SK_API int32_t    model_lod_count   (model_t model, int32_t subset);
+SK_API void       model_set_auto_lod(int32_t lod_count, float triangle_ratio = 0.5f);
 
 ///////////////////////////////////////////
 
@@ -508,6 +534,37 @@ SK_API void     sprite_draw       (sprite_t sprite, const matrix &transform, col
 
 ///////////////////////////////////////////
 
+struct particle_emitter_t {
+	float rate;            // New particles per second, while the particles are being drawn
+	float life_min;        // Seconds
+	float life_max;
+	vec3  velocity;        // Starting velocity, in the emitter's space
+	float velocity_spread; // Random speed added in any direction, meters/second
+	vec3  acceleration;    // In world space, gravity goes here
+	float drag;            // Fraction of velocity lost each second
+	float radius;          // Particles start somewhere in this sphere around the emitter
+	float size_start;      // Width in meters
+	float size_end;
+};
+
+// A particle system keeps its own particles, and only simulates while it's
+// being drawn, so particles_draw should be called every frame, like the
+// rest of the draw functions. Simulation happens once per frame, after the
+// app's update, using the last transform it was drawn at. Unlike assets,
+// particle systems aren't shared or found by id, each one belongs to
+// whoever created it, and particles_release frees it right away.
+SK_DeclarePrivateType(particles_t);
+
+SK_API particles_t particles_create     (int32_t max_particles, const particle_emitter_t &emitter, material_t material = nullptr);
+SK_API void        particles_set_emitter(particles_t particles, const particle_emitter_t &emitter);
+SK_API void        particles_set_colors (particles_t particles, gradient_t color_over_life);
+SK_API void        particles_burst      (particles_t particles, int32_t count);
+SK_API void        particles_draw       (particles_t particles, const matrix &transform);
+SK_API int32_t     particles_count      (particles_t particles);
+SK_API void        particles_release    (particles_t particles);
+
+///////////////////////////////////////////
+
 struct line_point_t {
 	vec3    pt;
 	float   thickness;
@@ -518,9 +575,45 @@ SK_API void line_add      (vec3 start, vec3 end, color32 color, float thickness)
 SK_API void line_addv     (line_point_t start, line_point_t end);
 SK_API void line_add_list (const vec3 *points, int32_t count, color32 color, float thickness);
 SK_API void line_add_listv(const line_point_t *points, int32_t count);
+SK_API void line_add_segments(const line_point_t *start_end_pairs, int32_t segment_count);
 
 ///////////////////////////////////////////
 
+struct render_mesh_cmd_t {
+	mesh_t     mesh;
+	material_t material;
+	matrix     transform;
+	color128   color;
+};
+
+// Counts for a single drawn frame. Uploads include anything sent to the
+// GPU while the frame was drawing, on any thread.
+struct render_stats_t {
+	int32_t queue_items;      // Items in the render queue, an instanced batch counts once
+	int32_t batches;          // Runs of items sharing a material and mesh
+	int32_t draw_calls;
+	int32_t instances;        // Instances drawn, counted once per view
+	int64_t triangles;        // Triangles drawn, counted once per view
+	int32_t lights;
+	int32_t swaps_mesh;
+	int32_t swaps_shader;
+	int32_t swaps_texture;
+	int32_t swaps_material;
+	int64_t upload_mesh_bytes;
+	int64_t upload_texture_bytes;
+	int64_t upload_constant_bytes;
+	int64_t upload_instance_bytes;
+	int64_t upload_light_bytes;
+	int32_t buffer_reallocs;  // GPU buffers and textures re-created to change their size
+};
+
+// A command buffer is a list of draws that can be built on any thread, and
+// then appended to the render queue in bulk with render_cmdbuf_submit. Each
+// buffer should only be touched by one thread at a time. The buffer holds a
+// reference to each draw's mesh and material until it's cleared or released,
+// so it's fine to release them while the buffer still uses them.
+SK_DeclarePrivateType(render_cmdbuf_t);
+
 SK_API void     render_set_clip      (float near_plane=0.01f, float far_plane=50);
 SK_API void     render_set_view      (const matrix &cam_transform);
 SK_API void     render_set_skytex    (tex_t sky_texture);
@@ -528,11 +621,33 @@ SK_API tex_t    render_get_skytex    ();
 SK_API void     render_set_skylight  (const spherical_harmonics_t &light_info);
 SK_API void     render_enable_skytex (bool32_t show_sky);
 SK_API bool32_t render_enabled_skytex();
+SK_API void     render_enable_opaque_sort (bool32_t front_to_back);
+SK_API bool32_t render_enabled_opaque_sort();
+SK_API void     render_enable_batching    (bool32_t enabled);
+SK_API bool32_t render_enabled_batching   ();
 SK_API void     render_add_mesh      (mesh_t mesh, material_t material, const matrix &transform, color128 color = {1,1,1,1});
+SK_API void     render_add_mesh_data (mesh_t mesh, material_t material, const matrix &transform, color128 color, vec4 inst_data);
 SK_API void     render_add_model     (model_t model, const matrix &transform, color128 color = {1,1,1,1});
+SK_API void     render_add_mesh_list (const render_mesh_cmd_t *commands, int32_t count);
+SK_API void     render_add_mesh_instances (mesh_t mesh, material_t material, const matrix *transforms, const color128 *colors, int32_t count);
+SK_API void     render_add_model_instances(model_t model, const matrix *transforms, const color128 *colors, int32_t count);
+SK_API void     render_add_mesh_head (mesh_t mesh, material_t material, const matrix &head_transform, color128 color = {1,1,1,1});
+SK_API void     render_add_model_head(model_t model, const matrix &head_transform, color128 color = {1,1,1,1});
+SK_API void     render_add_light     (vec3 position, float radius, color128 color, float intensity = 1);
+SK_API void     render_add_light_spot(vec3 position, vec3 direction, float radius, float angle_inner, float angle_outer, color128 color, float intensity = 1);
 SK_API void     render_blit          (tex_t to_rendertarget, material_t material);
 SK_API void     render_screenshot    (vec3 from_viewpt, vec3 at, int width, int height, const char *file);
 SK_API void     render_get_device    (void **device, void **context);
+SK_API render_stats_t render_get_stats        ();
+SK_API int32_t        render_get_stats_history(render_stats_t *out_history, int32_t max_count);
+
+SK_API render_cmdbuf_t render_cmdbuf_create  (int32_t capacity = 0);
+SK_API void            render_cmdbuf_release (render_cmdbuf_t cmdbuf);
+SK_API void            render_cmdbuf_clear   (render_cmdbuf_t cmdbuf);
+SK_API int32_t         render_cmdbuf_count   (render_cmdbuf_t cmdbuf);
+SK_API void            render_cmdbuf_add_mesh(render_cmdbuf_t cmdbuf, mesh_t mesh, material_t material, const matrix &transform, color128 color = {1,1,1,1});
+SK_API void            render_cmdbuf_add_list(render_cmdbuf_t cmdbuf, const render_mesh_cmd_t *commands, int32_t count);
+SK_API void            render_cmdbuf_submit  (render_cmdbuf_t cmdbuf);
 
 ///////////////////////////////////////////
 
@@ -551,6 +666,60 @@ SK_API quat     hierarchy_to_world_rotation (const quat &local_orientation);
 
 ///////////////////////////////////////////
 
+// Archives are packed collections of asset files, memory mapped on mount.
+// Once mounted, any asset loaded by a relative filename is looked for in
+// the mounted archives first, newest mount first, and falls back to loose
+// files in the assets folder.
+SK_API bool32_t vfs_mount(const char *archive_file);
+SK_API bool32_t vfs_pack (const char *archive_file, const char **files, int32_t file_count);
+
+///////////////////////////////////////////
+
+enum asset_type_ {
+	asset_type_mesh = 0,
+	asset_type_texture,
+	asset_type_shader,
+	asset_type_material,
+	asset_type_model,
+	asset_type_font,
+	asset_type_sprite,
+	asset_type_sound,
+	asset_type_max,
+};
+
+// Heap memory is counted by the subsystem that asked for it, for anything
+// that goes through StereoKit's own allocators. Asset GPU bytes are
+// estimated from the size and format of their buffers and textures.
+enum memory_tag_ {
+	memory_tag_assets = 0,
+	memory_tag_render,
+	memory_tag_text,
+	memory_tag_sprites,
+	memory_tag_lines,
+	memory_tag_particles,
+	memory_tag_other,
+	memory_tag_max,
+};
+
+struct memory_usage_t {
+	int64_t bytes;
+	int64_t bytes_peak;
+	int32_t allocations;
+};
+
+struct memory_asset_usage_t {
+	int32_t count;
+	int64_t cpu_bytes;
+	int64_t gpu_bytes;
+};
+
+SK_API memory_usage_t       memory_get_usage      (memory_tag_ tag);
+SK_API memory_asset_usage_t memory_get_asset_usage(asset_type_ type);
+SK_API int64_t              memory_get_total      ();
+SK_API void                 memory_log            ();
+
+///////////////////////////////////////////
+
 SK_DeclarePrivateType(sound_t);
 
 SK_API sound_t sound_find    (const char *id);
@@ -646,6 +815,7 @@ SK_API int           input_pointer_count(input_source_ filter = input_source_any
 SK_API pointer_t     input_pointer      (int32_t index, input_source_ filter = input_source_any);
 SK_API const hand_t &input_hand         (handed_ hand);
 SK_API const pose_t &input_head         ();
+SK_API pose_t        input_head_predict (float seconds_ahead);
 SK_API const mouse_t&input_mouse        ();
 SK_API button_state_ input_key          (key_ key);
 SK_API void          input_hand_visible (handed_ hand, bool32_t visible);
@@ -1,33 +1,37 @@
 #include "defaults.h"
-#include "../stereokit.h"
+#include "../libraries/stref.h"
+#include "../asset_types/assets.h"
 #include "../shaders_builtin/shader_builtin.h"
 
 #include <string.h>
+#include <mutex>
+#include <chrono>
+using namespace std;
+using namespace std::chrono;
 
 namespace sk {
 
 ///////////////////////////////////////////
 
-tex_t        sk_default_tex;
-tex_t        sk_default_tex_black;
-tex_t        sk_default_tex_gray;
-tex_t        sk_default_tex_flat;
-tex_t        sk_default_tex_rough;
+struct default_asset_t {
+	const char  *id;
+	asset_type_  type;
+	void      *(*create)(void);
+	uint64_t     hash;
+	void        *asset;
+	bool         attempted;
+	int64_t      create_duration; // Not counting other defaults it pulled in
+};
+
 tex_t        sk_default_cubemap;
-mesh_t       sk_default_quad;
-shader_t     sk_default_shader;
-shader_t     sk_default_shader_pbr;
-shader_t     sk_default_shader_unlit;
-shader_t     sk_default_shader_font;
-shader_t     sk_default_shader_equirect;
-shader_t     sk_default_shader_ui;
-material_t   sk_default_material;
-material_t   sk_default_material_equirect;
-material_t   sk_default_material_font;
-material_t   sk_default_material_ui;
-font_t       sk_default_font;
 text_style_t sk_default_text_style;
 
+// Creating one default can look up others, like a material finding its
+// shader, so this needs to be recursive.
+recursive_mutex defaults_lock;
+bool            defaults_active;
+int64_t         defaults_nested_duration;
+
 ///////////////////////////////////////////
 
 tex_t defaults_texture(const char *id, color32 color) {
@@ -46,22 +50,129 @@ tex_t defaults_texture(const char *id, color32 color) {
 
 ///////////////////////////////////////////
 
-bool defaults_init() {
+shader_t defaults_shader(const char *id, const char *hlsl) {
+	shader_t result = shader_create(hlsl);
+	if (result == nullptr)
+		return nullptr;
+	shader_set_id(result, id);
+	return result;
+}
+
+///////////////////////////////////////////
+
+material_t defaults_material(const char *id, const char *shader_id) {
+	shader_t shader = shader_find(shader_id);
+	if (shader == nullptr)
+		return nullptr;
+	material_t result = material_create(shader);
+	shader_release(shader);
+	if (result == nullptr)
+		return nullptr;
+	material_set_id(result, id);
+	return result;
+}
+
+///////////////////////////////////////////
+
+default_asset_t defaults_list[] = {
 	// Textures
-	sk_default_tex       = defaults_texture("default/tex",       {255,255,255,255});
-	sk_default_tex_black = defaults_texture("default/tex_black", {0,0,0,255}      );
-	sk_default_tex_gray  = defaults_texture("default/tex_gray",  {128,128,128,255});
-	sk_default_tex_flat  = defaults_texture("default/tex_flat",  {128,128,255,255}); // Default for normal maps
-	sk_default_tex_rough = defaults_texture("default/tex_rough", {0,0,255,255}    ); // Default for metal/roughness maps
-
-	if (sk_default_tex       == nullptr ||
-		sk_default_tex_black == nullptr ||
-		sk_default_tex_gray  == nullptr ||
-		sk_default_tex_flat  == nullptr ||
-		sk_default_tex_rough == nullptr)
-		return false;
+	{ "default/tex",       asset_type_texture, []() -> void * { return defaults_texture("default/tex",       {255,255,255,255}); } },
+	{ "default/tex_black", asset_type_texture, []() -> void * { return defaults_texture("default/tex_black", {0,0,0,255}      ); } },
+	{ "default/tex_gray",  asset_type_texture, []() -> void * { return defaults_texture("default/tex_gray",  {128,128,128,255}); } },
+	{ "default/tex_flat",  asset_type_texture, []() -> void * { return defaults_texture("default/tex_flat",  {128,128,255,255}); } }, // Default for normal maps
+	{ "default/tex_rough", asset_type_texture, []() -> void * { return defaults_texture("default/tex_rough", {0,0,255,255}    ); } }, // Default for metal/roughness maps
+
+	// Default rendering quad
+	{ "default/quad", asset_type_mesh, []() -> void * {
+		mesh_t result = mesh_create();
+		vert_t verts[4] = {
+			vec3{-1,-1,0}, vec3{0,0,-1}, vec2{0,0}, color32{255,255,255,255},
+			vec3{ 1,-1,0}, vec3{0,0,-1}, vec2{1,0}, color32{255,255,255,255},
+			vec3{ 1, 1,0}, vec3{0,0,-1}, vec2{1,1}, color32{255,255,255,255},
+			vec3{-1, 1,0}, vec3{0,0,-1}, vec2{0,1}, color32{255,255,255,255},
+		};
+		vind_t inds[6] = { 0,1,2, 0,2,3 };
+		mesh_set_verts(result, verts, 4);
+		mesh_set_inds (result, inds,  6);
+		mesh_set_id   (result, "default/quad");
+		return result; } },
+
+	// Shaders
+	{ "default/shader",          asset_type_shader, []() -> void * { return defaults_shader("default/shader",          sk_shader_builtin_default ); } },
+	{ "default/shader_pbr",      asset_type_shader, []() -> void * { return defaults_shader("default/shader_pbr",      sk_shader_builtin_pbr     ); } },
+	{ "default/shader_unlit",    asset_type_shader, []() -> void * { return defaults_shader("default/shader_unlit",    sk_shader_builtin_unlit   ); } },
+	{ "default/shader_font",     asset_type_shader, []() -> void * { return defaults_shader("default/shader_font",     sk_shader_builtin_font    ); } },
+	{ "default/equirect_shader", asset_type_shader, []() -> void * { return defaults_shader("default/equirect_shader", sk_shader_builtin_equirect); } },
+	{ "default/shader_ui",       asset_type_shader, []() -> void * { return defaults_shader("default/shader_ui",       sk_shader_builtin_ui      ); } },
+	{ "default/nv12_shader",     asset_type_shader, []() -> void * { return defaults_shader("default/nv12_shader",     sk_shader_builtin_nv12    ); } },
 
-	// Cubemap
+	// Materials
+	{ "default/material",         asset_type_material, []() -> void * { return defaults_material("default/material",         "default/shader"         ); } },
+	{ "default/equirect_convert", asset_type_material, []() -> void * { return defaults_material("default/equirect_convert", "default/equirect_shader"); } },
+	{ "default/material_ui",      asset_type_material, []() -> void * { return defaults_material("default/material_ui",      "default/shader_ui"      ); } },
+	{ "default/nv12_convert",     asset_type_material, []() -> void * { return defaults_material("default/nv12_convert",     "default/nv12_shader"    ); } },
+	{ "default/material_font",    asset_type_material, []() -> void * {
+		material_t result = defaults_material("default/material_font", "default/shader_font");
+		tex_t      tex    = tex_find("default/tex");
+		if (result != nullptr && tex != nullptr)
+			material_set_texture(result, "diffuse", tex);
+		tex_release(tex);
+		return result; } },
+
+	// Text!
+	{ "default/font", asset_type_font, []() -> void * {
+		font_t result = font_create("C:/Windows/Fonts/segoeui.ttf");
+		if (result != nullptr)
+			font_set_id(result, "default/font");
+		return result; } },
+};
+
+///////////////////////////////////////////
+
+void *defaults_find(uint64_t id, asset_type_ type) {
+	lock_guard<recursive_mutex> lock(defaults_lock);
+	if (!defaults_active)
+		return nullptr;
+
+	for (size_t i = 0; i < _countof(defaults_list); i++) {
+		default_asset_t &item = defaults_list[i];
+		if (item.hash != id || item.type != type)
+			continue;
+
+		// Only try once, a builtin that failed won't do better next time
+		if (!item.attempted) {
+			item.attempted = true;
+
+			int64_t nested = defaults_nested_duration;
+			defaults_nested_duration = 0;
+			time_point<high_resolution_clock> start = high_resolution_clock::now();
+
+			item.asset = item.create();
+			if (item.asset == nullptr)
+				log_errf("Failed to create default asset %s!", item.id);
+
+			time_point<high_resolution_clock> end = high_resolution_clock::now();
+			int64_t duration = duration_cast<nanoseconds>(end - start).count();
+			item.create_duration     = duration - defaults_nested_duration;
+			defaults_nested_duration = nested + duration;
+		}
+
+		if (item.asset != nullptr)
+			assets_addref(*(asset_header_t *)item.asset);
+		return item.asset;
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////
+
+bool defaults_init() {
+	for (size_t i = 0; i < _countof(defaults_list); i++)
+		defaults_list[i].hash = string_hash(defaults_list[i].id);
+	defaults_active = true;
+
+	// Cubemap, this one's on screen from the first frame, so no sense in
+	// waiting for it.
 	spherical_harmonics_t lighting = { {
 		{ 0.27f,  0.26f,  0.25f},
 		{ 0.07f,  0.09f,  0.11f},
@@ -79,65 +190,18 @@ bool defaults_init() {
 	render_set_skylight(lighting);
 	render_enable_skytex(true);
 
-	// Default rendering quad
-	sk_default_quad = mesh_create();
-	vert_t verts[4] = {
-		vec3{-1,-1,0}, vec3{0,0,-1}, vec2{0,0}, color32{255,255,255,255},
-		vec3{ 1,-1,0}, vec3{0,0,-1}, vec2{1,0}, color32{255,255,255,255},
-		vec3{ 1, 1,0}, vec3{0,0,-1}, vec2{1,1}, color32{255,255,255,255},
-		vec3{-1, 1,0}, vec3{0,0,-1}, vec2{0,1}, color32{255,255,255,255},
-	};
-	vind_t inds[6] = { 0,1,2, 0,2,3 };
-	mesh_set_verts(sk_default_quad, verts, 4);
-	mesh_set_inds (sk_default_quad, inds,  6);
-	mesh_set_id   (sk_default_quad, "default/quad");
-
-	// Shaders
-	sk_default_shader          = shader_create(sk_shader_builtin_default);
-	sk_default_shader_pbr      = shader_create(sk_shader_builtin_pbr);
-	sk_default_shader_unlit    = shader_create(sk_shader_builtin_unlit);
-	sk_default_shader_font     = shader_create(sk_shader_builtin_font);
-	sk_default_shader_equirect = shader_create(sk_shader_builtin_equirect);
-	sk_default_shader_ui       = shader_create(sk_shader_builtin_ui);
-	
-	if (sk_default_shader          == nullptr ||
-		sk_default_shader_pbr      == nullptr ||
-		sk_default_shader_unlit    == nullptr ||
-		sk_default_shader_font     == nullptr ||
-		sk_default_shader_equirect == nullptr ||
-		sk_default_shader_ui       == nullptr)
+	// The default text style has to be style 0, so it gets made up front,
+	// before anyone else can make a style.
+	font_t     font     = font_find    ("default/font");
+	material_t font_mat = material_find("default/material_font");
+	if (font == nullptr || font_mat == nullptr) {
+		font_release    (font);
+		material_release(font_mat);
 		return false;
-
-	shader_set_id(sk_default_shader,          "default/shader");
-	shader_set_id(sk_default_shader_pbr,      "default/shader_pbr");
-	shader_set_id(sk_default_shader_unlit,    "default/shader_unlit");
-	shader_set_id(sk_default_shader_font,     "default/shader_font");
-	shader_set_id(sk_default_shader_equirect, "default/equirect_shader");
-	
-	// Materials
-	sk_default_material          = material_create(sk_default_shader);
-	sk_default_material_equirect = material_create(sk_default_shader_equirect);
-	sk_default_material_font     = material_create(sk_default_shader_font);
-	sk_default_material_ui       = material_create(sk_default_shader_ui);
-
-	if (sk_default_material          == nullptr ||
-		sk_default_material_equirect == nullptr ||
-		sk_default_material_font     == nullptr ||
-		sk_default_material_ui       == nullptr)
-		return false;
-
-	material_set_id(sk_default_material,          "default/material");
-	material_set_id(sk_default_material_equirect, "default/equirect_convert");
-	material_set_id(sk_default_material_font,     "default/material_font");
-	material_set_id(sk_default_material_ui,       "default/material_ui");
-
-	material_set_texture(sk_default_material_font, "diffuse", sk_default_tex);
-
-	// Text!
-	sk_default_font       = font_create("C:/Windows/Fonts/segoeui.ttf");
-	sk_default_text_style = text_make_style(sk_default_font, 20 * mm2m, sk_default_material_font, color32{ 255,255,255,255 });
-
-	font_set_id(sk_default_font, "default/font");
+	}
+	sk_default_text_style = text_make_style(font, 20 * mm2m, font_mat, color32{ 255,255,255,255 });
+	font_release    (font);
+	material_release(font_mat);
 
 	return true;
 }
@@ -145,23 +209,30 @@ bool defaults_init() {
 ///////////////////////////////////////////
 
 void defaults_shutdown() {
-	font_release    (sk_default_font);
-	material_release(sk_default_material_equirect);
-	material_release(sk_default_material);
-	material_release(sk_default_material_font);
-	material_release(sk_default_material_ui);
-	shader_release  (sk_default_shader_equirect);
-	shader_release  (sk_default_shader_font);
-	shader_release  (sk_default_shader_unlit);
-	shader_release  (sk_default_shader_pbr);
-	shader_release  (sk_default_shader);
-	shader_release  (sk_default_shader_ui);
-	mesh_release    (sk_default_quad);
-	tex_release     (sk_default_tex);
-	tex_release     (sk_default_tex_black);
-	tex_release     (sk_default_tex_gray);
-	tex_release     (sk_default_tex_flat);
-	tex_release     (sk_default_tex_rough);
+	lock_guard<recursive_mutex> lock(defaults_lock);
+	defaults_active = false;
+
+	int32_t created = 0;
+	int64_t total   = 0;
+	for (size_t i = 0; i < _countof(defaults_list); i++) {
+		default_asset_t &item = defaults_list[i];
+		if (item.asset == nullptr)
+			continue;
+		created += 1;
+		total   += item.create_duration;
+		log_diagf("Default %-24s created in %7.2fms", item.id, item.create_duration / 1000000.0);
+	}
+	log_infof("Created %d of %d default assets on demand, in %.2fms", created, (int32_t)_countof(defaults_list), total / 1000000.0);
+
+	// Materials hold references to their shaders and textures, so go in
+	// reverse of the order things were listed.
+	for (int32_t i = _countof(defaults_list) - 1; i >= 0; i--) {
+		default_asset_t &item = defaults_list[i];
+		if (item.asset != nullptr)
+			assets_releaseref(*(asset_header_t *)item.asset);
+		item.asset     = nullptr;
+		item.attempted = false;
+	}
 }
 
-} // namespace sk
\ No newline at end of file
+} // namespace sk
@@ -1,8 +1,18 @@
 #pragma once
 
+#include "../stereokit.h"
+
 namespace sk {
 
-bool defaults_init();
-void defaults_shutdown();
+// Most default assets are only created the first time something looks them
+// up by id, so apps that never touch the PBR shader or the equirect
+// material don't pay to compile them.
+
+bool  defaults_init    ();
+void  defaults_shutdown();
+// Creates the default asset with this id, if there is one, and returns it
+// with a reference for the caller. Called from assets_find_ref when nothing
+// with that id exists yet.
+void *defaults_find    (uint64_t id, asset_type_ type);
 
-} // namespace sk
\ No newline at end of file
+} // namespace sk
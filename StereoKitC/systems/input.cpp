@@ -1,6 +1,7 @@
 #include "../stereokit.h"
 #include "input.h"
 #include "input_hand.h"
+#include "../pose_predict.h"
 
 #ifndef SK_NO_FLATSCREEN
 #define WIN32_LEAN_AND_MEAN
@@ -25,6 +26,7 @@ vector<pointer_t>     input_pointers;
 mouse_t               input_mouse_data = {};
 keyboard_t            input_key_data   = {};
 pose_t                input_head_pose  = { vec3_zero, quat_identity };
+pose_predictor_t      input_head_predictor;
 
 ///////////////////////////////////////////
 
@@ -95,6 +97,7 @@ void input_fire_event(input_source_ source, button_state_ event, const pointer_t
 ///////////////////////////////////////////
 
 bool input_init() {
+	pose_predictor_reset(input_head_predictor);
 	input_hand_init();
 	return true;
 }
@@ -110,6 +113,7 @@ void input_shutdown() {
 ///////////////////////////////////////////
 
 void input_update() {
+	pose_predictor_add(input_head_predictor, input_head_pose, time_get_unscaled());
 	input_hand_update();
 }
 
@@ -129,4 +133,10 @@ const pose_t &input_head() {
 	return input_head_pose;
 }
 
+///////////////////////////////////////////
+
+pose_t input_head_predict(float seconds_ahead) {
+	return pose_predictor_at(input_head_predictor, input_head_predictor.time + seconds_ahead);
+}
+
 } // namespace sk {
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "job_pool.h"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+using namespace std;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct job_batch_t {
+	void          (*job)(int32_t index, void *context);
+	void           *context;
+	int32_t         count;
+	atomic<int32_t> next;
+};
+
+vector<thread>     job_workers;
+mutex              job_mutex;
+condition_variable job_work_cv;
+condition_variable job_done_cv;
+job_batch_t        job_batch;
+atomic<bool>       job_busy    = {false};
+uint64_t           job_gen     = 0;
+int32_t            job_pending = 0;
+bool               job_run     = false;
+
+// More threads than this rarely helps with the sizes of work we hand out,
+// and leaves more cores for the app and the runtime.
+const int32_t job_pool_max_workers = 3;
+
+///////////////////////////////////////////
+
+void job_pool_work() {
+	int32_t i;
+	while ((i = job_batch.next.fetch_add(1)) < job_batch.count)
+		job_batch.job(i, job_batch.context);
+}
+
+///////////////////////////////////////////
+
+void job_pool_worker() {
+	uint64_t gen = 0;
+	while (true) {
+		{
+			unique_lock<mutex> lock(job_mutex);
+			job_work_cv.wait(lock, [gen] { return job_gen != gen || !job_run; });
+			if (!job_run)
+				return;
+			gen = job_gen;
+		}
+
+		job_pool_work();
+
+		{
+			lock_guard<mutex> lock(job_mutex);
+			job_pending -= 1;
+		}
+		job_done_cv.notify_one();
+	}
+}
+
+///////////////////////////////////////////
+
+bool job_pool_init() {
+	int32_t worker_count = (int32_t)thread::hardware_concurrency() - 1;
+	if (worker_count > job_pool_max_workers) worker_count = job_pool_max_workers;
+
+	job_run = true;
+	for (int32_t i = 0; i < worker_count; i++)
+		job_workers.emplace_back(job_pool_worker);
+	return true;
+}
+
+///////////////////////////////////////////
+
+void job_pool_shutdown() {
+	{
+		lock_guard<mutex> lock(job_mutex);
+		job_run = false;
+	}
+	job_work_cv.notify_all();
+	for (size_t i = 0; i < job_workers.size(); i++)
+		job_workers[i].join();
+	job_workers.clear();
+}
+
+///////////////////////////////////////////
+
+int32_t job_pool_threads() {
+	return (int32_t)job_workers.size() + 1;
+}
+
+///////////////////////////////////////////
+
+void job_pool_for(int32_t count, void (*job)(int32_t index, void *context), void *context) {
+	// One batch at a time. Anyone who shows up while the pool is busy,
+	// including a job that wants to split itself up further, goes it alone.
+	bool expected = false;
+	if (count <= 1 || job_workers.size() == 0 || !job_busy.compare_exchange_strong(expected, true)) {
+		for (int32_t i = 0; i < count; i++)
+			job(i, context);
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(job_mutex);
+		job_batch.job     = job;
+		job_batch.context = context;
+		job_batch.count   = count;
+		job_batch.next.store(0);
+		job_pending = (int32_t)job_workers.size();
+		job_gen    += 1;
+	}
+	job_work_cv.notify_all();
+
+	job_pool_work();
+
+	// Every worker has to check in before the batch can be reused, even the
+	// ones that woke up too late to find any work.
+	{
+		unique_lock<mutex> lock(job_mutex);
+		job_done_cv.wait(lock, [] { return job_pending == 0; });
+	}
+	job_busy.store(false);
+}
+
+} // namespace sk
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace sk {
+
+// A small pool of persistent worker threads for splitting up work that's
+// done every frame, like binning lights or stepping particles. Waking a
+// sleeping thread isn't free, so callers should only bother when there's
+// enough work to be worth it.
+
+bool    job_pool_init    ();
+void    job_pool_shutdown();
+
+// Workers, plus the calling thread.
+int32_t job_pool_threads ();
+
+// Calls job(i, context) once for each i in [0, count), spread across the
+// workers and the calling thread, and returns when they're all done. If
+// another thread is already using the pool, the caller just does all the
+// jobs itself rather than waiting.
+void    job_pool_for     (int32_t count, void (*job)(int32_t index, void *context), void *context);
+
+} // namespace sk
@@ -3,21 +3,66 @@
 #include "../shaders_builtin/shader_builtin.h"
 #include "../math.h"
 #include "../hierarchy.h"
+#include "../_stereokit.h"
+#include "../memory_tracking.h"
+#include "thread_chunks.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 namespace sk {
 
 ///////////////////////////////////////////
 
-mesh_t     line_mesh;
-material_t line_material;
-vert_t  *line_verts    = nullptr;
-uint32_t line_vert_ct  = 0;
-uint32_t line_vert_cap = 0;
-vind_t  *line_inds     = nullptr;
-uint32_t line_ind_ct   = 0;
-uint32_t line_ind_cap  = 0;
+struct line_buffer_t {
+	vert_t  *verts;
+	uint32_t vert_ct;
+	uint32_t vert_cap;
+	vind_t  *inds;
+	uint32_t ind_ct;
+	uint32_t ind_cap;
+};
+
+mesh_t        line_mesh;
+material_t    line_material;
+line_buffer_t line_buffer = {};
+thread_chunks_t<line_buffer_t> line_thread_buffers;
+
+///////////////////////////////////////////
+
+void line_ensure_cap(line_buffer_t &buffer, int32_t verts, int32_t inds);
+
+///////////////////////////////////////////
+
+// Lines from worker threads are built in that thread's own buffer, and
+// appended to the main one during line_drawer_update.
+inline line_buffer_t &line_get_buffer() {
+	return sk_on_main_thread()
+		? line_buffer
+		: thread_chunk_get(line_thread_buffers);
+}
+
+///////////////////////////////////////////
+
+void line_merge_buffer(line_buffer_t &from, bool thread_exited) {
+	if (from.ind_ct > 0) {
+		line_ensure_cap(line_buffer, from.vert_ct, from.ind_ct);
+		memcpy(&line_buffer.verts[line_buffer.vert_ct], from.verts, from.vert_ct * sizeof(vert_t));
+		for (uint32_t i = 0; i < from.ind_ct; i++) {
+			line_buffer.inds[line_buffer.ind_ct + i] = (vind_t)(from.inds[i] + line_buffer.vert_ct);
+		}
+		line_buffer.vert_ct += from.vert_ct;
+		line_buffer.ind_ct  += from.ind_ct;
+	}
+	from.vert_ct = 0;
+	from.ind_ct  = 0;
+
+	if (thread_exited) {
+		sk_free(from.verts);
+		sk_free(from.inds);
+		from = {};
+	}
+}
 
 ///////////////////////////////////////////
 
@@ -36,16 +81,18 @@ bool line_drawer_init() {
 ///////////////////////////////////////////
 
 void line_drawer_update() {
-	if (line_ind_ct <= 0)
+	thread_chunks_drain(line_thread_buffers, line_merge_buffer);
+
+	if (line_buffer.ind_ct <= 0)
 		return;
 
-	mesh_set_verts    (line_mesh, line_verts, line_vert_cap, false);
-	mesh_set_inds     (line_mesh, line_inds,  line_ind_cap);
-	mesh_set_draw_inds(line_mesh, line_ind_ct);
+	mesh_set_verts    (line_mesh, line_buffer.verts, line_buffer.vert_cap, false);
+	mesh_set_inds     (line_mesh, line_buffer.inds,  line_buffer.ind_cap);
+	mesh_set_draw_inds(line_mesh, line_buffer.ind_ct);
 	render_add_mesh   (line_mesh, line_material, matrix_identity);
 
-	line_ind_ct  = 0;
-	line_vert_ct = 0;
+	line_buffer.ind_ct  = 0;
+	line_buffer.vert_ct = 0;
 }
 
 ///////////////////////////////////////////
@@ -53,19 +100,22 @@ void line_drawer_update() {
 void line_drawer_shutdown() {
 	mesh_release    (line_mesh);
 	material_release(line_material);
+	sk_free(line_buffer.verts);
+	sk_free(line_buffer.inds);
+	line_buffer = {};
 }
 
 ///////////////////////////////////////////
 
-void line_ensure_cap(int32_t verts, int32_t inds) {
-	if (line_vert_ct + verts >= line_vert_cap) {
-		line_vert_cap = maxi(line_vert_ct + verts, line_vert_cap * 2);
-		line_verts    = (vert_t*)realloc(line_verts, line_vert_cap * sizeof(vert_t));
+void line_ensure_cap(line_buffer_t &buffer, int32_t verts, int32_t inds) {
+	if (buffer.vert_ct + verts >= buffer.vert_cap) {
+		buffer.vert_cap = maxi(buffer.vert_ct + verts, buffer.vert_cap * 2);
+		buffer.verts    = (vert_t*)sk_realloc(memory_tag_lines, buffer.verts, buffer.vert_cap * sizeof(vert_t));
 	}
 
-	if (line_ind_ct + inds >= line_ind_cap) {
-		line_ind_cap = maxi(line_ind_ct + inds, line_ind_cap * 2);
-		line_inds    = (vind_t*)realloc(line_inds, line_ind_cap * sizeof(vind_t));
+	if (buffer.ind_ct + inds >= buffer.ind_cap) {
+		buffer.ind_cap = maxi(buffer.ind_ct + inds, buffer.ind_cap * 2);
+		buffer.inds    = (vind_t*)sk_realloc(memory_tag_lines, buffer.inds, buffer.ind_cap * sizeof(vind_t));
 	}
 }
 
@@ -77,8 +127,7 @@ void line_add(vec3 start, vec3 end, color32 color, float thickness) {
 
 ///////////////////////////////////////////
 
-void line_addv(line_point_t start, line_point_t end) {
-	line_ensure_cap(4, 6);
+inline void line_add_segment(line_buffer_t &buffer, line_point_t start, line_point_t end) {
 	start.thickness *= 0.5f;
 	end  .thickness *= 0.5f;
 
@@ -88,51 +137,71 @@ void line_addv(line_point_t start, line_point_t end) {
 		end  .pt = matrix_mul_point(transform, end.pt);
 	}
 
-	vind_t start_vert = (vind_t)line_vert_ct;
+	vind_t start_vert = (vind_t)buffer.vert_ct;
 	vec3   dir        = vec3_normalize(end.pt - start.pt);
 
-	line_verts[line_vert_ct+0] = vert_t{ start.pt, dir* start.thickness, {0,0}, start.color };
-	line_verts[line_vert_ct+1] = vert_t{ start.pt, dir*-start.thickness, {0,1}, start.color };
-	line_verts[line_vert_ct+2] = vert_t{ end  .pt, dir* end.thickness,   {1,0}, end  .color };
-	line_verts[line_vert_ct+3] = vert_t{ end  .pt, dir*-end.thickness,   {1,1}, end  .color };
+	buffer.verts[buffer.vert_ct+0] = vert_t{ start.pt, dir* start.thickness, {0,0}, start.color };
+	buffer.verts[buffer.vert_ct+1] = vert_t{ start.pt, dir*-start.thickness, {0,1}, start.color };
+	buffer.verts[buffer.vert_ct+2] = vert_t{ end  .pt, dir* end.thickness,   {1,0}, end  .color };
+	buffer.verts[buffer.vert_ct+3] = vert_t{ end  .pt, dir*-end.thickness,   {1,1}, end  .color };
+
+	buffer.inds[buffer.ind_ct++] = start_vert + 0;
+	buffer.inds[buffer.ind_ct++] = start_vert + 2;
+	buffer.inds[buffer.ind_ct++] = start_vert + 3;
+	buffer.inds[buffer.ind_ct++] = start_vert + 0;
+	buffer.inds[buffer.ind_ct++] = start_vert + 3;
+	buffer.inds[buffer.ind_ct++] = start_vert + 1;
+
+	buffer.vert_ct += 4;
+}
+
+///////////////////////////////////////////
 
-	line_inds[line_ind_ct++] = start_vert + 0;
-	line_inds[line_ind_ct++] = start_vert + 2;
-	line_inds[line_ind_ct++] = start_vert + 3;
-	line_inds[line_ind_ct++] = start_vert + 0;
-	line_inds[line_ind_ct++] = start_vert + 3;
-	line_inds[line_ind_ct++] = start_vert + 1;
+void line_addv(line_point_t start, line_point_t end) {
+	line_buffer_t &buffer = line_get_buffer();
+	line_ensure_cap (buffer, 4, 6);
+	line_add_segment(buffer, start, end);
+}
 
-	line_vert_ct += 4;
+///////////////////////////////////////////
+
+void line_add_segments(const line_point_t *start_end_pairs, int32_t segment_count) {
+	if (segment_count <= 0) return;
+	line_buffer_t &buffer = line_get_buffer();
+	line_ensure_cap(buffer, segment_count * 4, segment_count * 6);
+	for (int32_t i = 0; i < segment_count; i++) {
+		line_add_segment(buffer, start_end_pairs[i*2], start_end_pairs[i*2+1]);
+	}
 }
 
 ///////////////////////////////////////////
 
 void line_add_list(const vec3 *points, int32_t count, color32 color, float thickness) {
 	if (count < 2) return;
-	line_ensure_cap(count*2, (count-2)*6);
+	line_buffer_t &buffer = line_get_buffer();
+	line_ensure_cap(buffer, count*2, (count-2)*6);
 	thickness *= 0.5f;
 	
 	vec3 prev = hierarchy_to_world_point(points[0]);
 	vec3 dir  = vec3_normalize(hierarchy_to_world_point(points[1]) - prev);
 	for (int32_t i = 0; i < count; i++) {
 		vec3 curr = hierarchy_to_world_point(points[i]);
-		line_verts[line_vert_ct + 0] = vert_t{ curr, dir *  thickness, {0,0}, color };
-		line_verts[line_vert_ct + 1] = vert_t{ curr, dir * -thickness, {0,1}, color };
+		buffer.verts[buffer.vert_ct + 0] = vert_t{ curr, dir *  thickness, {0,0}, color };
+		buffer.verts[buffer.vert_ct + 1] = vert_t{ curr, dir * -thickness, {0,1}, color };
 
 		if (i < count - 1) {
-			line_inds[line_ind_ct++] = line_vert_ct + 0;
-			line_inds[line_ind_ct++] = line_vert_ct + 2;
-			line_inds[line_ind_ct++] = line_vert_ct + 3;
-			line_inds[line_ind_ct++] = line_vert_ct + 0;
-			line_inds[line_ind_ct++] = line_vert_ct + 3;
-			line_inds[line_ind_ct++] = line_vert_ct + 1;
+			buffer.inds[buffer.ind_ct++] = buffer.vert_ct + 0;
+			buffer.inds[buffer.ind_ct++] = buffer.vert_ct + 2;
+			buffer.inds[buffer.ind_ct++] = buffer.vert_ct + 3;
+			buffer.inds[buffer.ind_ct++] = buffer.vert_ct + 0;
+			buffer.inds[buffer.ind_ct++] = buffer.vert_ct + 3;
+			buffer.inds[buffer.ind_ct++] = buffer.vert_ct + 1;
 
 			dir = vec3_normalize(curr - prev);
 		}
 
-		line_vert_ct += 2;
-		prev          = curr;
+		buffer.vert_ct += 2;
+		prev            = curr;
 	}
 }
 
@@ -140,28 +209,29 @@ void line_add_list(const vec3 *points, int32_t count, color32 color, float thick
 
 void line_add_listv(const line_point_t *points, int32_t count) {
 	if (count < 2) return;
-	line_ensure_cap(count*2, (count-2)*6);
+	line_buffer_t &buffer = line_get_buffer();
+	line_ensure_cap(buffer, count*2, (count-2)*6);
 	
 	vec3 prev = hierarchy_to_world_point(points[0].pt);
 	vec3 dir  = vec3_normalize(hierarchy_to_world_point(points[1].pt) - prev);
 	for (int32_t i = 0; i < count; i++) {
 		vec3 curr = hierarchy_to_world_point(points[i].pt);
-		line_verts[line_vert_ct + 0] = vert_t{ curr, dir *  points[i].thickness, {0,0}, points[i].color };
-		line_verts[line_vert_ct + 1] = vert_t{ curr, dir * -points[i].thickness, {0,1}, points[i].color };
+		buffer.verts[buffer.vert_ct + 0] = vert_t{ curr, dir *  points[i].thickness, {0,0}, points[i].color };
+		buffer.verts[buffer.vert_ct + 1] = vert_t{ curr, dir * -points[i].thickness, {0,1}, points[i].color };
 
 		if (i < count - 1) {
-			line_inds[line_ind_ct++] = line_vert_ct + 0;
-			line_inds[line_ind_ct++] = line_vert_ct + 2;
-			line_inds[line_ind_ct++] = line_vert_ct + 3;
-			line_inds[line_ind_ct++] = line_vert_ct + 0;
-			line_inds[line_ind_ct++] = line_vert_ct + 3;
-			line_inds[line_ind_ct++] = line_vert_ct + 1;
+			buffer.inds[buffer.ind_ct++] = buffer.vert_ct + 0;
+			buffer.inds[buffer.ind_ct++] = buffer.vert_ct + 2;
+			buffer.inds[buffer.ind_ct++] = buffer.vert_ct + 3;
+			buffer.inds[buffer.ind_ct++] = buffer.vert_ct + 0;
+			buffer.inds[buffer.ind_ct++] = buffer.vert_ct + 3;
+			buffer.inds[buffer.ind_ct++] = buffer.vert_ct + 1;
 
 			dir = vec3_normalize(curr - prev);
 		}
 
-		line_vert_ct += 2;
-		prev          = curr;
+		buffer.vert_ct += 2;
+		prev            = curr;
 	}
 }
 
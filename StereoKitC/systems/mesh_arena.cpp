@@ -0,0 +1,238 @@
+#include "mesh_arena.h"
+#include "render.h"
+#include "d3d.h"
+#include "../offset_allocator.h"
+#include "../memory_tracking.h"
+#include "../asset_types/mesh.h"
+
+#include <string.h>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+using namespace std;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct mesh_arena_t {
+	ID3D11Buffer      *buffer;
+	offset_allocator_t allocator;
+	vector<mesh_t>     owners; // By allocator node
+	bool               freed;  // Anything freed since the last defrag check
+};
+
+struct mesh_arena_upload_t {
+	mesh_arena_ type;
+	int32_t     arena;
+	uint32_t    start;
+	uint32_t    count;
+	void       *data;
+};
+
+struct mesh_arena_item_t {
+	uint32_t offset;
+	uint32_t count;
+	mesh_t   mesh;
+};
+
+// Sizes are in elements, not bytes. Anything bigger than a quarter of an
+// arena is better off in its own buffer anyhow.
+// Each index width gets arenas of its own, since an index buffer binds
+// with a single format.
+const uint32_t mesh_arena_size     [mesh_arena_max] = { 64 * 1024, 256 * 1024, 256 * 1024 };
+const uint32_t mesh_arena_stride   [mesh_arena_max] = { sizeof(vert_t), sizeof(uint16_t), sizeof(uint32_t) };
+const UINT     mesh_arena_bind     [mesh_arena_max] = { D3D11_BIND_VERTEX_BUFFER, D3D11_BIND_INDEX_BUFFER, D3D11_BIND_INDEX_BUFFER };
+const uint32_t mesh_arena_max_items = 4096;
+
+vector<mesh_arena_t *>      mesh_arenas[mesh_arena_max];
+vector<mesh_arena_upload_t> mesh_arena_uploads;
+vector<mesh_arena_item_t>   mesh_arena_items;
+mutex                       mesh_arena_lock;
+
+///////////////////////////////////////////
+
+ID3D11Buffer *mesh_arena_create_buffer(mesh_arena_ type) {
+	ID3D11Buffer      *result = nullptr;
+	CD3D11_BUFFER_DESC desc(mesh_arena_size[type] * mesh_arena_stride[type], mesh_arena_bind[type]);
+	if (FAILED(d3d_device->CreateBuffer(&desc, nullptr, &result))) {
+		log_err("mesh_arena: Failed to create an arena buffer!");
+		return nullptr;
+	}
+	if      (type == mesh_arena_verts ) { DX11ResType(result, "mesh_arena_verts" ); }
+	else if (type == mesh_arena_inds16) { DX11ResType(result, "mesh_arena_inds16"); }
+	else                                { DX11ResType(result, "mesh_arena_inds32"); }
+	return result;
+}
+
+///////////////////////////////////////////
+
+mesh_arena_t *mesh_arena_add(mesh_arena_ type) {
+	ID3D11Buffer *buffer = mesh_arena_create_buffer(type);
+	if (buffer == nullptr)
+		return nullptr;
+
+	mesh_arena_t *result = new mesh_arena_t();
+	result->buffer = buffer;
+	result->owners.resize(mesh_arena_max_items);
+	offset_allocator_init(result->allocator, mesh_arena_size[type], mesh_arena_max_items);
+	mesh_arenas[type].push_back(result);
+	return result;
+}
+
+///////////////////////////////////////////
+
+inline void mesh_arena_set(mesh_t mesh, mesh_arena_ type, int32_t arena, ID3D11Buffer *buffer, offset_alloc_t alloc) {
+	if (type == mesh_arena_verts) {
+		mesh->vert_arena  = arena;
+		mesh->vert_buffer = buffer;
+		mesh->vert_start  = alloc.offset;
+		mesh->vert_alloc  = alloc;
+	} else {
+		mesh->ind_arena  = arena;
+		mesh->ind_buffer = buffer;
+		mesh->ind_start  = alloc.offset;
+		mesh->ind_alloc  = alloc;
+	}
+}
+
+///////////////////////////////////////////
+
+bool mesh_arena_place(mesh_t mesh, mesh_arena_ type, const void *data, uint32_t count) {
+	if (count == 0 || count > mesh_arena_size[type] / 4)
+		return false;
+
+	lock_guard<mutex> lock(mesh_arena_lock);
+
+	// First fit over the arenas, and a new one if none have room
+	offset_alloc_t alloc = { offset_alloc_none, offset_alloc_none };
+	int32_t        index = 0;
+	for (; index < (int32_t)mesh_arenas[type].size(); index++) {
+		alloc = offset_allocator_alloc(mesh_arenas[type][index]->allocator, count);
+		if (alloc.offset != offset_alloc_none)
+			break;
+	}
+	if (alloc.offset == offset_alloc_none) {
+		mesh_arena_t *arena = mesh_arena_add(type);
+		if (arena == nullptr)
+			return false;
+		index = (int32_t)mesh_arenas[type].size() - 1;
+		alloc = offset_allocator_alloc(arena->allocator, count);
+	}
+
+	mesh_arena_t *arena = mesh_arenas[type][index];
+	arena->owners[alloc.node] = mesh;
+	mesh_arena_set(mesh, type, index + 1, arena->buffer, alloc);
+
+	size_t size = (size_t)count * mesh_arena_stride[type];
+	void  *copy = sk_malloc(memory_tag_render, size);
+	memcpy(copy, data, size);
+	mesh_arena_uploads.push_back({ type, index, alloc.offset, count, copy });
+	return true;
+}
+
+///////////////////////////////////////////
+
+void mesh_arena_remove(mesh_t mesh, mesh_arena_ type) {
+	// A defrag can move the allocation, so it's only read under the lock
+	lock_guard<mutex> lock(mesh_arena_lock);
+	int32_t        arena_id = type == mesh_arena_verts ? mesh->vert_arena : mesh->ind_arena;
+	offset_alloc_t alloc    = type == mesh_arena_verts ? mesh->vert_alloc : mesh->ind_alloc;
+	if (arena_id == 0)
+		return;
+
+	mesh_arena_t *arena = mesh_arenas[type][arena_id - 1];
+	arena->owners[alloc.node] = nullptr;
+	arena->freed = true;
+	offset_allocator_free(arena->allocator, alloc);
+	mesh_arena_set(mesh, type, 0, nullptr, { 0, offset_alloc_none });
+}
+
+///////////////////////////////////////////
+
+void mesh_arena_defrag(mesh_arena_ type, int32_t index) {
+	mesh_arena_t *arena  = mesh_arenas[type][index];
+	ID3D11Buffer *buffer = mesh_arena_create_buffer(type);
+	if (buffer == nullptr)
+		return;
+	render_stats_realloc();
+
+	mesh_arena_items.clear();
+	for (uint32_t i = 0; i < mesh_arena_max_items; i++) {
+		if (arena->owners[i] == nullptr)
+			continue;
+		offset_alloc_t alloc = { arena->allocator.nodes[i].offset, i };
+		mesh_arena_items.push_back({ alloc.offset, offset_allocator_size_of(arena->allocator, alloc), arena->owners[i] });
+		arena->owners[i] = nullptr;
+	}
+	sort(mesh_arena_items.begin(), mesh_arena_items.end(), [](const mesh_arena_item_t &a, const mesh_arena_item_t &b) { return a.offset < b.offset; });
+
+	// A fresh allocator hands out ranges back to back, so everything packs
+	// down to the start of the new buffer in the same order.
+	uint32_t stride = mesh_arena_stride[type];
+	offset_allocator_reset(arena->allocator);
+	for (size_t i = 0; i < mesh_arena_items.size(); i++) {
+		mesh_arena_item_t &item  = mesh_arena_items[i];
+		offset_alloc_t     alloc = offset_allocator_alloc(arena->allocator, item.count);
+
+		D3D11_BOX box = { item.offset * stride, 0, 0, (item.offset + item.count) * stride, 1, 1 };
+		d3d_context->CopySubresourceRegion(buffer, 0, alloc.offset * stride, 0, 0, arena->buffer, 0, &box);
+
+		arena->owners[alloc.node] = item.mesh;
+		mesh_arena_set(item.mesh, type, index + 1, buffer, alloc);
+	}
+
+	arena->buffer->Release();
+	arena->buffer = buffer;
+}
+
+///////////////////////////////////////////
+
+void mesh_arena_flush() {
+	lock_guard<mutex> lock(mesh_arena_lock);
+
+	for (size_t i = 0; i < mesh_arena_uploads.size(); i++) {
+		mesh_arena_upload_t &upload = mesh_arena_uploads[i];
+		uint32_t             stride = mesh_arena_stride[upload.type];
+		D3D11_BOX box = { upload.start * stride, 0, 0, (upload.start + upload.count) * stride, 1, 1 };
+		d3d_context->UpdateSubresource(mesh_arenas[upload.type][upload.arena]->buffer, 0, &box, upload.data, 0, 0);
+		sk_free(upload.data);
+	}
+	mesh_arena_uploads.clear();
+
+	// Compact arenas where there's plenty of free space, but it's too
+	// scattered to be useful.
+	for (int32_t t = 0; t < mesh_arena_max; t++) {
+		for (int32_t i = 0; i < (int32_t)mesh_arenas[t].size(); i++) {
+			mesh_arena_t *arena = mesh_arenas[t][i];
+			if (!arena->freed)
+				continue;
+			arena->freed = false;
+
+			uint32_t total, largest;
+			offset_allocator_free_space(arena->allocator, &total, &largest);
+			if (total > mesh_arena_size[t] / 4 && largest < total / 2)
+				mesh_arena_defrag((mesh_arena_)t, i);
+		}
+	}
+}
+
+///////////////////////////////////////////
+
+void mesh_arena_shutdown() {
+	lock_guard<mutex> lock(mesh_arena_lock);
+	for (size_t i = 0; i < mesh_arena_uploads.size(); i++)
+		sk_free(mesh_arena_uploads[i].data);
+	mesh_arena_uploads.clear();
+
+	for (int32_t t = 0; t < mesh_arena_max; t++) {
+		for (size_t i = 0; i < mesh_arenas[t].size(); i++) {
+			mesh_arenas[t][i]->buffer->Release();
+			offset_allocator_destroy(mesh_arenas[t][i]->allocator);
+			delete mesh_arenas[t][i];
+		}
+		mesh_arenas[t].clear();
+	}
+}
+
+} // namespace sk
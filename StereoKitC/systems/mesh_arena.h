@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../stereokit.h"
+
+namespace sk {
+
+// Static meshes are packed into a few large shared vertex and index
+// buffers, rather than each getting a pair of tiny buffers of their own.
+// That's far fewer driver allocations, and meshes in the same arena draw
+// without rebinding anything, just a different start index and base
+// vertex. Meshes that get updated after creation move out into buffers of
+// their own, like before.
+//
+// Placing a mesh copies its data into a queue, which the drawing thread
+// uploads in mesh_arena_flush, so placing never has to wait on the render
+// pipeline. Arenas that get too fragmented are compacted during the flush
+// too.
+
+enum mesh_arena_ {
+	mesh_arena_verts = 0,
+	mesh_arena_inds16,
+	mesh_arena_inds32,
+	mesh_arena_max,
+};
+
+// Returns false if the mesh is too big for an arena, or there's no room,
+// in which case it should get its own buffer.
+bool mesh_arena_place   (mesh_t mesh, mesh_arena_ type, const void *data, uint32_t count);
+void mesh_arena_remove  (mesh_t mesh, mesh_arena_ type);
+// Drawing thread only, before anything is drawn.
+void mesh_arena_flush   ();
+void mesh_arena_shutdown();
+
+} // namespace sk
@@ -0,0 +1,334 @@
+#include "particles.h"
+#include "render.h"
+#include "input.h"
+#include "job_pool.h"
+
+#include "../particle_sim.h"
+#include "../hierarchy.h"
+#include "../math.h"
+#include "../asset_types/assets.h"
+#include "../asset_types/material.h"
+
+#include <math.h>
+#include <vector>
+#include <mutex>
+using namespace std;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Particle systems aren't assets. Like gradient_t and render_cmdbuf_t, each
+// one is owned by whoever created it. A system is simulation state that
+// gets stepped once per frame, so there's nothing to share between owners,
+// and two owners drawing the same system would just fight over where it
+// is. Without sharing there's no need for ids, finding or references, so
+// particles_release frees it right away. Anything already submitted to the
+// renderer was copied, so that's safe.
+//
+// particles_draw, particles_burst and particles_count can be called from
+// any thread, and go through particles_lock. Creating, releasing and the
+// particles_set_ functions are app thread only, like asset setters.
+struct _particles_t {
+	particle_soa_t     particles;
+	particle_emitter_t emitter;
+	particle_look_t    look;
+	material_t         material;
+	matrix             transform;
+	float              spawn_carry; // Fraction of a particle left over from the last frame's rate
+	int32_t            burst;
+	int32_t            count;       // particles.count as of the last update, under particles_lock
+	uint32_t           seed;
+	bool               drawn;
+};
+
+// A range of one particle system's particles, small enough that a frame's
+// worth of them spreads out nicely over the job pool.
+struct particles_job_t {
+	particles_t        particles;
+	int32_t            start;
+	int32_t            end;
+	render_instance_t *instances;
+};
+
+vector<particles_t>     particles_list;
+vector<particles_t>     particles_active;
+vector<particles_t>     particles_frame;
+vector<particles_job_t> particles_jobs;
+particle_step_t         particles_step_info;
+mutex                   particles_lock;
+uint32_t                particles_seed = 1;
+material_t              particles_material;
+tex_t                   particles_tex;
+mesh_t                  particles_quad;
+
+const int32_t particles_job_size     = 4096;
+const int32_t particles_parallel_min = particles_job_size * 2;
+
+///////////////////////////////////////////
+
+void particles_set_look(particles_t particles, gradient_t color_over_life) {
+	// The default quad is 2x2, so size is scaled down by half to match.
+	particles->look.size_start = particles->emitter.size_start * 0.5f;
+	particles->look.size_end   = particles->emitter.size_end   * 0.5f;
+	if (color_over_life == nullptr)
+		return;
+	for (int32_t i = 0; i < particle_lut_size; i++)
+		particles->look.lut[i] = gradient_get(color_over_life, i / (float)(particle_lut_size - 1));
+}
+
+///////////////////////////////////////////
+
+particles_t particles_create(int32_t max_particles, const particle_emitter_t &emitter, material_t material) {
+	particles_t result = new _particles_t();
+	result->emitter  = emitter;
+	result->material = material != nullptr ? material : particles_material;
+	result->seed     = particles_seed;
+	particles_seed  += 0x9E3779B9;
+	assets_addref(result->material->header);
+
+	particle_soa_resize(result->particles, max_particles);
+	for (int32_t i = 0; i < particle_lut_size; i++)
+		result->look.lut[i] = { 1,1,1,1 };
+	particles_set_look(result, nullptr);
+
+	lock_guard<mutex> guard(particles_lock);
+	particles_list.push_back(result);
+	return result;
+}
+
+///////////////////////////////////////////
+
+void particles_set_emitter(particles_t particles, const particle_emitter_t &emitter) {
+	particles->emitter = emitter;
+	particles_set_look(particles, nullptr);
+}
+
+///////////////////////////////////////////
+
+void particles_set_colors(particles_t particles, gradient_t color_over_life) {
+	particles_set_look(particles, color_over_life);
+}
+
+///////////////////////////////////////////
+
+void particles_burst(particles_t particles, int32_t count) {
+	lock_guard<mutex> guard(particles_lock);
+	particles->burst += count;
+}
+
+///////////////////////////////////////////
+
+void particles_draw(particles_t particles, const matrix &transform) {
+	matrix world = transform;
+	if (hierarchy_enabled)
+		matrix_mul(transform, hierarchy_stack.back().transform, world);
+
+	lock_guard<mutex> guard(particles_lock);
+	particles->transform = world;
+	if (!particles->drawn) {
+		particles->drawn = true;
+		particles_active.push_back(particles);
+	}
+}
+
+///////////////////////////////////////////
+
+int32_t particles_count(particles_t particles) {
+	// The simulation itself may be partway through a step on other threads
+	lock_guard<mutex> guard(particles_lock);
+	return particles->count;
+}
+
+///////////////////////////////////////////
+
+void particles_release(particles_t particles) {
+	if (particles == nullptr)
+		return;
+
+	{
+		lock_guard<mutex> guard(particles_lock);
+		for (size_t i = 0; i < particles_list.size(); i++) {
+			if (particles_list[i] == particles) { particles_list.erase(particles_list.begin() + i); break; }
+		}
+		for (size_t i = 0; i < particles_active.size(); i++) {
+			if (particles_active[i] == particles) { particles_active.erase(particles_active.begin() + i); break; }
+		}
+	}
+	particle_soa_free(particles->particles);
+	material_release (particles->material);
+	delete particles;
+}
+
+///////////////////////////////////////////
+
+void particles_job_step(int32_t index, void *) {
+	particles_job_t &job = particles_jobs[index];
+	particle_step_t  step = particles_step_info;
+	step.acceleration = job.particles->emitter.acceleration;
+	step.drag         = job.particles->emitter.drag;
+	particle_sim_step(job.particles->particles, step, job.start, job.end);
+}
+
+///////////////////////////////////////////
+
+void particles_job_instances(int32_t index, void *) {
+	particles_job_t &job = particles_jobs[index];
+	particle_sim_instances(job.particles->particles, job.particles->look, job.start, job.end, job.instances);
+}
+
+///////////////////////////////////////////
+
+void particles_run_jobs(void (*job)(int32_t index, void *context), int32_t total) {
+	if (total < particles_parallel_min) {
+		for (size_t i = 0; i < particles_jobs.size(); i++)
+			job((int32_t)i, nullptr);
+	} else {
+		job_pool_for((int32_t)particles_jobs.size(), job, nullptr);
+	}
+}
+
+///////////////////////////////////////////
+
+void particles_make_jobs() {
+	particles_jobs.clear();
+	for (size_t i = 0; i < particles_frame.size(); i++) {
+		particles_t particles = particles_frame[i];
+		for (int32_t start = 0; start < particles->particles.count; start += particles_job_size) {
+			int32_t end = start + particles_job_size;
+			particles_jobs.push_back({ particles, start, end < particles->particles.count ? end : particles->particles.count, nullptr });
+		}
+	}
+}
+
+///////////////////////////////////////////
+
+bool particles_init() {
+	// A soft round dot, so particles look alright without any setup
+	const int32_t size = 32;
+	color32 colors[size * size];
+	for (int32_t y = 0; y < size; y++) {
+		for (int32_t x = 0; x < size; x++) {
+			float dx = (x + 0.5f) / size * 2 - 1;
+			float dy = (y + 0.5f) / size * 2 - 1;
+			float a  = fmaxf(0, 1 - sqrtf(dx*dx + dy*dy));
+			colors[x + y * size] = { 255, 255, 255, (uint8_t)(a * a * 255) };
+		}
+	}
+	particles_quad = mesh_find("default/quad");
+
+	particles_tex = tex_create();
+	tex_set_colors (particles_tex, size, size, colors);
+	tex_set_address(particles_tex, tex_address_clamp);
+	tex_set_id     (particles_tex, "render/particle_tex");
+
+	shader_t shader = shader_find("default/shader_unlit");
+	particles_material = material_create(shader);
+	material_set_id          (particles_material, "render/particle_material");
+	material_set_transparency(particles_material, transparency_blend);
+	material_set_texture     (particles_material, "diffuse", particles_tex);
+	shader_release(shader);
+
+	return particles_material != nullptr;
+}
+
+///////////////////////////////////////////
+
+void particles_update() {
+	{
+		lock_guard<mutex> guard(particles_lock);
+		particles_frame.swap(particles_active);
+		particles_active.clear();
+	}
+	if (particles_frame.size() == 0)
+		return;
+
+	float dt = time_elapsedf();
+	particles_step_info.dt = dt;
+
+	// Spawning is cheap and needs the emitter's random state in order, so
+	// it stays on this thread.
+	for (size_t i = 0; i < particles_frame.size(); i++) {
+		particles_t particles = particles_frame[i];
+		particles->drawn = false;
+
+		float   to_spawn = particles->spawn_carry + particles->emitter.rate * dt;
+		int32_t count    = (int32_t)to_spawn;
+		particles->spawn_carry = to_spawn - count;
+		{
+			lock_guard<mutex> guard(particles_lock);
+			count += particles->burst;
+			particles->burst = 0;
+		}
+
+		particle_spawn_t spawn;
+		spawn.transform       = particles->transform;
+		spawn.velocity        = particles->emitter.velocity;
+		spawn.velocity_spread = particles->emitter.velocity_spread;
+		spawn.radius          = particles->emitter.radius;
+		spawn.life_min        = particles->emitter.life_min;
+		spawn.life_max        = particles->emitter.life_max;
+		spawn.seed            = particles->seed;
+		particle_sim_spawn(particles->particles, spawn, count);
+		particles->seed = spawn.seed;
+	}
+
+	// Step everything, in parallel if there's enough of it
+	particles_make_jobs();
+	int32_t total = 0;
+	for (size_t i = 0; i < particles_frame.size(); i++)
+		total += particles_frame[i]->particles.count;
+	particles_run_jobs(particles_job_step, total);
+
+	for (size_t i = 0; i < particles_frame.size(); i++)
+		particle_sim_compact(particles_frame[i]->particles);
+	{
+		lock_guard<mutex> guard(particles_lock);
+		for (size_t i = 0; i < particles_frame.size(); i++)
+			particles_frame[i]->count = particles_frame[i]->particles.count;
+	}
+
+	// Each system is a single instanced draw, facing the user's head
+	vec3 right   = input_head_pose.orientation * vec3{ 1,0,0 };
+	vec3 up      = input_head_pose.orientation * vec3{ 0,1,0 };
+	vec3 forward = input_head_pose.orientation * vec3{ 0,0,1 };
+	particles_make_jobs();
+	total = 0;
+	for (size_t i = 0; i < particles_frame.size(); i++)
+		total += particles_frame[i]->particles.count;
+
+	// Reserving up front keeps each batch's instance pointer valid while
+	// the others are added.
+	render_reserve_instances(total);
+	for (size_t i = 0; i < particles_frame.size(); i++) {
+		particles_t particles = particles_frame[i];
+		particles->look.right   = right;
+		particles->look.up      = up;
+		particles->look.forward = forward;
+		if (particles->particles.count == 0)
+			continue;
+
+		render_instance_t *instances = render_add_instances(particles_quad, particles->material, matrix_mul_point(particles->transform, vec3_zero), particles->particles.count);
+		for (size_t j = 0; j < particles_jobs.size(); j++) {
+			if (particles_jobs[j].particles == particles)
+				particles_jobs[j].instances = instances + particles_jobs[j].start;
+		}
+	}
+	particles_run_jobs(particles_job_instances, total);
+
+	particles_frame.clear();
+}
+
+///////////////////////////////////////////
+
+void particles_shutdown() {
+	while (particles_list.size() > 0) {
+		log_warn("A particle system wasn't released before shutdown!");
+		particles_release(particles_list[0]);
+	}
+	material_release(particles_material);
+	tex_release     (particles_tex);
+	mesh_release    (particles_quad);
+}
+
+} // namespace sk
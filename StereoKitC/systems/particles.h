@@ -0,0 +1,9 @@
+#pragma once
+
+namespace sk {
+
+bool particles_init    ();
+void particles_update  ();
+void particles_shutdown();
+
+} // namespace sk
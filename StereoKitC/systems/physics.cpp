@@ -209,4 +209,12 @@ void solid_get_pose(const solid_t solid, pose_t &out_pose) {
 	memcpy(&out_pose.orientation, &solid_tr.getOrientation().x, sizeof(quat));
 }
 
+///////////////////////////////////////////
+
+void solid_get_poses(const solid_t *solids, int32_t count, pose_t *out_poses) {
+	for (int32_t i = 0; i < count; i++) {
+		solid_get_pose(solids[i], out_poses[i]);
+	}
+}
+
 } // namespace sk
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "../../_stereokit.h"
 #include "../../systems/d3d.h"
 #include "../../systems/render.h"
+#include "../../systems/render_pipeline.h"
 #include "../../systems/input.h"
 #include "../../systems/input_hand.h"
 #include "../../asset_types/texture.h"
@@ -533,14 +534,18 @@ void openxr_shutdown() {
 
 void openxr_step_begin() {
 	openxr_poll_events();
-	if (xr_running)
+	if (xr_running) {
+		openxr_wait_frame  ();
 		openxr_poll_actions();
+	}
 }
 
 ///////////////////////////////////////////
 
 void openxr_step_end() {
-	if (xr_running)
+	// This may be on the render thread, so it only goes by what the app
+	// thread handed over in render_frame_swap.
+	if (render_frame_display_time() != 0)
 		openxr_render_frame();
 }
 
@@ -553,6 +558,8 @@ void openxr_poll_events() {
 		switch (event_buffer.type) {
 		case XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED: {
 			XrEventDataSessionStateChanged *changed = (XrEventDataSessionStateChanged*)&event_buffer;
+			// Don't pull the session out from under a frame that's still rendering
+			render_pipeline_sync();
 			xr_session_state = changed->state;
 			sk_focused       = xr_session_state == XR_SESSION_STATE_VISIBLE || xr_session_state == XR_SESSION_STATE_FOCUSED;
 
@@ -578,37 +585,48 @@ void openxr_poll_events() {
 
 ///////////////////////////////////////////
 
-void openxr_render_frame() {
+void openxr_wait_frame() {
 	// Block until the previous frame is finished displaying, and is ready for another one.
 	// Also returns a prediction of when the next frame will be displayed, for use with predicting
-	// locations of controllers, viewpoints, etc.
+	// locations of controllers, viewpoints, etc. This stays on the app thread, so input can be
+	// polled for the time this frame will actually show up, and only the time itself goes over
+	// to the render thread.
 	XrFrameState frame_state = { XR_TYPE_FRAME_STATE };
-	xrWaitFrame (xr_session, nullptr, &frame_state);
+	xrWaitFrame(xr_session, nullptr, &frame_state);
+
+	xr_time = frame_state.predictedDisplayTime;
+	render_set_display_time(xr_time);
+}
+
+///////////////////////////////////////////
+
+void openxr_render_frame() {
+	XrTime display_time = render_frame_display_time();
+
 	// Must be called before any rendering is done! This can return some interesting flags, like 
 	// XR_SESSION_VISIBILITY_UNAVAILABLE, which means we could skip rendering this frame and call
 	// xrEndFrame right away.
 	xrBeginFrame(xr_session, nullptr);
 
-	// Timing also needs some work, may be best as some sort of anchor system
-	xr_time = frame_state.predictedDisplayTime + frame_state.predictedDisplayPeriod;
-
-	// Execute any code that's dependant on the predicted time, such as updating the location of
-	// controller models.
-	//openxr_poll_predicted(frame_state.predictedDisplayTime);
-	uwp_update_hands(frame_state.predictedDisplayTime, true);
+	// App code submitted head relative content using a head pose from much
+	// earlier in the frame, so latch the freshest prediction we can get for
+	// the actual display time.
+	pose_t head_latch;
+	if (openxr_get_space(xr_head_space, display_time, head_latch))
+		render_set_head_latch(head_latch);
 
 	// If the session is active, lets render our layer in the compositor!
 	XrCompositionLayerBaseHeader            *layer      = nullptr;
 	XrCompositionLayerProjection             layer_proj = { XR_TYPE_COMPOSITION_LAYER_PROJECTION };
 	vector<XrCompositionLayerProjectionView> views;
 	bool session_active = xr_session_state == XR_SESSION_STATE_VISIBLE || xr_session_state == XR_SESSION_STATE_FOCUSED;
-	if (session_active && openxr_render_layer(frame_state.predictedDisplayTime, views, layer_proj)) {
+	if (session_active && openxr_render_layer(display_time, views, layer_proj)) {
 		layer = (XrCompositionLayerBaseHeader*)&layer_proj;
 	}
 
 	// We're finished with rendering our layer, so send it off for display!
 	XrFrameEndInfo end_info{ XR_TYPE_FRAME_END_INFO };
-	end_info.displayTime          = frame_state.predictedDisplayTime;
+	end_info.displayTime          = display_time;
 	end_info.environmentBlendMode = xr_blend;
 	end_info.layerCount           = layer == nullptr ? 0 : 1;
 	end_info.layers               = &layer;
@@ -926,7 +944,7 @@ void openxr_poll_actions() {
 		}
 	}
 
-	uwp_update_hands(xr_time, false);
+	uwp_update_hands(xr_time, true);
 }
 
 ///////////////////////////////////////////
@@ -7,6 +7,7 @@ void openxr_shutdown      ();
 void openxr_step_begin    ();
 void openxr_step_end      ();
 void openxr_poll_events   ();
+void openxr_wait_frame    ();
 void openxr_render_frame  ();
 void openxr_make_actions  ();
 void openxr_poll_actions  ();
@@ -9,6 +9,7 @@
 #include "../../asset_types/texture.h"
 #include "../d3d.h"
 #include "../render.h"
+#include "../render_pipeline.h"
 #include "win32_input.h"
 
 namespace sk {
@@ -349,6 +350,7 @@ private:
 		log_infof("Resized to: %d<~BLK>x<~clr>%d", outputWidth, outputHeight);
 
 		if (uwp_swapchain != nullptr) {
+			render_pipeline_sync();
 			tex_releasesurface(uwp_target);
 			uwp_swapchain->ResizeBuffers(0, (UINT)d3d_screen_width, (UINT)d3d_screen_height, DXGI_FORMAT_UNKNOWN, 0);
 			ID3D11Texture2D *back_buffer;
@@ -14,6 +14,7 @@
 #include "../../_stereokit.h"
 #include "../../asset_types/texture.h"
 #include "../render.h"
+#include "../render_pipeline.h"
 #include "../d3d.h"
 #include "../input.h"
 
@@ -42,6 +43,7 @@ void win32_resize(int width, int height) {
 	log_diagf("Resized to: %d<~BLK>x<~clr>%d", width, height);
 	
 	if (win32_swapchain != nullptr) {
+		render_pipeline_sync();
 		tex_releasesurface(win32_target);
 		win32_swapchain->ResizeBuffers(0, (UINT)d3d_screen_width, (UINT)d3d_screen_height, DXGI_FORMAT_UNKNOWN, 0);
 		ID3D11Texture2D *back_buffer;
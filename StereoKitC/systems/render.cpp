@@ -5,6 +5,8 @@
 #include "../spherical_harmonics.h"
 #include "../stereokit.h"
 #include "../hierarchy.h"
+#include "../radix_sort.h"
+#include "../memory_tracking.h"
 #include "../asset_types/mesh.h"
 #include "../asset_types/texture.h"
 #include "../asset_types/shader.h"
@@ -12,12 +14,21 @@
 #include "../asset_types/model.h"
 #include "../shaders_builtin/shader_builtin.h"
 #include "../systems/input.h"
+#include "../systems/render_pipeline.h"
+#include "../systems/render_lights.h"
+#include "../systems/mesh_arena.h"
+#include "../systems/tex_upload.h"
+#include "../systems/state_cache.h"
+#include "../systems/thread_chunks.h"
+#include "../_stereokit.h"
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "../libraries/stb_image_write.h"
 
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 using namespace std;
 
 #include <directxmath.h> // Matrix math functions and objects
@@ -34,6 +45,23 @@ struct render_item_t {
 	mesh_t      mesh;
 	material_t  material;
 	uint64_t    sort_id;
+	bool        head_relative;
+	// When inst_count isn't zero, this item draws instances from the
+	// queue's instance list, and transform is only used for sorting.
+	uint32_t    inst_start = 0;
+	uint32_t    inst_count = 0;
+	vec4        inst_data  = {}; // For shaders with '// [inst]' fields
+};
+// The LOD level a model subset was drawn with, so next frame's draw of it
+// can apply hysteresis.
+struct render_lod_t {
+	uint64_t key;
+	int32_t  level;
+};
+struct render_queue_t {
+	vector<render_item_t>     items;
+	vector<render_instance_t> instances;
+	vector<render_lod_t>      lods;
 };
 struct render_transform_buffer_t {
 	XMMATRIX world;
@@ -49,6 +77,9 @@ struct render_global_buffer_t {
 	vec4     camera_dir[2];
 	vec4     fingertip[2];
 	float    time;
+	XMMATRIX cluster_view;
+	vec4     cluster_proj;  // x scale, y scale, x offset, y offset
+	vec4     cluster_depth; // near plane, depth scale, light count
 };
 struct render_blit_data_t {
 	float width;
@@ -60,6 +91,25 @@ struct render_inst_buffer {
 	size_t       max;
 	shaderargs_t buffer;
 };
+// A run of the instance list that draws with a single mesh.
+struct render_batch_span_t {
+	mesh_t   mesh;
+	uint32_t inst_start;
+	uint32_t inst_count;
+};
+struct render_frame_state_t {
+	vec4   lighting[9];
+	vec4   fingertip[2];
+	float  time;
+	pose_t head;
+	tex_t  sky_cubemap;
+	matrix camera_tr;
+	matrix camera_proj;
+	int64_t display_time;
+};
+struct _render_cmdbuf_t {
+	vector<render_item_t> items;
+};
 struct render_screenshot_t {
 	char *filename;
 	vec3  from;
@@ -72,8 +122,18 @@ struct render_screenshot_t {
 
 vector<render_transform_buffer_t> render_instance_list;
 render_inst_buffer                render_instance_buffers[] = { { 1 }, { 5 }, { 10 }, { 20 }, { 50 }, { 100 }, { 250 }, { 500 }, { 682 } };
-
-vector<render_item_t>  render_queue;
+vector<render_batch_span_t>       render_batch_spans;
+ID3D11Buffer                     *render_instance_ids;
+// Custom per-instance data, parallel to render_instance_list, but only
+// filled for shaders that declare '// [inst]' fields.
+vector<vec4>                      render_instance_data;
+ID3D11Buffer                     *render_instance_data_buffer;
+bool32_t                          render_batching = true;
+
+render_queue_t         render_queue;
+render_queue_t         render_queue_draw;
+thread_chunks_t<render_queue_t> render_thread_queues;
+render_frame_state_t   render_frame_state;
 shaderargs_t           render_shader_globals;
 shaderargs_t           render_shader_blit;
 matrix                 render_default_camera_tr;
@@ -87,24 +147,113 @@ vec4                   render_lighting[9] = {};
 
 vector<render_screenshot_t>  render_screenshot_list;
 
+// render_stats is only touched by the drawing thread, uploads can come from
+// anywhere, and are gathered up when the frame is done.
+const int32_t   render_stats_history_size = 120;
+atomic<int64_t> render_stats_uploads[render_upload_max];
+atomic<int32_t> render_stats_reallocs;
+mutex           render_stats_lock;
+render_stats_t  render_stats_last;
+render_stats_t  render_stats_history[render_stats_history_size];
+int32_t         render_stats_history_count = 0;
+int32_t         render_stats_history_next  = 0;
+
 mesh_t     render_sky_mesh = nullptr;
 material_t render_sky_mat = nullptr;
 tex_t      render_sky_cubemap = nullptr;
 bool32_t   render_sky_show = false;
 
+vector<sort_key_t> render_sort_keys;
+vector<sort_key_t> render_sort_scratch;
+bool32_t           render_sort_opaque = true;
+
+// Material and mesh ids aren't dense or stable enough to fit in 10 bits of
+// the sort key, so each draw numbers them by pointer in the order they
+// first show up, which only runs out past 1024 of them in one frame.
+struct render_remap_t {
+	vector<const void *> keys;
+	vector<uint32_t>     values;
+	uint32_t             count;
+};
+render_remap_t     render_remap_materials;
+render_remap_t     render_remap_meshes;
+
+// Last frame's LOD levels, rebuilt at render_frame_swap and only read while
+// draws are being submitted, so worker threads can look things up without
+// a lock. Open addressing, with a key of 0 marking an empty slot.
+struct render_lod_history_t {
+	vector<uint64_t> keys;
+	vector<int32_t>  levels;
+};
+render_lod_history_t render_lod_history;
+
+// The primary view of the last frame drawn, which draws being submitted now
+// measure their screen size against when picking LODs. Under XR this is the
+// first eye, with its own FOV. The drawing thread writes render_drawn_*, and
+// render_frame_swap copies it over while that thread is idle.
+matrix render_drawn_view;
+matrix render_drawn_proj;
+bool   render_drawn          = false;
+vec3   render_lod_camera     = vec3_zero;
+float  render_lod_proj_scale = 1;
+
+// The queues are vectors rather than sk_malloc memory, so their capacity is
+// reported to memory tracking by hand each frame.
+int64_t render_memory_reported = 0;
+
+pose_t     render_head_latch   = { vec3_zero, quat_identity };
+int64_t    render_display_time = 0;
+bool       render_head_latched = false;
+
 material_t render_last_material;
 shader_t   render_last_shader;
 mesh_t     render_last_mesh;
+// Meshes in the same arena share buffers, so these get tracked separately
+ID3D11Buffer *render_last_verts;
+ID3D11Buffer *render_last_inds;
+// State ids from the state cache, unknown forces the next bind through
+const state_id_t render_state_unknown = 0xFFFF;
+state_id_t       render_last_blend    = render_state_unknown;
+state_id_t       render_last_raster   = render_state_unknown;
+ID3D11ShaderResourceView *render_last_textures[10];
 
 ///////////////////////////////////////////
 
 shaderargs_t *render_fill_inst_buffer(vector<render_transform_buffer_t> &list, size_t &offset, size_t &out_count);
+void          render_draw_batch      (material_t material);
+void          render_fill_inst_data  (uint32_t start, uint32_t count);
+void          render_set_instance_ids();
 void          render_check_screenshots();
+void          render_memory_report   ();
 
 ///////////////////////////////////////////
 
+// Sort ids, from most to least significant bits:
+// [63..48] queue, alpha_mode*1000 + queue_offset, biased so negative
+//          offsets still sort before the base queue
+// [47..28] material sort key: shader, then render states, then texture
+//          set, so the expensive swaps happen the least
+// [27..18] material, left empty until draw time
+// [17.. 8] mesh, left empty until draw time
+// [ 7.. 1] left empty, depth goes here at draw time for opaque items
+// [0]      set for blended items, which get re-keyed back to front
 inline uint64_t render_queue_id(material_t material, mesh_t mesh) {
-	return ((uint64_t)(material->alpha_mode*1000 + material->queue_offset) << 32) | (material->header.index << 16) | mesh->header.index;
+	int32_t queue = material->alpha_mode*1000 + material->queue_offset + 0x8000;
+	queue = queue < 0 ? 0 : (queue > 0xFFFF ? 0xFFFF : queue);
+	return
+		((uint64_t)queue                          << 48) |
+		((uint64_t)(material->sort_key & 0xFFFFF) << 28) |
+		(material->alpha_mode == transparency_blend ? 1 : 0);
+}
+
+///////////////////////////////////////////
+
+// The queue that draws from the current thread should go into. Worker
+// threads get their own, which are merged in at render_frame_swap.
+inline render_queue_t &render_submit_queue() {
+	return sk_on_main_thread()
+		? render_queue
+		: thread_chunk_get(render_thread_queues);
 }
 
 ///////////////////////////////////////////
@@ -180,23 +329,194 @@ bool32_t render_enabled_skytex() {
 
 ///////////////////////////////////////////
 
-void render_add_mesh(mesh_t mesh, material_t material, const matrix &transform, color128 color) {
+void render_enable_opaque_sort(bool32_t front_to_back) {
+	render_sort_opaque = front_to_back;
+}
+
+///////////////////////////////////////////
+
+bool32_t render_enabled_opaque_sort() {
+	return render_sort_opaque;
+}
+
+///////////////////////////////////////////
+
+void render_enable_batching(bool32_t enabled) {
+	render_batching = enabled;
+}
+
+///////////////////////////////////////////
+
+bool32_t render_enabled_batching() {
+	return render_batching;
+}
+
+///////////////////////////////////////////
+
+void render_add_mesh_internal(mesh_t mesh, material_t material, const matrix &transform, color128 color, bool head_relative, vec4 inst_data = {}) {
 	render_item_t item;
-	item.mesh     = mesh;
-	item.material = material;
-	item.color    = color;
-	item.sort_id  = render_queue_id(material, mesh);
+	item.mesh          = mesh;
+	item.material      = material;
+	item.color         = color;
+	item.sort_id       = render_queue_id(material, mesh);
+	item.head_relative = head_relative;
+	item.inst_data     = inst_data;
 	if (hierarchy_enabled) {
 		matrix_mul(transform, hierarchy_stack.back().transform, item.transform);
 	} else {
 		math_matrix_to_fast(transform, &item.transform);
 	}
-	render_queue.emplace_back(item);
+	render_submit_queue().items.emplace_back(item);
 }
 
 ///////////////////////////////////////////
 
-void render_add_model(model_t model, const matrix &transform, color128 color) {
+void render_add_mesh(mesh_t mesh, material_t material, const matrix &transform, color128 color) {
+	render_add_mesh_internal(mesh, material, transform, color, false);
+}
+
+///////////////////////////////////////////
+
+void render_add_mesh_data(mesh_t mesh, material_t material, const matrix &transform, color128 color, vec4 inst_data) {
+	render_add_mesh_internal(mesh, material, transform, color, false, inst_data);
+}
+
+///////////////////////////////////////////
+
+void render_add_mesh_list(const render_mesh_cmd_t *commands, int32_t count) {
+	if (count <= 0) return;
+
+	vector<render_item_t> &queue = render_submit_queue().items;
+	size_t start = queue.size();
+	queue.resize(start + count);
+	render_item_t *items = &queue[start];
+
+	XMMATRIX parent;
+	if (hierarchy_enabled)
+		math_matrix_to_fast(hierarchy_stack.back().transform, &parent);
+
+	for (int32_t i = 0; i < count; i++) {
+		const render_mesh_cmd_t &cmd  = commands[i];
+		render_item_t           &item = items[i];
+		item.mesh          = cmd.mesh;
+		item.material      = cmd.material;
+		item.color         = cmd.color;
+		item.sort_id       = render_queue_id(cmd.material, cmd.mesh);
+		item.head_relative = false;
+		math_matrix_to_fast(cmd.transform, &item.transform);
+		if (hierarchy_enabled)
+			item.transform = XMMatrixMultiply(item.transform, parent);
+	}
+}
+
+///////////////////////////////////////////
+
+void render_add_mesh_head(mesh_t mesh, material_t material, const matrix &head_transform, color128 color) {
+	render_add_mesh_internal(mesh, material, head_transform, color, true);
+}
+
+///////////////////////////////////////////
+
+render_instance_t *render_add_instances(mesh_t mesh, material_t material, vec3 sort_center, int32_t count) {
+	if (count <= 0) return nullptr;
+
+	render_queue_t &queue = render_submit_queue();
+	render_item_t   item;
+	item.mesh          = mesh;
+	item.material      = material;
+	item.color         = { 1,1,1,1 };
+	item.sort_id       = render_queue_id(material, mesh);
+	item.head_relative = false;
+	item.transform     = XMMatrixTranslation(sort_center.x, sort_center.y, sort_center.z);
+	item.inst_start    = (uint32_t)queue.instances.size();
+	item.inst_count    = (uint32_t)count;
+	queue.items.emplace_back(item);
+
+	queue.instances.resize(queue.instances.size() + count);
+	return &queue.instances[item.inst_start];
+}
+
+///////////////////////////////////////////
+
+void render_reserve_instances(int32_t count) {
+	vector<render_instance_t> &instances = render_submit_queue().instances;
+	instances.reserve(instances.size() + count);
+}
+
+///////////////////////////////////////////
+
+// How much of the primary view's height the bounds cover, roughly. 1 is the
+// whole view, and anything the camera is inside of counts as larger than
+// that.
+float render_screen_size(const XMMATRIX &transform, const bounds_t &bounds, bool head_relative) {
+	XMVECTOR center = XMVector3Transform(XMLoadFloat3((XMFLOAT3 *)&bounds.center), transform);
+	XMVECTOR camera = head_relative
+		? XMVectorZero()
+		: XMLoadFloat3((XMFLOAT3 *)&render_lod_camera);
+	float scale_sq = fmaxf(XMVectorGetX(XMVector3LengthSq(transform.r[0])), fmaxf(
+		XMVectorGetX(XMVector3LengthSq(transform.r[1])),
+		XMVectorGetX(XMVector3LengthSq(transform.r[2]))));
+	float radius = vec3_magnitude(bounds.dimensions) * 0.5f * sqrtf(scale_sq);
+	float dist   = XMVectorGetX(XMVector3Length(XMVectorSubtract(center, camera)));
+	if (dist <= radius)
+		return 2;
+	return (radius * render_lod_proj_scale) / dist;
+}
+
+///////////////////////////////////////////
+
+// Draws don't have an identity of their own, so a model subset drawn at
+// the same spot as last frame, to the centimeter, counts as the same draw.
+// Anything moving faster than that crosses LOD thresholds in one direction
+// anyway, so it doesn't need the hysteresis.
+uint64_t render_lod_key(model_t model, int32_t subset, const XMMATRIX &transform, bool head_relative) {
+	XMFLOAT3 at;
+	XMStoreFloat3(&at, transform.r[3]);
+	uint64_t key = (uint64_t)(uintptr_t)model + (uint64_t)subset * 2 + (head_relative ? 1 : 0);
+	key = (key ^ (uint32_t)(int32_t)floorf(at.x * 100)) * 0x9E3779B97F4A7C15ULL;
+	key = (key ^ (uint32_t)(int32_t)floorf(at.y * 100)) * 0x9E3779B97F4A7C15ULL;
+	key = (key ^ (uint32_t)(int32_t)floorf(at.z * 100)) * 0x9E3779B97F4A7C15ULL;
+	return key == 0 ? 1 : key;
+}
+
+///////////////////////////////////////////
+
+int32_t render_lod_history_get(uint64_t key) {
+	if (render_lod_history.keys.size() == 0)
+		return -1;
+	size_t mask = render_lod_history.keys.size() - 1;
+	size_t at   = (size_t)(key >> 32) & mask;
+	while (render_lod_history.keys[at] != 0) {
+		if (render_lod_history.keys[at] == key)
+			return render_lod_history.levels[at];
+		at = (at + 1) & mask;
+	}
+	return -1;
+}
+
+///////////////////////////////////////////
+
+void render_lod_history_build(const vector<render_lod_t> &lods) {
+	// Power of two, and at most half full
+	size_t size = 64;
+	while (size < lods.size() * 2)
+		size *= 2;
+	render_lod_history.keys  .assign(size, 0);
+	render_lod_history.levels.resize(size);
+
+	size_t mask = size - 1;
+	for (size_t i = 0; i < lods.size(); i++) {
+		size_t at = (size_t)(lods[i].key >> 32) & mask;
+		while (render_lod_history.keys[at] != 0 && render_lod_history.keys[at] != lods[i].key)
+			at = (at + 1) & mask;
+		render_lod_history.keys  [at] = lods[i].key;
+		render_lod_history.levels[at] = lods[i].level;
+	}
+}
+
+///////////////////////////////////////////
+
+void render_add_model_internal(model_t model, const matrix &transform, color128 color, bool head_relative) {
 	XMMATRIX root;
 	if (hierarchy_enabled) {
 		matrix_mul(transform, hierarchy_stack.back().transform, root);
@@ -204,27 +524,286 @@ void render_add_model(model_t model, const matrix &transform, color128 color) {
 		math_matrix_to_fast(transform, &root);
 	}
 
+	render_queue_t &queue = render_submit_queue();
 	for (int i = 0; i < model->subset_count; i++) {
-		render_item_t item;
-		item.mesh     = model->subsets[i].mesh;
-		item.material = model->subsets[i].material;
-		item.color    = color;
-		item.sort_id  = render_queue_id(item.material, item.mesh);
-		matrix_mul(model->subsets[i].offset, root, item.transform);
-		render_queue.emplace_back(item);
+		model_subset_t &subset = model->subsets[i];
+		render_item_t   item;
+		matrix_mul(subset.offset, root, item.transform);
+		item.mesh = subset.mesh;
+		if (subset.lod_count > 0) {
+			uint64_t key   = render_lod_key(model, i, item.transform, head_relative);
+			int32_t  level = model_lod_select(subset, render_screen_size(item.transform, subset.mesh->bounds, head_relative), render_lod_history_get(key));
+			item.mesh = model_lod_mesh(subset, level);
+			queue.lods.push_back({ key, level });
+		}
+		item.material      = subset.material;
+		item.color         = color;
+		item.sort_id       = render_queue_id(item.material, item.mesh);
+		item.head_relative = head_relative;
+		queue.items.emplace_back(item);
 	}
 }
 
 ///////////////////////////////////////////
 
-void render_draw_queue(const matrix *views, const matrix *projections, int32_t view_count) {
-	size_t queue_size = render_queue.size();
-	if (queue_size == 0) return;
+void render_add_model(model_t model, const matrix &transform, color128 color) {
+	render_add_model_internal(model, transform, color, false);
+}
+
+///////////////////////////////////////////
+
+void render_add_model_head(model_t model, const matrix &head_transform, color128 color) {
+	render_add_model_internal(model, head_transform, color, true);
+}
+
+///////////////////////////////////////////
+
+// Brings instance transforms into world space once, with the hierarchy
+// applied, and returns their average position for sorting. Models re-use
+// the result for every subset.
+vec3 render_world_instances(const matrix *transforms, int32_t count, vector<matrix> &out_world) {
+	out_world.resize(count);
+
+	XMMATRIX parent;
+	if (hierarchy_enabled)
+		math_matrix_to_fast(hierarchy_stack.back().transform, &parent);
+
+	XMVECTOR center = XMVectorZero();
+	for (int32_t i = 0; i < count; i++) {
+		XMMATRIX world;
+		math_matrix_to_fast(transforms[i], &world);
+		if (hierarchy_enabled)
+			world = XMMatrixMultiply(world, parent);
+		center = XMVectorAdd(center, world.r[3]);
+		math_fast_to_matrix(world, &out_world[i]);
+	}
+	center = XMVectorScale(center, 1.0f / count);
+	return math_fast_to_vec3(center);
+}
+
+///////////////////////////////////////////
+
+void render_fill_instances(render_instance_t *out_instances, const matrix *world, const color128 *colors, int32_t count, const matrix *offset) {
+	if (offset == nullptr) {
+		for (int32_t i = 0; i < count; i++)
+			out_instances[i].transform = world[i];
+	} else {
+		XMMATRIX offset_fast;
+		math_matrix_to_fast(*offset, &offset_fast);
+		for (int32_t i = 0; i < count; i++) {
+			XMMATRIX world_fast;
+			math_matrix_to_fast(world[i], &world_fast);
+			math_fast_to_matrix(XMMatrixMultiply(offset_fast, world_fast), &out_instances[i].transform);
+		}
+	}
 
-	// Sort the draw list
-	sort(render_queue.begin(), render_queue.end(), [](const render_item_t &a, const render_item_t &b) -> bool { 
-		return a.sort_id < b.sort_id;
+	if (colors == nullptr) {
+		for (int32_t i = 0; i < count; i++)
+			out_instances[i].color = { 1,1,1,1 };
+	} else {
+		for (int32_t i = 0; i < count; i++)
+			out_instances[i].color = colors[i];
+	}
+}
+
+///////////////////////////////////////////
+
+void render_add_mesh_instances(mesh_t mesh, material_t material, const matrix *transforms, const color128 *colors, int32_t count) {
+	if (count <= 0) return;
+
+	thread_local vector<matrix> world;
+	vec3 center = render_world_instances(transforms, count, world);
+
+	render_instance_t *instances = render_add_instances(mesh, material, center, count);
+	render_fill_instances(instances, world.data(), colors, count, nullptr);
+}
+
+///////////////////////////////////////////
+
+void render_add_model_instances(model_t model, const matrix *transforms, const color128 *colors, int32_t count) {
+	if (count <= 0) return;
+
+	thread_local vector<matrix> world;
+	vec3 center = render_world_instances(transforms, count, world);
+
+	// Each subset becomes one instanced item, with its sort id worked out
+	// once for all the instances. LODs are picked per item rather than per
+	// instance, so instances all get the full detail mesh.
+	render_reserve_instances(count * model->subset_count);
+	for (int32_t i = 0; i < model->subset_count; i++) {
+		model_subset_t    &subset    = model->subsets[i];
+		render_instance_t *instances = render_add_instances(subset.mesh, subset.material, center, count);
+		render_fill_instances(instances, world.data(), colors, count, &subset.offset);
+	}
+}
+
+///////////////////////////////////////////
+
+void render_set_head_latch(const pose_t &head) {
+	render_head_latch   = head;
+	render_head_latched = true;
+}
+
+///////////////////////////////////////////
+
+void render_set_display_time(int64_t time) {
+	render_display_time = time;
+}
+
+///////////////////////////////////////////
+
+int64_t render_frame_display_time() {
+	return render_frame_state.display_time;
+}
+
+///////////////////////////////////////////
+
+void render_frame_swap() {
+	// Hand the app's queue over for drawing, and give the app back an empty
+	// one. Anything the draw reads that the app could change mid-frame gets
+	// copied here too, so the two can safely run on different threads.
+	thread_chunks_drain(render_thread_queues, [](render_queue_t &queue, bool) {
+		uint32_t inst_offset = (uint32_t)render_queue.instances.size();
+		for (size_t i = 0; i < queue.items.size(); i++)
+			queue.items[i].inst_start += inst_offset;
+		render_queue.items    .insert(render_queue.items    .end(), queue.items    .begin(), queue.items    .end());
+		render_queue.instances.insert(render_queue.instances.end(), queue.instances.begin(), queue.instances.end());
+		render_queue.lods     .insert(render_queue.lods     .end(), queue.lods     .begin(), queue.lods     .end());
+		queue.items    .clear();
+		queue.instances.clear();
+		queue.lods     .clear();
 	});
+	render_lod_history_build(render_queue.lods);
+	render_queue.lods.clear();
+
+	// Until something's been drawn, the flatscreen camera is the best guess
+	matrix view_inv;
+	matrix_inverse(render_drawn ? render_drawn_view : render_default_camera_tr, view_inv);
+	render_lod_camera     = matrix_mul_point(view_inv, vec3_zero);
+	render_lod_proj_scale = render_drawn ? render_drawn_proj.row[1].y : render_default_camera_proj.row[1].y;
+	render_queue_draw.items    .clear();
+	render_queue_draw.instances.clear();
+	render_queue_draw.items    .swap(render_queue.items);
+	render_queue_draw.instances.swap(render_queue.instances);
+	render_lights_swap();
+
+	memcpy(render_frame_state.lighting, render_lighting, sizeof(vec4) * 9);
+	render_frame_state.time         = time_getf();
+	render_frame_state.head         = input_head_pose;
+	render_frame_state.sky_cubemap  = render_sky_cubemap;
+	render_frame_state.camera_tr    = render_default_camera_tr;
+	render_frame_state.camera_proj  = render_default_camera_proj;
+	render_frame_state.display_time = render_display_time;
+	render_display_time = 0;
+
+	vec3 tip = input_hand(handed_right).tracked_state & button_state_active ? input_hand(handed_right).fingers[1][4].position : vec3{0,-1000,0};
+	render_frame_state.fingertip[0] = { tip.x, tip.y, tip.z, 0 };
+	tip = input_hand(handed_left).tracked_state & button_state_active ? input_hand(handed_left).fingers[1][4].position : vec3{0,-1000,0};
+	render_frame_state.fingertip[1] = { tip.x, tip.y, tip.z, 0 };
+
+	render_memory_report();
+}
+
+///////////////////////////////////////////
+
+void render_memory_report() {
+	// Called while the drawing thread is idle, so its vectors are safe to
+	// look at too.
+	int64_t bytes =
+		(int64_t)(render_queue.items    .capacity() + render_queue_draw.items    .capacity()) * sizeof(render_item_t) +
+		(int64_t)(render_queue.instances.capacity() + render_queue_draw.instances.capacity()) * sizeof(render_instance_t) +
+		(int64_t)(render_sort_keys      .capacity() + render_sort_scratch        .capacity()) * sizeof(sort_key_t) +
+		(int64_t)(render_remap_materials.keys.capacity() + render_remap_meshes.keys.capacity()) * (sizeof(void *) + sizeof(uint32_t)) +
+		(int64_t) render_lod_history.keys.capacity() * (sizeof(uint64_t) + sizeof(int32_t)) +
+		(int64_t) render_queue.lods      .capacity() * sizeof(render_lod_t) +
+		(int64_t) render_instance_list  .capacity() * sizeof(render_transform_buffer_t) +
+		(int64_t) render_instance_data  .capacity() * sizeof(vec4);
+	memory_track(memory_tag_render, bytes - render_memory_reported);
+	render_memory_reported = bytes;
+}
+
+///////////////////////////////////////////
+
+void render_remap_clear(render_remap_t &remap, size_t item_count) {
+	// Power of two, and at most half full
+	size_t size = 64;
+	while (size < item_count * 2)
+		size *= 2;
+	remap.keys  .assign(size, nullptr);
+	remap.values.resize(size);
+	remap.count = 0;
+}
+
+///////////////////////////////////////////
+
+uint32_t render_remap_get(render_remap_t &remap, const void *key) {
+	size_t mask = remap.keys.size() - 1;
+	size_t at   = (size_t)(((uint64_t)(uintptr_t)key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+	while (remap.keys[at] != nullptr && remap.keys[at] != key)
+		at = (at + 1) & mask;
+	if (remap.keys[at] == nullptr) {
+		remap.keys  [at] = key;
+		remap.values[at] = remap.count++;
+	}
+	return remap.values[at];
+}
+
+///////////////////////////////////////////
+
+// Mixes the item's view depth into its sort id. Blended items need to go
+// back to front to look right, so depth takes over from material and mesh
+// there. Opaque items can go front to back within each material/mesh
+// bucket, which lets the depth test skip more of the hidden pixels.
+uint64_t render_sort_key(const render_item_t &item, const XMMATRIX &head_fast, const XMVECTOR &cam_pos, const XMVECTOR &cam_dir) {
+	uint64_t sort_id = item.sort_id |
+		((uint64_t)(render_remap_get(render_remap_materials, item.material) & 0x3FF) << 18) |
+		((uint64_t)(render_remap_get(render_remap_meshes,    item.mesh    ) & 0x3FF) <<  8);
+	bool blend = (sort_id & 1) != 0;
+	if (!blend && !render_sort_opaque)
+		return sort_id;
+
+	XMVECTOR center = XMLoadFloat3((XMFLOAT3 *)&item.mesh->bounds.center);
+	center = item.head_relative
+		? XMVector3Transform(XMVector3Transform(center, item.transform), head_fast)
+		: XMVector3Transform(center, item.transform);
+	float depth = XMVectorGetX(XMVector3Dot(XMVectorSubtract(center, cam_pos), cam_dir));
+
+	// Positive floats sort the same as their bits do, so the top of the
+	// float is a depth quantization that works for any scale.
+	uint32_t depth_bits = 0;
+	if (depth > 0) memcpy(&depth_bits, &depth, sizeof(depth_bits));
+
+	if (blend) {
+		uint64_t far_first = 0xFFFFFF - (depth_bits >> 7);
+		return
+			(sort_id & 0xFFFF000000000000) |
+			(far_first << 24) |
+			((sort_id >> 8) & 0xFFFFF);
+	} else {
+		// Opaque only has 7 bits, 8 steps per power of two from 1/16m out
+		// to 4km, which is plenty for a rough front to back.
+		int32_t near_first = (int32_t)(depth_bits >> 20) - (123 << 3);
+		near_first = near_first < 0 ? 0 : (near_first > 0x7F ? 0x7F : near_first);
+		return (sort_id & ~(uint64_t)0xFF) | ((uint64_t)near_first << 1);
+	}
+}
+
+///////////////////////////////////////////
+
+void render_draw_queue(const matrix *views, const matrix *projections, int32_t view_count) {
+	// New static meshes are waiting to be copied into their arena, and an
+	// arena defrag may have moved meshes into a different buffer.
+	mesh_arena_flush();
+	tex_upload_flush();
+	render_last_mesh  = nullptr;
+	render_last_verts = nullptr;
+	render_last_inds  = nullptr;
+	render_last_blend  = render_state_unknown;
+	render_last_raster = render_state_unknown;
+
+	size_t queue_size = render_queue_draw.items.size();
+	if (queue_size == 0) return;
+	render_stats.queue_items += (int32_t)queue_size;
 
 	// Copy camera information into the global buffer
 	for (int32_t i = 0; i < view_count; i++) {
@@ -243,47 +822,100 @@ void render_draw_queue(const matrix *views, const matrix *projections, int32_t v
 		render_global_buffer.proj[i] = XMMatrixTranspose(projection_f);
 		render_global_buffer.viewproj[i] = XMMatrixTranspose(view_f * projection_f);
 	}
-	memcpy(render_global_buffer.lighting, render_lighting, sizeof(vec4) * 9);
-	render_global_buffer.time = time_getf();
-
-	vec3 tip = input_hand(handed_right).tracked_state & button_state_active ? input_hand(handed_right).fingers[1][4].position : vec3{0,-1000,0};
-	render_global_buffer.fingertip[0] = { tip.x, tip.y, tip.z, 0 };
-	tip = input_hand(handed_left).tracked_state & button_state_active ? input_hand(handed_left).fingers[1][4].position : vec3{0,-1000,0};
-	render_global_buffer.fingertip[1] = { tip.x, tip.y, tip.z, 0 };
+	memcpy(render_global_buffer.lighting,  render_frame_state.lighting,  sizeof(vec4) * 9);
+	memcpy(render_global_buffer.fingertip, render_frame_state.fingertip, sizeof(vec4) * 2);
+	render_global_buffer.time = render_frame_state.time;
+
+	// Bin this frame's lights into clusters for the views we're drawing
+	render_lights_info_t lights;
+	render_lights_update(views, projections, view_count, render_clip_planes.x, render_clip_planes.y, lights);
+	math_matrix_to_fast(lights.grid.view, &render_global_buffer.cluster_view);
+	render_global_buffer.cluster_view  = XMMatrixTranspose(render_global_buffer.cluster_view);
+	render_global_buffer.cluster_proj  = lights.grid.proj;
+	render_global_buffer.cluster_depth = { lights.grid.near_plane, lights.grid.depth_scale, (float)lights.light_count, 0 };
+	render_stats.lights = lights.light_count;
 
 	shaderargs_set_data  (render_shader_globals, &render_global_buffer);
 	shaderargs_set_active(render_shader_globals);
+	render_stats_upload(render_upload_constant, sizeof(render_global_buffer_t));
 	d3d_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	render_set_instance_ids();
+
+	tex_t sky_cubemap = render_frame_state.sky_cubemap;
+	if (sky_cubemap != nullptr) {
+		ID3D11SamplerState *sky_sampler = state_cache_get_sampler(sky_cubemap->sampler);
+		d3d_context->VSSetSamplers       (11, 1, &sky_sampler);
+		d3d_context->VSSetShaderResources(11, 1, &sky_cubemap->resource);
+		d3d_context->PSSetSamplers       (11, 1, &sky_sampler);
+		d3d_context->PSSetShaderResources(11, 1, &sky_cubemap->resource);
+	}
 
-	if (render_sky_cubemap != nullptr) {
-		d3d_context->VSSetSamplers       (11, 1, &render_sky_cubemap->sampler);
-		d3d_context->VSSetShaderResources(11, 1, &render_sky_cubemap->resource);
-		d3d_context->PSSetSamplers       (11, 1, &render_sky_cubemap->sampler);
-		d3d_context->PSSetShaderResources(11, 1, &render_sky_cubemap->resource);
+	// Head relative content gets attached to the freshest head pose we have,
+	// which may have been latched by the platform long after it was submitted.
+	matrix   head_mat;
+	XMMATRIX head_fast;
+	pose_matrix_out(render_head_latched ? render_head_latch : render_frame_state.head, head_mat);
+	math_matrix_to_fast(head_mat, &head_fast);
+
+	// Sort the draw list by key, with the view's depth mixed into it
+	XMVECTOR cam_pos = XMLoadFloat3((XMFLOAT3 *)&render_global_buffer.camera_pos[0]);
+	XMVECTOR cam_dir = XMLoadFloat3((XMFLOAT3 *)&render_global_buffer.camera_dir[0]);
+	if (view_count > 1) {
+		cam_pos = XMVectorScale(XMVectorAdd(cam_pos, XMLoadFloat3((XMFLOAT3 *)&render_global_buffer.camera_pos[1])), 0.5f);
 	}
+	render_sort_keys   .resize(queue_size);
+	render_sort_scratch.resize(queue_size);
+	render_remap_clear(render_remap_materials, queue_size);
+	render_remap_clear(render_remap_meshes,    queue_size);
+	for (size_t i = 0; i < queue_size; i++) {
+		render_sort_keys[i].key   = render_sort_key(render_queue_draw.items[i], head_fast, cam_pos, cam_dir);
+		render_sort_keys[i].index = (uint32_t)i;
+	}
+	sort_key_t *sorted = radix_sort(render_sort_keys.data(), render_sort_scratch.data(), queue_size);
 
-	render_item_t *item          = &render_queue[0];
+	render_item_t *item          = &render_queue_draw.items[sorted[0].index];
 	material_t     last_material = item->material;
 	mesh_t         last_mesh     = item->mesh;
+	size_t         span_start    = 0;
 	
 	for (size_t i = 0; i < queue_size; i++) {
-		XMMATRIX transpose = XMMatrixTranspose(item->transform);
-		for (int32_t v = 0; v < view_count; v++) {
-			render_instance_list.emplace_back(render_transform_buffer_t { transpose, item->color, (uint32_t)v } );
+		bool inst_data = item->material->shader->inst_desc.float_count > 0;
+		if (item->inst_count > 0) {
+			const render_instance_t *instances = &render_queue_draw.instances[item->inst_start];
+			for (uint32_t n = 0; n < item->inst_count; n++) {
+				XMMATRIX transpose;
+				math_matrix_to_fast(instances[n].transform, &transpose);
+				transpose = XMMatrixTranspose(transpose);
+				for (int32_t v = 0; v < view_count; v++) {
+					render_instance_list.emplace_back(render_transform_buffer_t { transpose, instances[n].color, (uint32_t)v } );
+				}
+				if (inst_data) render_instance_data.insert(render_instance_data.end(), view_count, instances[n].data);
+			}
+		} else {
+			XMMATRIX transpose = XMMatrixTranspose(item->head_relative 
+				? item->transform * head_fast 
+				: item->transform);
+			for (int32_t v = 0; v < view_count; v++) {
+				render_instance_list.emplace_back(render_transform_buffer_t { transpose, item->color, (uint32_t)v } );
+			}
+			if (inst_data) render_instance_data.insert(render_instance_data.end(), view_count, item->inst_data);
 		}
 
-		render_item_t *next = i+1>=queue_size?nullptr:&render_queue[i+1];
+		render_item_t *next = i+1>=queue_size?nullptr:&render_queue_draw.items[sorted[i+1].index];
 		if (next == nullptr || last_material != next->material || last_mesh != next->mesh) {
-			render_set_material(item->material);
-			render_set_mesh    (item->mesh);
-
-			size_t offsets = 0, count = 0;
-			do {
-				shaderargs_t *instances = render_fill_inst_buffer(render_instance_list, offsets, count);
-				shaderargs_set_active(*instances, false);
-				render_draw_item((int)count);
-			} while (offsets != 0);
-			render_instance_list.clear();
+			render_batch_spans.push_back({ item->mesh, (uint32_t)span_start, (uint32_t)(render_instance_list.size() - span_start) });
+			span_start = render_instance_list.size();
+
+			// A different mesh with the same material can keep going in the
+			// same batch, if the shader can start partway into the instances.
+			bool join = next != nullptr
+				&& render_batching
+				&& last_material == next->material
+				&& last_material->shader->batchable;
+			if (!join) {
+				render_draw_batch(item->material);
+				span_start = 0;
+			}
 			
 			if (next != nullptr) {
 				last_material = next->material;
@@ -296,13 +928,67 @@ void render_draw_queue(const matrix *views, const matrix *projections, int32_t v
 
 ///////////////////////////////////////////
 
+void render_draw_batch(material_t material) {
+	render_stats.batches++;
+	render_set_material(material);
+	bool inst_data = material->shader->inst_desc.float_count > 0;
+
+	// The instance list goes up in as few buffers as it fits in, and each
+	// mesh span draws its part of whichever buffer it landed in. Meshes that
+	// share arena buffers don't rebind anything between draws.
+	size_t offsets = 0, count = 0, span = 0;
+	do {
+		uint32_t      chunk_start = (uint32_t)offsets;
+		shaderargs_t *instances   = render_fill_inst_buffer(render_instance_list, offsets, count);
+		uint32_t      chunk_end   = chunk_start + (uint32_t)count;
+		shaderargs_set_active(*instances, false);
+		if (inst_data)
+			render_fill_inst_data(chunk_start, (uint32_t)count);
+
+		while (span < render_batch_spans.size()) {
+			const render_batch_span_t &curr = render_batch_spans[span];
+			uint32_t start = maxi(curr.inst_start, chunk_start);
+			uint32_t end   = mini(curr.inst_start + curr.inst_count, chunk_end);
+			if (end > start) {
+				render_set_mesh (curr.mesh);
+				render_draw_item((int)(end - start), (int)(start - chunk_start));
+			}
+			if (curr.inst_start + curr.inst_count > chunk_end)
+				break;
+			span++;
+		}
+	} while (offsets != 0);
+
+	render_instance_list.clear();
+	render_instance_data.clear();
+	render_batch_spans  .clear();
+}
+
+///////////////////////////////////////////
+
+void render_fill_inst_data(uint32_t start, uint32_t count) {
+	D3D11_MAPPED_SUBRESOURCE resource;
+	if (FAILED(d3d_context->Map(render_instance_data_buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource)))
+		return;
+	memcpy(resource.pData, &render_instance_data[start], sizeof(vec4) * count);
+	d3d_context->Unmap(render_instance_data_buffer, 0);
+	render_stats_upload(render_upload_instance, sizeof(vec4) * count);
+}
+
+///////////////////////////////////////////
+
 void render_draw() {
-	render_draw_matrix(&render_default_camera_tr, &render_default_camera_proj, 1);
+	render_draw_matrix(&render_frame_state.camera_tr, &render_frame_state.camera_proj, 1);
 }
 
 ///////////////////////////////////////////
 
 void render_draw_matrix(const matrix* views, const matrix* projections, int32_t count) {
+	if (count > 0) {
+		render_drawn_view = views[0];
+		render_drawn_proj = projections[0];
+		render_drawn      = true;
+	}
 	render_draw_queue(views, projections, count);
 	render_check_screenshots();
 }
@@ -356,13 +1042,65 @@ void render_check_screenshots() {
 ///////////////////////////////////////////
 
 void render_clear() {
-	//log_infof("draws: %d, material: %d, shader: %d, texture %d, mesh %d", render_stats.draw_calls, render_stats.swaps_material, render_stats.swaps_shader, render_stats.swaps_texture, render_stats.swaps_mesh);
-	render_queue.clear();
+	render_stats.upload_mesh_bytes     = render_stats_uploads[render_upload_mesh    ].exchange(0);
+	render_stats.upload_texture_bytes  = render_stats_uploads[render_upload_texture ].exchange(0);
+	render_stats.upload_constant_bytes = render_stats_uploads[render_upload_constant].exchange(0);
+	render_stats.upload_instance_bytes = render_stats_uploads[render_upload_instance].exchange(0);
+	render_stats.upload_light_bytes    = render_stats_uploads[render_upload_light   ].exchange(0);
+	render_stats.buffer_reallocs       = render_stats_reallocs.exchange(0);
+	{
+		lock_guard<mutex> lock(render_stats_lock);
+		render_stats_last = render_stats;
+		render_stats_history[render_stats_history_next] = render_stats;
+		render_stats_history_next  = (render_stats_history_next + 1) % render_stats_history_size;
+		render_stats_history_count = mini(render_stats_history_count + 1, render_stats_history_size);
+	}
+
+	render_queue_draw.items    .clear();
+	render_queue_draw.instances.clear();
 	render_stats = {};
+	render_head_latched = false;
 
 	render_last_material = nullptr;
 	render_last_shader = nullptr;
 	render_last_mesh = nullptr;
+	render_last_verts = nullptr;
+	render_last_inds = nullptr;
+	render_last_blend = render_state_unknown;
+	render_last_raster = render_state_unknown;
+	memset(render_last_textures, 0, sizeof(render_last_textures));
+}
+
+///////////////////////////////////////////
+
+void render_stats_upload(render_upload_ type, size_t bytes) {
+	render_stats_uploads[type].fetch_add((int64_t)bytes, memory_order_relaxed);
+}
+
+///////////////////////////////////////////
+
+void render_stats_realloc() {
+	render_stats_reallocs.fetch_add(1, memory_order_relaxed);
+}
+
+///////////////////////////////////////////
+
+render_stats_t render_get_stats() {
+	lock_guard<mutex> lock(render_stats_lock);
+	return render_stats_last;
+}
+
+///////////////////////////////////////////
+
+int32_t render_get_stats_history(render_stats_t *out_history, int32_t max_count) {
+	// Newest first, so out_history[0] matches render_get_stats
+	lock_guard<mutex> lock(render_stats_lock);
+	int32_t count = mini(max_count, render_stats_history_count);
+	for (int32_t i = 0; i < count; i++) {
+		int32_t index = (render_stats_history_next - 1 - i + render_stats_history_size) % render_stats_history_size;
+		out_history[i] = render_stats_history[index];
+	}
+	return count;
 }
 
 ///////////////////////////////////////////
@@ -375,6 +1113,28 @@ bool render_initialize() {
 		shaderargs_create(render_instance_buffers[i].buffer, sizeof(render_transform_buffer_t) * render_instance_buffers[i].max, 1);
 	}
 
+	// Instance indices as a per-instance vertex stream, for shaders that
+	// read SK_INSTANCE. D3D11 adds the draw's start instance to these, but
+	// never to SV_InstanceID.
+	uint32_t ids[682];
+	for (uint32_t i = 0; i < _countof(ids); i++)
+		ids[i] = i;
+	D3D11_SUBRESOURCE_DATA id_data = { ids };
+	CD3D11_BUFFER_DESC     id_desc(sizeof(ids), D3D11_BIND_VERTEX_BUFFER, D3D11_USAGE_IMMUTABLE);
+	if (FAILED(d3d_device->CreateBuffer(&id_desc, &id_data, &render_instance_ids))) {
+		log_err("Failed to create the instance id buffer!");
+		return false;
+	}
+	DX11ResType(render_instance_ids, "render_instance_ids");
+
+	// And room for one float4 of custom data per instance, for SK_INST_DATA
+	CD3D11_BUFFER_DESC data_desc(sizeof(vec4) * _countof(ids), D3D11_BIND_VERTEX_BUFFER, D3D11_USAGE_DYNAMIC, D3D11_CPU_ACCESS_WRITE);
+	if (FAILED(d3d_device->CreateBuffer(&data_desc, nullptr, &render_instance_data_buffer))) {
+		log_err("Failed to create the instance data buffer!");
+		return false;
+	}
+	DX11ResType(render_instance_data_buffer, "render_instance_data");
+
 	// Setup a default camera
 	render_set_clip(render_clip_planes.x, render_clip_planes.y);
 	render_set_view(matrix_trs(vec3{ 0,0.2f,0.4f }, quat_lookat({ 0,0.2f,0.4f }, vec3_zero), vec3_one));
@@ -413,6 +1173,7 @@ void render_update() {
 ///////////////////////////////////////////
 
 void render_shutdown() {
+	render_lights_shutdown();
 	material_release(render_sky_mat);
 	mesh_release    (render_sky_mesh);
 	tex_release   (render_sky_cubemap);
@@ -421,6 +1182,8 @@ void render_shutdown() {
 	for (size_t i = 0; i < _countof(render_instance_buffers); i++) {
 		shaderargs_destroy(render_instance_buffers[i].buffer);
 	}
+	if (render_instance_ids         != nullptr) { render_instance_ids        ->Release(); render_instance_ids         = nullptr; }
+	if (render_instance_data_buffer != nullptr) { render_instance_data_buffer->Release(); render_instance_data_buffer = nullptr; }
 
 	shaderargs_destroy(render_shader_blit);
 	shaderargs_destroy(render_shader_globals);
@@ -430,6 +1193,10 @@ void render_shutdown() {
 ///////////////////////////////////////////
 
 void render_blit(tex_t to, material_t material) {
+	render_pipeline_sync();
+	mesh_arena_flush();
+	tex_upload_flush();
+
 	// Set up where on the render target we want to draw, the view has a 
 	D3D11_VIEWPORT viewport = CD3D11_VIEWPORT(0.f, 0.f, (float)to->width, (float)to->height);
 	d3d_context->RSSetViewports(1, &viewport);
@@ -447,7 +1214,9 @@ void render_blit(tex_t to, material_t material) {
 
 	// Setup render states for blitting
 	shaderargs_set_data  (render_shader_blit, &data);
+	render_stats_upload  (render_upload_constant, sizeof(render_blit_data_t));
 	shaderargs_set_active(render_shader_blit);
+	render_set_instance_ids();
 	render_set_material(material);
 	render_set_mesh    (render_blit_quad);
 	
@@ -458,12 +1227,18 @@ void render_blit(tex_t to, material_t material) {
 
 	render_last_material = nullptr;
 	render_last_mesh = nullptr;
+	render_last_verts = nullptr;
+	render_last_inds = nullptr;
+	render_last_blend = render_state_unknown;
+	render_last_raster = render_state_unknown;
 	render_last_shader = nullptr;
+	memset(render_last_textures, 0, sizeof(render_last_textures));
 }
 
 ///////////////////////////////////////////
 
 void render_screenshot(vec3 from_viewpt, vec3 at, int width, int height, const char *file) {
+	render_pipeline_sync();
 	char *file_copy = string_copy(file);
 	render_screenshot_list.push_back( render_screenshot_t{ file_copy, from_viewpt, at, width, height });
 }
@@ -479,6 +1254,7 @@ void render_set_material(material_t material) {
 	render_set_shader    (material->shader);
 	shaderargs_set_data  (material->shader->args, material->args.buffer);
 	shaderargs_set_active(material->shader->args);
+	render_stats_upload  (render_upload_constant, material->shader->args.buffer_size);
 
 	// Fill an array of texture data so we can set them all at the same time
 	ID3D11SamplerState       *samplers [10];
@@ -492,8 +1268,12 @@ void render_set_material(material_t material) {
 		if (tex == nullptr)
 			tex = material->shader->tex_slots.tex[i].default_tex;
 
-		samplers [i] = tex->sampler;
+		samplers [i] = state_cache_get_sampler(tex->sampler);
 		resources[i] = tex->resource;
+		if (render_last_textures[i] != tex->resource) {
+			render_last_textures[i] = tex->resource;
+			render_stats.swaps_texture++;
+		}
 	}
 	if (material->shader->tex_slots.tex_count != 0) {
 		d3d_context->PSSetSamplers       (0, material->shader->tex_slots.tex_count, samplers);
@@ -502,15 +1282,20 @@ void render_set_material(material_t material) {
 		d3d_context->VSSetShaderResources(0, material->shader->tex_slots.tex_count, resources);
 	}
 
-	if (material->alpha_mode == transparency_none) {
-		d3d_context->OMSetBlendState(0,0, 0xFFFFFFFF);
-	} else {
-		d3d_context->OMSetBlendState(material->blend_state, nullptr, 0xFFFFFFFF);
+	// States are shared through the state cache, so materials with the same
+	// settings have the same ids, and don't need a rebind.
+	state_id_t blend = material->alpha_mode == transparency_none ? state_id_none : material->blend_state;
+	if (blend != render_last_blend) {
+		render_last_blend = blend;
+		d3d_context->OMSetBlendState(state_cache_get_blend(blend), nullptr, 0xFFFFFFFF);
 	}
-	if (material->rasterizer_state != nullptr) {
-		d3d_context->RSSetState(material->rasterizer_state);
-	} else {
-		d3d_context->RSSetState(d3d_rasterstate);
+	if (material->raster_state != render_last_raster) {
+		render_last_raster = material->raster_state;
+		if (material->raster_state != state_id_none) {
+			d3d_context->RSSetState(state_cache_get_raster(material->raster_state));
+		} else {
+			d3d_context->RSSetState(d3d_rasterstate);
+		}
 	}
 }
 
@@ -535,22 +1320,35 @@ void render_set_mesh(mesh_t mesh) {
 	render_last_mesh = mesh;
 	render_stats.swaps_mesh++;
 
-	UINT strides[] = { sizeof(vert_t) };
-	UINT offsets[] = { 0 };
-	d3d_context->IASetVertexBuffers(0, 1, &mesh->vert_buffer, strides, offsets);
-#ifdef SK_32BIT_INDICES
-	d3d_context->IASetIndexBuffer  (mesh->ind_buffer, DXGI_FORMAT_R32_UINT, 0);
-#else
-	d3d_context->IASetIndexBuffer  (mesh->ind_buffer, DXGI_FORMAT_R16_UINT, 0);
-#endif
+	if (mesh->vert_buffer != render_last_verts) {
+		render_last_verts = mesh->vert_buffer;
+		UINT strides[] = { sizeof(vert_t) };
+		UINT offsets[] = { 0 };
+		d3d_context->IASetVertexBuffers(0, 1, &mesh->vert_buffer, strides, offsets);
+	}
+	if (mesh->ind_buffer != render_last_inds) {
+		render_last_inds = mesh->ind_buffer;
+		d3d_context->IASetIndexBuffer(mesh->ind_buffer, mesh->ind_wide ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT, 0);
+	}
 }
 
 ///////////////////////////////////////////
 
-void render_draw_item(int count) {
+void render_draw_item(int count, int inst_start) {
 	render_stats.draw_calls++;
+	render_stats.instances += count;
+	render_stats.triangles += (int64_t)(render_last_mesh->ind_draw / 3) * count;
+
+	d3d_context->DrawIndexedInstanced(render_last_mesh->ind_draw, count, render_last_mesh->ind_start, render_last_mesh->vert_start, inst_start);
+}
+
+///////////////////////////////////////////
 
-	d3d_context->DrawIndexedInstanced(render_last_mesh->ind_draw, count, 0, 0, 0);
+void render_set_instance_ids() {
+	ID3D11Buffer *buffers[] = { render_instance_ids, render_instance_data_buffer };
+	UINT          strides[] = { sizeof(uint32_t),    sizeof(vec4) };
+	UINT          offsets[] = { 0, 0 };
+	d3d_context->IASetVertexBuffers(1, 2, buffers, strides, offsets);
 }
 
 ///////////////////////////////////////////
@@ -578,6 +1376,7 @@ shaderargs_t *render_fill_inst_buffer(vector<render_transform_buffer_t> &list, s
 
 	// Copy data into the buffer, and return it!
 	shaderargs_set_data(render_instance_buffers[index].buffer, &list[start], sizeof(render_transform_buffer_t) * out_count);
+	render_stats_upload(render_upload_instance, sizeof(render_transform_buffer_t) * out_count);
 	return &render_instance_buffers[index].buffer;
 }
 
@@ -597,4 +1396,116 @@ void render_get_device(void **device, void **context) {
 	*context = d3d_context;
 }
 
+///////////////////////////////////////////
+
+render_cmdbuf_t render_cmdbuf_create(int32_t capacity) {
+	render_cmdbuf_t result = new _render_cmdbuf_t();
+	if (capacity > 0)
+		result->items.reserve(capacity);
+	return result;
+}
+
+///////////////////////////////////////////
+
+// Each draw in a command buffer holds a reference to its mesh and material,
+// since a buffer can be kept and submitted long after the app let go of
+// them.
+void render_cmdbuf_release_refs(render_cmdbuf_t cmdbuf) {
+	for (size_t i = 0; i < cmdbuf->items.size(); i++) {
+		assets_releaseref(cmdbuf->items[i].mesh    ->header);
+		assets_releaseref(cmdbuf->items[i].material->header);
+	}
+}
+
+///////////////////////////////////////////
+
+void render_cmdbuf_release(render_cmdbuf_t cmdbuf) {
+	if (cmdbuf == nullptr)
+		return;
+
+	render_cmdbuf_release_refs(cmdbuf);
+	delete cmdbuf;
+}
+
+///////////////////////////////////////////
+
+void render_cmdbuf_clear(render_cmdbuf_t cmdbuf) {
+	render_cmdbuf_release_refs(cmdbuf);
+	cmdbuf->items.clear();
+}
+
+///////////////////////////////////////////
+
+int32_t render_cmdbuf_count(render_cmdbuf_t cmdbuf) {
+	return (int32_t)cmdbuf->items.size();
+}
+
+///////////////////////////////////////////
+
+void render_cmdbuf_add_mesh(render_cmdbuf_t cmdbuf, mesh_t mesh, material_t material, const matrix &transform, color128 color) {
+	// Items are stored the way the render queue wants them, so submitting
+	// is mostly a copy. This doesn't touch any global state, so it's safe
+	// to do from any thread. The sort id waits for submit, since materials
+	// can change while the buffer is kept around.
+	render_item_t item;
+	item.mesh          = mesh;
+	item.material      = material;
+	item.color         = color;
+	item.sort_id       = 0;
+	item.head_relative = false;
+	math_matrix_to_fast(transform, &item.transform);
+	cmdbuf->items.emplace_back(item);
+	assets_addref(mesh    ->header);
+	assets_addref(material->header);
+}
+
+///////////////////////////////////////////
+
+void render_cmdbuf_add_list(render_cmdbuf_t cmdbuf, const render_mesh_cmd_t *commands, int32_t count) {
+	if (count <= 0) return;
+
+	size_t start = cmdbuf->items.size();
+	cmdbuf->items.resize(start + count);
+	render_item_t *items = &cmdbuf->items[start];
+	for (int32_t i = 0; i < count; i++) {
+		const render_mesh_cmd_t &cmd  = commands[i];
+		render_item_t           &item = items[i];
+		item.mesh          = cmd.mesh;
+		item.material      = cmd.material;
+		item.color         = cmd.color;
+		item.sort_id       = 0;
+		item.head_relative = false;
+		math_matrix_to_fast(cmd.transform, &item.transform);
+		assets_addref(cmd.mesh    ->header);
+		assets_addref(cmd.material->header);
+	}
+}
+
+///////////////////////////////////////////
+
+void render_cmdbuf_submit(render_cmdbuf_t cmdbuf) {
+	const vector<render_item_t> &items = cmdbuf->items;
+	if (items.size() == 0) return;
+
+	vector<render_item_t> &queue = render_submit_queue().items;
+	size_t start = queue.size();
+	queue.insert(queue.end(), items.begin(), items.end());
+
+	// Sort ids come from the materials as they are now, not when the
+	// buffer was built, same as render_add_mesh.
+	for (size_t i = start; i < queue.size(); i++)
+		queue[i].sort_id = render_queue_id(queue[i].material, queue[i].mesh);
+
+	// The buffer may have been built without knowledge of the hierarchy, so
+	// it gets applied here, with the submitting thread's hierarchy, like
+	// render_add_mesh does.
+	if (hierarchy_enabled) {
+		XMMATRIX parent;
+		math_matrix_to_fast(hierarchy_stack.back().transform, &parent);
+		for (size_t i = start; i < queue.size(); i++) {
+			queue[i].transform = XMMatrixMultiply(queue[i].transform, parent);
+		}
+	}
+}
+
 } // namespace sk
\ No newline at end of file
@@ -4,28 +4,58 @@
 
 namespace sk {
 
-struct render_stats_t {
-	int swaps_mesh;
-	int swaps_shader;
-	int swaps_texture;
-	int swaps_material;
-	int draw_calls;
+enum render_upload_ {
+	render_upload_mesh = 0,
+	render_upload_texture,
+	render_upload_constant,
+	render_upload_instance,
+	render_upload_light,
+	render_upload_max,
 };
 
+// One instance in a render_add_instances batch. The transform is world
+// space, and the hierarchy isn't applied to it.
+struct render_instance_t {
+	matrix   transform;
+	color128 color;
+	vec4     data; // For shaders with '// [inst]' fields
+};
+
+void render_frame_swap  ();
 void render_draw        ();
 void render_draw_matrix (const matrix *views, const matrix *projs, int32_t view_count);
 void render_clear       ();
 vec3 render_unproject_pt(vec3 normalized_screen_pt);
 void render_update_projection();
+void render_set_head_latch(const pose_t &head);
+// The platform's predicted display time for the frame being built, in its
+// own units. Set on the app thread, and read on the drawing side from the
+// copy made in render_frame_swap, 0 when there's nothing to display.
+void    render_set_display_time  (int64_t time);
+int64_t render_frame_display_time();
+
+// Adds a single queue item that draws count instances of mesh with
+// material, and returns space for their data. This should be filled out
+// before the thread adds anything else to the render queue! sort_center is
+// used in place of the instances when sorting the queue.
+render_instance_t *render_add_instances(mesh_t mesh, material_t material, vec3 sort_center, int32_t count);
+// Makes sure the next count instances added from this thread won't move
+// any of the others in memory, so several batches can be filled at once.
+void               render_reserve_instances(int32_t count);
 
 bool render_initialize();
 void render_update();
 void render_shutdown();
 
+// Safe to call from any thread, these go into the stats for the frame
+// that's drawing when they happen.
+void render_stats_upload (render_upload_ type, size_t bytes);
+void render_stats_realloc();
+
 void render_set_material(material_t material);
 void render_set_shader  (shader_t   shader);
 void render_set_texture (tex_t      texture, int slot);
 void render_set_mesh    (mesh_t     mesh);
-void render_draw_item   (int count);
+void render_draw_item   (int count, int inst_start = 0);
 
 } // namespace sk
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "render_lights.h"
+#include "render.h"
+#include "d3d.h"
+#include "thread_chunks.h"
+#include "job_pool.h"
+#include "../hierarchy.h"
+#include "../math.h"
+#include "../_stereokit.h"
+
+#include <string.h>
+#include <vector>
+using namespace std;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct render_light_buffer_t {
+	ID3D11Buffer             *buffer;
+	ID3D11ShaderResourceView *view;
+	uint32_t                  capacity;
+	uint32_t                  stride;
+};
+
+///////////////////////////////////////////
+
+// Lights are immediate mode like everything else in the render queue, so
+// they're submitted each frame, and double buffered for the render thread.
+vector<cluster_light_t>                  render_lights;
+vector<cluster_light_t>                  render_lights_draw;
+thread_chunks_t<vector<cluster_light_t>> render_lights_thread_queues;
+cluster_bins_t                           render_lights_bins;
+render_light_buffer_t                    render_lights_gpu_lights  = { nullptr, nullptr, 0, sizeof(cluster_light_t) };
+render_light_buffer_t                    render_lights_gpu_cells   = { nullptr, nullptr, 0, sizeof(cluster_cell_t)  };
+render_light_buffer_t                    render_lights_gpu_indices = { nullptr, nullptr, 0, sizeof(uint32_t)        };
+
+// Binning is split across the job pool by depth slice. Below this many
+// lights, waking the workers up costs more than it saves.
+const int32_t render_lights_parallel_min = 64;
+
+///////////////////////////////////////////
+
+void render_lights_bin_share(int32_t share, void *context) {
+	int32_t share_count = *(int32_t *)context;
+	int32_t start = ( share      * cluster_z) / share_count;
+	int32_t end   = ((share + 1) * cluster_z) / share_count;
+	light_cluster_bin_slices(render_lights_bins, start, end);
+}
+
+///////////////////////////////////////////
+
+void render_lights_bin() {
+	int32_t share_count = job_pool_threads();
+	if (share_count == 1 || render_lights_bins.visible.size() < render_lights_parallel_min) {
+		light_cluster_bin_slices(render_lights_bins, 0, cluster_z);
+		return;
+	}
+	job_pool_for(share_count, render_lights_bin_share, &share_count);
+}
+
+///////////////////////////////////////////
+
+void render_lights_buffer_set(render_light_buffer_t &buffer, const void *data, uint32_t count) {
+	if (buffer.buffer == nullptr || count > buffer.capacity) {
+		if (buffer.buffer != nullptr) render_stats_realloc();
+		if (buffer.view   != nullptr) buffer.view  ->Release();
+		if (buffer.buffer != nullptr) buffer.buffer->Release();
+		buffer.view     = nullptr;
+		buffer.buffer   = nullptr;
+		buffer.capacity = maxi(maxi(count, buffer.capacity * 2), 64u);
+
+		D3D11_BUFFER_DESC desc = {};
+		desc.ByteWidth           = buffer.capacity * buffer.stride;
+		desc.Usage               = D3D11_USAGE_DYNAMIC;
+		desc.BindFlags           = D3D11_BIND_SHADER_RESOURCE;
+		desc.CPUAccessFlags      = D3D11_CPU_ACCESS_WRITE;
+		desc.MiscFlags           = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+		desc.StructureByteStride = buffer.stride;
+		if (FAILED(d3d_device->CreateBuffer(&desc, nullptr, &buffer.buffer))) {
+			log_err("render_lights: Failed to create a light buffer!");
+			buffer.capacity = 0;
+			return;
+		}
+		DX11ResType(buffer.buffer, "light_buffer");
+
+		D3D11_SHADER_RESOURCE_VIEW_DESC view_desc = {};
+		view_desc.Format              = DXGI_FORMAT_UNKNOWN;
+		view_desc.ViewDimension       = D3D11_SRV_DIMENSION_BUFFER;
+		view_desc.Buffer.FirstElement = 0;
+		view_desc.Buffer.NumElements  = buffer.capacity;
+		d3d_device->CreateShaderResourceView(buffer.buffer, &view_desc, &buffer.view);
+	}
+	if (count == 0)
+		return;
+
+	D3D11_MAPPED_SUBRESOURCE res;
+	if (SUCCEEDED(d3d_context->Map(buffer.buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &res))) {
+		memcpy(res.pData, data, (size_t)count * buffer.stride);
+		d3d_context->Unmap(buffer.buffer, 0);
+		render_stats_upload(render_upload_light, (size_t)count * buffer.stride);
+	}
+}
+
+///////////////////////////////////////////
+
+void render_lights_buffer_release(render_light_buffer_t &buffer) {
+	if (buffer.view   != nullptr) buffer.view  ->Release();
+	if (buffer.buffer != nullptr) buffer.buffer->Release();
+	buffer.view     = nullptr;
+	buffer.buffer   = nullptr;
+	buffer.capacity = 0;
+}
+
+///////////////////////////////////////////
+
+void render_lights_shutdown() {
+	render_lights_buffer_release(render_lights_gpu_lights);
+	render_lights_buffer_release(render_lights_gpu_cells);
+	render_lights_buffer_release(render_lights_gpu_indices);
+}
+
+///////////////////////////////////////////
+
+void render_lights_swap() {
+	thread_chunks_drain(render_lights_thread_queues, [](vector<cluster_light_t> &lights, bool) {
+		render_lights.insert(render_lights.end(), lights.begin(), lights.end());
+		lights.clear();
+	});
+	render_lights_draw.clear();
+	render_lights_draw.swap(render_lights);
+}
+
+///////////////////////////////////////////
+
+void render_lights_update(const matrix *views, const matrix *projections, int32_t view_count, float near_plane, float far_plane, render_lights_info_t &out_info) {
+	int32_t light_count = (int32_t)render_lights_draw.size();
+	out_info.grid        = light_cluster_grid(views, projections, view_count, near_plane, far_plane);
+	out_info.light_count = light_count;
+
+	light_cluster_bounds(render_lights_bins, out_info.grid, render_lights_draw.data(), light_count);
+	render_lights_bin   ();
+	light_cluster_finish(render_lights_bins);
+
+	render_lights_buffer_set(render_lights_gpu_lights,  render_lights_draw.data(),        light_count);
+	render_lights_buffer_set(render_lights_gpu_cells,   render_lights_bins.cells,         cluster_count);
+	render_lights_buffer_set(render_lights_gpu_indices, render_lights_bins.indices.data(), (uint32_t)render_lights_bins.indices.size());
+
+	ID3D11ShaderResourceView *views_srv[3] = {
+		render_lights_gpu_lights .view,
+		render_lights_gpu_cells  .view,
+		render_lights_gpu_indices.view };
+	d3d_context->PSSetShaderResources(12, 3, views_srv);
+}
+
+///////////////////////////////////////////
+
+void render_add_light_internal(vec3 position, vec3 direction, float radius, float cos_inner, float cos_outer, color128 color, float intensity) {
+	if (hierarchy_enabled) {
+		matrix &transform = hierarchy_stack.back().transform;
+		position  = matrix_mul_point    (transform, position);
+		direction = matrix_mul_direction(transform, direction);
+	}
+
+	cluster_light_t light;
+	light.pos            = position;
+	light.radius         = radius;
+	light.color          = vec3{ color.r, color.g, color.b } * intensity;
+	light.dir            = vec3_magnitude(direction) > 0 ? vec3_normalize(direction) : vec3_forward;
+	light.spot_cos_outer = cos_outer;
+	light.spot_cos_inner = cos_inner;
+
+	vector<cluster_light_t> &queue = sk_on_main_thread()
+		? render_lights
+		: thread_chunk_get(render_lights_thread_queues);
+	queue.push_back(light);
+}
+
+///////////////////////////////////////////
+
+void render_add_light(vec3 position, float radius, color128 color, float intensity) {
+	render_add_light_internal(position, vec3_forward, radius, -2, -2, color, intensity);
+}
+
+///////////////////////////////////////////
+
+void render_add_light_spot(vec3 position, vec3 direction, float radius, float angle_inner, float angle_outer, color128 color, float intensity) {
+	float cos_outer = cosf(angle_outer * 0.5f * deg2rad);
+	float cos_inner = cosf(fminf(angle_inner, angle_outer) * 0.5f * deg2rad);
+	render_add_light_internal(position, direction, radius, cos_inner, cos_outer, color, intensity);
+}
+
+} // namespace sk
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "../light_cluster.h"
+
+namespace sk {
+
+// Filled out by render_lights_update for the shader globals
+struct render_lights_info_t {
+	cluster_grid_t grid;
+	int32_t        light_count;
+};
+
+void render_lights_shutdown();
+void render_lights_swap    ();
+void render_lights_update  (const matrix *views, const matrix *projections, int32_t view_count, float near_plane, float far_plane, render_lights_info_t &out_info);
+
+} // namespace sk
@@ -0,0 +1,122 @@
+#include "render_pipeline.h"
+#include "render.h"
+#include "platform/platform.h"
+#include "../_stereokit.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// When pipelined, frame N is drawn and presented on this thread while the
+// app thread is already running update for frame N+1. The render queue is
+// double buffered, so the only hand-off is a swap in render_frame_swap.
+thread             render_pipe_thread;
+thread::id         render_pipe_thread_id;
+mutex              render_pipe_mutex;
+condition_variable render_pipe_cv;
+bool               render_pipe_active = false;
+bool               render_pipe_busy   = false;
+bool               render_pipe_run    = false;
+
+///////////////////////////////////////////
+
+void render_pipeline_thread() {
+	while (true) {
+		{
+			unique_lock<mutex> lock(render_pipe_mutex);
+			render_pipe_cv.wait(lock, [] { return render_pipe_busy || !render_pipe_run; });
+			if (!render_pipe_busy && !render_pipe_run)
+				break;
+		}
+
+		platform_end_frame();
+		platform_present  ();
+
+		{
+			lock_guard<mutex> lock(render_pipe_mutex);
+			render_pipe_busy = false;
+		}
+		render_pipe_cv.notify_all();
+	}
+}
+
+///////////////////////////////////////////
+
+bool render_pipeline_init() {
+	if (!sk_settings.render_pipelined)
+		return true;
+
+	render_pipe_run       = true;
+	render_pipe_busy      = false;
+	render_pipe_thread    = thread(render_pipeline_thread);
+	render_pipe_thread_id = render_pipe_thread.get_id();
+	render_pipe_active    = true;
+	log_info("Render pipelining enabled, drawing on a separate thread.");
+	return true;
+}
+
+///////////////////////////////////////////
+
+void render_pipeline_shutdown() {
+	if (!render_pipe_active)
+		return;
+
+	{
+		lock_guard<mutex> lock(render_pipe_mutex);
+		render_pipe_run = false;
+	}
+	render_pipe_cv.notify_all();
+	render_pipe_thread.join();
+	render_pipe_active = false;
+}
+
+///////////////////////////////////////////
+
+void render_pipeline_sync() {
+	if (!render_pipe_active || this_thread::get_id() == render_pipe_thread_id)
+		return;
+
+	unique_lock<mutex> lock(render_pipe_mutex);
+	render_pipe_cv.wait(lock, [] { return !render_pipe_busy; });
+}
+
+///////////////////////////////////////////
+
+bool render_pipeline_active() {
+	return render_pipe_active;
+}
+
+///////////////////////////////////////////
+
+void render_pipeline_frame() {
+	if (!render_pipe_active) {
+		render_frame_swap ();
+		platform_end_frame();
+		return;
+	}
+
+	// Wait for the previous frame to finish up, then hand this frame's
+	// queue over to the render thread.
+	render_pipeline_sync();
+	render_frame_swap   ();
+	{
+		lock_guard<mutex> lock(render_pipe_mutex);
+		render_pipe_busy = true;
+	}
+	render_pipe_cv.notify_all();
+}
+
+///////////////////////////////////////////
+
+void render_pipeline_present() {
+	// The render thread presents on its own when pipelined
+	if (!render_pipe_active)
+		platform_present();
+}
+
+} // namespace sk
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+namespace sk {
+
+bool render_pipeline_init    ();
+void render_pipeline_shutdown();
+void render_pipeline_frame   ();
+void render_pipeline_present ();
+
+// Blocks until the render thread is done with the frame it's working on.
+// Anything on the app thread that touches the D3D context, or frees data
+// the render thread may be reading, needs to call this first! It's a no-op
+// when pipelining is off, or when called from the render thread itself.
+void render_pipeline_sync    ();
+bool render_pipeline_active  ();
+
+} // namespace sk
\ No newline at end of file
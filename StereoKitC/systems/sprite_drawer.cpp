@@ -6,6 +6,9 @@
 
 #include "../hierarchy.h"
 #include "../math.h"
+#include "../_stereokit.h"
+#include "../memory_tracking.h"
+#include "thread_chunks.h"
 
 #include <vector>
 using namespace std;
@@ -17,8 +20,22 @@ namespace sk {
 
 ///////////////////////////////////////////
 
+// Batched sprites from worker threads are recorded here and added to
+// their buffers on the main thread, since growing a buffer touches the GPU.
+struct sprite_deferred_t {
+	sprite_t sprite;
+	matrix   at;
+	matrix   world;
+	color32  color;
+};
+
 vector<sprite_buffer_t> sprite_buffers;
 mesh_t                  sprite_quad;
+thread_chunks_t<vector<sprite_deferred_t>> sprite_thread_queues;
+
+///////////////////////////////////////////
+
+void sprite_drawer_add_fast(sprite_t sprite, const matrix &at, const XMMATRIX &tr, color32 color);
 
 ///////////////////////////////////////////
 
@@ -36,11 +53,11 @@ void sprite_buffer_ensure_capacity(sprite_buffer_t &buffer) {
 		return;
 
 	buffer.vert_cap = buffer.vert_count + 4;
-	buffer.verts    = (vert_t *)realloc(buffer.verts, sizeof(vert_t) * buffer.vert_cap);
+	buffer.verts    = (vert_t *)sk_realloc(memory_tag_sprites, buffer.verts, sizeof(vert_t) * buffer.vert_cap);
 
 	// regenerate indices
 	vind_t  quads = (vind_t)(buffer.vert_cap / 4);
-	vind_t *inds  = (vind_t *)malloc(quads * 6 * sizeof(vind_t));
+	vind_t *inds  = (vind_t *)sk_malloc(memory_tag_sprites, quads * 6 * sizeof(vind_t));
 	for (vind_t i = 0; i < quads; i++) {
 		vind_t q = i * 4;
 		vind_t c = i * 6;
@@ -53,15 +70,12 @@ void sprite_buffer_ensure_capacity(sprite_buffer_t &buffer) {
 		inds[c+5] = q;
 	}
 	mesh_set_inds(buffer.mesh, inds, quads * 6);
-	free(inds);
+	sk_free(inds);
 }
 
 ///////////////////////////////////////////
 
 void sprite_drawer_add     (sprite_t sprite, const matrix &at, color32 color) {
-	float width  = (sprite->uvs[1].x - sprite->uvs[0].x) * sprite->size;
-	float height = (sprite->uvs[1].y - sprite->uvs[0].y) * sprite->size;
-
 	// Check if this one does get batched
 	if (sprite->buffer_index == -1) {
 		// Just plop a quad onto the render queue
@@ -69,11 +83,6 @@ void sprite_drawer_add     (sprite_t sprite, const matrix &at, color32 color) {
 		return;
 	}
 
-	sprite_buffer_t &buffer = sprite_buffers[sprite->buffer_index];
-
-	// Resize array if we need more room for this
-	sprite_buffer_ensure_capacity(buffer);
-
 	// Get the heirarchy based transform
 	XMMATRIX tr;
 	if (hierarchy_enabled) {
@@ -81,6 +90,30 @@ void sprite_drawer_add     (sprite_t sprite, const matrix &at, color32 color) {
 	} else {
 		math_matrix_to_fast(at, &tr);
 	}
+
+	if (!sk_on_main_thread()) {
+		sprite_deferred_t item;
+		item.sprite = sprite;
+		item.at     = at;
+		item.color  = color;
+		math_fast_to_matrix(tr, &item.world);
+		thread_chunk_get(sprite_thread_queues).push_back(item);
+		return;
+	}
+
+	sprite_drawer_add_fast(sprite, at, tr, color);
+}
+
+///////////////////////////////////////////
+
+void sprite_drawer_add_fast(sprite_t sprite, const matrix &at, const XMMATRIX &tr, color32 color) {
+	float width  = (sprite->uvs[1].x - sprite->uvs[0].x) * sprite->size;
+	float height = (sprite->uvs[1].y - sprite->uvs[0].y) * sprite->size;
+
+	sprite_buffer_t &buffer = sprite_buffers[sprite->buffer_index];
+
+	// Resize array if we need more room for this
+	sprite_buffer_ensure_capacity(buffer);
 	
 	// Add a sprite quad
 	size_t offset = buffer.vert_count;
@@ -116,6 +149,15 @@ bool sprite_drawer_init() {
 ///////////////////////////////////////////
 
 void sprite_drawer_update() {
+	thread_chunks_drain(sprite_thread_queues, [](vector<sprite_deferred_t> &items, bool) {
+		for (size_t i = 0; i < items.size(); i++) {
+			XMMATRIX tr;
+			math_matrix_to_fast(items[i].world, &tr);
+			sprite_drawer_add_fast(items[i].sprite, items[i].at, tr, items[i].color);
+		}
+		items.clear();
+	});
+
 	for (size_t i = 0; i < sprite_buffers.size(); i++) {
 		sprite_buffer_t &buffer = sprite_buffers[i];
 		if (buffer.vert_count <= 0)
@@ -137,7 +179,7 @@ void sprite_drawer_shutdown() {
 		sprite_buffer_t &buffer = sprite_buffers[i];
 		mesh_release(buffer.mesh);
 		material_release(buffer.material);
-		free(buffer.verts);
+		sk_free(buffer.verts);
 	}
 	sprite_buffers.clear();
 }
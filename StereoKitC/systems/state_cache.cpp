@@ -0,0 +1,287 @@
+#include "state_cache.h"
+#include "d3d.h"
+
+#include <string.h>
+#include <vector>
+#include <mutex>
+using namespace std;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct state_entry_t {
+	uint64_t           key;
+	ID3D11DeviceChild *native;
+	int32_t            refs;
+	state_id_t         next;     // Next entry in the same hash bucket
+	bool               dying;    // In state_cache_dying
+	uint64_t           released; // Frame the last reference went away
+};
+
+const int32_t  state_cache_max     = 4096;
+const int32_t  state_cache_buckets = 1024;
+// Same as the asset destroy delay, the render thread can still be drawing
+// with a state for a couple of frames after the app lets go of it.
+const uint64_t state_cache_delay   = 2;
+
+// Ids are the index + 1, so 0 can mean no state. Entries never move, which
+// is what lets the render thread look them up without the lock.
+state_entry_t      state_cache_entries[state_cache_max];
+state_id_t         state_cache_table  [state_cache_buckets];
+int32_t            state_cache_count;
+vector<state_id_t> state_cache_free;
+vector<state_id_t> state_cache_dying;
+uint64_t           state_cache_frame;
+mutex              state_cache_lock;
+
+///////////////////////////////////////////
+
+inline uint32_t state_cache_bucket(uint64_t key) {
+	// A 64 bit finalizer, since keys differ mostly in their low bits
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+	return (uint32_t)key & (state_cache_buckets - 1);
+}
+
+///////////////////////////////////////////
+
+ID3D11DeviceChild *state_cache_create(uint64_t key) {
+	state_type_ type = (state_type_)((key >> 48) & 0xFFFF);
+	uint32_t    a    = (uint32_t   )((key >> 32) & 0xFFFF);
+	uint32_t    b    = (uint32_t   )((key >> 16) & 0xFFFF);
+	uint32_t    c    = (uint32_t   )((key      ) & 0xFFFF);
+
+	switch (type) {
+	case state_type_blend: {
+		D3D11_BLEND_DESC desc_blend = {};
+		desc_blend.AlphaToCoverageEnable  = false;
+		desc_blend.IndependentBlendEnable = false;
+		desc_blend.RenderTarget[0].BlendEnable = (transparency_)a == transparency_blend;
+		desc_blend.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+		desc_blend.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+		desc_blend.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+		desc_blend.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+		desc_blend.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+		desc_blend.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ZERO;
+		desc_blend.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+
+		ID3D11BlendState *result = nullptr;
+		if (FAILED(d3d_device->CreateBlendState(&desc_blend, &result)))
+			log_warn("state_cache: failed to create blend state!");
+		return result;
+	}
+	case state_type_raster: {
+		D3D11_RASTERIZER_DESC desc_rasterizer = {};
+		desc_rasterizer.FillMode = D3D11_FILL_SOLID;
+		switch ((cull_)a) {
+		case cull_none:  desc_rasterizer.CullMode = D3D11_CULL_NONE;  break;
+		case cull_front: desc_rasterizer.CullMode = D3D11_CULL_FRONT; break;
+		case cull_back:  desc_rasterizer.CullMode = D3D11_CULL_BACK;  break;
+		}
+		desc_rasterizer.FrontCounterClockwise = true;
+
+		ID3D11RasterizerState *result = nullptr;
+		if (FAILED(d3d_device->CreateRasterizerState(&desc_rasterizer, &result)))
+			log_warn("state_cache: failed to create rasterizer state!");
+		return result;
+	}
+	case state_type_sampler: {
+		D3D11_TEXTURE_ADDRESS_MODE mode;
+		switch ((tex_address_)b) {
+		case tex_address_clamp:  mode = D3D11_TEXTURE_ADDRESS_CLAMP;  break;
+		case tex_address_wrap:   mode = D3D11_TEXTURE_ADDRESS_WRAP;   break;
+		case tex_address_mirror: mode = D3D11_TEXTURE_ADDRESS_MIRROR; break;
+		default: mode = D3D11_TEXTURE_ADDRESS_WRAP;
+		}
+
+		D3D11_FILTER filter;
+		switch ((tex_sample_)a) {
+		case tex_sample_linear:     filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR; break; // Technically trilinear
+		case tex_sample_point:      filter = D3D11_FILTER_MIN_MAG_MIP_POINT;  break;
+		case tex_sample_anisotropic:filter = D3D11_FILTER_ANISOTROPIC;        break;
+		default: filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+		}
+
+		D3D11_SAMPLER_DESC desc_sampler = {};
+		desc_sampler.AddressU = mode;
+		desc_sampler.AddressV = mode;
+		desc_sampler.AddressW = mode;
+		desc_sampler.Filter   = filter;
+		desc_sampler.MaxAnisotropy  = c;
+		desc_sampler.MaxLOD         = D3D11_FLOAT32_MAX;
+		desc_sampler.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+
+		ID3D11SamplerState *result = nullptr;
+		if (FAILED(d3d_device->CreateSamplerState(&desc_sampler, &result)))
+			log_warn("state_cache: failed to create sampler state!");
+		return result;
+	}
+	default: return nullptr;
+	}
+}
+
+///////////////////////////////////////////
+
+state_id_t state_cache_get(uint64_t key) {
+	lock_guard<mutex> lock(state_cache_lock);
+
+	uint32_t bucket = state_cache_bucket(key);
+	for (state_id_t id = state_cache_table[bucket]; id != state_id_none; id = state_cache_entries[id - 1].next) {
+		if (state_cache_entries[id - 1].key == key) {
+			state_cache_entries[id - 1].refs += 1;
+			return id;
+		}
+	}
+
+	state_id_t id;
+	if (state_cache_free.size() > 0) {
+		id = state_cache_free.back();
+		state_cache_free.pop_back();
+	} else if (state_cache_count < state_cache_max) {
+		id = (state_id_t)(++state_cache_count);
+	} else {
+		log_err("state_cache: ran out of state ids!");
+		return state_id_none;
+	}
+
+	ID3D11DeviceChild *native = state_cache_create(key);
+	if (native == nullptr) {
+		state_cache_free.push_back(id);
+		return state_id_none;
+	}
+
+	state_cache_entries[id - 1] = { key, native, 1, state_cache_table[bucket], false, 0 };
+	state_cache_table[bucket] = id;
+	return id;
+}
+
+///////////////////////////////////////////
+
+state_id_t state_cache_blend(transparency_ mode) {
+	return state_cache_get(state_cache_key(state_type_blend, mode));
+}
+
+///////////////////////////////////////////
+
+state_id_t state_cache_raster(cull_ mode) {
+	return state_cache_get(state_cache_key(state_type_raster, mode));
+}
+
+///////////////////////////////////////////
+
+state_id_t state_cache_sampler(tex_sample_ sample, tex_address_ address, int32_t anisotropy) {
+	return state_cache_get(state_cache_key(state_type_sampler, sample, address, (uint32_t)anisotropy));
+}
+
+///////////////////////////////////////////
+
+void state_cache_addref(state_id_t id) {
+	if (id == state_id_none)
+		return;
+	lock_guard<mutex> lock(state_cache_lock);
+	state_cache_entries[id - 1].refs += 1;
+}
+
+///////////////////////////////////////////
+
+void state_cache_release(state_id_t id) {
+	if (id == state_id_none)
+		return;
+	lock_guard<mutex> lock(state_cache_lock);
+	state_entry_t &entry = state_cache_entries[id - 1];
+	entry.refs -= 1;
+	if (entry.refs > 0)
+		return;
+
+	// It stays findable until state_cache_update destroys it, so if it's
+	// wanted again before then, it just comes back.
+	entry.released = state_cache_frame;
+	if (!entry.dying) {
+		entry.dying = true;
+		state_cache_dying.push_back(id);
+	}
+}
+
+///////////////////////////////////////////
+
+void state_cache_destroy(state_id_t id) {
+	state_entry_t &entry = state_cache_entries[id - 1];
+
+	// Unlink it from its bucket
+	state_id_t *link = &state_cache_table[state_cache_bucket(entry.key)];
+	while (*link != id)
+		link = &state_cache_entries[*link - 1].next;
+	*link = entry.next;
+
+	entry.native->Release();
+	entry = {};
+	state_cache_free.push_back(id);
+}
+
+///////////////////////////////////////////
+
+void state_cache_update() {
+	lock_guard<mutex> lock(state_cache_lock);
+	state_cache_frame += 1;
+
+	size_t keep = 0;
+	for (size_t i = 0; i < state_cache_dying.size(); i++) {
+		state_id_t     id    = state_cache_dying[i];
+		state_entry_t &entry = state_cache_entries[id - 1];
+		if (entry.refs > 0) {
+			entry.dying = false;
+		} else if (entry.released + state_cache_delay < state_cache_frame) {
+			state_cache_destroy(id);
+		} else {
+			state_cache_dying[keep++] = id;
+		}
+	}
+	state_cache_dying.resize(keep);
+}
+
+///////////////////////////////////////////
+
+void state_cache_shutdown() {
+	lock_guard<mutex> lock(state_cache_lock);
+	int32_t leaks = 0;
+	for (int32_t i = 0; i < state_cache_count; i++) {
+		if (state_cache_entries[i].native == nullptr)
+			continue;
+		state_cache_entries[i].native->Release();
+		if (state_cache_entries[i].refs > 0)
+			leaks += 1;
+	}
+	if (leaks > 0)
+		log_warnf("state_cache: %d render states were still referenced at shutdown.", leaks);
+
+	memset(state_cache_entries, 0, sizeof(state_cache_entries));
+	memset(state_cache_table,   0, sizeof(state_cache_table));
+	state_cache_count = 0;
+	state_cache_frame = 0;
+	state_cache_free .clear();
+	state_cache_dying.clear();
+}
+
+///////////////////////////////////////////
+
+ID3D11BlendState *state_cache_get_blend(state_id_t id) {
+	return id == state_id_none ? nullptr : (ID3D11BlendState *)state_cache_entries[id - 1].native;
+}
+
+///////////////////////////////////////////
+
+ID3D11RasterizerState *state_cache_get_raster(state_id_t id) {
+	return id == state_id_none ? nullptr : (ID3D11RasterizerState *)state_cache_entries[id - 1].native;
+}
+
+///////////////////////////////////////////
+
+ID3D11SamplerState *state_cache_get_sampler(state_id_t id) {
+	return id == state_id_none ? nullptr : (ID3D11SamplerState *)state_cache_entries[id - 1].native;
+}
+
+} // namespace sk
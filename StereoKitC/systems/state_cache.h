@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../stereokit.h"
+
+#include <d3d11.h>
+
+namespace sk {
+
+// Blend, rasterizer and sampler states are shared between everything that
+// uses the same settings, rather than each material or texture making its
+// own. States are keyed by StereoKit's own settings, not the D3D
+// descriptor, so the keying doesn't care what the backend is. Materials and
+// textures hold a small id, which is cheap to compare when filtering out
+// redundant binds, and small enough to go into a sort key.
+//
+// Getting a state adds a reference to it, and the native object goes away
+// a couple of frames after the last reference is released, once the render
+// thread can't be drawing with it anymore. Lookups from an id are lock
+// free, since an id never moves or gets reused until then.
+
+typedef uint16_t state_id_t;
+const state_id_t state_id_none = 0;
+
+enum state_type_ {
+	state_type_blend = 1,
+	state_type_raster,
+	state_type_sampler,
+};
+
+// Each setting gets 16 bits of the key. Inline so the keying can be tested
+// without a device.
+inline uint64_t state_cache_key(state_type_ type, uint32_t a, uint32_t b = 0, uint32_t c = 0) {
+	return
+		((uint64_t)(type & 0xFFFF) << 48) |
+		((uint64_t)(a    & 0xFFFF) << 32) |
+		((uint64_t)(b    & 0xFFFF) << 16) |
+		((uint64_t)(c    & 0xFFFF));
+}
+
+state_id_t state_cache_blend    (transparency_ mode);
+state_id_t state_cache_raster   (cull_ mode);
+state_id_t state_cache_sampler  (tex_sample_ sample, tex_address_ address, int32_t anisotropy);
+void       state_cache_addref   (state_id_t id);
+void       state_cache_release  (state_id_t id);
+// Once a frame, destroys states released long enough ago.
+void       state_cache_update   ();
+void       state_cache_shutdown ();
+
+ID3D11BlendState      *state_cache_get_blend  (state_id_t id);
+ID3D11RasterizerState *state_cache_get_raster (state_id_t id);
+ID3D11SamplerState    *state_cache_get_sampler(state_id_t id);
+
+} // namespace sk
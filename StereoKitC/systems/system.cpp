@@ -7,6 +7,11 @@
 #include "../stereokit.h"
 
 #include <chrono>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <condition_variable>
+using namespace std;
 using namespace std::chrono;
 
 namespace sk {
@@ -23,9 +28,21 @@ int32_t  *system_init_order = nullptr;
 int32_t   system_count = 0;
 int32_t   system_cap   = 0;
 
+// Init runs as a task graph over the init dependencies. The job pool is
+// itself a system, so init gets a few short-lived threads of its own.
+mutex              system_init_mutex;
+condition_variable system_init_cv;
+vector<int32_t>    system_init_ready;
+vector<int32_t>    system_init_waiting; // Unfinished dependencies, by system
+vector<int32_t>    system_init_done;    // In the order they finished
+bool               system_init_failed;
+int64_t            system_init_duration;
+const int32_t      system_init_max_workers = 3;
+
 ///////////////////////////////////////////
 
 int32_t systems_find(const char *name);
+int64_t systems_critical_path();
 
 void    array_reorder(void **list, size_t item_size, int32_t count, int32_t *sort_order);
 int32_t topological_sort      (sort_dependency_t *dependencies, int32_t count, int32_t **out_order);
@@ -54,6 +71,14 @@ void systems_add(const char *name, const char **init_dependencies, int32_t init_
 
 ///////////////////////////////////////////
 
+void systems_set_init_any_thread(const char *name) {
+	int32_t index = systems_find(name);
+	if (index == -1) log_errf("Can't find system by the name of %s!", name);
+	else             systems[index].init_any_thread = true;
+}
+
+///////////////////////////////////////////
+
 int32_t systems_find(const char *name) {
 	for (int32_t i = 0; i < system_count; i++) {
 		if (string_eq(name, systems[i].name))
@@ -128,32 +153,138 @@ bool systems_sort() {
 
 ///////////////////////////////////////////
 
-bool systems_initialize() {
-	if (!systems_sort())
-		return false;
+// Call with system_init_mutex held. The main thread takes work only it can
+// do first, since nobody else can pick that up.
+int32_t systems_init_take(bool main_thread) {
+	for (int32_t pass = main_thread ? 0 : 1; pass < 2; pass++) {
+		for (size_t i = 0; i < system_init_ready.size(); i++) {
+			int32_t index = system_init_ready[i];
+			if (pass == 0 && systems[index].init_any_thread) continue;
+			if (pass == 1 && !systems[index].init_any_thread && !main_thread) continue;
+			system_init_ready.erase(system_init_ready.begin() + i);
+			return index;
+		}
+	}
+	return -1;
+}
 
+///////////////////////////////////////////
+
+// Call with system_init_mutex held.
+void systems_init_finish(int32_t index) {
+	system_init_done.push_back(index);
 	for (int32_t i = 0; i < system_count; i++) {
-		int32_t index = system_init_order[i];
+		for (int32_t d = 0; d < systems[i].init_dependency_count; d++) {
+			if (!string_eq(systems[i].init_dependencies[d], systems[index].name))
+				continue;
+			system_init_waiting[i] -= 1;
+			if (system_init_waiting[i] == 0)
+				system_init_ready.push_back(i);
+		}
+	}
+}
+
+///////////////////////////////////////////
+
+void systems_init_worker(bool main_thread) {
+	unique_lock<mutex> lock(system_init_mutex);
+	while (true) {
+		int32_t index = -1;
+		while (!system_init_failed && (int32_t)system_init_done.size() < system_count && (index = systems_init_take(main_thread)) == -1)
+			system_init_cv.wait(lock);
+		if (index == -1)
+			return;
+
+		lock.unlock();
+		bool result = true;
 		if (systems[index].func_initialize != nullptr) {
 			// start timing
 			time_point<high_resolution_clock> start = high_resolution_clock::now();
 
-			if (!systems[index].func_initialize()) {
+			result = systems[index].func_initialize();
+			if (!result)
 				log_errf("System %s failed to initialize!", systems[index].name);
-				return false;
-			}
 
 			// end timing
 			time_point<high_resolution_clock> end = high_resolution_clock::now();
 			systems[index].profile_start_duration = duration_cast<nanoseconds>(end - start).count();
 		}
+		lock.lock();
+
+		if (result) systems_init_finish(index);
+		else        system_init_failed = true;
+		system_init_cv.notify_all();
+	}
+}
+
+///////////////////////////////////////////
+
+bool systems_initialize() {
+	if (!systems_sort())
+		return false;
+
+	time_point<high_resolution_clock> start = high_resolution_clock::now();
+
+	int32_t any_thread = 0;
+	system_init_failed = false;
+	system_init_ready  .clear();
+	system_init_done   .clear();
+	system_init_waiting.resize(system_count);
+	for (int32_t i = 0; i < system_count; i++) {
+		system_init_waiting[i] = systems[i].init_dependency_count;
+		if (system_init_waiting[i] == 0)
+			system_init_ready.push_back(i);
+		if (systems[i].init_any_thread)
+			any_thread += 1;
 	}
+
+	int32_t worker_count = (int32_t)thread::hardware_concurrency() - 1;
+	if (worker_count > system_init_max_workers) worker_count = system_init_max_workers;
+	if (worker_count > any_thread)              worker_count = any_thread;
+	vector<thread> workers;
+	for (int32_t i = 0; i < worker_count; i++)
+		workers.emplace_back(systems_init_worker, false);
+	systems_init_worker(true);
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+
+	time_point<high_resolution_clock> end = high_resolution_clock::now();
+	system_init_duration = duration_cast<nanoseconds>(end - start).count();
+
+	if (system_init_failed)
+		return false;
+
+	// Shutdown goes in reverse of the order things actually finished in
+	memcpy(system_init_order, system_init_done.data(), sizeof(int32_t) * system_count);
+
 	log_info("Initialization successful");
 	return true;
 }
 
 ///////////////////////////////////////////
 
+// The longest chain of init times through the dependencies, which is the
+// best a parallel init could ever do.
+int64_t systems_critical_path() {
+	vector<int64_t> path(system_count);
+	int64_t         result = 0;
+	for (int32_t i = 0; i < system_count; i++) {
+		int32_t index = system_init_order[i];
+		int64_t longest = 0;
+		for (int32_t d = 0; d < systems[index].init_dependency_count; d++) {
+			int32_t dep = systems_find(systems[index].init_dependencies[d]);
+			if (dep != -1 && path[dep] > longest)
+				longest = path[dep];
+		}
+		path[index] = longest + systems[index].profile_start_duration;
+		if (path[index] > result)
+			result = path[index];
+	}
+	return result;
+}
+
+///////////////////////////////////////////
+
 void systems_update() {
 	for (int32_t i = 0; i < system_count; i++) {
 		if (systems[i].func_update != nullptr) {
@@ -184,7 +315,7 @@ void systems_shutdown() {
 
 			// end timing
 			time_point<high_resolution_clock> end = high_resolution_clock::now();
-			systems[i].profile_shutdown_duration = duration_cast<nanoseconds>(end - start).count();
+			systems[index].profile_shutdown_duration = duration_cast<nanoseconds>(end - start).count();
 		}
 	}
 
@@ -219,6 +350,14 @@ void systems_shutdown() {
 	}
 	log_info("<~BLK>|________________|____________|__________|___________|<~clr>");
 
+	int64_t serial = 0;
+	for (int32_t i = 0; i < system_count; i++)
+		serial += systems[i].profile_start_duration;
+	log_infof("Startup took <~YLW>%.2f<~BLK>ms<~clr>, critical path <~YLW>%.2f<~BLK>ms<~clr>, serial <~YLW>%.2f<~BLK>ms<~clr>",
+		system_init_duration    / 1000000.0,
+		systems_critical_path() / 1000000.0,
+		serial                  / 1000000.0);
+
 	free(systems);
 	free(system_init_order);
 	systems = nullptr;
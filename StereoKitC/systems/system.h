@@ -19,12 +19,19 @@ struct system_t {
 	int64_t profile_start_duration;
 	int64_t profile_shutdown_duration;
 
+	// Most systems touch the graphics device or the window during init, so
+	// they stay on the main thread unless they're marked otherwise.
+	bool init_any_thread;
+
 	bool (*func_initialize)(void);
 	void (*func_update)(void);
 	void (*func_shutdown)(void);
 };
 
 void    systems_add (const char *name, const char **init_dependencies, int32_t init_dependency_count, const char **update_dependencies, int32_t update_dependency_count, bool (*func_initialize)(void), void (*func_update)(void), void (*func_shutdown)(void));
+// Lets the system's func_initialize run on a worker thread, alongside
+// other systems that don't depend on it.
+void    systems_set_init_any_thread(const char *name);
 
 bool    systems_initialize();
 void    systems_update();
@@ -0,0 +1,283 @@
+#include "tex_upload.h"
+#include "render.h"
+#include "d3d.h"
+#include "../memory_tracking.h"
+#include "../math.h"
+#include "../asset_types/texture.h"
+
+#include <string.h>
+#include <vector>
+#include <mutex>
+using namespace std;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct tex_upload_t {
+	tex_t    texture;
+	int32_t  slice;
+	int32_t  x, y;
+	int32_t  width, height;
+	size_t   row_size;
+	void    *data;
+	size_t   capacity;
+	tex_t    convert_to;
+};
+
+struct tex_stage_t {
+	ID3D11Texture2D *texture;
+	DXGI_FORMAT      format;
+	int32_t          width;
+	int32_t          height;
+};
+
+// Three is enough for the GPU to be reading one while another waits in the
+// queue, and we're still free to write the third.
+const int32_t tex_stage_count   = 3;
+const size_t  tex_upload_spares = 4;
+
+vector<tex_upload_t> tex_uploads;
+vector<tex_upload_t> tex_uploads_draw;
+vector<tex_upload_t> tex_upload_spare; // Data buffers from finished uploads
+tex_stage_t          tex_stages[tex_stage_count];
+int32_t              tex_stage_next;
+bool                 tex_upload_flushing;
+mutex                tex_upload_lock;
+
+///////////////////////////////////////////
+
+void tex_upload_recycle(tex_upload_t &upload) {
+	if (tex_upload_spare.size() < tex_upload_spares)
+		tex_upload_spare.push_back(upload);
+	else
+		sk_free(upload.data);
+	upload.data = nullptr;
+}
+
+///////////////////////////////////////////
+
+void tex_upload_queue(tex_t texture, int32_t slice, int32_t x, int32_t y, int32_t width, int32_t height, const void *data, int32_t stride, tex_t convert_to) {
+	size_t row_size = (size_t)width * tex_format_size(texture->format);
+	size_t size     = row_size * height;
+	if (stride <= 0)
+		stride = (int32_t)row_size;
+
+	lock_guard<mutex> lock(tex_upload_lock);
+
+	// A new write to the same rectangle replaces one that hasn't gone up
+	// yet, which is the usual case for video. Only the last upload for the
+	// texture qualifies, or overlapping writes could land out of order.
+	tex_upload_t *upload = nullptr;
+	for (int32_t i = (int32_t)tex_uploads.size() - 1; i >= 0; i--) {
+		tex_upload_t &item = tex_uploads[i];
+		if (item.texture != texture)
+			continue;
+		if (item.slice == slice && item.x == x && item.y == y && item.width == width && item.height == height && item.convert_to == convert_to)
+			upload = &item;
+		break;
+	}
+
+	if (upload == nullptr) {
+		tex_upload_t item = { texture, slice, x, y, width, height, row_size, nullptr, 0, convert_to };
+		for (size_t i = 0; i < tex_upload_spare.size(); i++) {
+			if (tex_upload_spare[i].capacity < size)
+				continue;
+			item.data     = tex_upload_spare[i].data;
+			item.capacity = tex_upload_spare[i].capacity;
+			tex_upload_spare[i] = tex_upload_spare.back();
+			tex_upload_spare.pop_back();
+			break;
+		}
+		if (item.data == nullptr) {
+			item.data     = sk_malloc(memory_tag_render, size);
+			item.capacity = size;
+		}
+		tex_uploads.push_back(item);
+		upload = &tex_uploads.back();
+	}
+
+	uint8_t       *dest = (uint8_t *)upload->data;
+	const uint8_t *src  = (const uint8_t *)data;
+	for (int32_t i = 0; i < height; i++) {
+		memcpy(dest, src, row_size);
+		dest += row_size;
+		src  += stride;
+	}
+}
+
+///////////////////////////////////////////
+
+void tex_upload_drop(tex_t texture) {
+	lock_guard<mutex> lock(tex_upload_lock);
+	for (int32_t i = (int32_t)tex_uploads.size() - 1; i >= 0; i--) {
+		if (tex_uploads[i].texture != texture && tex_uploads[i].convert_to != texture)
+			continue;
+		tex_upload_recycle(tex_uploads[i]);
+		tex_uploads.erase(tex_uploads.begin() + i);
+	}
+}
+
+///////////////////////////////////////////
+
+ID3D11Texture2D *tex_stage_map(DXGI_FORMAT format, int32_t width, int32_t height, D3D11_MAPPED_SUBRESOURCE *out_mem) {
+	// Take the first staging texture that fits and the GPU is done with
+	for (int32_t i = 0; i < tex_stage_count; i++) {
+		int32_t      index = (tex_stage_next + i) % tex_stage_count;
+		tex_stage_t &stage = tex_stages[index];
+		if (stage.texture == nullptr || stage.format != format || stage.width < width || stage.height < height)
+			continue;
+		if (SUCCEEDED(d3d_context->Map(stage.texture, 0, D3D11_MAP_WRITE, D3D11_MAP_FLAG_DO_NOT_WAIT, out_mem))) {
+			tex_stage_next = (index + 1) % tex_stage_count;
+			return stage.texture;
+		}
+	}
+
+	// Otherwise the next one in the ring gets resized, or waited on if
+	// they're all still busy.
+	tex_stage_t &stage = tex_stages[tex_stage_next];
+	tex_stage_next = (tex_stage_next + 1) % tex_stage_count;
+	if (stage.texture == nullptr || stage.format != format || stage.width < width || stage.height < height) {
+		// Grow in steps, so regions that are only a little bigger don't
+		// each need a new one.
+		bool    same_format = stage.texture != nullptr && stage.format == format;
+		int32_t new_width   = (maxi(width,  same_format ? stage.width  : 0) + 255) & ~255;
+		int32_t new_height  = (maxi(height, same_format ? stage.height : 0) + 255) & ~255;
+		if (stage.texture != nullptr) {
+			stage.texture->Release();
+			stage = {};
+			render_stats_realloc();
+		}
+
+		D3D11_TEXTURE2D_DESC desc = {};
+		desc.Width            = new_width;
+		desc.Height           = new_height;
+		desc.MipLevels        = 1;
+		desc.ArraySize        = 1;
+		desc.SampleDesc.Count = 1;
+		desc.Format           = format;
+		desc.Usage            = D3D11_USAGE_STAGING;
+		desc.CPUAccessFlags   = D3D11_CPU_ACCESS_WRITE;
+		if (FAILED(d3d_device->CreateTexture2D(&desc, nullptr, &stage.texture))) {
+			log_err("tex_upload: Failed to create a staging texture!");
+			return nullptr;
+		}
+		DX11ResType(stage.texture, "tex_upload_stage");
+		stage.format = format;
+		stage.width  = new_width;
+		stage.height = new_height;
+	}
+
+	if (FAILED(d3d_context->Map(stage.texture, 0, D3D11_MAP_WRITE, 0, out_mem))) {
+		log_err("tex_upload: Failed mapping a staging texture!");
+		return nullptr;
+	}
+	return stage.texture;
+}
+
+///////////////////////////////////////////
+
+void tex_upload_copy(const tex_upload_t &upload) {
+	ID3D11Texture2D *dest = upload.texture->texture;
+	if (dest == nullptr)
+		return;
+
+	D3D11_TEXTURE2D_DESC desc;
+	dest->GetDesc(&desc);
+
+	D3D11_MAPPED_SUBRESOURCE mem   = {};
+	ID3D11Texture2D         *stage = tex_stage_map(desc.Format, upload.width, upload.height, &mem);
+	if (stage == nullptr)
+		return;
+
+	uint8_t *dest_line = (uint8_t *)mem.pData;
+	uint8_t *src_line  = (uint8_t *)upload.data;
+	for (int32_t i = 0; i < upload.height; i++) {
+		memcpy(dest_line, src_line, upload.row_size);
+		dest_line += mem.RowPitch;
+		src_line  += upload.row_size;
+	}
+	d3d_context->Unmap(stage, 0);
+
+	D3D11_BOX box = { 0, 0, 0, (UINT)upload.width, (UINT)upload.height, 1 };
+	d3d_context->CopySubresourceRegion(
+		dest, D3D11CalcSubresource(0, upload.slice, desc.MipLevels), upload.x, upload.y, 0,
+		stage, 0, &box);
+}
+
+///////////////////////////////////////////
+
+void tex_upload_flush() {
+	// Conversions blit, and a blit flushes too
+	if (tex_upload_flushing)
+		return;
+	{
+		lock_guard<mutex> lock(tex_upload_lock);
+		tex_uploads_draw.swap(tex_uploads);
+	}
+	if (tex_uploads_draw.size() == 0)
+		return;
+	tex_upload_flushing = true;
+
+	// A conversion blit changes the render target, so put back whatever
+	// was there before.
+	bool converting = false;
+	for (size_t i = 0; i < tex_uploads_draw.size(); i++)
+		converting = converting || tex_uploads_draw[i].convert_to != nullptr;
+
+	ID3D11RenderTargetView *old_target       = nullptr;
+	ID3D11DepthStencilView *old_depth        = nullptr;
+	D3D11_VIEWPORT          old_viewport     = {};
+	UINT                    viewports        = 1;
+	material_t              convert_material = nullptr;
+	if (converting) {
+		d3d_context->OMGetRenderTargets(1, &old_target, &old_depth);
+		d3d_context->RSGetViewports(&viewports, &old_viewport);
+		convert_material = material_find("default/nv12_convert");
+	}
+
+	for (size_t i = 0; i < tex_uploads_draw.size(); i++) {
+		tex_upload_t &upload = tex_uploads_draw[i];
+		tex_upload_copy(upload);
+		if (upload.convert_to != nullptr && convert_material != nullptr && upload.convert_to->target_view != nullptr) {
+			material_set_texture(convert_material, "source", upload.texture);
+			render_blit(upload.convert_to, convert_material);
+		}
+	}
+
+	if (converting) {
+		d3d_context->OMSetRenderTargets(1, &old_target, old_depth);
+		if (viewports > 0)
+			d3d_context->RSSetViewports(1, &old_viewport);
+		if (old_target != nullptr) old_target->Release();
+		if (old_depth  != nullptr) old_depth ->Release();
+		material_release(convert_material);
+	}
+
+	lock_guard<mutex> lock(tex_upload_lock);
+	for (size_t i = 0; i < tex_uploads_draw.size(); i++)
+		tex_upload_recycle(tex_uploads_draw[i]);
+	tex_uploads_draw.clear();
+	tex_upload_flushing = false;
+}
+
+///////////////////////////////////////////
+
+void tex_upload_shutdown() {
+	lock_guard<mutex> lock(tex_upload_lock);
+	for (size_t i = 0; i < tex_uploads.size(); i++)
+		sk_free(tex_uploads[i].data);
+	for (size_t i = 0; i < tex_upload_spare.size(); i++)
+		sk_free(tex_upload_spare[i].data);
+	tex_uploads     .clear();
+	tex_upload_spare.clear();
+
+	for (int32_t i = 0; i < tex_stage_count; i++) {
+		if (tex_stages[i].texture != nullptr)
+			tex_stages[i].texture->Release();
+		tex_stages[i] = {};
+	}
+	tex_stage_next = 0;
+}
+
+} // namespace sk
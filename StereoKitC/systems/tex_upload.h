@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../stereokit.h"
+
+namespace sk {
+
+// Writes to dynamic textures don't touch the GPU right away. The pixels are
+// copied into a queue, and the drawing thread moves them into the texture in
+// tex_upload_flush, so writing never has to wait on the render pipeline. The
+// copy goes through a small ring of staging textures, and a staging texture
+// the GPU is still reading from gets skipped rather than waited on.
+//
+// An upload can also ask for a conversion afterwards, which is how NV12
+// video gets turned into color by a blit on the GPU.
+
+void tex_upload_queue   (tex_t texture, int32_t slice, int32_t x, int32_t y, int32_t width, int32_t height, const void *data, int32_t stride, tex_t convert_to = nullptr);
+// Forgets anything queued for the texture, for when its surface goes away.
+void tex_upload_drop    (tex_t texture);
+// Drawing thread only, before anything is drawn.
+void tex_upload_flush   ();
+void tex_upload_shutdown();
+
+} // namespace sk
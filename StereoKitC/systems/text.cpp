@@ -5,6 +5,9 @@
 #include "../systems/defaults.h"
 #include "../hierarchy.h"
 #include "../math.h"
+#include "../_stereokit.h"
+#include "../memory_tracking.h"
+#include "thread_chunks.h"
 
 #include <vector>
 using namespace std;
@@ -16,8 +19,29 @@ namespace sk {
 
 ///////////////////////////////////////////
 
+// Text from worker threads can't touch the style buffers, since growing
+// them touches the GPU. It gets recorded here instead, with the hierarchy
+// already applied, and is built on the main thread in text_update.
+struct text_deferred_t {
+	matrix       transform;
+	size_t       text_start;
+	text_style_t style;
+	text_align_  position;
+	text_align_  align;
+	vec3         offset;
+};
+struct text_thread_queue_t {
+	vector<text_deferred_t> items;
+	vector<char>            chars;
+};
+
 vector<_text_style_t> text_styles;
 vector<text_buffer_t> text_buffers;
+thread_chunks_t<text_thread_queue_t> text_thread_queues;
+
+///////////////////////////////////////////
+
+void text_add_at_fast(const char *text, const XMMATRIX &tr, text_style_t style, text_align_ position, text_align_ align, float off_x, float off_y, float off_z);
 
 ///////////////////////////////////////////
 
@@ -26,11 +50,11 @@ void text_buffer_ensure_capacity(text_buffer_t &buffer, size_t characters) {
 		return;
 
 	buffer.vert_cap = buffer.vert_count + (int)characters * 4;
-	buffer.verts    = (vert_t *)realloc(buffer.verts, sizeof(vert_t) * buffer.vert_cap);
+	buffer.verts    = (vert_t *)sk_realloc(memory_tag_text, buffer.verts, sizeof(vert_t) * buffer.vert_cap);
 
 	// regenerate indices
 	vind_t  quads = (vind_t)(buffer.vert_cap / 4);
-	vind_t *inds  = (vind_t *)malloc(quads * 6 * sizeof(vind_t));
+	vind_t *inds  = (vind_t *)sk_malloc(memory_tag_text, quads * 6 * sizeof(vind_t));
 	for (vind_t i = 0; i < quads; i++) {
 		vind_t q = i * 4;
 		vind_t c = i * 6;
@@ -43,7 +67,7 @@ void text_buffer_ensure_capacity(text_buffer_t &buffer, size_t characters) {
 		inds[c+5] = q;
 	}
 	mesh_set_inds(buffer.mesh, inds, quads * 6);
-	free(inds);
+	sk_free(inds);
 }
 
 ///////////////////////////////////////////
@@ -144,6 +168,26 @@ void text_add_at(const char* text, const matrix &transform, text_style_t style,
 		math_matrix_to_fast(transform, &tr);
 	}
 
+	if (!sk_on_main_thread()) {
+		text_thread_queue_t &queue = thread_chunk_get(text_thread_queues);
+		text_deferred_t item;
+		item.text_start = queue.chars.size();
+		item.style      = style;
+		item.position   = position;
+		item.align      = align;
+		item.offset     = { off_x, off_y, off_z };
+		math_fast_to_matrix(tr, &item.transform);
+		queue.items.push_back(item);
+		queue.chars.insert(queue.chars.end(), text, text + strlen(text) + 1);
+		return;
+	}
+
+	text_add_at_fast(text, tr, style, position, align, off_x, off_y, off_z);
+}
+
+///////////////////////////////////////////
+
+void text_add_at_fast(const char *text, const XMMATRIX &tr, text_style_t style, text_align_ position, text_align_ align, float off_x, float off_y, float off_z) {
 	text_style_t   styleId    = style == -1 ? 0 : style;
 	_text_style_t &style_data = text_styles[styleId];
 	text_buffer_t &buffer     = text_buffers[style_data.buffer_index];
@@ -214,7 +258,27 @@ void text_add_at(const char* text, const matrix &transform, text_style_t style,
 
 ///////////////////////////////////////////
 
+void text_add_list(const text_span_t *spans, int32_t count) {
+	for (int32_t i = 0; i < count; i++) {
+		const text_span_t &span = spans[i];
+		text_add_at(span.text, span.transform, span.style, span.position, span.align, span.offset.x, span.offset.y, span.offset.z);
+	}
+}
+
+///////////////////////////////////////////
+
 void text_update() {
+	thread_chunks_drain(text_thread_queues, [](text_thread_queue_t &queue, bool) {
+		for (size_t i = 0; i < queue.items.size(); i++) {
+			const text_deferred_t &item = queue.items[i];
+			XMMATRIX tr;
+			math_matrix_to_fast(item.transform, &tr);
+			text_add_at_fast(&queue.chars[item.text_start], tr, item.style, item.position, item.align, item.offset.x, item.offset.y, item.offset.z);
+		}
+		queue.items.clear();
+		queue.chars.clear();
+	});
+
 	for (size_t i = 0; i < text_buffers.size(); i++) {
 		text_buffer_t &buffer = text_buffers[i];
 		if (buffer.vert_count <= 0)
@@ -236,7 +300,7 @@ void text_shutdown() {
 		mesh_release(buffer.mesh);
 		font_release(buffer.font);
 		material_release(buffer.material);
-		free(buffer.verts);
+		sk_free(buffer.verts);
 	}
 	text_buffers.clear();
 }
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Draw submission from threads other than the main thread goes into a chunk
+// owned by that thread, so adding to it never needs a lock. The main thread
+// drains all the chunks at a point where the workers are known to be done,
+// which is after the app's update for the frame. The only locking is when a
+// thread submits for the first time, when it exits, and during the drain,
+// which nobody else contends for.
+//
+// Each thread gets one chunk per data type T, so each thread_chunks_t<T>
+// should only exist once!
+
+template <typename T>
+struct thread_chunk_t {
+	T    data;
+	bool exited;
+};
+
+template <typename T>
+struct thread_chunks_t {
+	std::mutex                       lock;
+	std::vector<thread_chunk_t<T> *> chunks;
+};
+
+template <typename T>
+struct thread_chunk_owner_t {
+	thread_chunks_t<T> *list  = nullptr;
+	thread_chunk_t<T>  *chunk = nullptr;
+
+	~thread_chunk_owner_t() {
+		if (chunk == nullptr) return;
+		// The data may still need drawing, so the main thread frees it on
+		// its next drain.
+		std::lock_guard<std::mutex> guard(list->lock);
+		chunk->exited = true;
+	}
+};
+
+///////////////////////////////////////////
+
+template <typename T>
+T &thread_chunk_get(thread_chunks_t<T> &list) {
+	static thread_local thread_chunk_owner_t<T> owner;
+	if (owner.chunk == nullptr) {
+		owner.list  = &list;
+		owner.chunk = new thread_chunk_t<T>();
+		std::lock_guard<std::mutex> guard(list.lock);
+		list.chunks.push_back(owner.chunk);
+	}
+	return owner.chunk->data;
+}
+
+///////////////////////////////////////////
+
+// on_data is called for each thread's chunk, and is responsible for
+// emptying it. thread_exited is true if this is the last time this data
+// will be seen, so anything that T doesn't clean up itself should be freed.
+template <typename T, typename F>
+void thread_chunks_drain(thread_chunks_t<T> &list, F on_data) {
+	std::lock_guard<std::mutex> guard(list.lock);
+	for (size_t i = 0; i < list.chunks.size(); i++) {
+		thread_chunk_t<T> *chunk = list.chunks[i];
+		on_data(chunk->data, chunk->exited);
+		if (chunk->exited) {
+			delete chunk;
+			list.chunks.erase(list.chunks.begin() + i);
+			i--;
+		}
+	}
+}
+
+} // namespace sk
@@ -0,0 +1,351 @@
+#include "vfs.h"
+#include "../asset_types/assets.h"
+#include "../libraries/stref.h"
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+using namespace std;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct vfs_archive_t {
+	char                   *name;
+	HANDLE                  file;
+	HANDLE                  mapping;
+	const uint8_t          *data;
+	uint64_t                size;
+	const vfs_pack_entry_t *entries;
+	const char             *names;
+	uint32_t                entry_count;
+};
+
+vector<vfs_archive_t> vfs_archives;
+mutex                 vfs_lock;
+
+///////////////////////////////////////////
+
+const char *vfs_normalize_start(const char *filename) {
+	while (filename[0] == '.' && (filename[1] == '/' || filename[1] == '\\'))
+		filename += 2;
+	return filename;
+}
+
+///////////////////////////////////////////
+
+inline char vfs_normalize_char(char ch) {
+	return ch == '\\' ? '/' : (char)tolower((unsigned char)ch);
+}
+
+///////////////////////////////////////////
+
+uint64_t vfs_hash(const char *filename) {
+	// Same FNV-1a as string_hash, but on the normalized name, so 'Models\a.glb'
+	// and 'models/a.glb' find the same entry.
+	uint64_t hash = STREF_HASH_START;
+	for (const char *ch = vfs_normalize_start(filename); *ch != '\0'; ch++)
+		hash = (hash ^ (uint8_t)vfs_normalize_char(*ch)) * 1099511628211;
+	return hash;
+}
+
+///////////////////////////////////////////
+
+bool vfs_name_eq(const char *a, const char *b) {
+	a = vfs_normalize_start(a);
+	b = vfs_normalize_start(b);
+	while (*a != '\0' && *b != '\0') {
+		if (vfs_normalize_char(*a) != vfs_normalize_char(*b))
+			return false;
+		a++; b++;
+	}
+	return *a == *b;
+}
+
+///////////////////////////////////////////
+
+bool vfs_is_absolute(const char *filename) {
+	return strchr(filename, ':') != nullptr;
+}
+
+///////////////////////////////////////////
+
+// Whether offset and size fit inside total, without adding anything that
+// a corrupt archive could overflow.
+inline bool vfs_in_range(uint64_t offset, uint64_t size, uint64_t total) {
+	return offset <= total && size <= total - offset;
+}
+
+///////////////////////////////////////////
+
+HANDLE vfs_os_open(const char *path) {
+#if WINDOWS_UWP
+	wchar_t wpath[1024];
+	if (MultiByteToWideChar(CP_UTF8, 0, path, -1, wpath, _countof(wpath)) == 0)
+		return INVALID_HANDLE_VALUE;
+	return CreateFile2(wpath, GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr);
+#else
+	return CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+#endif
+}
+
+///////////////////////////////////////////
+
+bool vfs_read_loose(const char *filename, vfs_file_t &out_file) {
+	char path[1024];
+	assets_file_path(filename, path, sizeof(path));
+
+	// Open, size, read, close. That's the whole syscall budget for a loose file.
+	HANDLE file = vfs_os_open(path);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart > 0xFFFFFFFF) {
+		CloseHandle(file);
+		return false;
+	}
+
+	// One extra zeroed byte, so text formats can treat the data as a string
+	uint8_t *data = (uint8_t*)malloc((size_t)size.QuadPart + 1);
+	DWORD    read = 0;
+	if (data == nullptr || !ReadFile(file, data, (DWORD)size.QuadPart, &read, nullptr) || read != (DWORD)size.QuadPart) {
+		free(data);
+		CloseHandle(file);
+		return false;
+	}
+	CloseHandle(file);
+	data[size.QuadPart] = 0;
+
+	out_file.data  = data;
+	out_file.size  = (size_t)size.QuadPart;
+	out_file.owned = data;
+	return true;
+}
+
+///////////////////////////////////////////
+
+const vfs_pack_entry_t *vfs_archive_find(const vfs_archive_t &archive, const char *filename, uint64_t hash) {
+	const vfs_pack_entry_t *end   = archive.entries + archive.entry_count;
+	const vfs_pack_entry_t *entry = lower_bound(archive.entries, end, hash, [](const vfs_pack_entry_t &e, uint64_t h) { return e.hash < h; });
+	for (; entry < end && entry->hash == hash; entry++) {
+		if (vfs_name_eq(archive.names + entry->name_offset, filename))
+			return entry;
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////
+
+bool vfs_open(const char *filename, vfs_file_t &out_file) {
+	out_file = {};
+	if (filename == nullptr)
+		return false;
+
+	if (!vfs_is_absolute(filename)) {
+		uint64_t hash = vfs_hash(filename);
+
+		lock_guard<mutex> lock(vfs_lock);
+		// Most recently mounted archives take priority, so patches can be
+		// mounted over the top of a base archive.
+		for (size_t i = vfs_archives.size(); i > 0; i--) {
+			const vfs_archive_t    &archive = vfs_archives[i-1];
+			const vfs_pack_entry_t *entry   = vfs_archive_find(archive, filename, hash);
+			if (entry == nullptr)
+				continue;
+
+			if (entry->compression != vfs_compression_none) {
+				log_errf("'%s' in archive '%s' uses an unsupported compression type (%u)!", filename, archive.name, entry->compression);
+				return false;
+			}
+			out_file.data = archive.data + entry->offset;
+			out_file.size = (size_t)entry->size;
+			return true;
+		}
+	}
+
+	return vfs_read_loose(filename, out_file);
+}
+
+///////////////////////////////////////////
+
+void vfs_close(vfs_file_t &file) {
+	free(file.owned);
+	file = {};
+}
+
+///////////////////////////////////////////
+
+void vfs_archive_unmap(vfs_archive_t &archive) {
+	if (archive.data    != nullptr) UnmapViewOfFile(archive.data);
+	if (archive.mapping != nullptr) CloseHandle    (archive.mapping);
+	if (archive.file    != nullptr && archive.file != INVALID_HANDLE_VALUE) CloseHandle(archive.file);
+	free(archive.name);
+	archive = {};
+}
+
+///////////////////////////////////////////
+
+bool32_t vfs_mount(const char *archive_file) {
+	char path[1024];
+	assets_file_path(archive_file, path, sizeof(path));
+
+	vfs_archive_t archive = {};
+	archive.file = vfs_os_open(path);
+	if (archive.file == INVALID_HANDLE_VALUE) {
+		log_errf("Couldn't open archive '%s'!", path);
+		return false;
+	}
+	archive.name = string_copy(archive_file);
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(archive.file, &size) || size.QuadPart <= 0) {
+		log_errf("Couldn't get the size of archive '%s'!", path);
+		vfs_archive_unmap(archive);
+		return false;
+	}
+	archive.size = (uint64_t)size.QuadPart;
+
+#if WINDOWS_UWP
+	archive.mapping = CreateFileMappingFromApp(archive.file, nullptr, PAGE_READONLY, 0, nullptr);
+	if (archive.mapping != nullptr)
+		archive.data = (const uint8_t*)MapViewOfFileFromApp(archive.mapping, FILE_MAP_READ, 0, 0);
+#else
+	archive.mapping = CreateFileMappingA(archive.file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (archive.mapping != nullptr)
+		archive.data = (const uint8_t*)MapViewOfFile(archive.mapping, FILE_MAP_READ, 0, 0, 0);
+#endif
+	if (archive.data == nullptr) {
+		log_errf("Couldn't map archive '%s' into memory!", path);
+		vfs_archive_unmap(archive);
+		return false;
+	}
+
+	// Validate everything up front, so lookups don't need to. None of the
+	// values in the file can be trusted, so ranges are checked by what's
+	// left of the file rather than by adding them up.
+	if (archive.size < sizeof(vfs_pack_header_t)) {
+		log_errf("Archive '%s' is too small to be valid!", path);
+		vfs_archive_unmap(archive);
+		return false;
+	}
+	const vfs_pack_header_t *header   = (const vfs_pack_header_t*)archive.data;
+	uint64_t                 toc_size = (uint64_t)header->entry_count * sizeof(vfs_pack_entry_t);
+	if (header->magic != VFS_PACK_MAGIC || header->version != VFS_PACK_VERSION ||
+		!vfs_in_range(header->toc_offset,            toc_size,           archive.size) ||
+		!vfs_in_range(header->toc_offset + toc_size, header->names_size, archive.size) ||
+		(header->names_size > 0 && archive.data[header->toc_offset + toc_size + header->names_size - 1] != '\0')) {
+		log_errf("'%s' isn't a valid v%d archive!", path, VFS_PACK_VERSION);
+		vfs_archive_unmap(archive);
+		return false;
+	}
+	archive.entries     = (const vfs_pack_entry_t*)(archive.data + header->toc_offset);
+	archive.names       = (const char*)(archive.data + header->toc_offset + toc_size);
+	archive.entry_count = header->entry_count;
+	for (uint32_t i = 0; i < archive.entry_count; i++) {
+		// Uncompressed entries are handed out as-is, so their size has to
+		// be the size that's actually stored.
+		const vfs_pack_entry_t &entry = archive.entries[i];
+		if (!vfs_in_range(entry.offset, entry.stored_size, archive.size) || entry.name_offset >= header->names_size ||
+			(entry.compression == vfs_compression_none && entry.size != entry.stored_size)) {
+			log_errf("Archive '%s' has a corrupt entry!", path);
+			vfs_archive_unmap(archive);
+			return false;
+		}
+	}
+
+	lock_guard<mutex> lock(vfs_lock);
+	vfs_archives.push_back(archive);
+	log_diagf("Mounted archive '%s', %u files.", archive_file, archive.entry_count);
+	return true;
+}
+
+///////////////////////////////////////////
+
+bool32_t vfs_pack(const char *archive_file, const char **files, int32_t file_count) {
+	char path[1024];
+	assets_file_path(archive_file, path, sizeof(path));
+
+	FILE *fp;
+	if (fopen_s(&fp, path, "wb") != 0 || fp == nullptr) {
+		log_errf("Couldn't create archive '%s'!", path);
+		return false;
+	}
+
+	vector<vfs_pack_entry_t> entries;
+	vector<char>             names;
+	uint64_t                 offset = sizeof(vfs_pack_header_t);
+	const uint8_t            padding[vfs_pack_align] = {};
+	fwrite(padding, 1, sizeof(vfs_pack_header_t), fp);
+
+	for (int32_t i = 0; i < file_count; i++) {
+		vfs_file_t file;
+		if (!vfs_read_loose(files[i], file)) {
+			log_errf("Couldn't read '%s' for archive '%s'!", files[i], path);
+			fclose(fp);
+			return false;
+		}
+
+		uint64_t pad = (vfs_pack_align - (offset % vfs_pack_align)) % vfs_pack_align;
+		fwrite(padding, 1, (size_t)pad, fp);
+		offset += pad;
+
+		vfs_pack_entry_t entry = {};
+		entry.hash        = vfs_hash(files[i]);
+		entry.offset      = offset;
+		entry.size        = file.size;
+		entry.stored_size = file.size;
+		entry.compression = vfs_compression_none;
+		entry.name_offset = (uint32_t)names.size();
+		entries.push_back(entry);
+
+		const char *name = vfs_normalize_start(files[i]);
+		for (const char *ch = name; *ch != '\0'; ch++)
+			names.push_back(vfs_normalize_char(*ch));
+		names.push_back('\0');
+
+		fwrite(file.data, 1, file.size, fp);
+		offset += file.size;
+		vfs_close(file);
+	}
+
+	sort(entries.begin(), entries.end(), [](const vfs_pack_entry_t &a, const vfs_pack_entry_t &b) { return a.hash < b.hash; });
+
+	uint64_t pad = (vfs_pack_align - (offset % vfs_pack_align)) % vfs_pack_align;
+	fwrite(padding, 1, (size_t)pad, fp);
+	offset += pad;
+
+	vfs_pack_header_t header = {};
+	header.magic       = VFS_PACK_MAGIC;
+	header.version     = VFS_PACK_VERSION;
+	header.entry_count = (uint32_t)entries.size();
+	header.names_size  = (uint32_t)names.size();
+	header.toc_offset  = offset;
+	if (entries.size() > 0) fwrite(entries.data(), sizeof(vfs_pack_entry_t), entries.size(), fp);
+	if (names  .size() > 0) fwrite(names  .data(), 1,                        names  .size(), fp);
+	fseek (fp, 0, SEEK_SET);
+	fwrite(&header, sizeof(header), 1, fp);
+	fclose(fp);
+
+	log_diagf("Packed %d files into '%s'.", file_count, archive_file);
+	return true;
+}
+
+///////////////////////////////////////////
+
+void vfs_shutdown() {
+	lock_guard<mutex> lock(vfs_lock);
+	for (size_t i = 0; i < vfs_archives.size(); i++)
+		vfs_archive_unmap(vfs_archives[i]);
+	vfs_archives.clear();
+}
+
+} // namespace sk
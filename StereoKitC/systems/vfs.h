@@ -0,0 +1,57 @@
+#pragma once
+
+#include "../stereokit.h"
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// A read-only view of a whole file. When the file comes from a mounted
+// archive, data points straight into the archive's memory mapped view, and
+// nothing is copied! Loose files are read into memory, and owned by the
+// view. Either way, vfs_close must be called when done.
+struct vfs_file_t {
+	const void *data;
+	size_t      size;
+	void       *owned;
+};
+
+enum vfs_compression_ {
+	vfs_compression_none = 0,
+	vfs_compression_lz4  = 1,
+	vfs_compression_zstd = 2,
+};
+
+///////////////////////////////////////////
+
+// Archive layout, all little endian. The table of contents is sorted by
+// hash, so lookups are a binary search, and file data is aligned to
+// vfs_pack_align so views can be handed to loaders without copying.
+#define VFS_PACK_MAGIC   0x4B504B53 // 'SKPK'
+#define VFS_PACK_VERSION 1
+const uint64_t vfs_pack_align = 64;
+
+struct vfs_pack_header_t {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entry_count;
+	uint32_t names_size;
+	uint64_t toc_offset;
+};
+struct vfs_pack_entry_t {
+	uint64_t hash;        // vfs_hash of the normalized file name
+	uint64_t offset;      // from the start of the archive
+	uint64_t size;        // uncompressed size
+	uint64_t stored_size; // size in the archive
+	uint32_t compression; // vfs_compression_
+	uint32_t name_offset; // into the names block after the toc
+};
+
+///////////////////////////////////////////
+
+bool     vfs_open    (const char *filename, vfs_file_t &out_file);
+void     vfs_close   (vfs_file_t &file);
+uint64_t vfs_hash    (const char *filename);
+void     vfs_shutdown();
+
+} // namespace sk